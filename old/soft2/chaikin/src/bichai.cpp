@@ -2,7 +2,7 @@
   File:          bichai.cpp
   Author:        J.K. Johnstone 
   Created:	 3 July 2001
-  Last Modified: 28 February 2006
+  Last Modified: 17 October 2026
   Purpose:       Compute bitangents in dual space
   		 of two Chaikin subdivision curves.
   Input: 	 Closed control polygons.
@@ -19,6 +19,7 @@
 		          to allow visual understanding and testing of duality.
 		 7/15/03: Added LAPTOP option.
 		 2/28/06: Updated to modern C++ library.
+		 10/17/26: Fused split/average stencil (subdivide.h).
 */
 
 #include <GL/glut.h>
@@ -38,6 +39,7 @@ using std::string;
 #include "basic/Vector.h"
 #include "basic/MiscVector.h"
 #include "basic2/Line.h"
+#include "subdivide.h"		// subdivideClosed
 
 #define PTSPERBEZSEGMENT 10      // # pts to draw on each Bezier segment
 
@@ -343,14 +345,8 @@ void split()
 void average()
 {
   prevchai = chai;
-  for (int c=0; c<2; c++)
-   {
-    int nPt = chaicirc[c].getn();
-    chai[c].allocate (nPt);
-    for (int i=0; i<nPt; i++)
-      for (int j=0; j<2; j++)	// each coordinate
-        chai[c][i][j] = (chaicirc[c][i][j] + chaicirc[c][(i+1)%nPt][j]) / 2.;
-   }
+  // split and average fused into one stencil (chaicirc is only for display)
+  for (int c=0; c<2; c++) subdivideClosed (prevchai[c], SUBCHAIKIN, 1, &chai[c]);
   subStage++;
 }
 
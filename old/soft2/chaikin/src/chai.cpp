@@ -2,7 +2,7 @@
   File:          chai.cpp
   Author:        J.K. Johnstone 
   Created:	 27 June 2001
-  Last Modified: 28 February 2006
+  Last Modified: 17 October 2026
   Purpose:       Compute one Chaikin curve and its dual,
   		 illustrating the subdivision step in primal space
 		 and its analog in dual space.
@@ -18,6 +18,14 @@
 		 11/12/03: Added cubic B-spline and DLG options.
 		           Dualizing may not work with these?
 		 2/28/06:  Updated to modern C++ library.
+		 10/17/26: Fused split/average stencils with ghost points and
+		           SSE/AVX kernels (subdivide.h); -s to subdivide 
+			   several levels at start.
+		 10/17/26: Lazy level cache: a level (primal or dual) is only
+		           computed when first needed, directly from the nearest
+			   coarser level, and least recently used levels are 
+			   evicted beyond a memory budget (-m).
+			   Dualization in blocks of 4 edges, without branches.
 */
 
 #include <GL/glut.h>
@@ -37,9 +45,10 @@ using std::string;
 #include "basic/Vector.h"
 #include "basic/MiscVector.h"
 #include "basic2/Line.h"
+#include "subdivide.h"			// subdivideClosed
 
 #define PTSPERBEZSEGMENT 10      // # pts to draw on each Bezier segment
-#define NLEVEL           1000    // maximum subdivision level
+#define NLEVEL           (MAXSUBDIVLEVEL+1)   // # subdivision levels (0..MAXSUBDIVLEVEL)
 
 static char *RoutineName;
 static void usage()
@@ -47,6 +56,8 @@ static void usage()
   cout << "Usage is " << RoutineName << endl;
   cout << "\t[-b] (cubic B-spline instead of Chaikin)" << endl;
   cout << "\t[-d] (DLG interpolatory scheme instead of Chaikin)" << endl;
+  cout << "\t[-s #] (subdivide # levels before display; at most " << MAXSUBDIVLEVEL << ")" << endl;
+  cout << "\t[-m #] (memory budget of cached levels in Mb; default 256)" << endl;
   cout << "\t[-l] (laptop)" << endl;
   cout << "\t[-w] (Windows)" << endl;
   cout << "\t[-h] (this help message)" << endl;
@@ -81,6 +92,10 @@ IntArrArr finiteA;		        // finite a-dual vertices
 IntArrArr finiteB;
 int 	  stage=0;		        // display stage within subdivision level
 int       level=0;                      // subdivision level
+int       dualValid[NLEVEL];            // are chaida/chaidb[i] computed for chai[i]?
+long      lastUse[NLEVEL];              // when was level i last requested?
+long      useClock=0;
+double    levelBudget=256*1048576.;     // bytes of cached levels before eviction
 
 int	  obstacleWin;	                // identifier for left obstacle window
 int	  dualWin;	                // identifier for top right dual window
@@ -132,37 +147,142 @@ void visibility (int status)
 }
 
 /******************************************************************************
-	Map Chaikin polygons to dual Chaikin polygons.
 ******************************************************************************/
 
-void dualize()
+int scheme()
+{
+  return (CUBICBSPLINE ? SUBBSPLINE : (DLG ? SUBDLG : SUBCHAIKIN));
+}
+
+/******************************************************************************
+	Map the edges of polygon P to dual points: 
+	edge i, on the line ax+by+c=0, maps to (c/a,b/a) in a-space (finite
+	iff a != 0) and to (a/b,c/b) in b-space (finite iff b != 0).
+	The ratios do not depend on the scale of (a,b,c), so
+	a = y_i - y_{i+1}, b = x_{i+1} - x_i, c = x_i y_{i+1} - x_{i+1} y_i.
+	Edges are processed 4 at a time; infinite dual points are 
+	masked to 0 rather than branched around.
+******************************************************************************/
+
+void dualizeEdges (V2fArr &P, V2fArr &da, V2fArr &db, IntArr &fa, IntArr &fb)
 {
-  chaida[level].allocate(chai[level].getn());
-  chaidb[level].allocate(chai[level].getn());
-  finiteA[level].allocate(chai[level].getn());
-  finiteB[level].allocate(chai[level].getn());
-  for (int i=0; i<chai[level].getn(); i++)	// for each edge
+  int i, k, n = P.getn();
+  da.allocate(n);  db.allocate(n);  fa.allocate(n);  fb.allocate(n);
+  for (i=0; i<n; i+=4)
    {
-    float a,b,c;	// coordinates of line ax+by+c=0 defining ith edge
-    Line2f L(chai[level][i], chai[level][(i+1)%chai[level].getn()]);
-    L.implicitEqn (a,b,c);
-    if (a != 0)
+    float x0[4], y0[4], x1[4], y1[4], ra[8], rb[8];
+    int   m = (n-i < 4 ? n-i : 4);
+    for (k=0; k<4; k++)
      {
-      chaida[level][i][0] = c/a;		// a-duality
-      chaida[level][i][1] = b/a;
-      finiteA[level][i] = 1;
+      int e = i + (k < m ? k : 0);		// pad the last block
+      x0[k] = P[e][0];  y0[k] = P[e][1];
+      x1[k] = P[(e+1)%n][0];  y1[k] = P[(e+1)%n][1];
      }
-    else finiteA[level][i] = 0;
-    if (b != 0)
+#ifdef __SSE__
+    __m128 X0 = _mm_loadu_ps (x0), Y0 = _mm_loadu_ps (y0);
+    __m128 X1 = _mm_loadu_ps (x1), Y1 = _mm_loadu_ps (y1);
+    __m128 A = _mm_sub_ps (Y0, Y1), B = _mm_sub_ps (X1, X0);
+    __m128 C = _mm_sub_ps (_mm_mul_ps (X0, Y1), _mm_mul_ps (X1, Y0));
+    __m128 zero = _mm_setzero_ps();
+    __m128 okA = _mm_cmpneq_ps (A, zero), okB = _mm_cmpneq_ps (B, zero);
+    __m128 one = _mm_set1_ps (1.f);
+    __m128 iA = _mm_and_ps (okA, _mm_div_ps (one, _mm_or_ps (A, _mm_andnot_ps (okA, one))));
+    __m128 iB = _mm_and_ps (okB, _mm_div_ps (one, _mm_or_ps (B, _mm_andnot_ps (okB, one))));
+    _mm_storeu_ps (ra,   _mm_mul_ps (C, iA));  _mm_storeu_ps (ra+4, _mm_mul_ps (B, iA));
+    _mm_storeu_ps (rb,   _mm_mul_ps (A, iB));  _mm_storeu_ps (rb+4, _mm_mul_ps (C, iB));
+    int maskA = _mm_movemask_ps (okA), maskB = _mm_movemask_ps (okB);
+#else
+    int maskA=0, maskB=0;
+    for (k=0; k<4; k++)
      {
-      chaidb[level][i][0] = a/b;		// b-duality
-      chaidb[level][i][1] = c/b; 
-      finiteB[level][i] = 1;
+      float a = y0[k] - y1[k], b = x1[k] - x0[k], c = x0[k]*y1[k] - x1[k]*y0[k];
+      float iA = (a != 0 ? 1/a : 0), iB = (b != 0 ? 1/b : 0);
+      ra[k] = c*iA;  ra[k+4] = b*iA;  rb[k] = a*iB;  rb[k+4] = c*iB;
+      maskA |= (a != 0) << k;  maskB |= (b != 0) << k;
      }
-    else finiteB[level][i] = 0;
+#endif
+    for (k=0; k<m; k++)
+     {
+      da[i+k][0] = ra[k];  da[i+k][1] = ra[k+4];  fa[i+k] = (maskA >> k) & 1;
+      db[i+k][0] = rb[k];  db[i+k][1] = rb[k+4];  fb[i+k] = (maskB >> k) & 1;
+     }
+   }
+}
+
+/******************************************************************************
+	Memory (in bytes) of the cached data of level k.
+******************************************************************************/
+
+double levelMemory (int k)
+{
+  return 8.*(chai[k].getn() + chaicirc[k].getn()) + 
+        24.*(dualValid[k] ? chai[k].getn() : 0);
+}
+
+/******************************************************************************
+	Evict least recently used levels (never level 0 or keep)
+	until the cached levels fit in levelBudget.
+******************************************************************************/
+
+void evictLevels (int keep)
+{
+  int k;
+  double used=0;
+  for (k=0; k<NLEVEL; k++) used += levelMemory(k);
+  while (used > levelBudget)
+   {
+    int lru=-1;
+    for (k=1; k<NLEVEL; k++)
+      if (k != keep && levelMemory(k) > 0 && (lru == -1 || lastUse[k] < lastUse[lru]))
+	lru = k;
+    if (lru == -1) return;
+    used -= levelMemory(lru);
+    chai[lru].allocate(0);  chaicirc[lru].allocate(0);
+    chaida[lru].allocate(0);  chaidb[lru].allocate(0);
+    finiteA[lru].allocate(0); finiteB[lru].allocate(0);
+    dualValid[lru] = 0;
    }
 }
 
+void split();
+
+/******************************************************************************
+	Make sure that the Chaikin polygon of level k is computed:
+	subdivide directly from the nearest coarser level in the cache
+	(intermediate levels are not stored).
+	If the split vertices are displayed, they are rebuilt too
+	(they were evicted, or the level was never split).
+******************************************************************************/
+
+void primalLevel (int k)
+{
+  lastUse[k] = ++useClock;
+  if (chai[k].getn() == 0)
+   {
+    int j=k-1;
+    while (chai[j].getn() == 0) j--;		// level 0 is never evicted
+    subdivideClosed (chai[j], scheme(), k-j, chai[k]);
+    dualValid[k] = 0;
+   }
+  else if (!DRAWSPLIT || k != level || chaicirc[k].getn() > 0) return;
+  if (DRAWSPLIT && k == level && chaicirc[k].getn() == 0) split();
+  evictLevels (k);
+}
+
+/******************************************************************************
+	Map Chaikin polygons to dual Chaikin polygons
+	(the present level, computed on first request).
+******************************************************************************/
+
+void dualize()
+{
+  primalLevel (level);
+  if (dualValid[level]) return;
+  dualizeEdges (chai[level], chaida[level], chaidb[level], finiteA[level], finiteB[level]);
+  dualValid[level] = 1;
+  evictLevels (level);
+}
+
 /******************************************************************************
 	Splitting step (see p. 63 of Stollnitz, DeRose and Salesin `Wavelets')
 ******************************************************************************/
@@ -185,27 +305,10 @@ void split()
 
 void average()
 {
-  int nPt = chaicirc[level].getn();
-  chai[level+1].allocate (nPt);
-  for (int i=0; i<nPt; i++)
-    for (int j=0; j<2; j++)	// each coordinate
-      if (CHAIKIN)
-	chai[level+1][i][j] = (chaicirc[level][i][j] + chaicirc[level][(i+1)%nPt][j]) / 2.;
-      else if (CUBICBSPLINE)
-	chai[level+1][i][j] = chaicirc[level][mod(i-1,nPt)][j]/4 + 
-	                      chaicirc[level][i][j]/2 + 
-	                      chaicirc[level][(i+1)%nPt][j]/4;
-      else if (DLG)
-	{
-	  if (i%2==0) chai[level+1][i][j] = chaicirc[level][i][j];
-	  else chai[level+1][i][j] = (-2*chaicirc[level][mod(i-2,nPt)][j] + 
-				       5*chaicirc[level][mod(i-1,nPt)][j] + 
-				      10*chaicirc[level][i][j] + 
-				       5*chaicirc[level][(i+1)%nPt][j] 
-				      -2*chaicirc[level][(i+2)%nPt][j])/16.;
-	}
+  if (level == NLEVEL-1) return;
+  // split and average fused into one stencil (chaicirc is only for display)
   level++;
-  if (level == NLEVEL) level--;
+  primalLevel (level);
 }
 
 /******************************************************************************
@@ -233,7 +336,8 @@ void keyboard (unsigned char key, int x, int y)
 		   DRAWSPLIT=1; stage=0; }
 		 				break;	
   case 9:	split(); average(); dualize();  break; // TAB
-  case 8:       level--; if (level<0) level=0;  stage=0; break; // backspace
+  case 8:       level--; if (level<0) level=0;  stage=0;        // backspace
+		DRAWSPLIT=0;  dualize();	break;	// may have been evicted
   case 27:	exit(1); 			break; // ESCAPE
   default:      				break;
   }
@@ -336,7 +440,7 @@ void menuOb (int value)
   switch (value) {
   case 1: 	DRAWVERT = !DRAWVERT;			break;
   case 2:	DRAWEDGE = !DRAWEDGE;			break;
-  case 3:       level--;                                break;
+  case 3:       level--; if (level<0) level=0;  dualize();  break;
   case 4:	DRAWBIGFIRST = !DRAWBIGFIRST;		break;
   case 5:	DRAWBIGSECOND = !DRAWBIGSECOND;		break;
   case 6: 	DONTDRAWBLUE = !DONTDRAWBLUE;		break;
@@ -423,7 +527,7 @@ void displayOb ()
 	glVertex2f (chai[level][j][0], chai[level][j][1]);
       glEnd();
      }
-    if (DRAWSPLIT && !DONTDRAWBLUE)
+    if (DRAWSPLIT && !DONTDRAWBLUE && chaicirc[level].getn() >= 5)
      {
       glColor3fv (Blue);
       if (WINDOWS)
@@ -467,7 +571,7 @@ void displayOb ()
 	glVertex2f (chai[level][j][0], chai[level][j][1]);
       glEnd();
      }
-    if (DRAWSPLIT && !DONTDRAWBLUE)
+    if (DRAWSPLIT && !DONTDRAWBLUE && chaicirc[level].getn() >= 5)
      {
       glColor3fv (Blue);
       if (WINDOWS)
@@ -627,7 +731,7 @@ void displayDual ()
         glEnd();
        }
      }
-    if (DRAWSPLIT && !DONTDRAWBLUE)
+    if (DRAWSPLIT && !DONTDRAWBLUE && chaicirc[level].getn() >= 5)
      {
       glColor3fv (Blue);
       for (j=(stage<2?0:1); j<3; j++)
@@ -659,7 +763,7 @@ void displayDual ()
         glEnd();
        }
      }
-    if (DRAWSPLIT && !DONTDRAWBLUE)
+    if (DRAWSPLIT && !DONTDRAWBLUE && chaicirc[level].getn() >= 5)
      {
       glColor3fv (Blue);
       for (j=2; j<(stage<2?5:4); j++)
@@ -905,6 +1009,7 @@ int main (int argc, char **argv)
 {
   int       ArgsParsed=0;
 //float     eps = .0001;	// accuracy of intersection computation
+  int       nStartLevel=0;	// # levels to subdivide before display
 
   RoutineName = argv[ArgsParsed++];
   if (argc == 1) { usage(); exit(-1); }
@@ -916,6 +1021,8 @@ int main (int argc, char **argv)
 //    case 'e': eps = atof(argv[ArgsParsed++]);			break;
       case 'b': CUBICBSPLINE = 1; CHAIKIN=0;                    break;
       case 'd': DLG = 1; CHAIKIN = 0;                           break;
+      case 's': nStartLevel = atoi(argv[ArgsParsed++]);         break;
+      case 'm': levelBudget = atof(argv[ArgsParsed++]) * 1048576.; break;
       case 'l': LAPTOP = 1;                                     break;
       case 'w': WINDOWS = 1;                                    break;
       case 'h': 
@@ -932,6 +1039,16 @@ int main (int argc, char **argv)
   
   // compute dual Chaikin vertices
   dualize();
+  if (nStartLevel > NLEVEL-1)
+   {
+    cerr << "Subdividing " << NLEVEL-1 << " levels, not " << nStartLevel << endl;
+    nStartLevel = NLEVEL-1;
+   }
+  if (nStartLevel > 0)		// only the finest level is computed and stored
+   {
+    level = nStartLevel;
+    dualize();
+   }
      
   /************************************************************/
     
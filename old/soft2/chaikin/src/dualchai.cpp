@@ -2,7 +2,7 @@
   File:          dualchai.cpp
   Author:        J.K. Johnstone 
   Created:	 18 July 2001
-  Last Modified: 15 July 2003
+  Last Modified: 17 October 2026
   Purpose:       Input defines the dual Chaikin curve instead,
   		 otherwise equivalent to chai.cpp.
 		 Only change is predualize and argument to input function.
@@ -10,6 +10,7 @@
   Input: 	 Closed control polygons.
   Output: 	 Point pairs defining bitangents.
   History: 	 7/15/03:  Added LAPTOP option.
+		 10/17/26: Fused split/average stencil (subdivide.h).
 */
 
 #include <GL/glut.h>
@@ -28,6 +29,7 @@ using std::string;
 #include "Miscellany.h"
 #include "Vector.h"
 #include "Line.h"
+#include "subdivide.h"		// subdivideClosed
 
 #define PTSPERBEZSEGMENT 10      // # pts to draw on each Bezier segment
 #define WINDOWS 0		// 0 for running on SGI, 1 for Windows
@@ -247,13 +249,11 @@ void average()
   prevchai = chai;
   prevActiveEdge = activeEdge;
   prevActiveEdgeb = activeEdgeb;
-  int nPt = chaicirc[0].getn();
-  chai[0].allocate (nPt);
+  // split and average fused into one stencil (chaicirc is only for display)
+  subdivideClosed (prevchai[0], SUBCHAIKIN, 1, &chai[0]);
+  int nPt = chai[0].getn();
   activeEdge.allocate (nPt);
   activeEdgeb.allocate(nPt);
-  for (i=0; i<nPt; i++)
-    for (j=0; j<2; j++)	// each coordinate
-      chai[0][i][j] = (chaicirc[0][i][j] + chaicirc[0][(i+1)%nPt][j]) / 2.;
       
   // update active edges: any edge in stage i+1 with a vertex lying on an
   // inactive edge of stage i is marked inactive.
@@ -273,11 +273,7 @@ void average()
    }
 
   prevchaib = chaib;
-  nPt = chaicircb[0].getn();
-  chaib[0].allocate (nPt);
-  for (i=0; i<nPt; i++)
-    for (j=0; j<2; j++)	// each coordinate
-      chaib[0][i][j] = (chaicircb[0][i][j] + chaicircb[0][(i+1)%nPt][j]) / 2.;
+  subdivideClosed (prevchaib[0], SUBCHAIKIN, 1, &chaib[0]);
 }
 
 /******************************************************************************
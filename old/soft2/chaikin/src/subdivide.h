@@ -0,0 +1,227 @@
+/*
+  File:          subdivide.h
+  Created:	 17 October 2026
+  Purpose:       Fused subdivision of closed polygons by the Chaikin,
+                 cubic B-spline and DLG (Dyn-Levin-Gregory 4-point) schemes.
+		 Splitting followed by averaging (Stollnitz, DeRose and
+		 Salesin, p. 63) is folded into one stencil per scheme,
+		 from the vertices p of one level to the vertices q of the next:
+		   Chaikin:   q[2i] = (3p[i] + p[i+1])/4,
+		              q[2i+1] = (p[i] + 3p[i+1])/4
+		   B-spline:  q[2i] = (p[i-1] + 6p[i] + p[i+1])/8,
+		              q[2i+1] = (p[i] + p[i+1])/2
+		   DLG:       q[2i] = p[i],
+		              q[2i+1] = (-p[i-1] + 9p[i] + 9p[i+1] - p[i+2])/16
+		 Coordinates are kept in separate x and y arrays with one ghost
+		 vertex before and two after (copies of the wrapped vertices),
+		 so the stencils need no modular indexing, and are run 4 (SSE)
+		 or 8 (AVX, if compiled with -mavx) vertices at a time.
+		 Several levels are computed between two buffers allocated once.
+  Usage:	 subdivideClosed (chai[level], SUBCHAIKIN, 1, &chai[level+1]);
+  		 subdivideClosed (poly, SUBDLG, 10, level);	// level[0..9]
+		 subdivideClosed (poly, SUBDLG, 10, finest);	// level 10 only
+*/
+
+#ifndef _SUBDIVIDE_H_
+#define _SUBDIVIDE_H_
+
+#include <limits.h>
+
+#ifdef __SSE__
+#include <xmmintrin.h>
+#endif
+#ifdef __AVX__
+#include <immintrin.h>
+#endif
+
+#define SUBCHAIKIN	0		// subdivision schemes
+#define SUBBSPLINE	1
+#define SUBDLG		2
+
+#define MAXSUBDIVLEVEL	20		// each level doubles the vertices
+
+struct SubdivBuffer		// x[1..n], y[1..n] are the vertices; x[0], x[n+1], x[n+2] ghosts
+{
+  float *x, *y;
+  int    n;
+};
+
+/******************************************************************************/
+/******************************************************************************/
+
+static void allocSubdivBuffer (SubdivBuffer &b, int size)
+{
+  b.x = new float[size+3];  b.y = new float[size+3];  b.n = 0;
+}
+
+static void freeSubdivBuffer (SubdivBuffer &b)
+{
+  delete [] b.x;  delete [] b.y;
+}
+
+static void setGhosts (SubdivBuffer &b)
+{
+  int n = b.n;
+  b.x[0]   = b.x[n];       b.y[0]   = b.y[n];
+  b.x[n+1] = b.x[1];       b.y[n+1] = b.y[1];
+  b.x[n+2] = b.x[1 + 1%n]; b.y[n+2] = b.y[1 + 1%n];
+}
+
+/******************************************************************************
+	Scalar stencil of one output pair (q[2i], q[2i+1]) from p[i-1..i+2].
+******************************************************************************/
+
+template <int SCHEME>
+static inline void subdivideStencil (const float *p, float *q, int i)
+{
+  if (SCHEME == SUBCHAIKIN)
+   {
+    q[2*i]   = .75f*p[i] + .25f*p[i+1];
+    q[2*i+1] = .25f*p[i] + .75f*p[i+1];
+   }
+  else if (SCHEME == SUBBSPLINE)
+   {
+    q[2*i]   = .125f*(p[i-1] + p[i+1]) + .75f*p[i];
+    q[2*i+1] = .5f*(p[i] + p[i+1]);
+   }
+  else
+   {
+    q[2*i]   = p[i];
+    q[2*i+1] = (9*(p[i] + p[i+1]) - (p[i-1] + p[i+2])) * .0625f;
+   }
+}
+
+/******************************************************************************
+	One coordinate of one level: p[0..n-1] (with p[-1], p[n], p[n+1]
+	valid ghosts) to q[0..2n-1].
+******************************************************************************/
+
+template <int SCHEME>
+static void subdivideCoord (const float *p, float *q, int n)
+{
+  int i=0;
+#ifdef __AVX__
+  const __m256 c75 = _mm256_set1_ps(.75f), c25 = _mm256_set1_ps(.25f),
+               c125 = _mm256_set1_ps(.125f), c5 = _mm256_set1_ps(.5f),
+	       c9 = _mm256_set1_ps(9.f), c0625 = _mm256_set1_ps(.0625f);
+  for (; i+8<=n; i+=8)
+   {
+    __m256 pm = _mm256_loadu_ps (p+i-1), p0 = _mm256_loadu_ps (p+i),
+           p1 = _mm256_loadu_ps (p+i+1), p2 = _mm256_loadu_ps (p+i+2), even, odd;
+    if (SCHEME == SUBCHAIKIN)
+     {
+      even = _mm256_add_ps (_mm256_mul_ps (c75, p0), _mm256_mul_ps (c25, p1));
+      odd  = _mm256_add_ps (_mm256_mul_ps (c25, p0), _mm256_mul_ps (c75, p1));
+     }
+    else if (SCHEME == SUBBSPLINE)
+     {
+      even = _mm256_add_ps (_mm256_mul_ps (c125, _mm256_add_ps (pm, p1)), _mm256_mul_ps (c75, p0));
+      odd  = _mm256_mul_ps (c5, _mm256_add_ps (p0, p1));
+     }
+    else
+     {
+      even = p0;
+      odd  = _mm256_mul_ps (c0625, _mm256_sub_ps (_mm256_mul_ps (c9, _mm256_add_ps (p0, p1)),
+						  _mm256_add_ps (pm, p2)));
+     }
+    __m256 lo = _mm256_unpacklo_ps (even, odd), hi = _mm256_unpackhi_ps (even, odd);
+    _mm256_storeu_ps (q+2*i,   _mm256_permute2f128_ps (lo, hi, 0x20));
+    _mm256_storeu_ps (q+2*i+8, _mm256_permute2f128_ps (lo, hi, 0x31));
+   }
+#endif
+#ifdef __SSE__
+  const __m128 d75 = _mm_set1_ps(.75f), d25 = _mm_set1_ps(.25f),
+               d125 = _mm_set1_ps(.125f), d5 = _mm_set1_ps(.5f),
+	       d9 = _mm_set1_ps(9.f), d0625 = _mm_set1_ps(.0625f);
+  for (; i+4<=n; i+=4)
+   {
+    __m128 pm = _mm_loadu_ps (p+i-1), p0 = _mm_loadu_ps (p+i),
+           p1 = _mm_loadu_ps (p+i+1), p2 = _mm_loadu_ps (p+i+2), even, odd;
+    if (SCHEME == SUBCHAIKIN)
+     {
+      even = _mm_add_ps (_mm_mul_ps (d75, p0), _mm_mul_ps (d25, p1));
+      odd  = _mm_add_ps (_mm_mul_ps (d25, p0), _mm_mul_ps (d75, p1));
+     }
+    else if (SCHEME == SUBBSPLINE)
+     {
+      even = _mm_add_ps (_mm_mul_ps (d125, _mm_add_ps (pm, p1)), _mm_mul_ps (d75, p0));
+      odd  = _mm_mul_ps (d5, _mm_add_ps (p0, p1));
+     }
+    else
+     {
+      even = p0;
+      odd  = _mm_mul_ps (d0625, _mm_sub_ps (_mm_mul_ps (d9, _mm_add_ps (p0, p1)),
+					    _mm_add_ps (pm, p2)));
+     }
+    _mm_storeu_ps (q+2*i,   _mm_unpacklo_ps (even, odd));
+    _mm_storeu_ps (q+2*i+4, _mm_unpackhi_ps (even, odd));
+   }
+#endif
+  for (; i<n; i++) subdivideStencil<SCHEME> (p, q, i);
+}
+
+/******************************************************************************
+	One level: in to out (which must hold 2*in.n vertices).
+******************************************************************************/
+
+void subdivideLevel (int scheme, SubdivBuffer &in, SubdivBuffer &out)
+{
+  switch (scheme)
+   {
+    case SUBCHAIKIN: subdivideCoord<SUBCHAIKIN> (in.x+1, out.x+1, in.n);
+		     subdivideCoord<SUBCHAIKIN> (in.y+1, out.y+1, in.n);  break;
+    case SUBBSPLINE: subdivideCoord<SUBBSPLINE> (in.x+1, out.x+1, in.n);
+		     subdivideCoord<SUBBSPLINE> (in.y+1, out.y+1, in.n);  break;
+    default:	     subdivideCoord<SUBDLG>     (in.x+1, out.x+1, in.n);
+		     subdivideCoord<SUBDLG>     (in.y+1, out.y+1, in.n);  break;
+   }
+  out.n = 2*in.n;
+  setGhosts (out);
+}
+
+/******************************************************************************
+	Subdivide closed polygon in nLevel times by scheme:
+	out[k] is the polygon after k+1 levels 
+	(if !allLevels, only out[0], the polygon after nLevel levels).
+	Nothing is computed if nLevel > MAXSUBDIVLEVEL or the 
+	n*2^nLevel vertices would overflow an int.
+******************************************************************************/
+
+static void subdivideClosed (V2fArr &in, int scheme, int nLevel, V2fArr *out, int allLevels)
+{
+  int i, k, n = in.getn();
+  if (n == 0 || nLevel < 1) return;
+  if (nLevel > MAXSUBDIVLEVEL || n > (INT_MAX - 4) >> nLevel)
+   {
+    cerr << "Cannot subdivide " << n << " vertices " << nLevel << " times" << endl;
+    return;
+   }
+  SubdivBuffer a, b;
+  allocSubdivBuffer (a, n << nLevel);  allocSubdivBuffer (b, n << nLevel);
+  for (i=0; i<n; i++) { a.x[i+1] = in[i][0];  a.y[i+1] = in[i][1]; }
+  a.n = n;  setGhosts (a);
+  for (k=0; k<nLevel; k++)
+   {
+    subdivideLevel (scheme, a, b);
+    if (allLevels || k == nLevel-1)
+     {
+      V2fArr &o = out[allLevels ? k : 0];
+      o.allocate (b.n);
+      for (i=0; i<b.n; i++) { o[i][0] = b.x[i+1];  o[i][1] = b.y[i+1]; }
+     }
+    SubdivBuffer t = a;  a = b;  b = t;
+   }
+  freeSubdivBuffer (a);  freeSubdivBuffer (b);
+}
+
+void subdivideClosed (V2fArr &in, int scheme, int nLevel, V2fArr *out)
+{
+  subdivideClosed (in, scheme, nLevel, out, 1);
+}
+
+void subdivideClosed (V2fArr &in, int scheme, int nLevel, V2fArr &finest)
+{
+  subdivideClosed (in, scheme, nLevel, &finest, 0);
+}
+
+#endif
@@ -2,8 +2,8 @@
   File:          convexhull.cpp
   Author:        J.K. Johnstone 
   Created:	 19 November 2001
-  Last Modified: 18 September 2002
-  Purpose:       Compute the smooth convex hull of a curve.
+  Last Modified: 17 October 2026
+  Purpose:       Compute the smooth convex hull of a scene of curves.
 		 Builds on tangentialCurve.c++, software for building the
 		 tangential curve of a Bezier curve,
 		 and extracts from selfbitang.c++.
@@ -13,6 +13,11 @@
   History: 	 9/16/02:  Added WINDOWS/PRINTOUT modes.
   		 9/18/02:  Added labels to bitangents.
 		 	   Built starting point robustly.
+		 10/17/26: O(n log n) merge of the bitangents (mergeCommonTangent).
+		 10/17/26: Disk cache of self-bitangents (-k).
+		 10/17/26: Convex hull of many curves (sceneHull.h): bounding
+		 	   polygon prefilter, bitangents between the curves
+			   near its boundary, and a sorted stack sweep (-S).
 */
 
 #include <GL/glut.h>
@@ -33,6 +38,10 @@ using std::string;
 #include "MiscVector.h"		
 #include "BezierCurve.h"	// drawTangent, drawPt
 #include "TangCurve.h"		// create; evalProj, drawCtrlPoly, drawPt (from RatBezierCurve inheritance)
+#include "bitangMerge.h"	// mergeCommonTangent (umbraPUBLISH/src)
+#include "tangCache.h"		// tangCacheKey, openTangCache (umbraPUBLISH/src)
+#include "bezierBatch.h"	// sampleBezierBatch (umbraPUBLISH/src)
+#include "sceneHull.h"		// sceneHullPrefilter, sceneHullSweep
 
 #define PTSPERBEZSEGMENT 30      // # pts to draw on each Bezier segment
 #define WINDOWS 0		// 0 for running on SGI, 1 for Windows
@@ -44,6 +53,9 @@ static void usage()
   cout << "\t[-d display density of Bezier segment] (default: 30)" << endl;
   cout << "\t[-p] (set to Postscript printing mode; default is screen display)" << endl;
   cout << "\t[-e eps] (accuracy at which intersections are made: default .0001)" << endl;
+  cout << "\t[-F featureSize] (merge bitangents closer than this: default 0, keep all)" << endl;
+  cout << "\t[-k] (cache bitangents in <file>.pts.convexhull.tcache)" << endl;
+  cout << "\t[-S # samples per Bezier segment in hull prefilter] (default: 8)" << endl;
   cout << "\t[-h] (this help message)" << endl;
   cout << "\t <file>.pts" << endl;
  }
@@ -58,7 +70,7 @@ static GLboolean DRAWDUAL=0;		// draw dual of active dual point?
 static GLboolean DRAWFIELD=0;		// draw line field (all tangents)?
 static GLboolean DRAWALLDUAL=0;		// draw entire unclipped tangential curves?
 static GLboolean DRAWHIT=1;		// draw dual self-intersections?
-static GLboolean DRAWBITANG=0;		// draw self-bitangents?
+static GLboolean DRAWBITANG=0;		// draw candidate bitangents?
 static GLboolean LABELBITANG=0;	// number the bitangents?
 static GLboolean DRAWCONVEXHULL=1;	// draw convex hull?
 static GLboolean DRAWCURVE=1;		// draw input curve?
@@ -72,12 +84,12 @@ Array<TangentialCurve>	obduala;	// associated tangential a-curves
 Array<TangentialCurve>	obdualb;	// associated tangential b-curves
 Array<CommonTangentArr> bitangA;	// self-bitangents from a-space for each curve
 Array<CommonTangentArr> bitangB;	// self-bitangents from b-space for each curve
-V2fArr			bitang;		// self-bitangents, as parameter pairs
-FloatArr		sortBitangEndpt;// sorted array of bitangent endpoints
-float 			startPt;	// starting point's parameter value
-V2fArr 			convHull;	// representation of convex hull = active parameter intervals
-IntArr			bitangConv;	// bitangents on convex hull (indices from bitang)
-IntArr 			active;		// active segments of convex hull on obstacle[0], after subdivideSpline
+Array<CommonTangentArr> pairA;		// bitangents of pair (i,j), i<j, from a-space
+Array<CommonTangentArr> pairB;		// and from b-space (index pairIndex(i,j))
+IntArr			onHull;		// may curve i touch the hull? (prefilter)
+SceneHullPolygon	hullPoly;	// bounding polygon of the samples
+CommonTangentArr	bitang;		// candidate bitangents (of curves onHull)
+SceneHull		hull;		// convex hull: hull bitangents and arcs
 float colour[7][3] = {{1,0,0}, {0,0,1}, {0,1,0}, {0,0,0}, {1,0,1}, {0,1,1}, {1,1,0}};
 BezierCurve2f	 	hodo0;		// hodograph of 1st obstacle, for interactive tangent display
 float 			tActive;	// interactive parameter value 					
@@ -88,6 +100,10 @@ int			dualWin2;	// b-dual window identifier
 int 			xsize, ysize;	// window size
 int       		nPtsPerSegment = PTSPERBEZSEGMENT;
 int 			PRINTOUT=0;	// 0 for displaying on screen, 1 for printing out image
+int			TANGCACHE=0;	// cache bitangents on disk (tangCache.h)?
+int			nSamplePerSeg=8;// samples per Bezier segment in hull prefilter
+float			featureSize=0;	// bitangents closer than this (in both parameters) 
+					// are merged; 0: keep all
 
 /******************************************************************************/
 /******************************************************************************/
@@ -285,6 +301,30 @@ void menuDual (int value)
 /******************************************************************************/
 /******************************************************************************/
 
+/******************************************************************************
+	Draw the arc of obstacle[ob] from parameter a[0] forward to a[1]
+	(wrapping around the end of the curve if a[1] <= a[0]).
+******************************************************************************/
+
+void drawArc (int ob, V2f &a)
+{
+  float t0 = obstacle[ob].getKnot(0), t1 = obstacle[ob].getLastKnot();
+  float len = (a[1] > a[0] ? a[1] - a[0] : a[1] - a[0] + t1 - t0);
+  int n = (int) (nPtsPerSegment * obstacle[ob].getL() * len / (t1-t0)) + 2;
+  glBegin (GL_LINE_STRIP);
+  for (int k=0; k<=n; k++)
+   {
+    float t = a[0] + len*k/n;
+    if (t > t1) t -= t1-t0;
+    V2f p;  obstacle[ob].eval (t, p);
+    glVertex2f (p[0], p[1]);
+   }
+  glEnd();
+}
+
+/******************************************************************************/
+/******************************************************************************/
+
 void displayOb ()
 {
   int i;
@@ -329,8 +369,8 @@ void displayOb ()
     for (i=0; i<bitang.getn(); i++)
      {
       V2f pt1, pt2;
-      obstacle[0].eval (bitang[i][0], pt1);
-      obstacle[0].eval (bitang[i][1], pt2);
+      obstacle[bitang[i].index1].eval (bitang[i].param1, pt1);
+      obstacle[bitang[i].index2].eval (bitang[i].param2, pt2);
       glBegin (GL_LINES);
       glVertex2f (pt1[0], pt1[1]);
       glVertex2f (pt2[0], pt2[1]);
@@ -340,9 +380,9 @@ void displayOb ()
   if (LABELBITANG)
    {
     glColor3fv (Black);
-    for (i=0; i<sortBitangEndpt.getn(); i++)
+    for (i=0; i<bitang.getn(); i++)
      {
-      V2f p;	obstacle[0].eval (sortBitangEndpt[i], p);
+      V2f p;	obstacle[bitang[i].index1].eval (bitang[i].param1, p);
       glRasterPos2f (p[0]+.01, p[1]+.01);
       char str[10];  itoa (i, str);
       for (int k=0; k<strlen(str); k++)
@@ -353,12 +393,13 @@ void displayOb ()
    {
 //    thicker
     glColor3fv (Blue);
-    obstacle[0].drawActive (active, nPtsPerSegment);
-    for (i=0; i<bitangConv.getn(); i++)
+    for (i=0; i<hull.arcOb.getn(); i++)
+      if (hull.arcOb[i] != -1) drawArc (hull.arcOb[i], hull.arc[i]);
+    for (i=0; i<hull.bitang.getn(); i++)
      {
       V2f pt1, pt2;
-      obstacle[0].eval (bitang[bitangConv[i]][0], pt1);
-      obstacle[0].eval (bitang[bitangConv[i]][1], pt2);
+      obstacle[hull.bitang[i].index1].eval (hull.bitang[i].param1, pt1);
+      obstacle[hull.bitang[i].index2].eval (hull.bitang[i].param2, pt2);
       glBegin (GL_LINES);
       glVertex2f (pt1[0], pt1[1]);
       glVertex2f (pt2[0], pt2[1]);
@@ -366,12 +407,13 @@ void displayOb ()
 //    back to normal thickness
      }
    }
-  if (DRAWSTARTPT)
+  if (DRAWSTARTPT && hull.arcOb[0] != -1)	// start of the first hull arc
    {
     glColor3fv (Red);
-    V2f p; obstacle[0].eval (startPt,p); 
+    int ob = hull.arcOb[0];  float startPt = hull.arc[0][0];
+    V2f p; obstacle[ob].eval (startPt,p); 
     if (WINDOWS) drawPt(p[0],p[1],.05);
-    else 	 obstacle[0].drawPt (startPt);
+    else 	 obstacle[ob].drawPt (startPt);
     glRasterPos2f (p[0]+.06, p[1]+.01);
     glutBitmapCharacter(GLUT_BITMAP_9_BY_15, 'P');
    }
@@ -516,6 +558,15 @@ cout << "Building" << endl;
 cout << "Finished building" << endl;   
 }
 
+/******************************************************************************
+	Index of pair (i,j), i<j, among the nOb(nOb-1)/2 pairs.
+******************************************************************************/
+
+int pairIndex (int i, int j, int nOb)
+{
+  return i*nOb - i*(i+1)/2 + (j-i-1);
+}
+
 /******************************************************************************
 ******************************************************************************/
 
@@ -535,6 +586,9 @@ int main (int argc, char **argv)
       case 'd': nPtsPerSegment = atoi(argv[ArgsParsed++]);	break;
       case 'p': PRINTOUT = 1;					break;
       case 'e': eps = atof(argv[ArgsParsed++]);			break;
+      case 'F': featureSize = atof(argv[ArgsParsed++]);		break;
+      case 'k': TANGCACHE = 1;					break;
+      case 'S': nSamplePerSeg = atoi(argv[ArgsParsed++]);	break;
       case 'h': 
       default:	usage(); exit(-1);				break;
       }
@@ -544,258 +598,85 @@ int main (int argc, char **argv)
   inputCurves(argv[argc-1], obstacle);
   buildTangentialCurves (obstacle);
   hodo0.createHodograph (obstacle[0]);	// for spinning tangent
-  int nOb = obstacle.getn();   // self-intersect tangential curves to find bitangents
+  int nOb = obstacle.getn(), nPair = nOb*(nOb-1)/2;
+  // only curves near the boundary of the bounding polygon can touch the hull:
+  // their self-bitangents and the bitangents of their pairs are candidates
+  sceneHullPrefilter (obstacle, nSamplePerSeg, hullPoly, onHull);
   bitangA.allocate(nOb);  bitangB.allocate(nOb);
-cout << "Intersecting" << endl;  
-  for (i=0; i<nOb; i++)
-   {
-    obduala[i].selfIntersect (bitangA[i], eps);
-    obdualb[i].selfIntersect (bitangB[i], eps);
-   }
-cout << "Finished intersecting" << endl;   
-  
-  assert(nOb==1);	// convex hull of single curve, for now
-  // combine bitangents from a-space and b-space, and at same time 
-  //	extract parameter pairs from bitangents, into V2f array
-  bitang.allocate(bitangA[0].getn() + bitangB[0].getn());
-  for (i=0; i<bitangA[0].getn(); i++)
-   {
-    bitang[i][0] = bitangA[0][i].param1;
-    bitang[i][1] = bitangA[0][i].param2;
-   }
-  for (j=0; j<bitangB[0].getn(); i++,j++)
-   {
-    bitang[i][0] = bitangB[0][j].param1;
-    bitang[i][1] = bitangB[0][j].param2;
-   }
-  // NOTE: implicitly assuming that bitang[i][0] < bitang[i][1]
-  // this is true of parameter pairs generated by selfIntersect
-  
-cout << "Unsorted bitangents" << endl;  
-for (i=0; i<bitang.getn(); i++) cout << bitang[i][0] << " " << bitang[i][1] << endl;
-
-  // sort by first value in parameter pair
-  FloatArr paramFirst(bitang.getn());
-  for (i=0; i<bitang.getn(); i++) paramFirst[i] = bitang[i][0];
-  IntArr sortIndex;  paramFirst.bubbleSort (sortIndex);
-  V2fArr oldbitang(bitang);	// rearrange bitang array in sorted order
-  for (i=0; i<bitang.getn(); i++)	bitang[i] = oldbitang[sortIndex[i]];
-
-cout << "Sorted bitangents" << endl;  
-for (i=0; i<bitang.getn(); i++) cout << bitang[i][0] << " " << bitang[i][1] << endl;
-
-  /* find a point on convex hull to start sweep
-  *  idea: if c(0) is not a point on the convex hull, then we can find one by 
-  *  sweeping forward on the curve until a bitangent endpoint is found that 
-  *  lies on the convex hull,
-  *  since the entrance to the convex hull is protected by bitangents
-  *  (1) is c(0) on convex hull? (i.e., does tangent at c(0) intersect curve?)
-  *  (2) if so, advance to the end of the next bitangent (so that we don't start
-  *	 in the middle of a convex hull segment);
-  *      if not, consider bitangents starting after t=0, until you find one
-  * 	 on the convex hull
-  */
-
-  convHull.create(bitang.getn()+1);  // max size is # of bitangents (see loop below)
-  if (bitang.getn() == 0)		// convexhull is entire curve
-   {
-    convHull[0][0] = obstacle[0].getKnot(0);
-    convHull[0][1] = obstacle[0].getLastKnot();
-    bitangConv.create(0);
-   }
-  else
+  pairA.allocate(nPair);  pairB.allocate(nPair);
+  float keyParam[2] = {eps, (float) nSamplePerSeg};
+  unsigned long long key = tangCacheKey (argv[argc-1], "convexhull", 2, keyParam);
+  TangCache cache;
+  if (TANGCACHE && openTangCache (argv[argc-1], "convexhull", key, 2*(nOb+nPair), cache))
    {
-    bitangConv.create(convHull.getn());
-    startPt = obstacle[0].getKnot(0);	// start at the beginning
-    V2fArr ptOfTang(2);
-    obstacle[0].eval (startPt, ptOfTang[0]);
-    ptOfTang[1] = ptOfTang[0]; 
-    int nextend = 0;	// next endpoint to consider in sorted list
-    
-    sortBitangEndpt.allocate(2*bitang.getn());	// sort the bitangent endpoints
-    IntArr sortIndex;	    // original position of endpoint in sortBitangEndpt
-    for (i=0; i<bitang.getn(); i++)
+    for (i=0; i<nOb; i++)
      {
-      sortBitangEndpt[2*i]   = bitang[i][0];
-      sortBitangEndpt[2*i+1] = bitang[i][1];
+      getTangCacheList (cache, 2*i,   bitangA[i]);
+      getTangCacheList (cache, 2*i+1, bitangB[i]);
      }
-    sortBitangEndpt.bubbleSort (sortIndex);
-
-    while (!obstacle[0].onConvexHull (startPt, ptOfTang, eps))
+    for (i=0; i<nPair; i++)
      {
-      int nextBitang = sortIndex[nextend] / 2;	// advance to next bitangent endpoint
-      int nextIndex  = sortIndex[nextend] % 2;
-      startPt = bitang[nextBitang][nextIndex];
-//    startPt = bitang[nextBitang][1]; // advance to end of next bitangent
-      obstacle[0].eval (bitang[nextBitang][0], ptOfTang[0]);
-      obstacle[0].eval (bitang[nextBitang][1], ptOfTang[1]);
-      nextend++;
-        // NOTE: if tritangent or more is possible,
-        // need to add more points of tangency: tough in present implementation
+      getTangCacheList (cache, 2*(nOb+i),   pairA[i]);
+      getTangCacheList (cache, 2*(nOb+i)+1, pairB[i]);
      }
-     
-    // now move forward to the middle of this curve segment
-    if (nextend==0)	// start point is beginning of curve
-     {
-      if (startPt == sortBitangEndpt[0])	// starting at an endpoint
+    closeTangCache (cache);
+cout << "Read bitangents from cache" << endl;
+   }
+  else
+   {
+cout << "Intersecting" << endl;  
+    for (i=0; i<nOb; i++)
+      if (onHull[i])
        {
-        float foo = (sortBitangEndpt[0] + sortBitangEndpt[1]) / 2.;
-	obstacle[0].eval (foo, ptOfTang[0]);
-	ptOfTang[1] = ptOfTang[0];
-	if (obstacle[0].onConvexHull (foo, ptOfTang, eps))
-	     startPt = foo;
-	else startPt = (sortBitangEndpt[2*bitang.getn()-1] + 
-			      sortBitangEndpt[0]) / 2.;
+        obduala[i].selfIntersect (bitangA[i], eps);
+        obdualb[i].selfIntersect (bitangB[i], eps);
        }
-     }
-    else startPt = (sortBitangEndpt[nextend-1] +
-    		    sortBitangEndpt[nextend]) / 2.;
-
-cout << "The starting point of our sweep, on the convex hull, is c("
-     << startPt << ") = ";
-ptOfTang[0].print();
-cout << endl;
-  
-    /* now sweep from this point, gathering segments on convex hull
-     *  and jumping to next segment via bitangents
-     *	consider each bitangent in turn, in sorted order
-     *	[is this a bitangent of the convex hull? (does it intersect curve?)
-     *		no need to ask question: it *will* be inherently]
-     *	jump to next segment
-     *	continue until back to starting point of sweep */
-     
-    // find bitangent endpoint immediately after starting point
-    int I=0;	// index of this endpoint
-    while (I < sortBitangEndpt.getn() && startPt > sortBitangEndpt[I]) I++;
-    if (I == sortBitangEndpt.getn()) I = 0;
-    int nCh = 0;	// index of convex hull segment under consideration
-    int startFound = 0;	// flag: have we looped back to starting point?
-    do {
-        // add free bitang assoc with I
-      bitangConv[nCh] = sortIndex[I] / 2;	
-      float buddyPar = bitang[sortIndex[I] / 2][(sortIndex[I]+1)%2];
-      		// parameter value of buddy (other end of bitangent)
-cout << "next free bitangent: " << bitang[sortIndex[I] / 2][0] << ","
-				<< bitang[sortIndex[I] / 2][1] << endl;		
-
-        // search forward for buddy in sorted list
-      int buddyI=(I+1)%sortBitangEndpt.getn();		
-      while (sortBitangEndpt[buddyI] != buddyPar) 
-        buddyI = (buddyI + 1)%sortBitangEndpt.getn();
-cout << "buddyI = " << buddyI << endl;	
-
-        // add curve segment from other end of this bitangent to beginning of next
-      convHull[nCh][0] = sortBitangEndpt[buddyI];
-      convHull[nCh][1] = sortBitangEndpt[(buddyI+1)%sortBitangEndpt.getn()];
-cout << "next conv hull seg : " << convHull[nCh][0] << "," 
- 				<< convHull[nCh][1] << endl;      
-
-        // update index of free bitangent
-      I = (buddyI+1)%sortBitangEndpt.getn();
-      
-      	// is the starting point on the newly added segment?
-      if (convHull[nCh][0] < convHull[nCh][1])
+      else { bitangA[i].allocate(0);  bitangB[i].allocate(0); }
+    for (i=0; i<nOb; i++)
+      for (j=i+1; j<nOb; j++)
        {
-        if (startPt > convHull[nCh][0] && startPt < convHull[nCh][1])
-	  startFound = 1;
+        int k = pairIndex (i,j,nOb);
+	if (onHull[i] && onHull[j])
+	 {
+          obduala[i].intersect (obduala[j], pairA[k], eps);
+          obdualb[i].intersect (obdualb[j], pairB[k], eps);
+	 }
+	else { pairA[k].allocate(0);  pairB[k].allocate(0); }
        }
-      else		// wraparound
-        if (startPt > convHull[nCh][0] || startPt < convHull[nCh][1])
-	  startFound = 1;
-	  
-      nCh++;
-    } while (!startFound);
-    if (nCh < convHull.getn())
-     {
-      // shrink convHull to correct size (will often have empty slots at end)
-      V2fArr oldconvhull(convHull);	IntArr oldbitangconv(bitangConv);
-      convHull.create(nCh);		bitangConv.create(nCh);
-      for (i=0; i<nCh; i++)  convHull[i] = oldconvhull[i];
-      for (i=0; i<nCh; i++)  bitangConv[i] = oldbitangconv[i];
-     } 
-   }
-   
-/************* OLD VERSION  
-    convHull[0][0] = startPt;
-    int nCh = 0;	// index of convex hull segment under consideration
-    int nBt = 0; 	// index of bitangent under consideration
-    while (nCh==0 || convHull[nCh][0] != startPt)	// haven't looped around yet
+cout << "Finished intersecting" << endl;   
+    if (TANGCACHE)
      {
-      // starting after present sweep position
-      while (nBt < bitang.getn() && bitang[nBt][0] < convHull[nCh][0])	nBt++;
-      if (nBt == bitang.getn())  	// if last segment straddles t=0, 
-       {	// it will be a convex segment stopped by beg. of 1st bitangent
-        convHull[nCh][1] = bitang[0][0];
-	bitangConv[nCh] = 0;
-	convHull[nCh+1][0] = bitang[0][1];	// this will signal end next time thru loop
-       }
-      else
-       { 
-        // stop active interval at beginning of next bitangent 
-        convHull[nCh][1] = bitang[nBt][0];
-	bitangConv[nCh] = nBt;	// bitangent after this c.h. segment is nBt
-        // start new active interval at end of this bitangent
-        convHull[nCh+1][0] = bitang[nBt][1];
-       }
-// cout << "next convex hull segment: " << convHull[nCh][0] << "," 
-// 				        << convHull[nCh][1] << endl;      
-      nCh++;
+      TangCacheWriter w;
+      beginTangCache (argv[argc-1], "convexhull", key, 2*(nOb+nPair), w);
+      for (i=0; i<nOb; i++)   { addTangCacheList (w, bitangA[i]);  addTangCacheList (w, bitangB[i]); }
+      for (i=0; i<nPair; i++) { addTangCacheList (w, pairA[i]);    addTangCacheList (w, pairB[i]); }
+      endTangCache (w);
      }
-    if (nCh < convHull.getn())
-     {
-      // shrink convHull to correct size (will often have empty slots at end)
-      V2fArr oldconvhull(convHull);	IntArr oldbitangconv(bitangConv);
-      convHull.create(nCh);		bitangConv.create(nCh);
-      for (i=0; i<nCh; i++)  convHull[i] = oldconvhull[i];
-      for (i=0; i<nCh; i++)  bitangConv[i] = oldbitangconv[i];
-     } 
    }
-***************/
-   
+
+  // combine bitangents from a-space and b-space (sorted, duplicates merged)
+  // into one candidate list, then sweep
+  Array<CommonTangentArr> merged(nOb+nPair);
+  int nCand=0;
+  for (i=0; i<nOb; i++)
+   { mergeCommonTangent (bitangA[i], bitangB[i], featureSize, merged[i]);  nCand += merged[i].getn(); }
+  for (i=0; i<nPair; i++)
+   { mergeCommonTangent (pairA[i], pairB[i], featureSize, merged[nOb+i]);  nCand += merged[nOb+i].getn(); }
+  bitang.allocate(nCand);
+  for (i=0, nCand=0; i<merged.getn(); i++)
+    for (j=0; j<merged[i].getn(); j++) bitang[nCand++] = merged[i][j];
+  sceneHullSweep (obstacle, hullPoly, bitang, hull);
+
+  int nOnHull=0;
+  for (i=0; i<nOb; i++) nOnHull += onHull[i];
+cout << nOnHull << " of " << nOb << " curves near the hull, " 
+     << bitang.getn() << " candidate bitangents" << endl;
 cout << "Convex hull = " << endl;
-for (i=0; i<convHull.getn(); i++)  convHull[i].print(); 
+for (i=0; i<hull.arcOb.getn(); i++)  
+  cout << "curve " << hull.arcOb[i] << ": " << hull.arc[i][0] << "," << hull.arc[i][1] << endl;
 cout << endl;
   
-  FloatArr paramCH(2*convHull.getn());	// param values of convex hull endpts
-  for (i=0,j=0; i<convHull.getn(); i++)  
-   { 
-    paramCH[j++] = convHull[i][0];
-    paramCH[j++] = convHull[i][1];
-   }
-  paramCH.bubbleSort(sortIndex);	// needed if convex hull wraps around
-  FloatArr knot(obstacle[0].getnKnot());
-  for (i=0; i<obstacle[0].getnKnot(); i++) knot[i] = obstacle[0].getKnot(i);
-  FloatArr paramCHfilter;		// with knots filtered out
-  paramCH.filterOut (knot, paramCHfilter, 0);
-  obstacle[0].subdivideSpline(paramCHfilter);
-// obstacle[0].print();
-  
-  // identify intervals of spline that correspond to convex hull
-  active.create(obstacle[0].getL());
-  knot.create(obstacle[0].getnKnot());
-  for (i=0; i<obstacle[0].getnKnot(); i++) knot[i] = obstacle[0].getKnot(i);
-  for (i=0; i<obstacle[0].getL(); i++)
-   {
-    int done = active[i] = 0;
-    for (j=0; !done && j<convHull.getn()-1; j++)
-      if (knot[i] >= convHull[j][0] && // ith curve seg contained in jth conv hull seg
-      	  knot[i] < convHull[j][1])	
-        done = active[i] = 1;
-   }
-  j = convHull.getn()-1;	// last convex hull segment is special
-  if (convHull[j][0] > convHull[j][1])	// wraparound in last convex hull segment
-    for (i=0; i<obstacle[0].getL(); i++)
-     {			
-      if (knot[i] >= convHull[j][0] || knot[i] < convHull[j][1])
-        active[i] = 1;
-     }
-  else
-    for (i=0; i<obstacle[0].getL(); i++)
-      if (knot[i] >= convHull[j][0] && knot[i] < convHull[j][1])
-        active[i] = 1;
-// cout << active << endl;
-  
-  for (i=0; i<obstacle.getn(); i++)	// wait until after subdivideSpline
+  for (i=0; i<obstacle.getn(); i++)
     obstacle[i].prepareDisplay (nPtsPerSegment);
   tActive = obstacle[0].getKnot(0);	// start at beginning
   if (WINDOWS) tDelta = obstacle[0].getKnot (obstacle[0].getnKnot()-1) / 2000.;
@@ -853,8 +734,8 @@ cout << endl;
   glutAddMenuEntry ("Reverse direction of spin [b]", 		3);
   glutAddMenuEntry ("Dual line of active point on a-dual curve (as test of dualization back to primal space) [d]", 4);
   glutAddMenuEntry ("Line field on 1st curve [l]",		5);
-  glutAddMenuEntry ("Self-bitangents [B]", 	    		6);
-  glutAddMenuEntry ("Number the self-bitangents",		7);
+  glutAddMenuEntry ("Candidate bitangents [B]", 	    	6);
+  glutAddMenuEntry ("Number the candidate bitangents",		7);
   glutAddMenuEntry ("Input curve [i]", 				11);
   glutAddMenuEntry ("Starting point [s]",			12);
   glutAddMenuEntry ("Beginning of curve",			13);
@@ -0,0 +1,310 @@
+/*
+  File:          sceneHull.h
+  Created:	 17 October 2026
+  Purpose:       Smooth convex hull of a scene of closed Bezier splines.
+		 The hull is a cycle of hull bitangents (supporting lines
+		 touching the scene twice, between two curves or the same
+		 curve) joined by arcs of the curves.
+		 (1) Prefilter: the curves are sampled, and the convex hull
+		     of all samples (the bounding polygon) is built by a
+		     monotone chain (O(m log m) sort and a stack sweep).
+		     A curve takes part only if its samples come within the
+		     sampling tolerance of the polygon's boundary; only these
+		     curves need self-bitangents, and only their pairs need
+		     bitangents.
+		 (2) Sweep: a candidate bitangent is on the hull if its line
+		     supports the bounding polygon (all samples on one side).
+		     The hull bitangents are oriented counterclockwise
+		     around the hull and sorted by direction in O(k log k);
+		     a stack sweep merges collinear ones (a tritangent line
+		     yields bitangents A-B, B-C and A-C: A-C is kept),
+		     and nearly collinear ones that do not chain (near a
+		     tritangent, all three pass the support test).
+		     Consecutive hull bitangents are joined by an arc of the
+		     curve on which the first ends and the next starts.
+  Usage:	 SceneHullPolygon poly;  IntArr onHull;
+  		 sceneHullPrefilter (obstacle, nSamplePerSeg, poly, onHull);
+		 ... bitangents of the curves with onHull[i], into cand ...
+		 SceneHull hull;  sceneHullSweep (obstacle, poly, cand, hull);
+*/
+
+#ifndef _SCENEHULL_H_
+#define _SCENEHULL_H_
+
+#include <math.h>
+#include <stdlib.h>		// qsort
+
+#define HULLTOL   .00001		// a line supports the scene if no sample is further
+				// than this on its wrong side, relative to the size
+				// of the bounding polygon (poly.size)
+#define HULLANGLE .0001		// hull bitangents closer than this in angle are collinear
+#define HULLSNAP  .01		// consecutive hull bitangents that do not chain (the
+				// first ends on another curve than the next starts)
+				// and are closer than this in angle are merged.
+				// A heuristic: near a tritangent the three bitangents
+				// pass the support test and differ in angle by about
+				// poly.tol / poly.size (sampling error over the hull's
+				// size); HULLSNAP bounds that for the sample densities
+				// in use, and a coarser sampling needs a larger one
+
+struct HullPt			// sample of a curve
+{
+  float x, y;
+  int   ob;
+};
+
+struct SceneHullPolygon		// convex hull of the samples, counterclockwise
+{
+  HullPt *pt;
+  int     n;
+  float   tol;			// sampling tolerance (longest chord between samples)
+  float   size;			// diagonal of the polygon's bounding box
+  IntArr  orient;		// orientation of each curve (1: ccw, -1: cw)
+};
+
+struct SceneHull
+{
+  CommonTangentArr bitang;	// hull bitangents, in counterclockwise order, each from
+				// (index1,param1) to (index2,param2)
+  IntArr           arcOb;	// arc k, from the end of bitang[k] to the start of
+  V2fArr           arc;		// bitang[k+1], is on curve arcOb[k], over parameters
+  				// arc[k][0] forward to arc[k][1] (wrapping if smaller)
+};
+
+/******************************************************************************/
+/******************************************************************************/
+
+static int compareHullPt (const void *a, const void *b)		// by x, then y
+{
+  const HullPt *p = (const HullPt *) a, *q = (const HullPt *) b;
+  if (p->x != q->x) return (p->x < q->x ? -1 : 1);
+  if (p->y != q->y) return (p->y < q->y ? -1 : 1);
+  return 0;
+}
+
+static inline float cross (HullPt &o, HullPt &a, HullPt &b)
+{
+  return (a.x - o.x) * (b.y - o.y) - (a.y - o.y) * (b.x - o.x);
+}
+
+/******************************************************************************
+	Convex hull of pt[0..n-1] (sorted in place) into hull, counterclockwise
+	without collinear points, by Andrew's monotone chain.
+	Returns the number of hull vertices; hull must hold 2n points.
+******************************************************************************/
+
+int convexHullPts (HullPt *pt, int n, HullPt *hull)
+{
+  int i, k=0;
+  if (n < 3) { for (i=0; i<n; i++) hull[i] = pt[i];  return n; }
+  qsort (pt, n, sizeof(HullPt), compareHullPt);
+  for (i=0; i<n; i++)				// lower chain
+   {
+    while (k >= 2 && cross (hull[k-2], hull[k-1], pt[i]) <= 0) k--;
+    hull[k++] = pt[i];
+   }
+  int lower = k+1;
+  for (i=n-2; i>=0; i--)			// upper chain
+   {
+    while (k >= lower && cross (hull[k-2], hull[k-1], pt[i]) <= 0) k--;
+    hull[k++] = pt[i];
+   }
+  return k-1;					// last point repeats the first
+}
+
+/******************************************************************************
+	Bounding polygon of the scene, and the curves that may touch the hull:
+	onHull[i] if some sample of obstacle[i] lies within the sampling
+	tolerance of the polygon's boundary (i.e., of one of its edge lines).
+	Each curve is sampled at nSamplePerSeg points per Bezier segment
+	(by sampleBezierBatch, bezierBatch.h).
+******************************************************************************/
+
+void sceneHullPrefilter (Array<BezierCurve2f> &obstacle, int nSamplePerSeg,
+			 SceneHullPolygon &poly, IntArr &onHull)
+{
+  int i, k, e, nOb = obstacle.getn(), m = 0;
+  IntArr nSample(nOb);
+  for (i=0; i<nOb; i++) { nSample[i] = nSamplePerSeg * obstacle[i].getL();  m += nSample[i]; }
+  HullPt *pt = new HullPt[m+1];
+  poly.tol = 0;
+  poly.orient.allocate (nOb);
+  float *x = new float[m+1], *y = new float[m+1];
+  for (i=0, m=0; i<nOb; i++)
+   {
+    float area = 0;
+    BezierBatch B;  initBezierBatch (obstacle[i], B);	// samples by batch evaluation
+    sampleBezierBatch (B, B.knot[0], B.knot[B.L], nSample[i], x, y);
+    freeBezierBatch (B);
+    for (k=0; k<nSample[i]; k++)
+     { pt[m+k].x = x[k];  pt[m+k].y = y[k];  pt[m+k].ob = i; }
+    for (k=0; k<nSample[i]; k++)		// chord length, signed area
+     {
+      HullPt &a = pt[m+k], &b = pt[m + (k+1)%nSample[i]];
+      float chord = sqrt ((b.x-a.x)*(b.x-a.x) + (b.y-a.y)*(b.y-a.y));
+      if (chord > poly.tol) poly.tol = chord;
+      area += a.x*b.y - b.x*a.y;
+     }
+    poly.orient[i] = (area >= 0 ? 1 : -1);
+    m += nSample[i];
+   }
+  delete [] x;  delete [] y;
+  HullPt *sample = new HullPt[2*m+2];		// convexHullPts sorts its input
+  for (k=0; k<m; k++) sample[k] = pt[k];
+  poly.pt = new HullPt[2*m+2];
+  poly.n  = convexHullPts (sample, m, poly.pt);
+  float xmin = 0, xmax = 0, ymin = 0, ymax = 0;	// size, for the support tolerance
+  for (k=0; k<poly.n; k++)
+   {
+    HullPt &p = poly.pt[k];
+    if (k == 0 || p.x < xmin) xmin = p.x;
+    if (k == 0 || p.x > xmax) xmax = p.x;
+    if (k == 0 || p.y < ymin) ymin = p.y;
+    if (k == 0 || p.y > ymax) ymax = p.y;
+   }
+  poly.size = sqrt ((xmax-xmin)*(xmax-xmin) + (ymax-ymin)*(ymax-ymin));
+  if (poly.size == 0) poly.size = 1;
+  onHull.allocate (nOb);
+  for (i=0; i<nOb; i++) onHull[i] = 0;
+  for (k=0; k<poly.n; k++) onHull[poly.pt[k].ob] = 1;
+  HullPt *obHull = sample + m+1;		// vertices of one curve's own hull
+  for (i=0, m=0; i<nOb; m += nSample[i++])	// near an edge line of the polygon
+   {
+    if (onHull[i]) continue;
+    for (k=0; k<nSample[i]; k++) sample[k] = pt[m+k];
+    int h = convexHullPts (sample, nSample[i], obHull);
+    for (e=0; !onHull[i] && e<poly.n; e++)
+     {
+      HullPt &a = poly.pt[e], &b = poly.pt[(e+1)%poly.n];
+      float len = sqrt ((b.x-a.x)*(b.x-a.x) + (b.y-a.y)*(b.y-a.y));
+      for (k=0; len > 0 && k<h; k++)
+        if (cross (a, b, obHull[k]) / len < poly.tol) { onHull[i] = 1;  break; }
+     }
+   }
+  delete [] sample;
+  delete [] pt;
+}
+
+void freeSceneHullPolygon (SceneHullPolygon &poly)
+{
+  delete [] poly.pt;  poly.n = 0;
+}
+
+/******************************************************************************
+	Side of the bounding polygon of the line through p and q:
+	1 if all its vertices are on the left (or within HULLTOL*poly.size),
+	-1 if all on the right, 0 otherwise.
+******************************************************************************/
+
+int supportingSide (SceneHullPolygon &poly, V2f &p, V2f &q)
+{
+  float dx = q[0]-p[0], dy = q[1]-p[1], len = sqrt (dx*dx + dy*dy);
+  if (len == 0) return 0;
+  float lo = 0, hi = 0, tol = HULLTOL * poly.size;
+  for (int k=0; k<poly.n; k++)
+   {
+    float d = (dx * (poly.pt[k].y - p[1]) - dy * (poly.pt[k].x - p[0])) / len;
+    if (d < lo) lo = d;
+    if (d > hi) hi = d;
+   }
+  if (lo >= -tol) return 1;
+  if (hi <=  tol) return -1;
+  return 0;
+}
+
+struct HullEdge
+{
+  float         angle;		// direction, in (-pi,pi]
+  CommonTangent t;
+  V2f           p, q;		// from p to q
+};
+
+static int compareHullEdge (const void *a, const void *b)
+{
+  float x = ((const HullEdge *) a)->angle, y = ((const HullEdge *) b)->angle;
+  return (x < y ? -1 : (x > y ? 1 : 0));
+}
+
+static void mergeCollinear (HullEdge &e, HullEdge &f)	// e = the span of e and f
+{
+  float dx = cos (e.angle), dy = sin (e.angle);
+  if (f.p[0]*dx + f.p[1]*dy < e.p[0]*dx + e.p[1]*dy)
+   { e.p = f.p;  e.t.index1 = f.t.index1;  e.t.param1 = f.t.param1; }
+  if (f.q[0]*dx + f.q[1]*dy > e.q[0]*dx + e.q[1]*dy)
+   { e.q = f.q;  e.t.index2 = f.t.index2;  e.t.param2 = f.t.param2; }
+  e.angle = atan2 (e.q[1]-e.p[1], e.q[0]-e.p[0]);
+}
+
+static int mergeable (HullEdge &e, HullEdge &f)	// f follows e in angle
+{
+  float d = f.angle - e.angle;
+  if (d < 0) d += 2*M_PI;
+  return (d < HULLANGLE || (d < HULLSNAP && e.t.index2 != f.t.index1));
+}
+
+/******************************************************************************
+	Hull of the scene from the candidate bitangents cand
+	(self-bitangents and bitangents of the curves onHull).
+******************************************************************************/
+
+void sceneHullSweep (Array<BezierCurve2f> &obstacle, SceneHullPolygon &poly,
+		     CommonTangentArr &cand, SceneHull &hull)
+{
+  int k, K=0;
+  HullEdge *edge = new HullEdge[cand.getn()+1];
+  for (k=0; k<cand.getn(); k++)		// supporting candidates, oriented ccw
+   {
+    HullEdge &e = edge[K];
+    e.t = cand[k];
+    obstacle[e.t.index1].eval (e.t.param1, e.p);
+    obstacle[e.t.index2].eval (e.t.param2, e.q);
+    int side = supportingSide (poly, e.p, e.q);
+    if (side == 0) continue;
+    if (side == -1)
+     {
+      V2f p = e.p;  e.p = e.q;  e.q = p;
+      e.t.index1 = cand[k].index2;  e.t.param1 = cand[k].param2;
+      e.t.index2 = cand[k].index1;  e.t.param2 = cand[k].param1;
+     }
+    e.angle = atan2 (e.q[1]-e.p[1], e.q[0]-e.p[0]);
+    K++;
+   }
+  qsort (edge, K, sizeof(HullEdge), compareHullEdge);
+  int top = -1;				// stack sweep: merge collinear edges
+  for (k=0; k<K; k++)
+   {
+    if (top >= 0 && mergeable (edge[top], edge[k]))
+      mergeCollinear (edge[top], edge[k]);
+    else edge[++top] = edge[k];
+    while (top >= 1 && mergeable (edge[top-1], edge[top]))	// a new start may 
+     { mergeCollinear (edge[top-1], edge[top]);  top--; }	// break the chain
+   }
+  K = top+1;
+  while (K > 1 && mergeable (edge[K-1], edge[0]))		// across -pi
+   { mergeCollinear (edge[K-1], edge[0]);  edge[0] = edge[--K]; }
+
+  hull.bitang.allocate (K);  hull.arcOb.allocate (K > 0 ? K : 1);
+  hull.arc.allocate (K > 0 ? K : 1);
+  if (K == 0)				// the hull is one convex curve: the extreme one
+   {
+    int ob = poly.pt[0].ob;
+    hull.arcOb[0]  = ob;
+    hull.arc[0][0] = obstacle[ob].getKnot(0);  hull.arc[0][1] = obstacle[ob].getLastKnot();
+   }
+  for (k=0; k<K; k++)
+   {
+    CommonTangent &t = edge[k].t, &next = edge[(k+1)%K].t;
+    hull.bitang[k] = t;
+    if (t.index2 != next.index1)	// a hull bitangent was missed
+     {
+      cout << "Convex hull: gap between bitangents " << k << " and " << (k+1)%K << endl;
+      hull.arcOb[k] = -1;  continue;
+     }
+    hull.arcOb[k] = t.index2;		// ccw around hull: forward on a ccw curve
+    if (poly.orient[t.index2] == 1) { hull.arc[k][0] = t.param2;     hull.arc[k][1] = next.param1; }
+    else			    { hull.arc[k][0] = next.param1;  hull.arc[k][1] = t.param2; }
+   }
+  delete [] edge;
+}
+
+#endif
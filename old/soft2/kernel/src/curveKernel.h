@@ -0,0 +1,287 @@
+/*
+  File:          curveKernel.h
+  Created:	 17 October 2026
+  Purpose:       Kernel of a curve (the points that see the whole curve),
+		 without a window: a reentrant call that keeps all of its
+		 state in a CurveKernel, so many curves can be processed
+		 in parallel (one CurveKernel per thread).
+		 The kernel boundary is built from the intersections of
+		 inflection tangents (with each other and with the curve)
+		 whose dual lines are free of the tangential c-curve.
+		 Each inflection tangent is built and intersected with the
+		 curve once; the hits and their parameters are kept together.
+  Usage:	 CurveKernel K;
+  		 computeKernel (obstacle, eps, nPtsPerSegment, K);
+		 writeKernel ("curve.pts.kernel", "curve.pts", K);
+*/
+
+#ifndef _CURVEKERNEL_H_
+#define _CURVEKERNEL_H_
+
+#include <math.h>
+#include <stdio.h>
+
+struct CurveKernel
+{
+  TangentialCurve obdualc;		// associated tangential c-curve
+  FloatArr	  tInfl;		// param values of inflection pts on obstacle
+  V2fArr	  hitInfl;		// intersections of the inflection bitangents
+  V2fArr	  linePair;		// params of the 2 inflection tangents defining hitInfl[i]
+  V2fArr	  hitCurve;		// intersections of infl tangents w. curve
+  V2fArr	  parameterPair;	// params of the inflection and curve point defining hitCurve[i]
+  V2fArr	  hitKernel;		// kernel boundary points, sorted by angle about kernelMean
+  int		  nKernelFromInfl;	// # of kernel pts from hitInfl
+  IntArr	  kernelSortIndex;	// rearrangement of hitKernel from sorting
+  V2f		  kernelMean;		// mean of finite kernel pts
+  V2f		  kernelCentroid;	// centroid of finite kernel pts
+  BezierCurve2f	  kernelCurve;		// original curve with only kernel segments active
+  IntArr	  activeKernel;		// active segments of kernelCurve
+  V2fArr	  hitCurveParameterPair;// parameter values of kernel points associated with curve
+  int		  starShaped;		// nonempty kernel? (convex, or some kernel pts)
+};
+
+/******************************************************************************
+	Is the dual line of the primal point p free of obdualc, ignoring
+	intersections near the dual points of the two tangents t[0], t[1]
+	that define p?
+******************************************************************************/
+
+static int dualFree (TangentialCurve &obdualc, V2f &p, V2f &t, float eps)
+{
+  TangentialCurve hitDual;	// dual of intersection point
+  V2fArr hit;  FloatArr tFoo, btFoo;  int nHit;
+  hitDual.createImplicitLine (p[0], p[1], 1);
+  obdualc.intersect (hitDual, nHit, hit, tFoo, btFoo, eps);
+  V2f dualPt1; obdualc.eval (t[0], dualPt1);	// 'cusps'
+  V2f dualPt2; obdualc.eval (t[1], dualPt2);
+  int nIgnore=0;		// how many intersections should be ignored?
+  for (int j=0; j<nHit; j++)
+    if (hit[j].dist (dualPt1) < 10*eps || hit[j].dist (dualPt2) < 10*eps)
+      nIgnore++;
+  return (nHit - nIgnore == 0);
+}
+
+/******************************************************************************
+	Index of the knot of curve within tol of t, or -1 if there is none.
+******************************************************************************/
+
+static int findKnot (BezierCurve2f &curve, float t, float tol)
+{
+  int j, best=-1;
+  for (j=0; j<=curve.getL(); j++)
+    if (fabs (curve.getKnot(j) - t) <= tol &&
+	(best == -1 || fabs (curve.getKnot(j) - t) < fabs (curve.getKnot(best) - t)))
+      best = j;
+  return best;
+}
+
+/******************************************************************************
+	Kernel of obstacle into K (obstacle is changed by the c-curve's
+	clipping, as in createC).
+	If nPtsPerSegment > 0, the c-curve and kernel curve are prepared
+	for display at that density; 0 for headless use.
+	If verbose, progress is printed (not for use from several threads).
+	Returns the number of kernel boundary points, or -1 if the kernel
+	arcs could not be traced on the subdivided curve (a kernel point
+	too close to the end of the curve, or not found among its knots).
+******************************************************************************/
+
+int computeKernel (BezierCurve2f &obstacle, float eps, int nPtsPerSegment,
+		   CurveKernel &K, int verbose=0)
+{
+  int i,j,k;
+  BezierCurve2f hodo;  hodo.createHodograph (obstacle);
+  K.obdualc.createC (obstacle, 0, .05);	// compute tangential c-curve
+  if (nPtsPerSegment > 0) K.obdualc.prepareDisplay (nPtsPerSegment*5);
+  obstacle.inflectionPt (K.tInfl, eps);	// compute inflection points
+
+  /******* compute intersections of inflection tangents ********/
+
+  int nInfl = K.tInfl.getn(), nHit = 0;
+  Array<Line2f> inflLine(nInfl);	// tangent at tInfl[i]
+  for (i=0; i<nInfl; i++) obstacle.buildTangent (K.tInfl[i], hodo, 1, inflLine[i]);
+  V2fArr hitInflTemp(nInfl*(nInfl-1)/2);
+  V2fArr linePair   (nInfl*(nInfl-1)/2);
+  for (i=0; i<nInfl; i++)
+    for (j=i+1; j<nInfl; j++)
+     {
+      float foo;
+      if (inflLine[i].intersect (inflLine[j], hitInflTemp[nHit], foo, 0, eps))
+       {	// not parallel
+        linePair[nHit][0]   = K.tInfl[i];
+	linePair[nHit++][1] = K.tInfl[j];
+       }
+     }
+  K.hitInfl.create  (hitInflTemp, nHit);	// some lines may be parallel
+  K.linePair.create (linePair, nHit);
+
+  /******* compute intersections of inflection tangents w. curve ********/
+
+  Array<V2fArr>   hit(nInfl);		// hits of the ith inflection tangent
+  Array<FloatArr> tHit(nInfl);		// and their parameters on obstacle
+  for (i=0, nHit=0; i<nInfl; i++)
+   {
+    BezierCurve2f inflTang;		// tangent at tInfl[i]
+    obstacle.buildTangent (K.tInfl[i], hodo, 1, inflTang);
+    int nFoo;  FloatArr btFoo;
+    obstacle.intersect (inflTang, nFoo, hit[i], tHit[i], btFoo, eps);
+    nHit += hit[i].getn();
+   }
+  K.hitCurve.allocate (nHit);  K.parameterPair.allocate (nHit);
+  for (i=0, nHit=0; i<nInfl; i++)
+    for (j=0; j<hit[i].getn(); j++)
+     {
+      K.hitCurve[nHit] = hit[i][j];
+      K.parameterPair[nHit][0]   = K.tInfl[i];
+      K.parameterPair[nHit++][1] = tHit[i][j];
+     }
+
+  /******* compute intersections associated with free lines in dual space ****/
+
+  int nInflHit = K.hitInfl.getn();
+  IntArr hitKerFlag (nInflHit + K.hitCurve.getn());
+  int nHitKer=0;
+  for (i=0; i<nInflHit; i++)
+   {
+    if (verbose) cout << "Considering hitInfl[" << i << "]" << endl;
+    hitKerFlag[i] = dualFree (K.obdualc, K.hitInfl[i], K.linePair[i], eps);
+    nHitKer += hitKerFlag[i];
+   }
+  for (i=0; i<K.hitCurve.getn(); i++)
+   {
+    if (verbose) cout << "Considering hitCurve[" << i << "]" << endl;
+    hitKerFlag[nInflHit+i] = dualFree (K.obdualc, K.hitCurve[i], K.parameterPair[i], eps);
+    nHitKer += hitKerFlag[nInflHit+i];
+   }
+
+  if (verbose) cout << "Collecting" << endl;
+  K.hitKernel.allocate (nHitKer);	// copy over
+  IntArr kernelIndex(nHitKer);		// remember where each kernel pt came from
+  nHitKer = 0;
+  for (i=0; i<nInflHit; i++)
+    if (hitKerFlag[i])
+     {
+      kernelIndex[nHitKer] = i;
+      K.hitKernel[nHitKer++] = K.hitInfl[i];
+     }
+  K.nKernelFromInfl = nHitKer;	// record # of kernel pts from hitInfl
+  K.hitCurveParameterPair.allocate (K.hitKernel.getn() - K.nKernelFromInfl);
+  for (i=0; i<K.hitCurve.getn(); i++)
+    if (hitKerFlag[nInflHit + i])
+     {
+      kernelIndex[nHitKer] = i;
+      K.hitCurveParameterPair[nHitKer - K.nKernelFromInfl] = K.parameterPair[i];
+      K.hitKernel[nHitKer++] = K.hitCurve[i];
+     }
+  K.starShaped = (nInfl == 0 || K.hitKernel.getn() > 0);
+  K.kernelMean[0] = K.kernelMean[1] = 0;
+  K.kernelSortIndex.allocate(0);  K.activeKernel.allocate(0);
+  if (K.hitKernel.getn() == 0) return 0;
+
+  if (verbose) cout << "Building full kernel from finite kernel points" << endl;
+  // build full kernel:
+  // connect two consecutive points of sorted hitKernel
+  // by a straight line if one of these points is an intersection of inflection tangents, and
+  // by a curve segment otherwise (both points are intersections of curve with inflection tangent)
+
+  for (i=0; i<K.hitKernel.getn(); i++) 	// compute sample mean
+    K.kernelMean += K.hitKernel[i];
+  K.kernelMean /= K.hitKernel.getn();
+
+  int nKernelFromCurve = K.hitKernel.getn() - K.nKernelFromInfl;
+  if (nKernelFromCurve > 0)	// some kernel pts from curve
+   {
+    K.kernelCurve = obstacle;	// subdivide kernel curve at hitCurve points of hitKernel
+    FloatArr tCurve(nKernelFromCurve);
+    for (i=0; i<tCurve.getn(); i++) 	// first few in kernel are from tInfl
+      tCurve[i] = K.parameterPair[kernelIndex[K.nKernelFromInfl+i]][1];
+    IntArr foo;  tCurve.bubbleSort (foo);
+    K.kernelCurve.subdivideSpline (tCurve);
+
+    // sort by angle about mean (first determine sort direction)
+    if (tCurve[0] + .1 >= K.kernelCurve.getLastKnot()) return -1;
+    V2f pt0; K.kernelCurve.eval (tCurve[0],       pt0);
+    V2f pt1; K.kernelCurve.eval (tCurve[0] + .01, pt1);
+    V2f vec0(pt0);  vec0 -= K.kernelMean;
+    V2f vec1(pt1);  vec1 -= K.kernelMean;
+    if (vec0.angleFromX() < vec1.angleFromX())
+         sortByAngleCCW (K.hitKernel, K.kernelMean, K.kernelSortIndex);
+    else sortByAngleCW  (K.hitKernel, K.kernelMean, K.kernelSortIndex);
+
+    // kernel segments of kernelCurve
+    int n = K.hitKernel.getn(), L = K.kernelCurve.getL();
+    float tol = 1e-6 * (K.kernelCurve.getLastKnot() - K.kernelCurve.getKnot(0));
+    K.activeKernel.allocate(K.kernelCurve.getL());
+    K.activeKernel.clear();			// initially turn off all segments
+    for (i=0; i<n; i++)				// traverse kernel boundary
+      if (K.kernelSortIndex[i]       >= K.nKernelFromInfl &&	// consecutive hitCurve points
+          K.kernelSortIndex[(i+1)%n] >= K.nKernelFromInfl)
+       {
+          // turn on segments between hitKernel[i] and hitKernel[i+1]
+          // 	since this represents a segment of the kernel
+          // find parameter values of two endpoints
+        float tStart = K.parameterPair [kernelIndex[K.kernelSortIndex[i]]      ][1];
+        float tEnd   = K.parameterPair [kernelIndex[K.kernelSortIndex[(i+1)%n]]][1];
+        int jStart = findKnot (K.kernelCurve, tStart, tol);
+        int jEnd   = findKnot (K.kernelCurve, tEnd,   tol);
+        if (jStart == -1 || jEnd == -1) return -1;
+        if (jStart == L && jEnd != L) jStart = 0;	// end of curve = start
+        for (j=jStart, k=0; j != jEnd; k++)
+         {
+	  if (k > L) return -1;			// never reached tEnd
+	  if (j != L)
+            K.activeKernel[j] = 1;
+	  if (j == L-1)
+	    if (jEnd == L)			// stop at end of curve
+	       j=j+1;
+	    else				// wraparound
+	       j=0;
+	  else j++;
+         }
+       }
+    if (nPtsPerSegment > 0)
+      K.kernelCurve.prepareActiveDisplay (K.activeKernel, nPtsPerSegment);
+  	// can't inherit obstacle's display, since we have subdivided at kernel points
+   }
+  else 	// sort direction doesn't matter
+    	 sortByAngleCCW (K.hitKernel, K.kernelMean, K.kernelSortIndex);
+
+  //  centroid requires sorted polygon
+  Polygon2f kernelBdry (K.hitKernel);
+  kernelBdry.centroid (K.kernelCentroid);
+  return K.hitKernel.getn();
+}
+
+/******************************************************************************
+	Write the kernel K of curve to file, as text:
+	  # kernel of <curve>
+	  starShaped <0/1>
+	  inflections <n>  <param> ...
+	  boundary <n>
+	  <x> <y> <i/c>	(in order; i: from hitInfl, c: from hitCurve;
+	  		 consecutive c points bound an arc of the curve,
+			 other consecutive points a segment)
+	  centroid <x> <y>	(if the boundary is nonempty)
+	Returns 0 if the file cannot be opened.
+******************************************************************************/
+
+int writeKernel (const char *file, const char *curve, CurveKernel &K)
+{
+  FILE *fp = fopen (file, "w");
+  if (!fp) return 0;
+  int i;
+  fprintf (fp, "# kernel of %s\n", curve);
+  fprintf (fp, "starShaped %d\n", K.starShaped);
+  fprintf (fp, "inflections %d", K.tInfl.getn());
+  for (i=0; i<K.tInfl.getn(); i++) fprintf (fp, " %g", K.tInfl[i]);
+  fprintf (fp, "\nboundary %d\n", K.hitKernel.getn());
+  for (i=0; i<K.hitKernel.getn(); i++)
+    fprintf (fp, "%g %g %c\n", K.hitKernel[i][0], K.hitKernel[i][1],
+    	     K.kernelSortIndex[i] < K.nKernelFromInfl ? 'i' : 'c');
+  if (K.hitKernel.getn() > 0)
+    fprintf (fp, "centroid %g %g\n", K.kernelCentroid[0], K.kernelCentroid[1]);
+  fclose (fp);
+  return 1;
+}
+
+#endif
@@ -2,7 +2,7 @@
   File:          kernel.cpp
   Author:        J.K. Johnstone 
   Created:	 23 August 2002 (from tangentialCurve.cpp)
-  Last Modified: 28 February 2006
+  Last Modified: 17 October 2026
   Purpose:       Compute the kernel of the given curve.
 		 Builds on tangentialCurve.cpp.
   Sequence: 	 3rd in a sequence (interpolate, tangentialCurve, kernel)
@@ -19,6 +19,9 @@
 		 9/13/02: Drawing convex hull in dual space (cheating: using kernel).
 		 9/25/02: Drawing trim region.
 		 2/28/06: Updated to modern C++ library.
+		 10/17/26: Kernel computation moved to curveKernel.h (headless,
+		 	  reentrant, one intersection pass per inflection tangent);
+			  batch mode over a list of curves (-b, -t).
 */
 
 #define APPLE 1
@@ -45,6 +48,8 @@ using std::string;
 #include "basic/MiscVector.h"		
 #include "curve/BezierCurve.h"	// drawTangent, drawPt
 #include "tangcurve/TangCurve.h" // create; evalProj, drawCtrlPoly, drawPt (from RatBezierCurve inheritance)
+#include "curveKernel.h"	// computeKernel, writeKernel
+#include "workSteal.h"		// workStealFor, nProcessor (umbraPUBLISH/src)
 
 #define PTSPERBEZSEGMENT 30     // # pts to draw on each Bezier segment
 #define WINDOWS 0		// 0 for running on SGI, 1 for Windows
@@ -60,6 +65,9 @@ static void usage()
   cout << "\t[-x tx] (translation amount in x)" << endl;
   cout << "\t[-e accuracy of inflection and intersection] (default: .001)" << endl;
   cout << "\t[-o] (open curve)" << endl;
+  cout << "\t[-b list] (batch: kernel of each curve in list, one .pts file per line,"  << endl;
+  cout << "\t           into <file>.pts.kernel; no display)" << endl;
+  cout << "\t[-t # threads in batch] (default: # processors)" << endl;
   cout << "\t <file>.pts" << endl;
  }
 
@@ -95,19 +103,21 @@ static GLboolean spinCCW=1;		// spin in 'counterclockwise' direction?
 
 BezierCurve2f 		obstacle;	// interpolating cubic Bezier curve
 FloatArr 		tTangThruOrigin;// params of tangents through origin
-TangentialCurve		obdualc;	// associated tangential c-curve
-FloatArr		tInfl;		// param values of inflection pts on obstacle
-V2fArr 			hitInfl;	// intersections of the inflection bitangents
-V2fArr 			hitCurve;	// intersections of infl tangents w. curve
-V2fArr 			hitKernel;	// intersections representing kernel boundary
-int 			nKernelFromInfl;// # of kernel pts from hitInfl
-V2f			kernelMean(0,0);// mean of finite kernel pts
-V2f			kernelCentroid;	// centroid of finite kernel pts
-IntArr 			kernelSortIndex;// rearrangement of hitKernel from sorting
-BezierCurve2f		kernelCurve;	// original curve with only kernel segments active
-IntArr			activeKernel;	// active segments of kernelCurve
-V2fArr 			hitCurveParameterPair;	// parameter values of kernel points associated with curve
-		  				// only used for convex hull
+CurveKernel		ker;		// kernel of obstacle (curveKernel.h)
+TangentialCurve		&obdualc = ker.obdualc;	// associated tangential c-curve
+FloatArr		&tInfl = ker.tInfl;	// param values of inflection pts on obstacle
+V2fArr 			&hitInfl = ker.hitInfl;	// intersections of the inflection bitangents
+V2fArr 			&hitCurve = ker.hitCurve;// intersections of infl tangents w. curve
+V2fArr 			&hitKernel = ker.hitKernel;// intersections representing kernel boundary
+int 			&nKernelFromInfl = ker.nKernelFromInfl;// # of kernel pts from hitInfl
+V2f			&kernelMean = ker.kernelMean;	// mean of finite kernel pts
+V2f			&kernelCentroid = ker.kernelCentroid;	// centroid of finite kernel pts
+IntArr 			&kernelSortIndex = ker.kernelSortIndex;// rearrangement of hitKernel from sorting
+BezierCurve2f		&kernelCurve = ker.kernelCurve;	// original curve with only kernel segments active
+IntArr			&activeKernel = ker.activeKernel;	// active segments of kernelCurve
+V2fArr 			&hitCurveParameterPair = ker.hitCurveParameterPair;	
+					// parameter values of kernel points associated with curve
+		  			// only used for convex hull
 float colour[7][3]    = {{1,0,0}, {0,0,1}, {0,1,0}, {0,0,0}, {1,0,1}, {0,1,1}, {1,1,0}};
 float greyscale[7][3] = {{0,0,0}, {.1,.1,.1}, {.2,.2,.2}, {.3,.3,.3}, {.4,.4,.4}, {.5,.5,.5}, {.6,.6,.6}};
 BezierCurve2f	 	hodo0;		// hodograph of 1st obstacle, for interactive tangent display
@@ -120,6 +130,8 @@ float 			xMouse=1, yMouse=0; // world coordinates of mouse
 int       		nPtsPerSegment = PTSPERBEZSEGMENT;
 int 			PRINTOUT=0;	// 0 for displaying on screen, 1 for printing out image
 float 			xTranslate=0;
+char			*batchList=NULL;// list of curves for batch mode (-b)
+int			nThread=0;	// # threads in batch mode (0: # processors)
 
 /******************************************************************************/
 /******************************************************************************/
@@ -650,18 +662,71 @@ void displayDual ()
 /******************************************************************************
 ******************************************************************************/
 
-void inputCurves (char *file, BezierCurve2f &obstacle)
+int inputCurves (const char *file, BezierCurve2f &obstacle)
 {
   int i,j;
   ifstream infile;  infile.open(file);  
+  if (!infile) return 0;
   V2fArrArr Pt;		// data points, organized into polygons
   read (infile, Pt);
+  if (Pt.getn() == 0) return 0;
   scaleToUnitSquare (Pt);
   for (i=0; i<Pt.getn(); i++)
     for (j=0; j<Pt[i].getn(); j++)
       Pt[i][j][0] += xTranslate;
   if (CLOSED)  obstacle.fitClosed (Pt[0]);
   else         obstacle.fit 	  (Pt[0]);
+  return 1;
+}
+
+/******************************************************************************
+	Batch mode: the kernel of each curve of a list, in parallel,
+	each into its own <file>.kernel (see writeKernel).
+	Each task owns its curve and CurveKernel; the shared inputs 
+	(xTranslate, CLOSED, eps) are read-only.
+******************************************************************************/
+
+struct KernelBatch
+{
+  Array<string> file;		// input curves
+  IntArr	nBdry;		// # kernel boundary pts of curve k (-1: failed)
+  IntArr	starShaped;	// is curve k star-shaped?
+  float		eps;
+};
+
+void kernelTask (int k, void *arg)
+{
+  KernelBatch &b = *(KernelBatch *) arg;
+  BezierCurve2f ob;  CurveKernel K;
+  b.nBdry[k] = -1;  b.starShaped[k] = 0;
+  if (!inputCurves (b.file[k].c_str(), ob)) return;
+  int n = computeKernel (ob, b.eps, 0, K);
+  if (n == -1) return;			// kernel arcs not traced
+  string out = b.file[k] + ".kernel";
+  if (!writeKernel (out.c_str(), b.file[k].c_str(), K)) return;
+  b.nBdry[k] = n;  b.starShaped[k] = K.starShaped;
+}
+
+void batchKernel (char *list, float eps, int nThread)
+{
+  ifstream infile;  infile.open(list);
+  if (!infile) { cout << "Cannot open " << list << endl;  exit(-1); }
+  KernelBatch b;  b.eps = eps;
+  int i, n=0;  string line;
+  while (getline (infile, line)) if (line.length() > 0 && line[0] != '#') n++;
+  b.file.allocate(n);  b.nBdry.allocate(n);  b.starShaped.allocate(n);
+  infile.clear();  infile.seekg(0);
+  for (i=0; i<n && getline (infile, line); )
+    if (line.length() > 0 && line[0] != '#') b.file[i++] = line;
+  if (nThread <= 0) nThread = nProcessor();
+  time_t start = time(0);
+  workStealFor (n, nThread, kernelTask, &b);
+  int nStar=0, nFail=0;
+  for (i=0; i<n; i++)
+    if (b.nBdry[i] == -1) { nFail++;  cout << "Failed: " << b.file[i] << endl; }
+    else nStar += b.starShaped[i];
+  cout << nStar << " of " << n << " curves star-shaped (" << nFail << " failed), "
+       << nThread << " threads, " << time(0) - start << " s" << endl;
 }
 
 /******************************************************************************
@@ -685,223 +750,25 @@ int main (int argc, char **argv)
       case 'x': xTranslate = atof(argv[ArgsParsed++]);		break;
       case 'e': eps = atof(argv[ArgsParsed++]);			break;
       case 'o': CLOSED=0;					break;
+      case 'b': batchList = argv[ArgsParsed++];			break;
+      case 't': nThread = atoi(argv[ArgsParsed++]);		break;
       case 'h': 
       default:	usage(); exit(-1);				break;
       }
    else ArgsParsed++;
   }
 
-  inputCurves(argv[argc-1], obstacle);
+  if (batchList) { batchKernel (batchList, eps, nThread);  return 0; }
+  if (!inputCurves(argv[argc-1], obstacle)) { cout << "Cannot read " << argv[argc-1] << endl;  exit(-1); }
   hodo0.createHodograph (obstacle);	// for spinning tangent
   V2f origin(0,0);			// compute tangs thru origin for display
   tangThruPt (obstacle, origin, tTangThruOrigin, .0001); 
   	// apparent chicken and egg problem: need tangential curve to compute tTangThruOrigin
 	// and worse, pts of tangency are inherently unstably computed infinite pts
 	//	solution: use tangential curve system of ACM SE conference
-  obdualc.createC (obstacle, 0, .05);	// compute tangential c-curve
-// obdualc.print();
-// cout << obdualc.active << endl;
+  if (computeKernel (obstacle, eps, nPtsPerSegment, ker, 1) == -1)
+    { cout << "Cannot trace the kernel of " << argv[argc-1] << endl;  exit(-1); }
   obstacle.prepareDisplay (nPtsPerSegment);	// postpone, since obstacle changes in creating obdualc
-  obdualc.prepareDisplay (nPtsPerSegment*5);
-  obstacle.inflectionPt (tInfl, eps);	// compute inflection points
-  
-
-  /******* compute intersections of inflection tangents ********/
-
-  int nInfl = tInfl.getn(), nHit = 0;
-  V2fArr hitInflTemp((nInfl-1)*nInfl/2);	
-  V2fArr linePair ((nInfl-1)*nInfl/2);	// linePair[i] = parameters of 2 points in dual space that define hitInfl[i] line
-  for (i=0; i<nInfl; i++)
-   {
-    Line2f inflTang1;		// tangent at tInfl[i]
-    obstacle.buildTangent (tInfl[i], hodo0, 1, inflTang1);
-    for (j=i+1; j<nInfl; j++)
-     {
-      Line2f inflTang2;		// tangent at tInfl[j]
-      obstacle.buildTangent (tInfl[j], hodo0, 1, inflTang2);
-      float foo; 
-      if (inflTang1.intersect (inflTang2, hitInflTemp[nHit], foo, 0, eps))
-       {	// not parallel
-        linePair[nHit][0]   = tInfl[i]; 
-	linePair[nHit++][1] = tInfl[j];
-       }
-     }
-   }
-  hitInfl.create (hitInflTemp, nHit);	// some lines may be parallel
-   
-  /******* compute intersections of inflection tangents w. curve ********/
-
-  hitCurve.allocate(0);
-  for (i=0; i<nInfl; i++)
-   {
-    BezierCurve2f inflTang;		// tangent at tInfl[i]
-    obstacle.buildTangent (tInfl[i], hodo0, 1, inflTang);
-    int nFoo;  V2fArr hit;  FloatArr tFoo, btFoo;
-    obstacle.intersect (inflTang, nFoo, hit, tFoo, btFoo, eps);
-// cout << hit.getn() << " intersections of inflection tangent with curve" << endl;    
-    hitCurve += hit;
-   }
-  V2fArr parameterPair (hitCurve.getn());  // parameterPair[i] = parameters of 2 points in dual space that define hitCurve[i] line
-  nHit=0;
-  for (i=0; i<nInfl; i++)
-   {
-    BezierCurve2f inflTang;		// tangent at tInfl[i]
-    obstacle.buildTangent (tInfl[i], hodo0, 1, inflTang);
-    int nFoo;  V2fArr hit;  FloatArr tFoo, btFoo;
-    obstacle.intersect (inflTang, nFoo, hit, tFoo, btFoo, eps);		// wish we didn't have to compute again, but can't see how not
-    for (j=0; j<hit.getn(); j++)
-     {
-      parameterPair[nHit][0]   = tInfl[i];
-      parameterPair[nHit++][1] = tFoo[j];
-     }
-   }
-
-  /******* compute intersections associated with free lines in dual space ****/
-
-  IntArr hitKerFlag (hitInfl.getn() + hitCurve.getn());
-  int nHitKer=0;	
-  TangentialCurve hitDual;	// dual of intersection point
-  V2fArr fooHit; FloatArr tFoo, btFoo;
-  for (i=0; i<hitInfl.getn(); i++)
-   {
-cout << "Considering hitInfl[" << i << "]" << endl;   
-    hitDual.createImplicitLine (hitInfl[i][0], hitInfl[i][1], 1);
-    obdualc.intersect (hitDual, nHit, fooHit, tFoo, btFoo, eps);
-
-    	// ignore intersections near 'cusps' defining the line
-    V2f dualPt1; obdualc.eval (linePair[i][0], dualPt1);	// 'cusps'
-    V2f dualPt2; obdualc.eval (linePair[i][1], dualPt2);
-    int nIgnore=0;		// how many intersections should be ignored?
-    for (j=0; j<nHit; j++)
-     {
-// cout << fooHit[j].dist (dualPt1) << " " << fooHit[j].dist (dualPt2) << endl;
-      if (fooHit[j].dist (dualPt1) < 10*eps || fooHit[j].dist (dualPt2) < 10*eps) 
-        nIgnore++;
-     }
-
-// cout << nHit - nIgnore << endl;
-    if (nHit - nIgnore == 0)		// dual of hitInfl[i] is free
-     {   hitKerFlag[i] = 1; nHitKer++; }
-    else hitKerFlag[i] = 0;
-   }
-   
-  /*******/
-
-  for (i=0; i<hitCurve.getn(); i++)
-   {
-cout << "Considering hitCurve[" << i << "]" << endl;   
-    hitDual.createImplicitLine (hitCurve[i][0], hitCurve[i][1], 1);
-    obdualc.intersect (hitDual, nHit, fooHit, tFoo, btFoo, eps);  
-
-    	// ignore intersections near cusp and curve point defining the line
-    V2f dualPt1; obdualc.eval (parameterPair[i][0], dualPt1);
-    V2f dualPt2; obdualc.eval (parameterPair[i][1], dualPt2);
-    int nIgnore=0;		// how many intersections should be ignored?
-    for (j=0; j<nHit; j++)
-     {
-// cout << fooHit[j].dist (dualPt1) << " " << fooHit[j].dist (dualPt2) << endl;
-      if (fooHit[j].dist (dualPt1) < 10*eps || fooHit[j].dist (dualPt2) < 10*eps) 
-        nIgnore++;
-     }
-
-// cout << nHit - nIgnore << endl;
-    if (nHit - nIgnore == 0)		// dual of hitCurve[i] is free
-     {   hitKerFlag[hitInfl.getn() + i] = 1; nHitKer++; }
-    else hitKerFlag[hitInfl.getn() + i] = 0;
-   }
-
-cout << "Collecting" << endl;   
-  hitKernel.allocate (nHitKer);		// copy over
-  IntArr kernelIndex(nHitKer);		// remember where each kernel pt came from
-  nHitKer = 0;
-  for (i=0; i<hitInfl.getn(); i++)
-    if (hitKerFlag[i]) 	
-     {
-      kernelIndex[nHitKer] = i;
-      hitKernel[nHitKer++] = hitInfl[i];
-     }
-  nKernelFromInfl = nHitKer;	// record # of kernel pts from hitInfl
-  hitCurveParameterPair.allocate (hitKernel.getn() - nKernelFromInfl);
-  for (i=0; i<hitCurve.getn(); i++)
-    if (hitKerFlag[hitInfl.getn() + i]) 
-     {
-      kernelIndex[nHitKer] = i;
-      hitCurveParameterPair[nHitKer - nKernelFromInfl] = parameterPair[i]; 
-      hitKernel[nHitKer++] = hitCurve[i];
-     }
-     
-if (hitKernel.getn() > 0)	// nonempty kernel
- {
-cout << "Building full kernel from finite kernel points" << endl;
-  // build full kernel:
-  // connect two consecutive points of sorted hitKernel
-  // by a straight line if one of these points is an intersection of inflection tangents, and
-  // by a curve segment otherwise (both points are intersections of curve with inflection tangent)
-
-  for (i=0; i<hitKernel.getn(); i++) 	// compute sample mean
-    kernelMean += hitKernel[i];
-  kernelMean /= hitKernel.getn();
-  
-  int nKernelFromCurve = hitKernel.getn() - nKernelFromInfl;
-  if (nKernelFromCurve > 0)	// some kernel pts from curve
-   {
-    kernelCurve = obstacle;	// subdivide kernel curve at hitCurve points of hitKernel
-    FloatArr tCurve(hitKernel.getn() - nKernelFromInfl);
-    for (i=0; i<tCurve.getn(); i++) 	// first few in kernel are from tInfl
-      tCurve[i] = parameterPair[kernelIndex[nKernelFromInfl+i]][1];
-    IntArr foo;  tCurve.bubbleSort (foo);
-    kernelCurve.subdivideSpline (tCurve);
-  
-//  kernelCurve.print();
-  
-    // sort by angle about mean (first determine sort direction)
-    assert (tCurve[0] + .1 < kernelCurve.getLastKnot());
-    V2f pt0; kernelCurve.eval (tCurve[0],       pt0);
-    V2f pt1; kernelCurve.eval (tCurve[0] + .01, pt1);
-    V2f vec0(pt0);  vec0 -= kernelMean;
-    V2f vec1(pt1);  vec1 -= kernelMean;
-    if (vec0.angleFromX() < vec1.angleFromX())
-         sortByAngleCCW (hitKernel, kernelMean, kernelSortIndex);  
-    else sortByAngleCW  (hitKernel, kernelMean, kernelSortIndex);
-
-    // prepare display of kernel segments
-    activeKernel.allocate(kernelCurve.getL());
-    activeKernel.clear();			// initially turn off all segments
-    for (i=0; i<hitKernel.getn(); i++)		// traverse kernel boundary
-      if (kernelSortIndex[i]   >= nKernelFromInfl &&	// consecutive hitCurve points
-          kernelSortIndex[(i+1)%hitKernel.getn()] >= nKernelFromInfl)
-       {
-          // turn on segments between hitKernel[i] and hitKernel[i+1]
-          // 	since this represents a segment of the kernel
-          // find parameter values of two endpoints
-        float tStart = parameterPair [kernelIndex[kernelSortIndex[i]]  ][1];
-        float tEnd   = parameterPair [kernelIndex[kernelSortIndex[(i+1)%hitKernel.getn()]]][1];
-// cout << "Turning on from " << tStart << " to " << tEnd << endl;     
-        j=0;  while (kernelCurve.getKnot(j) != tStart) j++;
-        while (kernelCurve.getKnot(j) != tEnd)
-         {
-// cout << "Turning on segment (" << kernelCurve.getKnot(j) << "," 
-//			       << kernelCurve.getKnot(j+1) << ")" << endl;
-	  if (j != kernelCurve.getL())			       
-            activeKernel[j] = 1;
-	  if (j == kernelCurve.getL()-1) 	
-	    if (tEnd == kernelCurve.getKnot(j+1))	// stop at end of curve
-	       j=j+1;
-	    else					// wraparound
-	       j=0;
-	  else j++;
-         }
-       }
-    kernelCurve.prepareActiveDisplay (activeKernel, nPtsPerSegment);
-  	// can't inherit obstacle's display, since we have subdivided at kernel points
-   }
-  else 	// sort direction doesn't matter
-    	 sortByAngleCCW (hitKernel, kernelMean, kernelSortIndex); 
-  
-  //  centroid requires sorted polygon
-  Polygon2f kernelBdry (hitKernel);
-  kernelBdry.centroid (kernelCentroid);
-}  // if (hitKernel.getn() > 0)
 
   tActive = obstacle.getKnot(0);	// start at beginning
   if (WINDOWS) tDelta = obstacle.getKnot (obstacle.getnKnot()-1) / 2000.;
@@ -2,7 +2,7 @@
   File:          bitang.cpp
   Author:        J.K. Johnstone 
   Created:	 11 August 2001
-  Last Modified: 28 February 2006
+  Last Modified: 17 October 2026
   Purpose:       Compute the bitangents of a collection of curves (or 2d scene).
   Sequence:	 3rd in a sequence (interpolate, tangentialCurve, bitang)
   Input: 	 k 2d point sets, implicitly defining k interpolating cubic 
@@ -13,6 +13,7 @@
   History: 	 6/4/03: Added scene input capability.
                  7/6/03: Cleaned.
 		 2/28/06: Updated to modern C++ library.
+		 10/17/26: Broad-phase culling of tangential curve pairs.
 */
 
 #define APPLE 1
@@ -38,6 +39,7 @@ using std::string;
 #include "curve/BezierCurve.h"	// inputCurves
 #include "curve/Scene2d.h"
 #include "tangcurve/TangCurve.h" // buildTangentialCurves, CommonTangent, intersect, draw, visible
+#include "dualBox.h"		 // buildDualBox, intersectDual (umbraPUBLISH/src)
 
 #define PTSPERBEZSEGMENT 10     // # pts to draw on each Bezier segment
 #define WINDOWS 0		// 0 for running under Unix, 1 for Windows
@@ -427,11 +429,17 @@ int main (int argc, char **argv)
 
   int nOb = obstacle.getn();   // intersect tangential curves to find bitangents
   bitangA.allocate(nOb*nOb);  bitangB.allocate(nOb*nOb);
+  Array<DualBoxArr> boxa(nOb), boxb(nOb);  // broad phase: segment boxes in dual space
+  for (i=0; i<nOb; i++)
+   {
+    buildDualBox (obduala[i], eps, boxa[i]);
+    buildDualBox (obdualb[i], eps, boxb[i]);
+   }
   for (i=0; i<nOb; i++)
     for (j=i+1; j<nOb; j++)		// bitangents between i and j
      {
-      obduala[i].intersect (obduala[j], bitangA[i*nOb+j], eps);
-      obdualb[i].intersect (obdualb[j], bitangB[i*nOb+j], eps);
+      intersectDual (obduala[i], boxa[i], obduala[j], boxa[j], bitangA[i*nOb+j], eps);
+      intersectDual (obdualb[i], boxb[i], obdualb[j], boxb[j], bitangB[i*nOb+j], eps);
      }
   vistangA.allocate(nOb*nOb);  vistangB.allocate(nOb*nOb);
   for (i=0; i<nOb; i++)
@@ -2,13 +2,15 @@
   File:          dynamicBitang.cpp
   Author:        J.K. Johnstone 
   Created:	 27 May 2004
-  Last Modified: 27 May 2004
+  Last Modified: 17 October 2026
   Purpose:       Dynamically compute bitangents,
                  to analyze flaws in the computation.
   Sequence:	 3rd in a sequence (interpolate, tangentialCurve, bitang)
   Input: 	 1 closed curve and 1 dynamic open curve,
                  the latter defining the spine of a skeletal curve.
   History: 	 5/27/04: Created from bitang.cpp.
+		 10/17/26: Bitangents are recomputed on a background thread, and only
+		           when the envelope changes (computeThread.h; -s to disable).
 */
 
 #include <GL/glut.h>
@@ -28,8 +30,10 @@ using std::string;
 #include "BezierCurve.h"	// inputCurves
 #include "TangCurve.h"		// buildTangentialCurves, CommonTangent, intersect, draw, visible
 #include "Scene2d.h"
+#include "computeThread.h"	// LatestSlot, ComputeThread
 
 #define PTSPERBEZSEGMENT 10     // # pts to draw on each Bezier segment
+#define POLLMSEC        15      // how often the display checks for new bitangents
 #define WINDOWS 0		// 0 for running under Unix, 1 for Windows
 
 static char *RoutineName;
@@ -41,6 +45,7 @@ static void usage()
   cout << "\t[-S] (scene input)" << endl;
   cout << "\t[-p] (set to Postscript printing mode; default is screen display)" << endl;
   cout << "\t[-l] (laptop)" << endl;
+  cout << "\t[-s] (synchronous: recompute inside the display callback, not on a compute thread)" << endl;
   cout << "\t[-h] (this help message)" << endl;
   cout << "\t <file>.pts" << endl;
  }
@@ -55,19 +60,16 @@ static GLboolean DRAWHIT=1;		// draw dual intersections?
 static GLboolean DRAWBITANGA=1;		// draw bitangents from a-space?
 static GLboolean DRAWBITANGB=1;		// draw bitangents from b-space?
 static GLboolean DRAWVISTANG=0;		// draw visible bitangents?
+static GLboolean SYNCHRONOUS=0;		// recompute in the display callback, not on a thread?
+static GLboolean POLLING=0;		// is the display waiting for new bitangents?
 
-Array<BezierCurve2f> 	obstacle;	// interpolating cubic Bezier curves
+Array<BezierCurve2f> 	obstacle;	// interpolating cubic Bezier curves, as input
+					// (the envelope is grown in BitangState::obstacle)
 float                   eps = .0001;	// accuracy of intersection computation
 float                   tGrow;          // present end parameter value of growing envelope
 float                   R=.1;           // radius of envelope
 float                   delta=.1;       // sampling step size
 BezierCurve2f           spine;          // spine curve, defining the dynamic envelope if DYNAMICSPINE
-Array<TangentialCurve>  obduala;	// associated tangential a-curves
-Array<TangentialCurve>  obdualb;	// associated tangential b-curves
-Array<CommonTangentArr> bitangA;	// bitangents from a-space for each pair of curves
-Array<CommonTangentArr> bitangB;	// bitangents from b-space for each pair of curves
-					// curve i/j bitangents are stored in 
-					// index i*obstacle.getn() + j
 Array<IntArr>		vistangA;	// is this a-bitangent visible?
 Array<IntArr>		vistangB;	// is this b-bitangent visible?
 float colour[7][3] = {{1,0,0}, {0,0,1}, {0,1,0}, {0,0,0}, {1,0,1}, {0,1,1}, {1,1,0}};
@@ -79,6 +81,31 @@ int       		nPtsPerSegment = PTSPERBEZSEGMENT;
 int 			PRINTOUT=0;	// 0 for displaying on screen, 1 for printing out image
 int                     LAPTOP=0;       // display environment for laptop?
 
+struct BitangState		// everything that depends on the envelope
+{
+  Array<BezierCurve2f>    obstacle;	// input curves, with the present envelope
+  Array<TangentialCurve>  obduala;	// associated tangential a-curves
+  Array<TangentialCurve>  obdualb;	// associated tangential b-curves
+  Array<CommonTangentArr> bitangA;	// bitangents from a-space for each pair of curves
+  Array<CommonTangentArr> bitangB;	// bitangents from b-space for each pair of curves
+					// curve i/j bitangents are stored in 
+					// index i*obstacle.getn() + j
+  int                     built;	// have the bitangents been built yet?
+  float                   tBuilt;	// value of tGrow when they were last built
+  int                     edit;		// # of the envelope edit they were built for
+};
+
+struct EnvelopeEdit		// an envelope edit, posted to the compute thread
+{
+  float                   tGrow;
+  int                     edit;
+};
+
+LatestSlot<BitangState>   state;	// shown bitangents (read), next (write)
+LatestSlot<EnvelopeEdit>  envelopeEdit;	// newest envelope edit
+ComputeThread             bitangThread;	// brings state up to date with envelopeEdit
+int                       nEdit=0;	// # envelope edits posted
+
 /******************************************************************************/
 /******************************************************************************/
 
@@ -201,6 +228,38 @@ void motiondualb (int x, int y)
   glutPostRedisplay();
 }
 
+/******************************************************************************
+	Redisplay when the compute thread has published newer bitangents,
+	and keep polling until they reflect the newest envelope edit.
+******************************************************************************/
+
+void pollBitang (int value)
+{
+  if (takeSlot (state))
+   {
+    glutPostWindowRedisplay (obstacleWin);
+    glutPostWindowRedisplay (dualWin);
+    glutPostWindowRedisplay (dualWin2);
+   }
+  if (readSlot(state).edit != nEdit) glutTimerFunc (POLLMSEC, pollBitang, 0);
+  else                               POLLING = 0;
+}
+
+/******************************************************************************
+	Hand the present envelope (tGrow) to the compute thread.
+	The windows go on showing the last bitangents until the new ones are ready.
+******************************************************************************/
+
+void postEnvelopeEdit ()
+{
+  if (SYNCHRONOUS) return;		// displayOb recomputes
+  EnvelopeEdit &e = writeSlot (envelopeEdit);
+  e.tGrow = tGrow;  e.edit = ++nEdit;
+  publishSlot (envelopeEdit);
+  wakeComputeThread (bitangThread);
+  if (!POLLING) { POLLING = 1;  glutTimerFunc (POLLMSEC, pollBitang, 0); }
+}
+
 /******************************************************************************/
 /******************************************************************************/
 
@@ -220,10 +279,12 @@ void keyboard (unsigned char key, int x, int y)
                 if (tGrow > spine.getLastKnot())
 		  tGrow = spine.getLastKnot();  
 		cout << "Growing envelope to " << tGrow << endl;
+		postEnvelopeEdit();
 		break;
   case 'G':     if (tGrow > .2) 
                   tGrow -= .1;                        // backwards
 		cout << "Shrinking envelope to " << tGrow << endl;
+		postEnvelopeEdit();
 		break;
   default:      break;
   }
@@ -261,12 +322,23 @@ void menuDual (int value)
   glutPostRedisplay();
 }
 
-/******************************************************************************/
-/******************************************************************************/
+/******************************************************************************
+	Bring the bitangents of S up to date with the envelope grown to tGrow
+	(nothing to do if it has not changed since S was last built).
+******************************************************************************/
 
-void buildBitang()
+void buildBitang (BitangState &S, float tGrow)
 {
   int i,j,k;
+  if (S.built && tGrow == S.tBuilt) return;
+  Array<BezierCurve2f>    &obstacle = S.obstacle;
+  Array<TangentialCurve>  &obduala  = S.obduala;
+  Array<TangentialCurve>  &obdualb  = S.obdualb;
+  Array<CommonTangentArr> &bitangA  = S.bitangA;
+  Array<CommonTangentArr> &bitangB  = S.bitangB;
+
+  // build next envelope of spine
+  spine.buildEnvelope (spine.getKnot(0), tGrow, delta, R, obstacle[1]);
   buildTangentialCurves (obstacle, nPtsPerSegment/2, obduala, obdualb);
 
   int nOb = obstacle.getn();   // intersect tangential curves to find bitangents
@@ -300,6 +372,34 @@ void buildBitang()
 	else 					vistangB[ij][k] = 0;
 	} 
   */
+  S.built = 1;  S.tBuilt = tGrow;
+}
+
+/******************************************************************************
+	Compute thread: bring the next bitangents up to date with the newest 
+	envelope edit and publish them.  Edits posted in the meantime replace
+	each other in envelopeEdit, so only the newest is computed next.
+******************************************************************************/
+
+void bitangStep (void *arg)
+{
+  if (!takeSlot (envelopeEdit)) return;	// newest edit already computed
+  EnvelopeEdit &e = readSlot  (envelopeEdit);
+  BitangState  &S = writeSlot (state);
+  buildBitang (S, e.tGrow);
+  S.edit = e.edit;
+  publishSlot (state);
+}
+
+/******************************************************************************
+	Start S from the input scene: nothing built yet.
+******************************************************************************/
+
+void initBitangState (BitangState &S)
+{
+  S.obstacle.allocate (obstacle.getn());
+  for (int i=0; i<obstacle.getn(); i++) S.obstacle[i] = obstacle[i];
+  S.built = 0;  S.edit = 0;
 }
 
 /******************************************************************************/
@@ -314,9 +414,11 @@ void displayOb ()
   glScalef  (zoomob, zoomob, zoomob);
   glPolygonMode (GL_FRONT_AND_BACK, GL_LINE);
 
-  // build next envelope of spine
-  spine.buildEnvelope (spine.getKnot(0), tGrow, delta, R, obstacle[1]);
-  buildBitang();
+  if (SYNCHRONOUS) buildBitang (readSlot (state), tGrow);
+  else             takeSlot (state);	// newest bitangents from the compute thread, if any
+  Array<BezierCurve2f>    &obstacle = readSlot(state).obstacle;
+  Array<CommonTangentArr> &bitangA  = readSlot(state).bitangA;
+  Array<CommonTangentArr> &bitangB  = readSlot(state).bitangB;
 
   int nOb = obstacle.getn(); 
   for (i=0; i<nOb; i++)
@@ -370,6 +472,8 @@ void displayDual ()
   glPushMatrix();
   glScalef  (zoomduala, zoomduala, zoomduala);
   glPolygonMode (GL_FRONT_AND_BACK, GL_LINE);
+  Array<TangentialCurve>  &obduala  = readSlot(state).obduala;
+  Array<CommonTangentArr> &bitangA  = readSlot(state).bitangA;
 
   int nOb = obstacle.getn(); 
   for (i=0; i<nOb; i++)                 // active segments of tangential a-curves
@@ -407,6 +511,8 @@ void displayDual2 ()
   glPushMatrix();
   glScalef  (zoomdualb, zoomdualb, zoomdualb);
   glPolygonMode (GL_FRONT_AND_BACK, GL_LINE);
+  Array<TangentialCurve>  &obdualb  = readSlot(state).obdualb;
+  Array<CommonTangentArr> &bitangB  = readSlot(state).bitangB;
    
   int nOb = obstacle.getn(); 
   for (i=0; i<nOb; i++)                 // active segments of tangential b-curves
@@ -477,6 +583,7 @@ int main (int argc, char **argv)
       case 'S': SCENEINPUT = 1;                                 break;
       case 'p': PRINTOUT = 1;					break;
       case 'l': LAPTOP = 1;                                     break;
+      case 's': SYNCHRONOUS = 1;                                break;
       case 'h': 
       default:	usage(); exit(-1);				break;
       }
@@ -495,6 +602,10 @@ int main (int argc, char **argv)
     }
   else inputCurves(argv[argc-1], obstacle);
   spine = obstacle[1]; tGrow = spine.getKnot(0) + .2;
+  initLatestSlot (state);  initLatestSlot (envelopeEdit);
+  for (i=0; i<3; i++) initBitangState (state.slot[i]);
+  buildBitang (readSlot (state), tGrow);		// first bitangents, before display
+  if (!SYNCHRONOUS) startComputeThread (bitangThread, bitangStep, NULL);
 
   
   /************************************************************/
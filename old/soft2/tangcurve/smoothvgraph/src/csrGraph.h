@@ -0,0 +1,352 @@
+/*
+  File:          csrGraph.h
+  Created:	 17 October 2026
+  Purpose:       Weighted undirected graph in compressed sparse row form,
+                 with shortest paths by Dijkstra or A* on an indexed binary
+		 heap.
+		 The neighbours of vertex v are adj[start[v] .. start[v+1]-1],
+		 with weights w[...], so a search touches contiguous memory.
+		 A search works in a CSRSearch, allocated once per graph
+		 (and per thread): only the vertices touched by a query are
+		 reset for the next one, so a query costs nothing for the
+		 parts of the graph it does not reach.
+		 A CSROverlay adds temporary vertices and edges to a graph
+		 (e.g., a query's source and destination) without rebuilding
+		 it; clearing the overlay costs only what was added.
+		 A* uses the Euclidean distance to the target as heuristic,
+		 which is consistent if no edge is shorter than the distance
+		 between its ends (true of a visibility graph, whose edges are
+		 segments and arcs).
+  Usage:	 CSREdgeList E;  initCSREdgeList (E);  addCSREdge (E, p, q, w); ...
+  		 CSRGraph G;  buildCSRGraph (nVert, E, G);
+		 CSRSearch S;  initCSRSearch (S, G.nVert);
+		 len = csrShortestPath (G, S, s, t, vert, path);	// vert NULL: Dijkstra
+		 CSROverlay O;  initCSROverlay (O, G);
+		 s = addCSRVertex (O);  addCSROverlayEdge (O, s, p, w); ...
+		 len = csrShortestPath (G, S, s, t, vert, path, &O);
+		 clearCSROverlay (O);
+		 csrShortestPathTree (G, S, root, dist, next, &O);
+*/
+
+#ifndef _CSRGRAPH_H_
+#define _CSRGRAPH_H_
+
+#include <math.h>
+
+struct CSREdgeList			// undirected edges p-q of weight w
+{
+  int    n, size;
+  int   *p, *q;
+  float *w;
+};
+
+struct CSRGraph
+{
+  int    nVert, nEdge;			// nEdge counts each direction
+  int   *start;				// nVert+1
+  int   *adj;				// nEdge
+  float *w;				// nEdge
+};
+
+struct CSROverlay			// temporary vertices and edges over a CSRGraph
+{
+  int    nBase, nVert;			// vertices of the graph; with the temporary ones
+  int    cap;				// # vertices head can hold
+  int   *head;				// first temporary edge of each vertex (-1: none)
+  int   *next, *adj;			// temporary edges (each direction), linked by vertex
+  float *w;
+  int    nEdge, size;
+  int   *touched, nTouched;		// vertices of the graph with temporary edges
+};
+
+struct CSRSearch			// workspace of one search
+{
+  int    nVert;
+  float *g, *key;			// distance from source, g + heuristic
+  int   *prev;				// predecessor on shortest path (-1: source/unreached)
+  int   *heap, *pos, nHeap;		// indexed binary heap on key (pos -1: not in heap)
+  int   *touched, nTouched;		// vertices to reset before the next query
+  char  *done;
+};
+
+/******************************************************************************/
+/******************************************************************************/
+
+void initCSREdgeList (CSREdgeList &E, int size=256)
+{
+  E.n = 0;  E.size = size;
+  E.p = new int[size];  E.q = new int[size];  E.w = new float[size];
+}
+
+void freeCSREdgeList (CSREdgeList &E)
+{
+  delete [] E.p;  delete [] E.q;  delete [] E.w;  E.n = E.size = 0;
+}
+
+void addCSREdge (CSREdgeList &E, int p, int q, float w)
+{
+  if (E.n == E.size)
+   {
+    int *p2 = new int[2*E.size], *q2 = new int[2*E.size];  float *w2 = new float[2*E.size];
+    for (int k=0; k<E.n; k++) { p2[k] = E.p[k];  q2[k] = E.q[k];  w2[k] = E.w[k]; }
+    delete [] E.p;  delete [] E.q;  delete [] E.w;
+    E.p = p2;  E.q = q2;  E.w = w2;  E.size *= 2;
+   }
+  E.p[E.n] = p;  E.q[E.n] = q;  E.w[E.n++] = w;
+}
+
+/******************************************************************************
+	Build G on nVert vertices from the undirected edges E
+	(by counting sort on the first vertex).
+******************************************************************************/
+
+void buildCSRGraph (int nVert, CSREdgeList &E, CSRGraph &G)
+{
+  int k, v;
+  G.nVert = nVert;  G.nEdge = 2*E.n;
+  G.start = new int[nVert+1];
+  G.adj   = new int[G.nEdge+1];
+  G.w     = new float[G.nEdge+1];
+  for (v=0; v<=nVert; v++) G.start[v] = 0;
+  for (k=0; k<E.n; k++) { G.start[E.p[k]+1]++;  G.start[E.q[k]+1]++; }
+  for (v=0; v<nVert; v++) G.start[v+1] += G.start[v];
+  int *fill = new int[nVert+1];
+  for (v=0; v<nVert; v++) fill[v] = G.start[v];
+  for (k=0; k<E.n; k++)
+   {
+    G.adj[fill[E.p[k]]] = E.q[k];  G.w[fill[E.p[k]]++] = E.w[k];
+    G.adj[fill[E.q[k]]] = E.p[k];  G.w[fill[E.q[k]]++] = E.w[k];
+   }
+  delete [] fill;
+}
+
+void freeCSRGraph (CSRGraph &G)
+{
+  delete [] G.start;  delete [] G.adj;  delete [] G.w;
+  G.nVert = G.nEdge = 0;
+}
+
+/******************************************************************************
+	Temporary vertices (numbered from G.nVert) and edges over G.
+******************************************************************************/
+
+void initCSROverlay (CSROverlay &O, CSRGraph &G, int cap=16, int size=64)
+{
+  O.nBase = O.nVert = G.nVert;
+  O.cap   = G.nVert + cap;
+  O.head  = new int[O.cap];
+  for (int v=0; v<O.cap; v++) O.head[v] = -1;
+  O.size  = size;  O.nEdge = 0;
+  O.next  = new int[size];  O.adj = new int[size];  O.w = new float[size];
+  O.touched = new int[G.nVert+1];  O.nTouched = 0;
+}
+
+void freeCSROverlay (CSROverlay &O)
+{
+  delete [] O.head;  delete [] O.next;  delete [] O.adj;  delete [] O.w;
+  delete [] O.touched;
+  O.nBase = O.nVert = O.cap = O.nEdge = O.size = 0;
+}
+
+void clearCSROverlay (CSROverlay &O)	// remove all temporary vertices and edges
+{
+  int v;
+  for (v=0; v<O.nTouched; v++)     O.head[O.touched[v]] = -1;
+  for (v=O.nBase; v<O.nVert; v++)  O.head[v] = -1;
+  O.nTouched = O.nEdge = 0;  O.nVert = O.nBase;
+}
+
+int addCSRVertex (CSROverlay &O)
+{
+  if (O.nVert == O.cap)
+   {
+    int *head2 = new int[2*O.cap];
+    for (int v=0; v<2*O.cap; v++) head2[v] = (v < O.cap ? O.head[v] : -1);
+    delete [] O.head;  O.head = head2;  O.cap *= 2;
+   }
+  return O.nVert++;
+}
+
+static void addCSROverlayArc (CSROverlay &O, int p, int q, float w)	// p to q only
+{
+  if (O.nEdge == O.size)
+   {
+    int *next2 = new int[2*O.size], *adj2 = new int[2*O.size];  float *w2 = new float[2*O.size];
+    for (int k=0; k<O.nEdge; k++) { next2[k] = O.next[k];  adj2[k] = O.adj[k];  w2[k] = O.w[k]; }
+    delete [] O.next;  delete [] O.adj;  delete [] O.w;
+    O.next = next2;  O.adj = adj2;  O.w = w2;  O.size *= 2;
+   }
+  if (p < O.nBase && O.head[p] == -1) O.touched[O.nTouched++] = p;
+  O.adj[O.nEdge] = q;  O.w[O.nEdge] = w;
+  O.next[O.nEdge] = O.head[p];  O.head[p] = O.nEdge++;
+}
+
+void addCSROverlayEdge (CSROverlay &O, int p, int q, float w)
+{
+  addCSROverlayArc (O, p, q, w);  addCSROverlayArc (O, q, p, w);
+}
+
+/******************************************************************************
+	Weight of the lightest edge from p to q (in G or O), or -1 if none.
+******************************************************************************/
+
+float csrEdgeWeight (CSRGraph &G, CSROverlay *O, int p, int q)
+{
+  float w = -1;
+  int   k;
+  if (p < G.nVert)
+    for (k=G.start[p]; k<G.start[p+1]; k++)
+      if (G.adj[k] == q && (w < 0 || G.w[k] < w)) w = G.w[k];
+  if (O)
+    for (k=O->head[p]; k!=-1; k=O->next[k])
+      if (O->adj[k] == q && (w < 0 || O->w[k] < w)) w = O->w[k];
+  return w;
+}
+
+/******************************************************************************/
+/******************************************************************************/
+
+void initCSRSearch (CSRSearch &S, int nVert)
+{
+  S.nVert   = nVert;
+  S.g       = new float[nVert];  S.key = new float[nVert];
+  S.prev    = new int[nVert];
+  S.heap    = new int[nVert];    S.pos = new int[nVert];
+  S.touched = new int[nVert];    S.done = new char[nVert];
+  for (int v=0; v<nVert; v++) { S.pos[v] = -1;  S.prev[v] = -1;  S.done[v] = 0;  S.g[v] = -1; }
+  S.nHeap = S.nTouched = 0;
+}
+
+void freeCSRSearch (CSRSearch &S)
+{
+  delete [] S.g;  delete [] S.key;  delete [] S.prev;
+  delete [] S.heap;  delete [] S.pos;  delete [] S.touched;  delete [] S.done;
+}
+
+static void reserveCSRSearch (CSRSearch &S, int nVert)	// room for nVert vertices
+{
+  if (nVert <= S.nVert) return;
+  freeCSRSearch (S);
+  initCSRSearch (S, 2*nVert);
+}
+
+static inline void csrHeapSwap (CSRSearch &S, int i, int j)
+{
+  int t = S.heap[i];  S.heap[i] = S.heap[j];  S.heap[j] = t;
+  S.pos[S.heap[i]] = i;  S.pos[S.heap[j]] = j;
+}
+
+static void csrHeapUp (CSRSearch &S, int i)
+{
+  while (i > 0 && S.key[S.heap[(i-1)/2]] > S.key[S.heap[i]])
+   { csrHeapSwap (S, i, (i-1)/2);  i = (i-1)/2; }
+}
+
+static void csrHeapDown (CSRSearch &S, int i)
+{
+  for (;;)
+   {
+    int l = 2*i+1, r = l+1, m = i;
+    if (l < S.nHeap && S.key[S.heap[l]] < S.key[S.heap[m]]) m = l;
+    if (r < S.nHeap && S.key[S.heap[r]] < S.key[S.heap[m]]) m = r;
+    if (m == i) return;
+    csrHeapSwap (S, i, m);  i = m;
+   }
+}
+
+static int csrHeapPop (CSRSearch &S)
+{
+  int v = S.heap[0];
+  S.heap[0] = S.heap[--S.nHeap];  S.pos[S.heap[0]] = 0;  S.pos[v] = -1;
+  if (S.nHeap > 0) csrHeapDown (S, 0);
+  return v;
+}
+
+static inline float csrHeuristic (V2f *vert, int v, int t)
+{
+  if (!vert) return 0;
+  float dx = vert[v][0] - vert[t][0], dy = vert[v][1] - vert[t][1];
+  return sqrt (dx*dx + dy*dy);
+}
+
+static inline void csrRelax (CSRSearch &S, int v, int u, float w, V2f *vert, int t)
+{
+  if (S.done[u]) return;
+  float gu = S.g[v] + w;
+  if (S.g[u] >= 0 && gu >= S.g[u]) return;
+  if (S.g[u] < 0) S.touched[S.nTouched++] = u;
+  S.g[u] = gu;  S.key[u] = gu + csrHeuristic (vert, u, t);  S.prev[u] = v;
+  if (S.pos[u] == -1) { S.heap[S.nHeap] = u;  S.pos[u] = S.nHeap++; }
+  csrHeapUp (S, S.pos[u]);
+}
+
+/******************************************************************************
+	Search from s in G (with O if given) until t is settled
+	(t == -1, with vert NULL: until all reachable vertices are).
+******************************************************************************/
+
+static void csrSearch (CSRGraph &G, CSRSearch &S, int s, int t, V2f *vert, CSROverlay *O)
+{
+  int k, v;
+  if (O) reserveCSRSearch (S, O->nVert);
+  for (k=0; k<S.nTouched; k++)			// reset the previous query
+   {
+    v = S.touched[k];
+    S.pos[v] = -1;  S.prev[v] = -1;  S.done[v] = 0;  S.g[v] = -1;
+   }
+  S.nTouched = S.nHeap = 0;
+  S.g[s] = 0;  S.key[s] = csrHeuristic (vert, s, t);
+  S.heap[S.nHeap] = s;  S.pos[s] = S.nHeap++;  S.touched[S.nTouched++] = s;
+  while (S.nHeap > 0)
+   {
+    v = csrHeapPop (S);
+    S.done[v] = 1;
+    if (v == t) break;
+    if (v < G.nVert)
+      for (k=G.start[v]; k<G.start[v+1]; k++) csrRelax (S, v, G.adj[k], G.w[k], vert, t);
+    if (O)
+      for (k=O->head[v]; k!=-1; k=O->next[k]) csrRelax (S, v, O->adj[k], O->w[k], vert, t);
+   }
+}
+
+/******************************************************************************
+	Shortest path from s to t in G, with the temporary vertices and
+	edges of O if given (A* if vert, the positions of the vertices,
+	is given; Dijkstra otherwise).
+	path is the sequence of vertices from s to t.
+	Returns its length, or -1 (and an empty path) if t is unreachable.
+******************************************************************************/
+
+float csrShortestPath (CSRGraph &G, CSRSearch &S, int s, int t, V2f *vert, IntArr &path,
+		       CSROverlay *O=NULL)
+{
+  int k, v;
+  csrSearch (G, S, s, t, vert, O);
+  if (!S.done[t]) { path.allocate(0);  return -1; }
+  int n=1;
+  for (v=t; v!=s; v=S.prev[v]) n++;
+  path.allocate(n);
+  for (v=t, k=n-1; k>=0; v=S.prev[v], k--) path[k] = v;
+  return S.g[t];
+}
+
+/******************************************************************************
+	Shortest-path tree of root in G (with O if given), by Dijkstra:
+	for each of the nVert vertices (G.nVert, or O->nVert), 
+	dist[v] is the length of the shortest path from v to root
+	(-1 if none) and next[v] the vertex after v on it (-1 at root).
+******************************************************************************/
+
+void csrShortestPathTree (CSRGraph &G, CSRSearch &S, int root, float *dist, int *next,
+			  CSROverlay *O=NULL)
+{
+  int nVert = (O ? O->nVert : G.nVert);
+  csrSearch (G, S, root, -1, NULL, O);
+  for (int v=0; v<nVert; v++) 
+   { 
+    dist[v] = (S.done[v] ? S.g[v] : -1);
+    next[v] = (S.done[v] ? S.prev[v] : -1);
+   }
+}
+
+#endif
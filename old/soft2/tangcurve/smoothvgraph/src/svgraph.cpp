@@ -2,7 +2,7 @@
   File:          svgraph.cpp
   Author:        J.K. Johnstone 
   Created:	 30 August 2000 (from dual.c++)
-  Last Modified: 1 February 2006
+  Last Modified: 17 October 2026
   Purpose:       Compute a (smooth) visibility graph amongst
 		 curved obstacles in the plane.
 		 Then interactively compute shortest paths between a source and
@@ -15,6 +15,16 @@
   Output: 	 V-graph (and interactive motion).
   History: 	 10/26/00: some unknown changes made
                  2/1/06:   updated (e.g., header files, removal of contour dependence)
+		 10/17/26: Smooth visibility graph built here (as in the 25Sept00
+		 	   version) on work-stealing threads (-t), stored in
+			   compressed sparse row form and queried by A* (-a: Dijkstra).
+		 10/17/26: Graph amongst obstacles frozen; source and destination
+		 	   spliced in per query as temporary vertices.
+		 10/17/26: Cached shortest-path trees to recent destinations (-p, -c).
+		 10/17/26: Arc lengths and path arcs sampled by batch evaluation
+		 	   (bezierBatch.h).
+		 10/17/26: Benchmark of polygonal against smooth shortest paths
+		 	   over a corpus of scenes, sweeping sampleeps and eps (-b).
   
   if (NEWFILE) 			// output V-graph
    {
@@ -53,6 +63,7 @@ using namespace std;
 #include <string>
 using std::string;
 #include <time.h>
+#include <sys/time.h>
 
 #include "basic/AllColor.h"
 #include "basic/Miscellany.h"
@@ -65,6 +76,9 @@ using std::string;
 #include "vgraph/Vgraph.h"
 #include "basic2/Line.h"
 #include "basic2/Polygon.h"
+#include "workSteal.h"			// workStealFor, nProcessor
+#include "csrGraph.h"			// CSRGraph, csrShortestPath
+#include "bezierBatch.h"		// BezierBatch, sampleBezierBatch
 
 #define XWINDOWSIZE	 545	
 #define YWINDOWSIZE	 545
@@ -82,8 +96,16 @@ static void usage()
   cout << "\t[-e eps]  (accuracy at which intersections are made: default .0001)" << endl;
   cout << "\t[-s sampleeps] (sampling rate: default .05)" << endl;
   cout << "\t[-d displaydensity of Bezier segment]" << endl;
+  cout << "\t[-t #] (number of threads for graph construction; 1 is serial; default: all cores)" << endl;
+  cout << "\t[-a] (shortest paths by Dijkstra rather than A*)" << endl;
+  cout << "\t[-p] (shortest paths by search from the source, not by cached trees to the destination)" << endl;
+  cout << "\t[-c #] (number of cached shortest-path trees: default 8)" << endl;
+  cout << "\t[-b] (benchmark: no display; compare polygonal and smooth graphs" << endl;
+  cout << "\t      on every <file>.pts given, for each sampleeps and eps)" << endl;
+  cout << "\t[-q #] (number of random queries per scene in benchmark: default 50)" << endl;
+  cout << "\t      (-s and -e take comma-separated lists in benchmark, e.g. -s .2,.1,.05)" << endl;
   cout << "\t[-h] (this help message)" << endl;
-  cout << "\t <file>.pts" << endl;
+  cout << "\t <file>.pts ..." << endl;
  }
 
 static GLfloat   transxob, transyob, zoomob;
@@ -107,6 +129,9 @@ static GLboolean DRAWPOLYVGRAPH=0;	// draw polygonal visibility graph?
 static GLboolean SOURCEDEST=1;		// draw source/destination?
 static GLboolean rotateOb=1;		// start rotating tangent on 1st curve?
 static GLboolean spinCCW=1;		// spin in 'ccw' direction?
+static GLboolean ASTAR=1;		// shortest paths by A* (else Dijkstra)?
+static GLboolean PATHTREE=1;		// shortest paths from cached trees to the destination?
+static GLboolean BENCHMARK=0;		// benchmark polygonal against smooth graphs, no display?
 
 // static GLboolean DEBUG = 1;
 
@@ -114,10 +139,30 @@ int 	    	   	n=0;		// # of obstacles
 V2f			source(0,0), dest(1,1);
 Array<Polygon2f>   	obstaclePoly;
 Array<BezierCurve2f> 	obstacle;
-SmoothVisibilityGraph	svgraph;	// smooth visibility graph
+BezierBatch	       *obBatch=NULL;	// batch evaluator of each obstacle
 VisibilityGraph		vgraph;		// polygonal visibility graph
 IntArr			shortestPath;	// from source to destination
 IntArr			polyShortestPath; 
+float			shortestPathLength;
+
+// smooth visibility graph
+Array<TangentialCurve>	tangCurve;	// n obstacles, then source (n) and destination (n+1)
+Array<CommonTangentArr>	visTang;	// visTang[i*(n+2)+j]: visible common tangents of i<=j
+CSRGraph		svgraph;	// amongst obstacles: vertices are points of tangency, 
+					// obstacle by obstacle in parameter order
+CSROverlay		svquery;	// source, destination, their points of tangency and edges
+CSRSearch		svsearch;
+int			sourceVert, destVert;
+V2f		       *svVert=NULL;	// position of each vertex (graph, then query)
+float		       *vertParam=NULL;	// parameter of vertex on its obstacle
+int		       *vertOb=NULL;	// obstacle of vertex (-1: source, -2: destination)
+int			vertCap=0;	// # vertices these can hold
+IntArr			obStart;	// vertices of obstacle i: obStart[i] .. obStart[i+1]-1
+FloatArr		arcLen;		// length of arc from vertex to next on its obstacle
+IntArr			tangEdge;	// tangent edges amongst obstacles, as vertex pairs
+CSREdgeList		queryTang;	// tangent edges of source and destination
+int			nThread=-1;	// # threads for construction (-1: all cores)
+float			eps = .0001;	// accuracy of intersection computation
 
 int			obstacleWin;
 int       		nPtsPerSegment = PTSPERBEZSEGMENT; 
@@ -224,19 +269,523 @@ void mouse (int button, int state, int x, int y)
   }
 }
 
+/******************************************************************************
+	Smooth visibility graph construction (after the 25Sept00 version).
+	The tangential curves, and the common tangents of each pair of them
+	(with their visibility culling, the dominant cost), are independent
+	tasks run on nThread work-stealing threads; each task writes only
+	its own slot, so the graph does not depend on the schedule.
+	The graph amongst the obstacles (svgraph) is built once and frozen.
+	The source and destination are spliced in for each query as
+	temporary vertices (svquery), with their tangents through the point
+	(as in tangthrupt/poletang) and the arcs from the new points of 
+	tangency to their neighbours on the obstacle, so moving them
+	touches nothing of the obstacles.
+******************************************************************************/
+
+void tangCurveTask (int k, void *arg)
+{
+  if      (k <  n) tangCurve[k].create (obstacle[k], k);
+  else if (k == n) tangCurve[k].create (source, -1);
+  else             tangCurve[k].create (dest,   -2);
+}
+
+struct PairTasks
+{
+  IntArr pairI, pairJ;
+};
+
+void pairTask (int k, void *arg)
+{
+  PairTasks &t = *(PairTasks *) arg;
+  int i = t.pairI[k], j = t.pairJ[k], l, nVis=0;
+  CommonTangentArr common;
+  if (i == j) tangCurve[i].selfIntersect (common, eps);
+  else        tangCurve[i].intersect (tangCurve[j], common, eps);
+  IntArr vis(common.getn());		// cull invisible common tangents, using all obstacles
+  for (l=0; l<common.getn(); l++)
+    if ((vis[l] = common[l].visible (obstacle, source, dest))) nVis++;
+  CommonTangentArr &out = visTang[i*(n+2)+j];
+  out.allocate (nVis);
+  for (l=0, nVis=0; l<common.getn(); l++)
+    if (vis[l]) out[nVis++] = common[l];
+}
+
+/******************************************************************************
+	Compute the visible common tangents of pairs (i,j), i<=j:
+	pairs of obstacles if which == 0; pairs of an obstacle and the 
+	source (which == -1) or destination (which == -2) otherwise.
+******************************************************************************/
+
+void buildVisibleTangents (int which)
+{
+  int i,j;
+  PairTasks t;
+  int nPair=0;
+  t.pairI.allocate (n*(n+1)/2 + n);  t.pairJ.allocate (n*(n+1)/2 + n);
+  for (i=0; i<n; i++)
+    if (which == 0) 
+      for (j=i; j<n; j++) { t.pairI[nPair] = i;  t.pairJ[nPair++] = j; }
+    else { t.pairI[nPair] = i;  t.pairJ[nPair++] = (which == -1 ? n : n+1); }
+  if (nThread <= 1) for (i=0; i<nPair; i++) pairTask (i, &t);
+  else              workStealFor (nPair, nThread, pairTask, &t);
+}
+
+/******************************************************************************/
+/******************************************************************************/
+
+static int compareFloat (const void *a, const void *b)
+{
+  float x = *(const float *) a, y = *(const float *) b;
+  return (x < y ? -1 : (x > y ? 1 : 0));
+}
+
+#define ARCSAMPLES 1000		// samples over a whole obstacle, for arc length
+
+/******************************************************************************
+	Length of closed curve obstacle[ob] from t0 forward to t1 (wrapping if t1 < t0),
+	as a sum of chords; no shorter than the chord from t0 to t1, so the
+	Euclidean A* heuristic stays consistent.
+******************************************************************************/
+
+float arcLength (int ob, float t0, float t1)
+{
+  BezierBatch &B = obBatch[ob];
+  float range = B.knot[B.L] - B.knot[0];
+  if (t1 < t0) t1 += range;
+  int   nSample = (int) ceil (ARCSAMPLES * (t1-t0) / range);
+  if (nSample < 2) nSample = 2;
+  float x[BATCHCHUNK+1], y[BATCHCHUNK+1];
+  float len = 0;
+  for (int k=0; k<nSample; k += BATCHCHUNK)	// samples k..k+m
+   {
+    int m = (nSample-k < BATCHCHUNK ? nSample-k : BATCHCHUNK);
+    sampleBezierBatch (B, t0 + (t1-t0)*k/nSample, t0 + (t1-t0)*(k+m)/nSample, m, x, y);
+    for (int j=1; j<=m; j++) len += sqrt ((x[j]-x[j-1])*(x[j]-x[j-1]) + (y[j]-y[j-1])*(y[j]-y[j-1]));
+   }
+  return len;
+}
+
+void arcTask (int i, void *arg)		// self-edges of obstacle i
+{
+  int nv = obStart[i+1] - obStart[i];
+  for (int v=obStart[i]; v<obStart[i+1]; v++)
+    arcLen[v] = (nv < 2 ? 0 : 
+    		 arcLength (i, vertParam[v], 
+		 	    vertParam[v+1 < obStart[i+1] ? v+1 : obStart[i]]));
+}
+
+static int vertexOf (int ob, float t)	// first vertex of obstacle ob at parameter >= t
+{
+  int lo = obStart[ob], hi = obStart[ob+1];
+  while (lo < hi)
+   {
+    int mid = (lo + hi) / 2;
+    if (vertParam[mid] < t) lo = mid+1; else hi = mid;
+   }
+  return lo;
+}
+
+static void reserveVertices (int nVert)	// room for nVert vertices in svVert, ...
+{
+  if (nVert <= vertCap) return;
+  int    cap = (2*vertCap > nVert ? 2*vertCap : nVert);
+  V2f   *vert2  = new V2f[cap];
+  float *param2 = new float[cap];
+  int   *ob2    = new int[cap];
+  for (int v=0; v<vertCap; v++) { vert2[v] = svVert[v];  param2[v] = vertParam[v];  ob2[v] = vertOb[v]; }
+  delete [] svVert;  delete [] vertParam;  delete [] vertOb;
+  svVert = vert2;  vertParam = param2;  vertOb = ob2;  vertCap = cap;
+}
+
+/******************************************************************************
+	Assemble the graph amongst the obstacles from visTang:
+	a vertex for each distinct point of tangency (sorted by parameter
+	on each obstacle); an edge for each visible tangent (weighted by 
+	its length) and for each arc between consecutive vertices of an 
+	obstacle (by arc length).
+******************************************************************************/
+
+void buildSmoothVisibilityGraph ()
+{
+  int i,j,k,v;
+  Array<FloatArr> param(n);	// param[i] = parameters of tangent endpoints on obstacle[i]
+  IntArr nParam(n);
+  for (i=0; i<n; i++) nParam[i] = 0;
+  for (i=0; i<n; i++)
+    for (j=i; j<n; j++)
+     {
+      nParam[i] += visTang[i*(n+2)+j].getn();
+      nParam[j] += visTang[i*(n+2)+j].getn();
+     }
+  for (i=0; i<n; i++) { param[i].allocate (nParam[i]);  nParam[i] = 0; }
+  for (i=0; i<n; i++)
+    for (j=i; j<n; j++)
+      for (k=0; k<visTang[i*(n+2)+j].getn(); k++)
+       {
+        param[i][nParam[i]++] = visTang[i*(n+2)+j][k].param1;
+	param[j][nParam[j]++] = visTang[i*(n+2)+j][k].param2;
+       }
+  obStart.allocate (n+1);
+  obStart[0] = 0;
+  for (i=0; i<n; i++)			// sort, merging duplicates
+   {
+    if (param[i].getn() > 0) qsort (&param[i][0], param[i].getn(), sizeof(float), compareFloat);
+    int nDistinct=0;
+    for (k=0; k<param[i].getn(); k++)
+      if (nDistinct == 0 || param[i][k] != param[i][nDistinct-1])
+	param[i][nDistinct++] = param[i][k];
+    nParam[i] = nDistinct;
+    obStart[i+1] = obStart[i] + nDistinct;
+   }
+  int nVert = obStart[n];
+  reserveVertices (nVert + 16);
+  arcLen.allocate (nVert);
+  for (i=0; i<n; i++)
+    for (k=0; k<nParam[i]; k++)
+     {
+      v = obStart[i]+k;
+      vertParam[v] = param[i][k];  vertOb[v] = i;
+      obstacle[i].eval (param[i][k], svVert[v]);
+     }
+
+  if (nThread <= 1) for (i=0; i<n; i++) arcTask (i, NULL);
+  else              workStealFor (n, nThread, arcTask, NULL);
+
+  CSREdgeList E;  initCSREdgeList (E);
+  for (i=0; i<n; i++)			// tangent edges
+    for (j=i; j<n; j++)
+      for (k=0; k<visTang[i*(n+2)+j].getn(); k++)
+       {
+	CommonTangent &t = visTang[i*(n+2)+j][k];
+	int p = vertexOf (i, t.param1), q = vertexOf (j, t.param2);
+	addCSREdge (E, p, q, svVert[p].dist (svVert[q]));
+       }
+  tangEdge.allocate (2*E.n);
+  for (k=0; k<E.n; k++) { tangEdge[2*k] = E.p[k];  tangEdge[2*k+1] = E.q[k]; }
+  for (i=0; i<n; i++)			// self-edges, including the wrap-around
+    if (nParam[i] > 1)
+      for (v=obStart[i]; v<obStart[i+1]; v++)
+	addCSREdge (E, v, (v+1 < obStart[i+1] ? v+1 : obStart[i]), arcLen[v]);
+  buildCSRGraph (nVert, E, svgraph);
+  freeCSREdgeList (E);
+  initCSRSearch (svsearch, nVert + 16);
+  initCSROverlay (svquery, svgraph);
+  initCSREdgeList (queryTang);
+}
+
+/******************************************************************************/
+/******************************************************************************/
+
+struct QueryPoint		// point of tangency of a source/destination tangent
+{
+  int   ob;
+  float param;
+  int   vert;
+};
+
+static int compareQueryPoint (const void *a, const void *b)	// by obstacle, then parameter
+{
+  const QueryPoint *x = (const QueryPoint *) a, *y = (const QueryPoint *) b;
+  if (x->ob != y->ob) return x->ob - y->ob;
+  return (x->param < y->param ? -1 : (x->param > y->param ? 1 : 0));
+}
+
+/******************************************************************************
+	Arcs of the query points pt[0..m-1] (sorted, all on obstacle i)
+	to their neighbours on the obstacle: a query point is joined to the
+	nearest vertex forward (query point or graph vertex), and to the
+	nearest vertex backward if that is a graph vertex.
+	(The graph's arc across a query point is left, as it is still a
+	valid path along the obstacle.)
+******************************************************************************/
+
+static void spliceArcs (int i, QueryPoint *pt, int m)
+{
+  float range = obstacle[i].getLastKnot() - obstacle[i].getKnot(0);
+  int   nv    = obStart[i+1] - obStart[i];
+  for (int k=0; k<m; k++)
+   {
+    float t = pt[k].param;
+    int   next=-1, prev=-1;		// forward and backward neighbours
+    float dNext=0, dPrev=0;		// and their parameter distances
+    if (m > 1)
+     {
+      next  = pt[(k+1)%m].vert;
+      dNext = pt[(k+1)%m].param - t;   if (k == m-1) dNext += range;
+      prev  = pt[(k+m-1)%m].vert;
+      dPrev = t - pt[(k+m-1)%m].param; if (k == 0)   dPrev += range;
+     }
+    if (nv > 0)
+     {
+      int   v  = vertexOf (i, t);	// first graph vertex at or after t
+      int   vn = v;			// graph vertices strictly after t,
+      if (vn < obStart[i+1] && vertParam[vn] == t) vn++;
+      int   vp = (vn > v ? v : v-1);	// and at or before t
+      if (vn == obStart[i+1]) vn = obStart[i];
+      if (vp <  obStart[i])   vp = obStart[i+1]-1;
+      float dn = vertParam[vn] - t;  if (dn <= 0) dn += range;
+      float dp = t - vertParam[vp];  if (dp <  0) dp += range;
+      if (next == -1 || dn < dNext) { next = vn;  dNext = dn; }
+      if (prev == -1 || dp < dPrev) { prev = vp;  dPrev = dp; }
+     }
+    if (next != -1 && next != pt[k].vert)
+      addCSROverlayEdge (svquery, pt[k].vert, next, 
+      			 arcLength (i, t, vertParam[next]));
+    if (prev != -1 && prev < svgraph.nVert)
+      addCSROverlayEdge (svquery, prev, pt[k].vert, 
+      			 arcLength (i, vertParam[prev], t));
+   }
+}
+
+/******************************************************************************
+	Splice the destination, then (if withSource) the source, into the
+	frozen graph, from their visible tangents visTang[i*(n+2)+n+1] and
+	visTang[i*(n+2)+n].
+	The destination's vertices come first, so they are numbered the
+	same with or without the source (as a shortest-path tree needs).
+******************************************************************************/
+
+void spliceSourceDest (int withSource=1)
+{
+  int i,j,k,m=0;
+  clearCSROverlay (svquery);
+  queryTang.n = 0;
+  for (i=0; i<n; i++) 
+    m += visTang[i*(n+2)+n].getn() + visTang[i*(n+2)+n+1].getn();
+  reserveVertices (svgraph.nVert + 2 + m);
+  QueryPoint *pt = new QueryPoint[m+1];
+  m=0;
+  sourceVert = -1;
+  for (j=n+1; j>=(withSource ? n : n+1); j--)	// destination, source
+   {
+    int end = addCSRVertex (svquery);
+    if (j == n+1) { destVert = end;    svVert[end] = dest; }
+    else          { sourceVert = end;  svVert[end] = source; }
+    vertOb[end] = (j == n ? -1 : -2);  vertParam[end] = 0;
+    for (i=0; i<n; i++)			// tangents through the point
+      for (k=0; k<visTang[i*(n+2)+j].getn(); k++)
+       {
+	int v = addCSRVertex (svquery);
+	pt[m].ob = i;  pt[m].param = visTang[i*(n+2)+j][k].param1;  pt[m++].vert = v;
+	vertOb[v] = i;  vertParam[v] = visTang[i*(n+2)+j][k].param1;
+	obstacle[i].eval (vertParam[v], svVert[v]);
+	addCSROverlayEdge (svquery, v, end, svVert[v].dist (svVert[end]));
+	addCSREdge (queryTang, v, end, 0);
+       }
+   }
+  if (m > 0) qsort (pt, m, sizeof(QueryPoint), compareQueryPoint);
+  for (k=0; k<m; k=j)			// arcs, obstacle by obstacle
+   {
+    for (j=k; j<m && pt[j].ob == pt[k].ob; j++) ;
+    spliceArcs (pt[k].ob, pt+k, j-k);
+   }
+  delete [] pt;
+  if (!withSource) return;
+  CommonTangent sd;			// 'common tangent' from source to destination
+  sd.index1 = -1;  sd.index2 = -2;
+  sd.param1 = sd.param2 = 0;		// irrelevant
+  if (sd.visible (obstacle, source, dest))
+   {
+    addCSROverlayEdge (svquery, sourceVert, destVert, source.dist (dest));
+    addCSREdge (queryTang, sourceVert, destVert, 0);
+   }
+}
+
+/******************************************************************************
+	Shortest-path trees to recent destinations, for many sources to
+	one destination (e.g., every robot heading to a dock).
+	A tree holds, for the frozen graph and the destination's
+	vertices (as numbered by spliceSourceDest), the distance to the
+	destination and the next vertex on the way; it stays valid as
+	long as the destination does not move.
+	Trees are kept for the last nPathTree destinations, evicting the
+	least recently used.
+******************************************************************************/
+
+#define MAXPATHTREE 64
+
+struct PathTree
+{
+  V2f    dest;
+  int    nVert;				// graph vertices and destination's vertices
+  float *dist;
+  int   *next;
+  int    lastUse;			// 0: empty slot
+};
+
+PathTree	pathTree[MAXPATHTREE];
+int		nPathTree=8;		// # trees cached
+int		treeClock=0;
+PathTree       *curTree=NULL;		// tree of the current destination
+
+/******************************************************************************
+	Tree of the current destination, from the cache or computed.
+******************************************************************************/
+
+PathTree *findPathTree ()
+{
+  int i, k, nVert = svgraph.nVert + 1;
+  for (i=0; i<n; i++) nVert += visTang[i*(n+2)+n+1].getn();
+  int lru=0;
+  for (k=0; k<nPathTree; k++)
+   {
+    PathTree &T = pathTree[k];
+    if (T.lastUse && T.dest[0] == dest[0] && T.dest[1] == dest[1] && T.nVert == nVert)
+     { T.lastUse = ++treeClock;  return &T; }
+    if (T.lastUse < pathTree[lru].lastUse) lru = k;
+   }
+  PathTree &T = pathTree[lru];
+  if (T.lastUse) { delete [] T.dist;  delete [] T.next; }
+  spliceSourceDest (0);
+  T.dest  = dest;  T.nVert = svquery.nVert;
+  T.dist  = new float[T.nVert];  T.next = new int[T.nVert];
+  csrShortestPathTree (svgraph, svsearch, destVert, T.dist, T.next, &svquery);
+  T.lastUse = ++treeClock;
+  return &T;
+}
+
+/******************************************************************************
+	Shortest path from the source, by a single relaxation over its
+	tangents into the tree T of the current destination (spliced as 
+	by spliceSourceDest): the best of source - point of tangency - 
+	neighbour on the obstacle - tree, and of the direct edge.
+	(A shortest path never visits two of the source's points of
+	tangency: the tangent to the second would be shorter.)
+	Returns its length, or -1 (and an empty path) if none.
+******************************************************************************/
+
+float treeShortestPath (PathTree &T, IntArr &path)
+{
+  int   e, f, bestW=-1, bestU=-1;
+  float best=-1;
+  for (e=svquery.head[sourceVert]; e!=-1; e=svquery.next[e])
+   {
+    int w = svquery.adj[e];
+    if (w == destVert) 
+     { 
+      if (best < 0 || svquery.w[e] < best) { best = svquery.w[e];  bestW = -1;  bestU = -1; }
+      continue;
+     }
+    for (f=svquery.head[w]; f!=-1; f=svquery.next[f])
+     {
+      int u = svquery.adj[f];
+      if (u >= T.nVert || T.dist[u] < 0) continue;	// not in tree (source, or its points)
+      float len = svquery.w[e] + svquery.w[f] + T.dist[u];
+      if (best < 0 || len < best) { best = len;  bestW = w;  bestU = u; }
+     }
+   }
+  if (best < 0) { path.allocate(0);  return -1; }
+  int nPath = 2, v;
+  if (bestW != -1) for (nPath=3, v=bestU; v!=destVert; v=T.next[v]) nPath++;
+  path.allocate (nPath);
+  path[0] = sourceVert;  path[nPath-1] = destVert;
+  if (bestW != -1)
+   {
+    path[1] = bestW;
+    for (nPath=2, v=bestU; v!=destVert; v=T.next[v]) path[nPath++] = v;
+   }
+  return best;
+}
+
+/******************************************************************************
+	Build the smooth visibility graph (which == 0), or update it after
+	the source (which == -1) or destination (which == -2) moves.
+******************************************************************************/
+
+void createSmoothVisibilityGraph (int which)
+{
+  if (which == 0)
+   {
+    tangCurve.allocate (n+2);
+    visTang.allocate ((n+2)*(n+2));
+    if (nThread <= 1) for (int k=0; k<n+2; k++) tangCurveTask (k, NULL);
+    else              workStealFor (n+2, nThread, tangCurveTask, NULL);
+    buildVisibleTangents (0);
+    buildSmoothVisibilityGraph ();
+    buildVisibleTangents (-1);
+    buildVisibleTangents (-2);
+   }
+  else 
+   {
+    tangCurveTask (which == -1 ? n : n+1, NULL);
+    buildVisibleTangents (which);
+   }
+  if (PATHTREE) curTree = findPathTree ();
+  spliceSourceDest ();
+}
+
+/******************************************************************************
+	Draw the tangent edges of the smooth visibility graph 
+	(its other edges are arcs of the obstacles).
+******************************************************************************/
+
+void drawSmoothVisibilityGraph ()
+{
+  int k;
+  glBegin (GL_LINES);
+  for (k=0; k<tangEdge.getn(); k++) 
+    glVertex2f (svVert[tangEdge[k]][0], svVert[tangEdge[k]][1]);
+  for (k=0; k<queryTang.n; k++)
+   {
+    glVertex2f (svVert[queryTang.p[k]][0], svVert[queryTang.p[k]][1]);
+    glVertex2f (svVert[queryTang.q[k]][0], svVert[queryTang.q[k]][1]);
+   }
+  glEnd();
+}
+
+/******************************************************************************
+	Draw path, following the obstacle along arcs.
+******************************************************************************/
+
+void drawSmoothPath (IntArr &path)
+{
+  glBegin (GL_LINE_STRIP);
+  for (int k=0; k<path.getn(); k++)
+   {
+    int p = (k > 0 ? path[k-1] : -1), q = path[k], i = vertOb[q];
+    if (p != -1 && i >= 0 && i == vertOb[p])	// arc, unless a (shorter) tangent
+     {
+      float w = csrEdgeWeight (svgraph, &svquery, p, q);	// -1: a tree's arc
+      if (w < 0 || w > svVert[p].dist (svVert[q]) * 1.0001)
+       {
+        float t0 = vertParam[p], t1 = vertParam[q];	// forward from p, or back?
+	float fwd = arcLength (i, t0, t1), bwd = arcLength (i, t1, t0);
+	int   forward = (w < 0 ? fwd <= bwd : fabs (fwd - w) <= fabs (bwd - w));
+	float range = obstacle[i].getLastKnot() - obstacle[i].getKnot(0);
+	if (forward  && t1 < t0) t1 += range;
+	if (!forward && t0 < t1) t0 += range;
+	float x[PTSPERBEZSEGMENT*4+1], y[PTSPERBEZSEGMENT*4+1];
+	if (!forward) { float tmp = t0;  t0 = t1;  t1 = tmp; }	// sample forward
+	sampleBezierBatch (obBatch[i], t0, t1, PTSPERBEZSEGMENT*4, x, y);
+	for (int s=1; s<PTSPERBEZSEGMENT*4; s++)
+	  if (forward) glVertex2f (x[s], y[s]);
+	  else	       glVertex2f (x[PTSPERBEZSEGMENT*4-s], y[PTSPERBEZSEGMENT*4-s]);
+       }
+     }
+    glVertex2f (svVert[q][0], svVert[q][1]);
+   }
+  glEnd();
+}
+
 /******************************************************************************
 ******************************************************************************/
 
 void printInfo()
 {
-  cout << "Smooth    visibility graph has " << svgraph.getn() << " vertices and "
-       << svgraph.getE() << " edges." << endl;
+  cout << "Smooth    visibility graph has " << svgraph.nVert << " vertices and "
+       << svgraph.nEdge/2 << " edges (+ " << svquery.nVert - svgraph.nVert 
+       << " and " << svquery.nEdge/2 << " for source and destination)." << endl;
   cout << "Polygonal visibility graph has (" << vgraph.getn() << " vertices and "
        << vgraph.getE() << " edges." << endl;
-  svgraph.dijkstra (svgraph.getn()-2, svgraph.getn()-1, shortestPath);
+  if (PATHTREE)
+    shortestPathLength = treeShortestPath (*curTree, shortestPath);
+  else
+    shortestPathLength = csrShortestPath (svgraph, svsearch, sourceVert, destVert,
+  					  (ASTAR ? svVert : NULL), shortestPath, &svquery);
   vgraph.dijkstra (0,1,polyShortestPath);
   cout << "Length of smooth shortest path                                       = " 
-       << svgraph.pathLength (shortestPath) << endl;
+       << shortestPathLength << endl;
   cout << "Length of polygonal shortest path (using incorrect self-edge length) = "
        << vgraph.pathLength (polyShortestPath) << endl;
 }
@@ -266,7 +815,7 @@ void motionob (int x, int y)
     firstx=0;
     screen2world (x,y,source);
     vgraph.updateSource  (source);
-    svgraph.updateSource (source);
+    createSmoothVisibilityGraph (-1);
     printInfo();
    }
   else if (!leftMouseDown && middleMouseDown && firstx)
@@ -274,7 +823,7 @@ void motionob (int x, int y)
     firstx=0;
     screen2world (x,y,dest);
     vgraph.updateDest (dest);
-    svgraph.updateDest (dest);
+    createSmoothVisibilityGraph (-2);
     printInfo();
    }
   else if (leftMouseDown && middleMouseDown)	   
@@ -373,7 +922,7 @@ void displayOb ()
   if (DRAWVGRAPH)
    {
     glColor3fv (Black);
-    svgraph.drawVG();
+    drawSmoothVisibilityGraph();
    }
   if (DRAWPOLYVGRAPH)
    {
@@ -384,7 +933,7 @@ void displayOb ()
    {
     glColor3fv (Black);
     glLineWidth(2.0);
-    svgraph.drawPath (shortestPath);
+    drawSmoothPath (shortestPath);
     glLineWidth(1.0);
    }
   if (DRAWPOLYPATH)
@@ -409,12 +958,373 @@ void inputCurves (char *file, Array<BezierCurve2f> &obstacle)
   V2fArrArr Pt;		// data points, organized into polygons
   read (infile, Pt);
   scaleToUnitSquare (Pt);
+  if (obBatch)				// previous scene (benchmark)
+   {
+    for (int i=0; i<obstacle.getn(); i++) freeBezierBatch (obBatch[i]);
+    delete [] obBatch;
+   }
   obstacle.allocate(Pt.getn());
+  obBatch = new BezierBatch[Pt.getn()];
   for (int i=0; i<Pt.getn(); i++)
    { 
     obstacle[i].fitClosed (Pt[i]);
     obstacle[i].prepareDisplay (nPtsPerSegment);
+    initBezierBatch (obstacle[i], obBatch[i]);
+   }
+}
+
+/******************************************************************************
+	Sample each obstacle every sampleeps, into polygon poly[i] 
+	(with vertices sample[i]).
+******************************************************************************/
+
+void samplePolygons (float sampleeps, Array<Polygon2f> &poly, Array<V2fArr> &sample)
+{
+  poly.allocate (n);  sample.allocate (n);
+  for (int i=0; i<n; i++)  
+   {
+    FloatArr tfoo;	// parameter values of samples
+    obstacle[i].uniformSample (sampleeps, sample[i], tfoo);
+    poly[i].create (sample[i]);
+   }
+}
+
+/******************************************************************************
+	Free the smooth visibility graph, before it is rebuilt
+	(for another scene or eps).
+******************************************************************************/
+
+void freeSmoothVisibilityGraph ()
+{
+  freeCSRGraph (svgraph);     freeCSROverlay (svquery);
+  freeCSRSearch (svsearch);   freeCSREdgeList (queryTang);
+}
+
+/******************************************************************************
+	Benchmark (-b) of polygonal against smooth shortest paths.
+	For each scene, nQuery random source/destination pairs in free space
+	are answered by the smooth graph at each eps and by the polygonal
+	graph at each sampleeps, and compared with the smooth graph at the
+	finest eps (the reference).  For each setting, over the corpus:
+	  build:   construction time of the graph (ms per scene)
+	  query:   time to move source and destination and find the path (us)
+	  memory:  an estimate, not a measurement: vertices and adjacency
+		   counted as if stored in CSR form (KB per scene),
+		   so that both graphs are estimated alike
+	  lenErr:  relative error in path length (mean and max)
+	  tangGap: distance from each point of tangency on the reference path
+	  	   to the nearest vertex of the setting's graph on that obstacle
+		   (the nearest place where its path can turn)
+	  miss:    queries where one found a path and the other did not
+	A setting is on the Pareto front if no other setting is at least as
+	good in both query time and mean lenErr, and better in one.
+******************************************************************************/
+
+#define BENCHSEED 1
+
+struct BenchQuery		// a query and its reference answer
+{
+  V2f    source, dest;
+  float  len;			// length of reference path (-1: none)
+  V2fArr tang;			// points of tangency on reference path,
+  IntArr tangOb;		// and their obstacles
+};
+
+struct BenchRow			// one setting, accumulated over the corpus
+{
+  int    polygonal;		// polygonal graph (else smooth)?
+  float  param;			// its sampleeps (eps)
+  double build, query, memory;	// seconds, seconds, bytes
+  double errSum, errMax, gapSum;
+  int    nErr, nGap, nMiss, nQuery, nScene;
+};
+
+static double benchClock ()	// wall-clock seconds
+{
+  struct timeval tv;
+  gettimeofday (&tv, NULL);
+  return tv.tv_sec + 1e-6 * tv.tv_usec;
+}
+
+/******************************************************************************
+	Parse a comma-separated list of numbers (e.g., .2,.1,.05).
+******************************************************************************/
+
+void parseList (char *arg, FloatArr &list)
+{
+  int k, m=1;
+  for (char *c=arg; *c; c++) if (*c == ',') m++;
+  list.allocate (m);
+  char *c = arg;
+  for (k=0; k<m; k++) { list[k] = strtod (c, &c);  if (*c == ',') c++; }
+}
+
+/******************************************************************************
+	Is p inside the polygon with vertices P (even-odd rule)?
+******************************************************************************/
+
+static int insideSamples (V2fArr &P, V2f &p)
+{
+  int inside=0, m=P.getn();
+  for (int k=0, l=m-1; k<m; l=k++)
+    if ((P[k][1] > p[1]) != (P[l][1] > p[1]) &&
+	p[0] < P[l][0] + (P[k][0]-P[l][0]) * (p[1]-P[l][1]) / (P[k][1]-P[l][1]))
+      inside = !inside;
+  return inside;
+}
+
+/******************************************************************************
+	nQuery random pairs of points outside every obstacle (sample),
+	in the bounding box of the scene enlarged by 10%.
+******************************************************************************/
+
+void randomQueries (Array<V2fArr> &sample, int nQuery, Array<BenchQuery> &Q)
+{
+  int i, k, c;
+  float lo[2], hi[2];
+  lo[0] = lo[1] = 1e30;  hi[0] = hi[1] = -1e30;
+  for (i=0; i<n; i++)
+    for (k=0; k<sample[i].getn(); k++)
+      for (c=0; c<2; c++)
+       {
+        if (sample[i][k][c] < lo[c]) lo[c] = sample[i][k][c];
+	if (sample[i][k][c] > hi[c]) hi[c] = sample[i][k][c];
+       }
+  for (c=0; c<2; c++) { float pad = .1*(hi[c]-lo[c]);  lo[c] -= pad;  hi[c] += pad; }
+  srand (BENCHSEED);
+  Q.allocate (nQuery);
+  for (k=0; k<2*nQuery; k++)
+   {
+    V2f &p = (k%2 ? Q[k/2].dest : Q[k/2].source);
+    int free;
+    do {
+      for (c=0; c<2; c++) p[c] = lo[c] + (hi[c]-lo[c]) * rand() / (float) RAND_MAX;
+      for (free=1, i=0; free && i<n; i++) free = !insideSamples (sample[i], p);
+    } while (!free);
+   }
+}
+
+/******************************************************************************
+	Smooth shortest path after moving the source and destination
+	(without path trees, as every query has a new destination).
+******************************************************************************/
+
+float smoothQuery (IntArr &path)
+{
+  tangCurveTask (n, NULL);  tangCurveTask (n+1, NULL);
+  buildVisibleTangents (-1);  buildVisibleTangents (-2);
+  spliceSourceDest ();
+  return csrShortestPath (svgraph, svsearch, sourceVert, destVert,
+			  (ASTAR ? svVert : NULL), path, &svquery);
+}
+
+/******************************************************************************/
+/******************************************************************************/
+
+static float nearestVertex (V2f &p, int ob)	// of the smooth graph, with query
+{
+  float best=-1;
+  for (int v=0; v<svquery.nVert; v++)
+    if (vertOb[v] == ob && (best < 0 || p.dist (svVert[v]) < best)) best = p.dist (svVert[v]);
+  return best;
+}
+
+static float nearestSample (V2f &p, V2fArr &sample)
+{
+  float best=-1;
+  for (int k=0; k<sample.getn(); k++)
+    if (best < 0 || p.dist (sample[k]) < best) best = p.dist (sample[k]);
+  return best;
+}
+
+/******************************************************************************
+	Length of a path of the polygonal graph, from its vertices:
+	vertex 0 is the source, 1 the destination, and 2... the vertices
+	of the polygons (sample), polygon after polygon.
+	(Not VisibilityGraph::pathLength, whose length of an edge along
+	a polygon is inexact.)  -1 if a vertex is out of range.
+******************************************************************************/
+
+static float polyPathLength (IntArr &path, V2f &source, V2f &dest, Array<V2fArr> &sample)
+{
+  int i, j, *start = new int[n+1];
+  for (start[0]=2, i=0; i<n; i++) start[i+1] = start[i] + sample[i].getn();
+  float len=0;
+  V2f prev;
+  for (j=0; j<path.getn(); j++)
+   {
+    V2f p;
+    int v = path[j];
+    if      (v == 0) p = source;
+    else if (v == 1) p = dest;
+    else if (v < 0 || v >= start[n]) { len = -1;  break; }
+    else
+     {
+      for (i=0; start[i+1] <= v; i++) ;
+      p = sample[i][v - start[i]];
+     }
+    if (j > 0) len += p.dist (prev);
+    prev = p;
+   }
+  delete [] start;
+  return len;
+}
+
+static void benchCompare (BenchRow &r, BenchQuery &Q, float len)
+{
+  r.nQuery++;
+  if ((Q.len < 0) != (len < 0)) { r.nMiss++;  return; }
+  if (Q.len <= 0) return;				// no path either way
+  double err = fabs (len - Q.len) / Q.len;
+  r.errSum += err;  r.nErr++;
+  if (err > r.errMax) r.errMax = err;
+}
+
+/******************************************************************************
+	Benchmark one scene: rows 0..nEps-1 are the smooth graph at each eps
+	(ascending, so row 0 is the reference), then the polygonal graph at
+	each sampleeps.
+******************************************************************************/
+
+void benchScene (char *file, FloatArr &sampleEps, FloatArr &epsList, int nQuery, 
+		 BenchRow *row)
+{
+  int i, j, k, q, nEps = epsList.getn();
+  double t;
+  inputCurves (file, obstacle);
+  n = obstacle.getn();
+  Array<Polygon2f>  poly;
+  Array<V2fArr>     sample;
+  Array<BenchQuery> Q;
+  samplePolygons (sampleEps[0], poly, sample);		// finest, for free space
+  randomQueries (sample, nQuery, Q);
+
+  for (k=0; k<nEps; k++)			// smooth
+   {
+    BenchRow &r = row[k];
+    eps = epsList[k];
+    source = Q[0].source;  dest = Q[0].dest;
+    freeSmoothVisibilityGraph ();
+    t = benchClock();
+    createSmoothVisibilityGraph (0);
+    r.build  += benchClock() - t;
+    r.memory += svgraph.nVert * (sizeof(V2f) + sizeof(float) + sizeof(int))
+              + (svgraph.nVert+1) * sizeof(int) + svgraph.nEdge * (sizeof(int) + sizeof(float));
+    r.nScene++;
+    for (q=0; q<nQuery; q++)
+     {
+      IntArr path;
+      source = Q[q].source;  dest = Q[q].dest;
+      t = benchClock();
+      float len = smoothQuery (path);
+      r.query += benchClock() - t;
+      if (k == 0)				// reference
+       {
+        int m=0;
+	for (j=0; j<path.getn(); j++) if (vertOb[path[j]] >= 0) m++;
+	Q[q].len = len;
+	Q[q].tang.allocate (m);  Q[q].tangOb.allocate (m);
+	for (j=0, m=0; j<path.getn(); j++) 
+	  if (vertOb[path[j]] >= 0)
+	   { Q[q].tang[m] = svVert[path[j]];  Q[q].tangOb[m++] = vertOb[path[j]]; }
+       }
+      benchCompare (r, Q[q], len);
+      for (j=0; j<Q[q].tang.getn(); j++)
+       { r.gapSum += nearestVertex (Q[q].tang[j], Q[q].tangOb[j]);  r.nGap++; }
+     }
+   }
+  for (k=0; k<sampleEps.getn(); k++)		// polygonal
+   {
+    BenchRow &r = row[nEps+k];
+    VisibilityGraph pg;
+    samplePolygons (sampleEps[k], poly, sample);
+    t = benchClock();
+    pg.create (poly, Q[0].source, Q[0].dest);
+    r.build  += benchClock() - t;
+    r.memory += pg.getn() * sizeof(V2f) + (pg.getn()+1) * sizeof(int)
+              + 2. * pg.getE() * (sizeof(int) + sizeof(float));
+    r.nScene++;
+    for (q=0; q<nQuery; q++)
+     {
+      IntArr path;
+      t = benchClock();
+      pg.updateSource (Q[q].source);  pg.updateDest (Q[q].dest);
+      pg.dijkstra (0, 1, path);
+      r.query += benchClock() - t;
+      float len = (path.getn() > 0 ? polyPathLength (path, Q[q].source, Q[q].dest, sample) : -1);
+      benchCompare (r, Q[q], len);
+      for (j=0; j<Q[q].tang.getn(); j++)
+       { r.gapSum += nearestSample (Q[q].tang[j], sample[Q[q].tangOb[j]]);  r.nGap++; }
+     }
+   }
+  freeSmoothVisibilityGraph ();
+}
+
+/******************************************************************************
+	Print one line per setting, then the Pareto front in query time
+	against mean path-length error.
+******************************************************************************/
+
+void reportBenchmark (BenchRow *row, int nRow)
+{
+  int k, l;
+  double *query = new double[nRow], *err = new double[nRow];
+  int    *front = new int[nRow];
+  for (k=0; k<nRow; k++)
+   {
+    query[k] = (row[k].nQuery ? 1e6 * row[k].query / row[k].nQuery : 0);
+    err[k]   = (row[k].nErr   ? row[k].errSum / row[k].nErr : 0);
+   }
+  for (k=0; k<nRow; k++)
+   {
+    front[k] = 1;
+    for (l=0; l<nRow && front[k]; l++)
+      if (l != k && query[l] <= query[k] && err[l] <= err[k] && 
+	  (query[l] < query[k] || err[l] < err[k]))
+	front[k] = 0;
    }
+  printf ("\n%-9s %10s %10s %10s %10s %10s %10s %10s %6s %s\n", "graph", "param", 
+	  "build(ms)", "query(us)", "estMem(KB)", "lenErr", "maxLenErr", "tangGap", "miss", "pareto");
+  for (k=0; k<nRow; k++)
+    printf ("%-9s %10g %10.3f %10.1f %10.1f %10.3g %10.3g %10.3g %6d %s\n", 
+	    (row[k].polygonal ? "polygon" : "smooth"), row[k].param,
+	    (row[k].nScene ? 1e3 * row[k].build / row[k].nScene : 0), query[k],
+	    (row[k].nScene ? row[k].memory / row[k].nScene / 1024 : 0),
+	    err[k], row[k].errMax, (row[k].nGap ? row[k].gapSum / row[k].nGap : 0),
+	    row[k].nMiss, (front[k] ? "*" : ""));
+  printf ("(param is sampleeps for polygon, eps for smooth; errors are against smooth at eps %g;\n"
+	  " estMem is estimated from the graph sizes, not measured)\n",
+	  row[0].param);
+  delete [] query;  delete [] err;  delete [] front;
+}
+
+/******************************************************************************
+	Run the benchmark over the corpus scene[0..nScene-1].
+******************************************************************************/
+
+int benchmark (int nScene, char **scene, FloatArr &sampleEps, FloatArr &epsList, int nQuery)
+{
+  int k, nEps = epsList.getn(), nRow = epsList.getn() + sampleEps.getn();
+  qsort (&epsList[0],   nEps,             sizeof(float), compareFloat);
+  qsort (&sampleEps[0], sampleEps.getn(), sizeof(float), compareFloat);
+  BenchRow *row = new BenchRow[nRow];
+  for (k=0; k<nRow; k++)
+   {
+    BenchRow &r = row[k];
+    r.polygonal = (k >= nEps);
+    r.param     = (k < nEps ? epsList[k] : sampleEps[k-nEps]);
+    r.build = r.query = r.memory = r.errSum = r.errMax = r.gapSum = 0;
+    r.nErr = r.nGap = r.nMiss = r.nQuery = r.nScene = 0;
+   }
+  PATHTREE = 0;		// a tree serves one destination of one graph
+  for (k=0; k<nScene; k++)
+   {
+    cout << "Benchmarking " << scene[k] << endl;
+    benchScene (scene[k], sampleEps, epsList, nQuery, row);
+   }
+  reportBenchmark (row, nRow);
+  delete [] row;
+  return 0;
 }
 
 /******************************************************************************
@@ -424,8 +1334,11 @@ int main (int argc, char **argv)
 {
   int       i;
   int       ArgsParsed=0;
-  float     eps = .0001;	// accuracy of intersection computation
   float     sampleeps = .05;	// sampling rate (one point per sampleeps) for polygon
+  FloatArr  sampleEps, epsList;	// sampleeps and eps to benchmark
+  char    **scene = new char*[argc];	// scene files
+  int       nScene=0;
+  int       nQuery=50;		// # queries per scene (benchmark)
 
   RoutineName = argv[ArgsParsed++];
   if (argc == 1) { usage(); exit(-1); }
@@ -440,30 +1353,40 @@ int main (int argc, char **argv)
         	dest[1] = atof(argv[ArgsParsed++]);             break;		
       case 'j': JUSTVIEWING=1; 					break;
 //    case 'n': NEWFILE=0; 					break;
-      case 'e': eps = atof(argv[ArgsParsed++]);			break;
-      case 's': sampleeps = atof(argv[ArgsParsed++]);		break;
+      case 'e': parseList (argv[ArgsParsed++], epsList);
+      		eps = epsList[0];				break;
+      case 's': parseList (argv[ArgsParsed++], sampleEps);
+      		sampleeps = sampleEps[0];			break;
+      case 't': nThread = atoi(argv[ArgsParsed++]);		break;
+      case 'a': ASTAR=0; 					break;
+      case 'p': PATHTREE=0; 					break;
+      case 'c': nPathTree = atoi(argv[ArgsParsed++]);		
+      		if (nPathTree < 1) nPathTree = 1;
+		if (nPathTree > MAXPATHTREE) nPathTree = MAXPATHTREE;	break;
+      case 'b': BENCHMARK=1;					break;
+      case 'q': nQuery = atoi(argv[ArgsParsed++]);		break;
       case 'h': 
       default:	usage(); exit(-1);				break;
       }
-   else ArgsParsed++;
+   else scene[nScene++] = argv[ArgsParsed++];
   }  
   
-  inputCurves (argv[argc-1], obstacle);
-  n = obstacle.getn();
-  // sample the curve to generate polygons
-  obstaclePoly.allocate(n);
-  for (i=0; i<n; i++)  
+  if (nThread == -1) nThread = nProcessor();	// not set by 't' parameter
+  if (BENCHMARK)
    {
-    FloatArr tfoo;	// parameter values of samples
-    V2fArr polySample;
-    obstacle[i].uniformSample (sampleeps, polySample, tfoo);
-    obstaclePoly[i].create (polySample);
+    if (nScene == 0 || nQuery < 1) { usage(); exit(-1); }
+    if (epsList.getn()   == 0) { epsList.allocate(1);    epsList[0]   = eps; }
+    if (sampleEps.getn() == 0) { sampleEps.allocate(1);  sampleEps[0] = sampleeps; }
+    exit (benchmark (nScene, scene, sampleEps, epsList, nQuery));
    }
+  inputCurves (argv[argc-1], obstacle);
+  n = obstacle.getn();
+  Array<V2fArr> polySample;
+  samplePolygons (sampleeps, obstaclePoly, polySample);	// sample the curve to generate polygons
   if (!JUSTVIEWING)
    {
     cout << "Creating smooth visibility graph" << endl;
-    svgraph.create (obstacle, source, dest, eps);
-    //    svgraph.updateSourceDest (source, dest);
+    createSmoothVisibilityGraph (0);
     cout << "Creating polygonal visibility graph" << endl;
     vgraph.create (obstaclePoly, source, dest);
     //    vgraph.updateSourceDest(source, dest);
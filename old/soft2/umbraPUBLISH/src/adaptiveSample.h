@@ -0,0 +1,200 @@
+/*
+  File:          adaptiveSample.h
+  Created:	 17 October 2026
+  Purpose:       Curvature-adaptive sampling of a curve segment, and a
+                 streaming polygon builder, for the umbral polygons.
+		 sampleSegment samples at a fixed parameter step, which is
+		 too dense where the curve is flat (near-collinear vertices
+		 near a point of tangency break triangulation) and too
+		 coarse where it bends.  Here the parameter interval is
+		 bisected until the curve lies within chordTol of each chord
+		 (tested at the midpoint and quarter points, so that an
+		 S-shaped piece is not mistaken for a straight one),
+		 so the polygon is within chordTol of the curve with few
+		 vertices in flat regions.
+		 The polygon builder grows by doubling (no fixed
+		 over-allocation) and drops a vertex closer than minDist to
+		 the previous one (such near-duplicates, e.g. a point of
+		 tangency added both as a sample and as a bitangent
+		 endpoint, also break triangulation).
+		 The curve is evaluated with bezierBatch.h (which must be
+		 included first), a level of bisection at a time, by a batch
+		 evaluator built once per curve and reused for all its
+		 segments.
+  Usage:	 initCurveBatch (obstacle[i], obBatch[i]);	// once per curve
+  		 PolygonBuilder pb;  initPolygonBuilder (pb, minDist);
+  		 addVertex (pb, pt);
+		 addSegmentAdaptive (pb, obstacle[i], obBatch[i], t0, t1, chordTol);
+		 buildPolygon (pb, poly);	// also frees pb
+		 freeBezierBatch (obBatch[i]);
+*/
+
+#ifndef _ADAPTIVESAMPLE_H_
+#define _ADAPTIVESAMPLE_H_
+
+#define MAXSAMPLEDEPTH 20	// deepest bisection (2^20 pieces at most)
+
+struct PolygonBuilder
+{
+  V2f  *pt;			// vertices so far
+  int   n, size;
+  float minDist;		// vertices closer than this to the previous are dropped
+};
+
+/******************************************************************************/
+/******************************************************************************/
+
+void initPolygonBuilder (PolygonBuilder &pb, float minDist, int size=64)
+{
+  pb.pt = new V2f[size];  pb.n = 0;  pb.size = size;  pb.minDist = minDist;
+}
+
+void addVertex (PolygonBuilder &pb, V2f pt)
+{
+  if (pb.n > 0 && pb.pt[pb.n-1].dist (pt) < pb.minDist) return;
+  if (pb.n == pb.size)
+   {
+    V2f *grown = new V2f[2*pb.size];
+    for (int i=0; i<pb.n; i++) grown[i] = pb.pt[i];
+    delete [] pb.pt;  pb.pt = grown;  pb.size *= 2;
+   }
+  pb.pt[pb.n++] = pt;
+}
+
+/******************************************************************************
+	Build poly from the vertices (dropping a last vertex that
+	duplicates the first) and free the builder.
+******************************************************************************/
+
+void buildPolygon (PolygonBuilder &pb, Polygon2f &poly)
+{
+  while (pb.n > 1 && pb.pt[pb.n-1].dist (pb.pt[0]) < pb.minDist) pb.n--;
+  V2fArr vert(pb.n);
+  for (int i=0; i<pb.n; i++) vert[i] = pb.pt[i];
+  poly.create (vert);
+  delete [] pb.pt;  pb.pt = NULL;  pb.n = pb.size = 0;
+}
+
+/******************************************************************************/
+/******************************************************************************/
+
+struct AdaptivePiece		// piece of the segment, from t to the next piece's t
+{
+  float t,  x,  y;		// start
+  float tm, xm, ym, km;		// midpoint, and curvature there
+  int   done;			// within chordTol?
+};
+
+/******************************************************************************
+	Evaluate closed curve ob at t[0..n-1] (wrapping past the last knot;
+	t is overwritten): in one batch by B if ob is a cubic spline,
+	otherwise one eval at a time (and curvature 0: not used).
+******************************************************************************/
+
+static void evalAdaptive (BezierCurve2f &ob, BezierBatch *B, float *t, int n,
+			  float *x, float *y, float *curv)
+{
+  int i;
+  float first = ob.getKnot(0), last = ob.getLastKnot();
+  for (i=0; i<n; i++) if (t[i] > last) t[i] -= last - first;
+  if (B) { evalBezierBatch (*B, t, n, x, y, NULL, NULL, curv);  return; }
+  for (i=0; i<n; i++)
+   {
+    V2f pt;  ob.eval (t[i], pt);
+    x[i] = pt[0];  y[i] = pt[1];  curv[i] = 0;
+   }
+}
+
+static float distToChord (float px, float py, float ax, float ay, float bx, float by)
+{
+  float dx = bx-ax, dy = by-ay, len = sqrt (dx*dx + dy*dy);
+  if (len == 0) return sqrt ((px-ax)*(px-ax) + (py-ay)*(py-ay));
+  return fabs ((px-ax)*dy - (py-ay)*dx) / len;
+}
+
+/******************************************************************************
+	Add samples of the segment of closed curve ob from t0 to t1
+	(wrapping around the end of the curve if t1 < t0),
+	within chordTol of the curve; in reverse order if reverse.
+	The pieces are bisected level by level, and the quarter points of
+	all pieces of a level are evaluated in one batch by ob's evaluator
+	batch (initCurveBatch; none if ob is not a cubic spline).
+	A piece is within chordTol if its midpoint and quarter points are,
+	and if the sagitta of an arc of the largest curvature found at
+	these points over its chord (curvature * chord^2 / 8) is.
+******************************************************************************/
+
+void addSegmentAdaptive (PolygonBuilder &pb, BezierCurve2f &ob, BezierBatch &batch,
+			 float t0, float t1, float chordTol, int reverse=0)
+{
+  if (t1 < t0) t1 += ob.getLastKnot() - ob.getKnot(0);
+  if (reverse) { float tmp = t0;  t0 = t1;  t1 = tmp; }
+  BezierBatch *B = (batch.L > 0 ? &batch : NULL);
+  int i, k, n = 2;
+  float t[5], x[5], y[5], curv[5], h = (t1 - t0) / 4;
+  for (i=0; i<5; i++) t[i] = t0 + i*h;		// bisect once first: 
+  evalAdaptive (ob, B, t, 5, x, y, curv);	// pt0 and pt1 may coincide
+  float tEnd = t1, xEnd = x[4], yEnd = y[4];
+  AdaptivePiece *piece = new AdaptivePiece[n];
+  for (i=0; i<2; i++)
+   {
+    AdaptivePiece &p = piece[i];
+    p.t  = t0 + 2*i*h;    p.x  = x[2*i];    p.y  = y[2*i];
+    p.tm = t0 + (2*i+1)*h;  p.xm = x[2*i+1];  p.ym = y[2*i+1];  p.km = curv[2*i+1];
+    p.done = 0;
+   }
+  for (int depth=1; ; depth++)
+   {
+    int m=0;
+    for (i=0; i<n; i++) if (!piece[i].done) m++;
+    if (m == 0) break;
+    float *tq = new float[2*m], *tw = new float[2*m], *xq = new float[2*m],
+	  *yq = new float[2*m], *kq = new float[2*m];
+    for (k=0, i=0; i<n; i++)			// quarter points of open pieces
+      if (!piece[i].done)
+       {
+	float tb = (i+1 < n ? piece[i+1].t : tEnd);
+	tq[2*k] = (piece[i].t + piece[i].tm) / 2;  tq[2*k+1] = (piece[i].tm + tb) / 2;
+	tw[2*k] = tq[2*k];  tw[2*k+1] = tq[2*k+1];  k++;
+       }
+    evalAdaptive (ob, B, tw, 2*m, xq, yq, kq);
+    AdaptivePiece *next = new AdaptivePiece[n+m];
+    int nNext=0;
+    for (k=0, i=0; i<n; i++)
+     {
+      AdaptivePiece &p = piece[i];
+      if (p.done) { next[nNext++] = p;  continue; }
+      float bx = (i+1 < n ? piece[i+1].x : xEnd), by = (i+1 < n ? piece[i+1].y : yEnd);
+      float *q = xq + 2*k, *r = yq + 2*k, *c = kq + 2*k;
+      float chord2 = (bx-p.x)*(bx-p.x) + (by-p.y)*(by-p.y);
+      float kMax = fabs (p.km);
+      if (fabs (c[0]) > kMax) kMax = fabs (c[0]);
+      if (fabs (c[1]) > kMax) kMax = fabs (c[1]);
+      if (depth >= MAXSAMPLEDEPTH ||
+	  (distToChord (p.xm, p.ym, p.x, p.y, bx, by) <= chordTol &&
+	   distToChord (q[0], r[0], p.x, p.y, bx, by) <= chordTol &&
+	   distToChord (q[1], r[1], p.x, p.y, bx, by) <= chordTol &&
+	   kMax * chord2 / 8 <= chordTol))
+       {
+	next[nNext] = p;  next[nNext++].done = 1;
+       }
+      else					// halves, whose midpoints are known
+       {
+	AdaptivePiece &a = next[nNext++], &b = next[nNext++];
+	a.t = p.t;   a.x = p.x;   a.y = p.y;
+	a.tm = tq[2*k];    a.xm = q[0];  a.ym = r[0];  a.km = c[0];  a.done = 0;
+	b.t = p.tm;  b.x = p.xm;  b.y = p.ym;
+	b.tm = tq[2*k+1];  b.xm = q[1];  b.ym = r[1];  b.km = c[1];  b.done = 0;
+       }
+      k++;
+     }
+    delete [] tq;  delete [] tw;  delete [] xq;  delete [] yq;  delete [] kq;
+    delete [] piece;
+    piece = next;  n = nNext;
+   }
+  for (i=0; i<n; i++) addVertex (pb, V2f (piece[i].x, piece[i].y));
+  addVertex (pb, V2f (xEnd, yEnd));
+  delete [] piece;
+}
+
+#endif
@@ -0,0 +1,246 @@
+/*
+  File:          bezierBatch.h
+  Created:	 17 October 2026
+  Purpose:       Batch evaluation of a cubic Bezier spline at many parameters:
+		 points, and optionally tangents (derivatives in t) and
+		 signed curvature, in one pass.
+		 The spline is converted once to the power basis,
+		   P(u) = a + u (b + u (c + u d)),  u = (t - knot[k]) / h[k],
+		 per segment, in structure-of-arrays form (ax[k], bx[k], ...).
+		 A sorted parameter array is split into runs that fall in one
+		 segment, and each run is evaluated by Horner's rule 4 (SSE)
+		 or 8 (AVX, if compiled with -mavx) parameters at a time with
+		 the segment's coefficients in registers.  Unsorted
+		 parameters are legal (each run starts with a binary search),
+		 but sorted ones (e.g., a wrapped interval: two sorted runs)
+		 need only one search per segment.
+		 Replaces one eval per parameter (a segment search and a
+		 de Casteljau evaluation each) in the sampling loops.
+  Usage:	 BezierBatch B;  initBezierBatch (obstacle[i], B);
+  		 (or initCurveBatch, for a curve that may not be cubic)
+  		 evalBezierBatch (B, t, n, x, y);		// points
+		 evalBezierBatch (B, t, n, x, y, dx, dy, curv);	// and tangents, curvature
+		 sampleBezierBatch (B, t0, t1, n, x, y);	// n+1 uniform samples
+		 freeBezierBatch (B);
+*/
+
+#ifndef _BEZIERBATCH_H_
+#define _BEZIERBATCH_H_
+
+#include <assert.h>
+#include <float.h>
+#include <math.h>
+#ifdef __SSE__
+#include <xmmintrin.h>
+#endif
+#ifdef __AVX__
+#include <immintrin.h>
+#endif
+
+#define BATCHCHUNK 256		// parameters per chunk in sampleBezierBatch
+
+struct BezierBatch
+{
+  int    L;			// # segments
+  float *knot;			// knot[0..L]
+  float *invh;			// 1 / (knot[k+1] - knot[k])
+  float *ax, *bx, *cx, *dx;	// power basis coefficients of segment k
+  float *ay, *by, *cy, *dy;
+};
+
+/******************************************************************************
+	Power basis of each segment of the cubic spline c
+	(control points 3k..3k+3 on segment k).
+******************************************************************************/
+
+void initBezierBatch (BezierCurve2f &c, BezierBatch &B)
+{
+  int L = B.L = c.getL();
+  assert (c.getnCtrlPt() == 3*L+1);
+  B.knot = new float[L+1];  B.invh = new float[L];
+  float *coef = new float[8*L];
+  B.ax = coef;      B.bx = coef + L;    B.cx = coef + 2*L;  B.dx = coef + 3*L;
+  B.ay = coef + 4*L;  B.by = coef + 5*L;  B.cy = coef + 6*L;  B.dy = coef + 7*L;
+  for (int k=0; k<=L; k++) B.knot[k] = c.getKnot(k);
+  for (int k=0; k<L; k++)
+   {
+    V2f p0, p1, p2, p3;
+    c.getCtrlPt (3*k, p0);    c.getCtrlPt (3*k+1, p1);
+    c.getCtrlPt (3*k+2, p2);  c.getCtrlPt (3*k+3, p3);
+    B.invh[k] = 1 / (B.knot[k+1] - B.knot[k]);
+    B.ax[k] = p0[0];  B.bx[k] = 3*(p1[0]-p0[0]);
+    B.cx[k] = 3*(p0[0] - 2*p1[0] + p2[0]);  B.dx[k] = p3[0] - p0[0] + 3*(p1[0]-p2[0]);
+    B.ay[k] = p0[1];  B.by[k] = 3*(p1[1]-p0[1]);
+    B.cy[k] = 3*(p0[1] - 2*p1[1] + p2[1]);  B.dy[k] = p3[1] - p0[1] + 3*(p1[1]-p2[1]);
+   }
+}
+
+/******************************************************************************
+	Batch evaluator of curve c if it is a cubic spline,
+	none (B.L == 0) otherwise (to be evaluated one eval at a time).
+******************************************************************************/
+
+void initCurveBatch (BezierCurve2f &c, BezierBatch &B)
+{
+  if (c.getnCtrlPt() == 3*c.getL() + 1) initBezierBatch (c, B);
+  else { B.L = 0;  B.knot = B.invh = B.ax = NULL; }
+}
+
+void freeBezierBatch (BezierBatch &B)
+{
+  delete [] B.knot;  delete [] B.invh;  delete [] B.ax;  B.L = 0;
+}
+
+static int batchSegment (BezierBatch &B, float t)	// segment containing t (clamped)
+{
+  int lo = 0, hi = B.L-1;
+  while (lo < hi)
+   {
+    int mid = (lo + hi + 1) / 2;
+    if (B.knot[mid] <= t) lo = mid; else hi = mid-1;
+   }
+  return lo;
+}
+
+/******************************************************************************
+	Scalar evaluation of parameter i (of a run in segment k).
+******************************************************************************/
+
+static inline void evalBatchScalar (BezierBatch &B, int k, const float *t, int i,
+				    float *x, float *y, float *dx, float *dy, float *curv)
+{
+  float u = (t[i] - B.knot[k]) * B.invh[k];
+  x[i] = B.ax[k] + u*(B.bx[k] + u*(B.cx[k] + u*B.dx[k]));
+  y[i] = B.ay[k] + u*(B.by[k] + u*(B.cy[k] + u*B.dy[k]));
+  if (!dx && !curv) return;
+  float h = B.invh[k];
+  float x1 = h*(B.bx[k] + u*(2*B.cx[k] + 3*u*B.dx[k]));
+  float y1 = h*(B.by[k] + u*(2*B.cy[k] + 3*u*B.dy[k]));
+  if (dx) { dx[i] = x1;  dy[i] = y1; }
+  if (!curv) return;
+  float x2 = h*h*(2*B.cx[k] + 6*u*B.dx[k]), y2 = h*h*(2*B.cy[k] + 6*u*B.dy[k]);
+  float s2 = x1*x1 + y1*y1, denom = s2*sqrt(s2);
+  curv[i] = (x1*y2 - y1*x2) / (denom > FLT_MIN ? denom : FLT_MIN);
+}
+
+/******************************************************************************
+	Parameters t[lo..hi-1], all in segment k.
+******************************************************************************/
+
+static void evalBatchRun (BezierBatch &B, int k, const float *t, int lo, int hi,
+			  float *x, float *y, float *dx, float *dy, float *curv)
+{
+  int i = lo;
+  int deriv = (dx || curv);
+#ifdef __AVX__
+  {
+  __m256 t0 = _mm256_set1_ps (B.knot[k]), h = _mm256_set1_ps (B.invh[k]),
+         ax = _mm256_set1_ps (B.ax[k]), bx = _mm256_set1_ps (B.bx[k]),
+         cx = _mm256_set1_ps (B.cx[k]), ex = _mm256_set1_ps (B.dx[k]),
+         ay = _mm256_set1_ps (B.ay[k]), by = _mm256_set1_ps (B.by[k]),
+         cy = _mm256_set1_ps (B.cy[k]), ey = _mm256_set1_ps (B.dy[k]),
+	 two = _mm256_set1_ps (2.f), three = _mm256_set1_ps (3.f), six = _mm256_set1_ps (6.f),
+	 tiny = _mm256_set1_ps (FLT_MIN);
+  for (; i+8<=hi; i+=8)
+   {
+    __m256 u = _mm256_mul_ps (_mm256_sub_ps (_mm256_loadu_ps (t+i), t0), h);
+    _mm256_storeu_ps (x+i, _mm256_add_ps (ax, _mm256_mul_ps (u, _mm256_add_ps (bx,
+		       _mm256_mul_ps (u, _mm256_add_ps (cx, _mm256_mul_ps (u, ex)))))));
+    _mm256_storeu_ps (y+i, _mm256_add_ps (ay, _mm256_mul_ps (u, _mm256_add_ps (by,
+		       _mm256_mul_ps (u, _mm256_add_ps (cy, _mm256_mul_ps (u, ey)))))));
+    if (!deriv) continue;
+    __m256 x1 = _mm256_mul_ps (h, _mm256_add_ps (bx, _mm256_mul_ps (u,
+		 _mm256_add_ps (_mm256_mul_ps (two, cx), _mm256_mul_ps (three, _mm256_mul_ps (u, ex))))));
+    __m256 y1 = _mm256_mul_ps (h, _mm256_add_ps (by, _mm256_mul_ps (u,
+		 _mm256_add_ps (_mm256_mul_ps (two, cy), _mm256_mul_ps (three, _mm256_mul_ps (u, ey))))));
+    if (dx) { _mm256_storeu_ps (dx+i, x1);  _mm256_storeu_ps (dy+i, y1); }
+    if (!curv) continue;
+    __m256 hh = _mm256_mul_ps (h, h);
+    __m256 x2 = _mm256_mul_ps (hh, _mm256_add_ps (_mm256_mul_ps (two, cx), _mm256_mul_ps (six, _mm256_mul_ps (u, ex))));
+    __m256 y2 = _mm256_mul_ps (hh, _mm256_add_ps (_mm256_mul_ps (two, cy), _mm256_mul_ps (six, _mm256_mul_ps (u, ey))));
+    __m256 s2 = _mm256_add_ps (_mm256_mul_ps (x1, x1), _mm256_mul_ps (y1, y1));
+    __m256 denom = _mm256_max_ps (_mm256_mul_ps (s2, _mm256_sqrt_ps (s2)), tiny);
+    _mm256_storeu_ps (curv+i, _mm256_div_ps (_mm256_sub_ps (_mm256_mul_ps (x1, y2),
+    				_mm256_mul_ps (y1, x2)), denom));
+   }
+  }
+#endif
+#ifdef __SSE__
+  {
+  __m128 t0 = _mm_set1_ps (B.knot[k]), h = _mm_set1_ps (B.invh[k]),
+         ax = _mm_set1_ps (B.ax[k]), bx = _mm_set1_ps (B.bx[k]),
+         cx = _mm_set1_ps (B.cx[k]), ex = _mm_set1_ps (B.dx[k]),
+         ay = _mm_set1_ps (B.ay[k]), by = _mm_set1_ps (B.by[k]),
+         cy = _mm_set1_ps (B.cy[k]), ey = _mm_set1_ps (B.dy[k]),
+	 two = _mm_set1_ps (2.f), three = _mm_set1_ps (3.f), six = _mm_set1_ps (6.f),
+	 tiny = _mm_set1_ps (FLT_MIN);
+  for (; i+4<=hi; i+=4)
+   {
+    __m128 u = _mm_mul_ps (_mm_sub_ps (_mm_loadu_ps (t+i), t0), h);
+    _mm_storeu_ps (x+i, _mm_add_ps (ax, _mm_mul_ps (u, _mm_add_ps (bx,
+		    _mm_mul_ps (u, _mm_add_ps (cx, _mm_mul_ps (u, ex)))))));
+    _mm_storeu_ps (y+i, _mm_add_ps (ay, _mm_mul_ps (u, _mm_add_ps (by,
+		    _mm_mul_ps (u, _mm_add_ps (cy, _mm_mul_ps (u, ey)))))));
+    if (!deriv) continue;
+    __m128 x1 = _mm_mul_ps (h, _mm_add_ps (bx, _mm_mul_ps (u,
+		 _mm_add_ps (_mm_mul_ps (two, cx), _mm_mul_ps (three, _mm_mul_ps (u, ex))))));
+    __m128 y1 = _mm_mul_ps (h, _mm_add_ps (by, _mm_mul_ps (u,
+		 _mm_add_ps (_mm_mul_ps (two, cy), _mm_mul_ps (three, _mm_mul_ps (u, ey))))));
+    if (dx) { _mm_storeu_ps (dx+i, x1);  _mm_storeu_ps (dy+i, y1); }
+    if (!curv) continue;
+    __m128 hh = _mm_mul_ps (h, h);
+    __m128 x2 = _mm_mul_ps (hh, _mm_add_ps (_mm_mul_ps (two, cx), _mm_mul_ps (six, _mm_mul_ps (u, ex))));
+    __m128 y2 = _mm_mul_ps (hh, _mm_add_ps (_mm_mul_ps (two, cy), _mm_mul_ps (six, _mm_mul_ps (u, ey))));
+    __m128 s2 = _mm_add_ps (_mm_mul_ps (x1, x1), _mm_mul_ps (y1, y1));
+    __m128 denom = _mm_max_ps (_mm_mul_ps (s2, _mm_sqrt_ps (s2)), tiny);
+    _mm_storeu_ps (curv+i, _mm_div_ps (_mm_sub_ps (_mm_mul_ps (x1, y2), _mm_mul_ps (y1, x2)), denom));
+   }
+  }
+#endif
+  for (; i<hi; i++) evalBatchScalar (B, k, t, i, x, y, dx, dy, curv);
+}
+
+/******************************************************************************
+	Evaluate the spline at t[0..n-1] (best sorted): point (x[i],y[i]),
+	and if dx is given the derivative (dx[i],dy[i]), and if curv is given
+	the signed curvature (positive where the curve turns left).
+	Parameters outside the knot range are evaluated on the end segments.
+******************************************************************************/
+
+void evalBezierBatch (BezierBatch &B, const float *t, int n, float *x, float *y,
+		      float *dx=NULL, float *dy=NULL, float *curv=NULL)
+{
+  int i = 0;
+  while (i < n)
+   {
+    int k = batchSegment (B, t[i]);
+    float lo = (k == 0 ? -FLT_MAX : B.knot[k]), hi = (k == B.L-1 ? FLT_MAX : B.knot[k+1]);
+    int j = i+1;
+    while (j < n && t[j] >= lo && t[j] < hi) j++;	// run in segment k
+    evalBatchRun (B, k, t, i, j, x, y, dx, dy, curv);
+    i = j;
+   }
+}
+
+/******************************************************************************
+	n+1 samples of the closed spline at t0 + (t1-t0) i/n, i=0..n,
+	wrapping around the end of the curve past the last knot.
+******************************************************************************/
+
+void sampleBezierBatch (BezierBatch &B, float t0, float t1, int n, float *x, float *y)
+{
+  float first = B.knot[0], last = B.knot[B.L], range = last - first;
+  float t[BATCHCHUNK];
+  for (int i=0; i<=n; i += BATCHCHUNK)
+   {
+    int m = (n+1 - i < BATCHCHUNK ? n+1 - i : BATCHCHUNK);
+    for (int j=0; j<m; j++)
+     {
+      float s = t0 + (t1-t0)*(i+j)/n;
+      t[j] = (s > last ? s - range : s);
+     }
+    evalBezierBatch (B, t, m, x+i, y+i);
+   }
+}
+
+#endif
@@ -0,0 +1,156 @@
+/*
+  File:          bitangMerge.h
+  Created:	 17 October 2026
+  Purpose:       Merge the bitangents found in a-space and b-space into one
+                 sorted CommonTangentArr without near-duplicates.
+		 Replaces concatenate + bubbleSort + deleteApproxDuplicate,
+		 which is quadratic in the number of bitangents:
+		 (1) each dual-space stream is sorted by (param1,param2)
+		     in O(n log n),
+		 (2) the two sorted streams are merged in linear time,
+		 (3) near-duplicates are dropped with a grid hash of cell size
+		     featureSize over (param1,param2): a bitangent is dropped
+		     if a bitangent already kept, between the same curves,
+		     has both parameters within featureSize
+		     (only the 3x3 neighbouring cells need to be examined).
+		 The first bitangent of a cluster (in sorted order) is kept.
+  Usage:	 mergeCommonTangent (bitangA, bitangB, featureSize, bitangAB);
+		 featureSize <= 0 merges without dropping duplicates.
+*/
+
+#ifndef _BITANGMERGE_H_
+#define _BITANGMERGE_H_
+
+#include <math.h>		// floor
+#include <stdlib.h>		// qsort
+
+struct CommonTangentKey		// sort key of one bitangent
+{
+  float p1, p2;			// param1, param2
+  int   k;			// index in its stream
+};
+
+static int compareCommonTangentKey (const void *a, const void *b)
+{
+  const CommonTangentKey *ka = (const CommonTangentKey *) a;
+  const CommonTangentKey *kb = (const CommonTangentKey *) b;
+  if (ka->p1 != kb->p1) return (ka->p1 < kb->p1 ? -1 : 1);
+  if (ka->p2 != kb->p2) return (ka->p2 < kb->p2 ? -1 : 1);
+  return ka->k - kb->k;		// stable
+}
+
+/******************************************************************************
+	Sort keys of bitang, in O(n log n).
+******************************************************************************/
+
+static CommonTangentKey *sortCommonTangent (CommonTangentArr &bitang)
+{
+  CommonTangentKey *key = new CommonTangentKey[bitang.getn() + 1];
+  for (int k=0; k<bitang.getn(); k++)
+   {
+    key[k].p1 = bitang[k].param1;  key[k].p2 = bitang[k].param2;  key[k].k = k;
+   }
+  qsort (key, bitang.getn(), sizeof(CommonTangentKey), compareCommonTangentKey);
+  return key;
+}
+
+/******************************************************************************
+	Grid hash over parameter space, cell size featureSize.
+	Open addressing on cell (cx,cy); each cell heads a linked list
+	(through next) of the bitangents kept in that cell.
+******************************************************************************/
+
+struct BitangGrid
+{
+  int  size;			// # slots, a power of 2
+  int *cx, *cy, *head;		// head = -1: empty slot
+  int *next;			// next kept bitangent in same cell
+};
+
+static void initBitangGrid (BitangGrid &g, int n)
+{
+  g.size = 1;  while (g.size < 2*n) g.size *= 2;
+  g.cx   = new int[g.size];  g.cy = new int[g.size];  g.head = new int[g.size];
+  g.next = new int[n + 1];
+  for (int s=0; s<g.size; s++) g.head[s] = -1;
+}
+
+static void freeBitangGrid (BitangGrid &g)
+{
+  delete [] g.cx;  delete [] g.cy;  delete [] g.head;  delete [] g.next;
+}
+
+static int bitangGridSlot (BitangGrid &g, int cx, int cy)   // slot of cell, or empty slot
+{
+  unsigned int h = ((unsigned int) cx * 73856093u) ^ ((unsigned int) cy * 19349663u);
+  int s = (int) (h & (g.size - 1));
+  while (g.head[s] != -1 && (g.cx[s] != cx || g.cy[s] != cy))
+    s = (s + 1) & (g.size - 1);
+  return s;
+}
+
+/******************************************************************************
+	bitangAB = sorted union of bitangA and bitangB, without near-duplicates.
+******************************************************************************/
+
+void mergeCommonTangent (CommonTangentArr &bitangA, CommonTangentArr &bitangB,
+			 float featureSize, CommonTangentArr &bitangAB)
+{
+  int nA = bitangA.getn(), nB = bitangB.getn(), n = nA + nB;
+  CommonTangentKey *keyA = sortCommonTangent (bitangA);
+  CommonTangentKey *keyB = sortCommonTangent (bitangB);
+
+  // merge the two sorted streams: merged[m] is keyA[..] (fromA) or keyB[..]
+  CommonTangentKey *merged = new CommonTangentKey[n + 1];
+  int *fromA = new int[n + 1];
+  int a=0, b=0, m=0;
+  while (a < nA || b < nB)
+    if (b == nB || (a < nA && compareCommonTangentKey (&keyA[a], &keyB[b]) <= 0))
+         { merged[m] = keyA[a++];  fromA[m++] = 1; }
+    else { merged[m] = keyB[b++];  fromA[m++] = 0; }
+
+  // drop near-duplicates
+  int *keep = new int[n + 1];  int nKeep = 0;
+  if (featureSize <= 0)
+    for (m=0; m<n; m++) keep[nKeep++] = m;
+  else
+   {
+    BitangGrid g;  initBitangGrid (g, n);
+    for (m=0; m<n; m++)
+     {
+      CommonTangent &t = (fromA[m] ? bitangA[merged[m].k] : bitangB[merged[m].k]);
+      int cx = (int) floor (merged[m].p1 / featureSize);
+      int cy = (int) floor (merged[m].p2 / featureSize);
+      int dup = 0;
+      for (int dx=-1; !dup && dx<=1; dx++)
+	for (int dy=-1; !dup && dy<=1; dy++)
+	 {
+	  int s = bitangGridSlot (g, cx+dx, cy+dy);
+	  for (int q=g.head[s]; !dup && q!=-1; q=g.next[q])
+	   {
+	    CommonTangent &u = (fromA[keep[q]] ? bitangA[merged[keep[q]].k]
+						: bitangB[merged[keep[q]].k]);
+	    if (u.index1 == t.index1 && u.index2 == t.index2 &&
+		fabs (merged[keep[q]].p1 - merged[m].p1) < featureSize &&
+		fabs (merged[keep[q]].p2 - merged[m].p2) < featureSize)
+	      dup = 1;
+	   }
+	 }
+      if (!dup)
+       {
+	int s = bitangGridSlot (g, cx, cy);
+	if (g.head[s] == -1) { g.cx[s] = cx;  g.cy[s] = cy; }
+	g.next[nKeep] = g.head[s];  g.head[s] = nKeep;
+	keep[nKeep++] = m;
+       }
+     }
+    freeBitangGrid (g);
+   }
+
+  bitangAB.allocate (nKeep);
+  for (int k=0; k<nKeep; k++)
+    bitangAB[k] = (fromA[keep[k]] ? bitangA[merged[keep[k]].k] : bitangB[merged[keep[k]].k]);
+  delete [] keep;  delete [] fromA;  delete [] merged;  delete [] keyA;  delete [] keyB;
+}
+
+#endif
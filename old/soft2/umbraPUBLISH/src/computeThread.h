@@ -0,0 +1,143 @@
+/*
+  File:          computeThread.h
+  Created:	 17 October 2026
+  Purpose:       Background recomputation for the interactive dynamic programs
+                 (dynamicLocalBackUmbra, dynamicBitang), so that a redisplay
+		 never waits for the geometry.
+		 The GUI thread posts each edit (e.g., the envelope end tGrow)
+		 to a single-producer, single-consumer LatestSlot; a compute
+		 thread takes the newest edit, brings a result buffer up to date
+		 with it and publishes that buffer through a second LatestSlot,
+		 from which the GUI thread takes the newest result at redisplay.
+		 A LatestSlot is a lock-free triple buffer: the writer owns one
+		 slot, the reader owns one, and the third is exchanged between
+		 them by one atomic swap, so neither side ever waits for the
+		 other and the reader never sees a half-written slot.
+		 An edit that is overwritten before it is taken is dropped:
+		 only the newest edit is ever computed.
+		 Each slot keeps its own state, so a result slot handed back to
+		 the writer can still be updated incrementally.
+		 The mutex of a ComputeThread only parks it while there is
+		 nothing to do; no data passes through it.
+  Usage:	 LatestSlot<Edit> edit;  LatestSlot<Result> result;
+  		 initLatestSlot (edit);  initLatestSlot (result);
+		 GUI:     writeSlot(edit) = ...;  publishSlot (edit);  wakeComputeThread (ct);
+		          if (takeSlot (result)) draw readSlot(result);
+		 compute: void step (void *arg)
+		          { if (takeSlot (edit)) { compute writeSlot(result) from readSlot(edit);
+			                           publishSlot (result); } }
+		 startComputeThread (ct, step, arg);
+		 Atomics are the GCC __atomic builtins (gcc 4.7 or later).
+		 Link with -lpthread.
+*/
+
+#ifndef _COMPUTETHREAD_H_
+#define _COMPUTETHREAD_H_
+
+#include <pthread.h>
+
+#define SLOTINDEX 3		// slot index bits of LatestSlot::middle
+#define SLOTFRESH 4		// middle slot was published and not yet taken
+
+template <class T>
+struct LatestSlot
+{
+  T    slot[3];
+  int  back;			// slot being written (writer only)
+  int  middle;			// slot in exchange, | SLOTFRESH if unread
+  int  front;			// slot being read (reader only)
+};
+
+struct ComputeThread
+{
+  pthread_t        thread;
+  pthread_mutex_t  lock;	// parks the thread only
+  pthread_cond_t   wake;
+  int              nWake;	// wake-ups since the thread last ran
+  void           (*step) (void *arg);
+  void            *arg;
+};
+
+/******************************************************************************/
+/******************************************************************************/
+
+template <class T>
+void initLatestSlot (LatestSlot<T> &s)
+{
+  s.back = 0;  s.middle = 1;  s.front = 2;
+}
+
+template <class T>
+inline T &writeSlot (LatestSlot<T> &s)	{ return s.slot[s.back]; }
+
+template <class T>
+inline T &readSlot (LatestSlot<T> &s)	{ return s.slot[s.front]; }
+
+/******************************************************************************
+	Writer: publish the slot just written, and continue in the old middle
+	slot (dropping it, if the reader never took it).
+******************************************************************************/
+
+template <class T>
+void publishSlot (LatestSlot<T> &s)
+{
+  int old = __atomic_exchange_n (&s.middle, s.back | SLOTFRESH, __ATOMIC_ACQ_REL);
+  s.back = old & SLOTINDEX;
+}
+
+/******************************************************************************
+	Reader: take the newest published slot, if there is one since the
+	last take.  Returns 1 iff readSlot(s) changed.
+******************************************************************************/
+
+template <class T>
+int takeSlot (LatestSlot<T> &s)
+{
+  if (!(__atomic_load_n (&s.middle, __ATOMIC_ACQUIRE) & SLOTFRESH)) return 0;
+  int old = __atomic_exchange_n (&s.middle, s.front, __ATOMIC_ACQ_REL);
+  s.front = old & SLOTINDEX;
+  return 1;
+}
+
+/******************************************************************************/
+/******************************************************************************/
+
+static void *computeThreadRun (void *c)
+{
+  ComputeThread &ct = *(ComputeThread *) c;
+  while (1)
+   {
+    pthread_mutex_lock (&ct.lock);
+    while (ct.nWake == 0) pthread_cond_wait (&ct.wake, &ct.lock);
+    ct.nWake = 0;			// one step serves every wake-up so far
+    pthread_mutex_unlock (&ct.lock);
+    ct.step (ct.arg);
+   }
+  return NULL;
+}
+
+/******************************************************************************
+	Start a detached thread that runs step(arg) after each wake-up.
+******************************************************************************/
+
+static void startComputeThread (ComputeThread &ct, void (*step) (void *arg), void *arg)
+{
+  pthread_mutex_init (&ct.lock, NULL);
+  pthread_cond_init  (&ct.wake, NULL);
+  ct.nWake = 0;  ct.step = step;  ct.arg = arg;
+  pthread_create (&ct.thread, NULL, computeThreadRun, &ct);
+  pthread_detach (ct.thread);
+}
+
+/******************************************************************************/
+/******************************************************************************/
+
+static inline void wakeComputeThread (ComputeThread &ct)
+{
+  pthread_mutex_lock (&ct.lock);
+  ct.nWake++;
+  pthread_cond_signal (&ct.wake);
+  pthread_mutex_unlock (&ct.lock);
+}
+
+#endif
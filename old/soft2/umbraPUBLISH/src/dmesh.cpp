@@ -2,14 +2,16 @@
   File:          dmesh.cpp
   Author:        J.K. Johnstone 
   Created:	 8 April 2003 (from umbra.cpp)
-  Last Modified: 8 April 2003 
+  Last Modified: 17 October 2026
   Purpose:       Compute the discontinuity mesh of a scene of curves.
 		 Generalizes umbra.cpp, a discontinuity mesh concentrating
 		 on the regions invisible or partially visible to the light.
   Sequence:	 5th in a sequence (interpolate, tangCurve, bitang, umbra, dmesh)
   Input: 	 k 2d polygons, implicitly defining k interpolating cubic 
   		 Bezier curves: the boundary of the objects in the scene.
-  History: 	 
+  History: 	 10/17/26: Broad-phase culling of tangential curve pairs.
+  		 10/17/26: Headless batch mode (-b, -o, -j).
+		 10/17/26: Disk cache of bitangents (-k).
 */
 
 #include <GL/glut.h>
@@ -31,6 +33,10 @@ using std::string;
 #include "BezierCurve.h"	
 #include "TangCurve.h"		// CommonTangent, intersect, draw, visible
 #include "UmbralBitang.h"
+#include "dualBox.h"		// buildDualBox, intersectDual
+#include "workSteal.h"		// nProcessor
+#include "umbraBatch.h"		// batchRun, writeUmbra, markStage
+#include "tangCache.h"		// tangCacheKey, openTangCache, beginTangCache
 
 #define PTSPERBEZSEGMENT 10      // # pts to draw on each Bezier segment
 
@@ -44,8 +50,14 @@ static void usage()
   cout << "\t[-s #] (obstacle that has refining umbral bitangent animated: 1<=n<=nOb [default: 1])" << endl;
   cout << "\t[-u #] (which umbral bitangent to animate: 0 or 1 [default: 0])" << endl;
   cout << "\t[-r #] (radius of bounding room; default 2)" << endl;
+  cout << "\t[-b] (batch: no display; compute every <file>.pts given, in parallel," << endl;
+  cout << "\t\t and write results to <file>.pts.json or .umb)" << endl;
+  cout << "\t[-o json|bin] (batch output format; default json)" << endl;
+  cout << "\t[-j #] (number of cores: one per scene run in parallel in batch; default: all cores)" << endl;
+  cout << "\t[-k] (cache bitangents in <file>.pts.dmesh.tcache, reused while" << endl;
+  cout << "\t\t the scene and -e are unchanged)" << endl;
   cout << "\t[-h] (this help message)" << endl;
-  cout << "\t <file>.pts" << endl;
+  cout << "\t <file>.pts ..." << endl;
  }
 
 static GLfloat   transxob, transyob, zoomob;
@@ -118,6 +130,11 @@ int 			pause=1;	// flag: are you pausing in sweep animation?
 float colour[7][3] = {{0,0,0}, {1,0,0}, {0,0,1}, {0,1,0}, {1,0,1}, {0,1,1}, {1,1,0}};
 int			obstacleWin;	// primal window identifier 
 int       		nPtsPerSegment = PTSPERBEZSEGMENT;
+static GLboolean BATCH=0;               // headless: compute and write each scene, no display?
+int              outputFormat=UMBRAJSON;// UMBRAJSON or UMBRABINARY (batch output)
+float            batchEps;              // accuracy of intersection computation (batch)
+static GLboolean TANGCACHE=0;           // cache bitangents on disk (tangCache.h)?
+UmbraTimer       umbraTimer;            // per-stage timings of present scene
 
 /******************************************************************************/
 /******************************************************************************/
@@ -652,6 +669,10 @@ void buildTangentialCurves (Array<BezierCurve2f> &obstacle)
 	(i.e., light first so that index1 and param1 of CommonTangent
 	refer to the point of bitangency with the light):
 	this is needed in outer.
+	Pairs whose tangential curves have no overlapping segment boxes
+	cannot intersect, and are culled before the exact intersection;
+	in the others, only the segments with an overlapping partner are
+	intersected.
 ******************************************************************************/
 
 void buildBitangent      (Array<TangentialCurve> &obduala,
@@ -663,17 +684,57 @@ void buildBitangent      (Array<TangentialCurve> &obduala,
   Array<CommonTangentArr> bitangB;	// bitangents from b-space 
   int nOb = obduala.getn();   
   bitang.allocate(nOb*nOb);  bitangA.allocate(nOb*nOb);  bitangB.allocate(nOb*nOb);
+  Array<DualBoxArr> boxa(nOb), boxb(nOb);	// segment boxes (broad phase)
+  for (int i=0; i<nOb; i++)
+   {
+    buildDualBox (obduala[i], eps, boxa[i]);
+    buildDualBox (obdualb[i], eps, boxb[i]);
+   }
+  int nCulled=0;
   for (int i=0; i<nOb; i++)
     for (int j=i+1; j<nOb; j++)		// bitangents between i and j
      {
-      obduala[i].intersect (obduala[j], bitangA[i*nOb+j], eps);
-      obdualb[i].intersect (obdualb[j], bitangB[i*nOb+j], eps); 
+      if (!intersectDual (obduala[i], boxa[i], obduala[j], boxa[j], bitangA[i*nOb+j], eps))
+	nCulled++;
+      if (!intersectDual (obdualb[i], boxb[i], obdualb[j], boxb[j], bitangB[i*nOb+j], eps))
+	nCulled++;
       bitang[i*nOb+j].append (bitangA[i*nOb+j], bitangB[i*nOb+j]);
       IntArr foo; 	bitang[i*nOb+j].bubbleSort (foo);
       bitang[i*nOb+j].deleteDuplicate();      
 cout << "Bitangents from obstacle " << i << " to obstacle " << j << ":" << endl;
 for (int k=0; k<bitang[i*nOb+j].getn(); k++) bitang[i*nOb+j][k].print();  cout << endl;
      }
+  cout << "Broad phase culled " << nCulled << " of " << nOb*(nOb-1) 
+       << " tangential curve intersections" << endl;
+}
+
+/******************************************************************************
+	Read bitang from the cache of scene file, if it is valid
+	(one list per pair i<j, in order).  Returns 0 if there is none.
+******************************************************************************/
+
+int readBitangentCache (char *file, int nOb, float eps, Array<CommonTangentArr> &bitang)
+{
+  TangCache c;
+  int l=0;
+  if (!openTangCache (file, "dmesh", tangCacheKey (file, "dmesh", 1, &eps), 
+		      nOb*(nOb-1)/2, c))
+    return 0;
+  bitang.allocate(nOb*nOb);
+  for (int i=0; i<nOb; i++)
+    for (int j=i+1; j<nOb; j++) getTangCacheList (c, l++, bitang[i*nOb+j]);
+  closeTangCache (c);
+  cout << "Read bitangents from cache" << endl;
+  return 1;
+}
+
+void writeBitangentCache (char *file, int nOb, float eps, Array<CommonTangentArr> &bitang)
+{
+  TangCacheWriter w;
+  beginTangCache (file, "dmesh", tangCacheKey (file, "dmesh", 1, &eps), nOb*(nOb-1)/2, w);
+  for (int i=0; i<nOb; i++)
+    for (int j=i+1; j<nOb; j++) addTangCacheList (w, bitang[i*nOb+j]);
+  endTangCache (w);
 }
 
 /******************************************************************************
@@ -1065,57 +1126,112 @@ void defineMaxUmbra (UmbralBitangArr &it, Polygon2f &maxUmbra)
 }
 
 /******************************************************************************
+	Read the scene in file and compute its discontinuity mesh.
 ******************************************************************************/
 
-int main (int argc, char **argv)
+void computeScene (char *file, float eps)
 {
-  int       ArgsParsed=0;
-  float     eps = .001;	// accuracy of intersection computation
-
-  RoutineName = argv[ArgsParsed++];
-  if (argc == 1) { usage(); exit(-1); }
-  while (ArgsParsed < argc)
-   {
-    if ('-' == argv[ArgsParsed][0])
-      switch (argv[ArgsParsed++][1])
-      {
-      case 'd': nPtsPerSegment = atoi(argv[ArgsParsed++]);	break;
-      case 'e': eps = atof(argv[ArgsParsed++]);			break;
-      case 's': specialOb = atoi(argv[ArgsParsed++]);		break;
-      case 'u': specialUmb = atoi (argv[ArgsParsed++]);		break;
-      case 'r': radiusRoom = atof (argv[ArgsParsed++]);		break;
-      case 'h': 
-      default:	usage(); exit(-1);				break;
-      }
-   else ArgsParsed++;
-  }
-
+  startTimer (umbraTimer);
 	cout << "Inputting curves" << endl;    
-  inputCurves(argv[argc-1], obstacle);
+  inputCurves(file, obstacle);
     assert (specialOb >= 1 && specialOb < obstacle.getn());
     assert (specialUmb == 0 || specialUmb == 1);
 	cout << "Creating hodographs" << endl;    
     specialHodo.createHodograph (obstacle[specialOb]);
     lightHodo.createHodograph   (obstacle[0]);
+  markStage (umbraTimer, "input");
 	cout << "Building tangential curves" << endl;    
   buildTangentialCurves (obstacle);
+  markStage (umbraTimer, "tangential curves");
+  if (TANGCACHE && readBitangentCache (file, obstacle.getn(), eps, bitang))
+    markStage (umbraTimer, "cached bitangents");
+  else
+   {
 	cout << "Building bitangents" << endl;    
-  buildBitangent (obduala, obdualb, eps, bitang);  
+    buildBitangent (obduala, obdualb, eps, bitang);  
+    markStage (umbraTimer, "bitangents");
+    if (TANGCACHE) writeBitangentCache (file, obstacle.getn(), eps, bitang);
+   }
 	cout << "Building outer bitangents" << endl;    
   buildOuterBitang (bitang, obstacle, eps, outer);  // just to light
+  markStage (umbraTimer, "outer bitangents");
 	cout << "Building inner bitangents" << endl;    
   buildInnerBitang (bitang, obstacle, eps, inner); // all pairs
+  markStage (umbraTimer, "inner bitangents");
 	cout << "Building piercing bitangents" << endl;    
   buildPierceBitang (bitang, obstacle, eps, pierce); // all pairs
+  markStage (umbraTimer, "piercing bitangents");
 	cout << "Inner sweep" << endl;    
   innerSweep (outer, inner, obstacle, umbTangInner);
+  markStage (umbraTimer, "inner sweep");
 	cout << "Outer sweep" << endl;    
   outerSweep (outer, obstacle, umbTangInner, umbTangOuter);
+  markStage (umbraTimer, "outer sweep");
   	cout << "Defining umbral polygons" << endl;
   defineUmbra (obstacle, radiusRoom, room, umbTangInner, umbTangOuter, umbra);
   defineLocalUmbra (outer, localUmbra);
   defineMaxUmbra (inner[1], maxUmbra);
+  markStage (umbraTimer, "umbral polygons");
 cout << "maxUmbra = " << maxUmbra << endl;
+}
+
+/******************************************************************************
+	Headless: compute the scene in file and write the bitangents,
+	umbral polygons and timings (see umbraBatch.h).
+******************************************************************************/
+
+int batchScene (char *file)
+{
+  computeScene (file, batchEps);
+  Array<Polygon2f> maxUmbraArr(2);	// maxUmbra belongs to first obstacle
+  maxUmbraArr[1] = maxUmbra;
+  UmbraRegion region[3] = {{"localUmbra", &localUmbra, 1}, {"umbra", &umbra, 1},
+			   {"maxUmbra", &maxUmbraArr, 1}};
+  return writeUmbra (file, outputFormat, obstacle.getn(), bitang, 3, region, umbraTimer);
+}
+
+/******************************************************************************
+******************************************************************************/
+
+int main (int argc, char **argv)
+{
+  int       ArgsParsed=0;
+  float     eps = .001;	// accuracy of intersection computation
+  char    **scene = new char*[argc];	// scene files
+  int       nScene=0;
+  int       nJob = nProcessor();	// # cores, one per scene computed in parallel (batch)
+
+  RoutineName = argv[ArgsParsed++];
+  if (argc == 1) { usage(); exit(-1); }
+  while (ArgsParsed < argc)
+   {
+    if ('-' == argv[ArgsParsed][0])
+      switch (argv[ArgsParsed++][1])
+      {
+      case 'd': nPtsPerSegment = atoi(argv[ArgsParsed++]);	break;
+      case 'e': eps = atof(argv[ArgsParsed++]);			break;
+      case 's': specialOb = atoi(argv[ArgsParsed++]);		break;
+      case 'u': specialUmb = atoi (argv[ArgsParsed++]);		break;
+      case 'r': radiusRoom = atof (argv[ArgsParsed++]);		break;
+      case 'b': BATCH=1;                                        break;
+      case 'o': outputFormat = (strcmp(argv[ArgsParsed++], "bin") == 0 
+				? UMBRABINARY : UMBRAJSON);     break;
+      case 'j': nJob = atoi(argv[ArgsParsed++]);
+	        if (nJob < 1) { usage(); exit(-1); }            break;
+      case 'k': TANGCACHE=1;                                    break;
+      case 'h': 
+      default:	usage(); exit(-1);				break;
+      }
+   else scene[nScene++] = argv[ArgsParsed++];
+  }
+  batchEps = eps;
+
+  if (BATCH)
+   {
+    if (nScene == 0) { usage(); exit(-1); }
+    exit (batchRun (nScene, scene, (nJob < nScene ? nJob : nScene), batchScene));
+   }
+  computeScene (argv[argc-1], eps);
   
   /************************************************************/
 
@@ -0,0 +1,256 @@
+/*
+  File:          dualBox.h
+  Created:	 17 October 2026
+  Purpose:       Broad phase for the intersection of tangential curves.
+		 Every active rational Bezier segment of a tangential curve
+		 has positive weights after clipping, so it lies in the
+		 axis-aligned box of its control points (convex hull property).
+		 A sweep-and-prune over these boxes finds the segment pairs
+		 of two tangential curves that can intersect.
+		 If there are none, the curves cannot intersect and the
+		 (exact) TangentialCurve::intersect can be skipped:
+		 the CommonTangentArr it would return is empty.
+		 Otherwise the segments with no candidate partner are
+		 deactivated for the duration of the intersection (as
+		 tangSurfCull.h does for patches) and restored afterwards.
+		 For a self-intersection, a segment is kept only if its box
+		 meets that of a non-adjacent segment, or if it is not
+		 strictly monotone in x or y together with each neighbour
+		 (with positive weights a segment whose control points
+		 are strictly monotone in x is itself strictly monotone in x,
+		 so it cannot cross itself or a neighbour monotone the same way).
+  Usage:	 DualBoxArr boxA;  buildDualBox (obduala[i], epsIntersect, boxA);
+		 if (!intersectDual (obduala[i], boxA, obduala[j], boxB, bitang, eps)) ... culled
+		 selfIntersectDual (obduala[i], boxA, selfbitang, eps);
+		 The curves are modified (and restored) during the call, so a
+		 curve must not be intersected by two threads at once: parallel
+		 callers give each thread its own copies of the curves.
+*/
+
+#ifndef _DUALBOX_H_
+#define _DUALBOX_H_
+
+#include <stdlib.h>		// qsort
+
+struct DualBox			// bounding box of one segment of a tangential curve
+{
+  float min[2], max[2];
+  int   seg;			// segment index in the tangential curve
+};
+
+typedef Array<DualBox> DualBoxArr;
+
+/******************************************************************************
+	Bounding box of each active segment of the tangential curve dual,
+	padded by eps (the intersection accuracy) so that intersections
+	found at accuracy eps are never culled.
+	Segment k is the rational Bezier curve on control points
+	deg*k,...,deg*(k+1).
+******************************************************************************/
+
+static inline void buildDualBox (TangentialCurve &dual, float eps, DualBoxArr &box)
+{
+  int nSeg = dual.getnKnot() - 1;
+  if (nSeg < 1) { box.allocate(0); return; }
+  int deg  = (dual.getnCtrlPt() - 1) / nSeg;
+  int nBox = 0;
+  box.allocate (nSeg);
+  for (int k=0; k<nSeg; k++)
+   {
+    if (!dual.active[k]) continue;		// clipped segment: never intersected
+    DualBox &b = box[nBox++];
+    b.seg = k;
+    for (int c=0; c<2; c++) b.min[c] = b.max[c] = dual.getCtrlPt (deg*k, c);
+    for (int i=deg*k+1; i<=deg*(k+1); i++)
+      for (int c=0; c<2; c++)
+       {
+	float x = dual.getCtrlPt (i, c);
+	if (x < b.min[c]) b.min[c] = x;
+	if (x > b.max[c]) b.max[c] = x;
+       }
+    for (int c=0; c<2; c++) { b.min[c] -= eps;  b.max[c] += eps; }
+   }
+  box.shrink (nBox);
+}
+
+/******************************************************************************/
+/******************************************************************************/
+
+struct DualBoxEndpt		// sweep event: a box's left edge
+{
+  float x;
+  int   curve;			// 0 or 1
+  int   index;			// box index in its curve's DualBoxArr
+};
+
+static inline int compareDualBoxEndpt (const void *a, const void *b)
+{
+  float xa = ((const DualBoxEndpt *) a)->x, xb = ((const DualBoxEndpt *) b)->x;
+  return (xa < xb ? -1 : (xa > xb ? 1 : 0));
+}
+
+/******************************************************************************
+	Sweep-and-prune in x over the boxes of two tangential curves.
+	Candidate segment pairs (box1[cand1[k]], box2[cand2[k]]) overlap in
+	both x and y.
+	If firstOnly, stop at the first candidate.
+	Returns the number of candidates.
+******************************************************************************/
+
+static inline int sweepAndPrune (DualBoxArr &box1, DualBoxArr &box2,
+				 IntArr &cand1, IntArr &cand2, int firstOnly=0)
+{
+  int n1 = box1.getn(), n2 = box2.getn(), n = n1 + n2;
+  int i, k, nCand=0, maxCand = (firstOnly ? 1 : n1*n2);
+  cand1.allocate (maxCand);  cand2.allocate (maxCand);
+  if (n1 == 0 || n2 == 0) { cand1.shrink(0); cand2.shrink(0); return 0; }
+  DualBoxEndpt *endpt = new DualBoxEndpt[n];
+  for (i=0; i<n1; i++) { endpt[i].x    = box1[i].min[0]; endpt[i].curve    = 0; endpt[i].index    = i; }
+  for (i=0; i<n2; i++) { endpt[n1+i].x = box2[i].min[0]; endpt[n1+i].curve = 1; endpt[n1+i].index = i; }
+  qsort (endpt, n, sizeof(DualBoxEndpt), compareDualBoxEndpt);
+
+  int *live[2];  int nLive[2] = {0,0};		// boxes whose x-interval is open
+  live[0] = new int[n1];  live[1] = new int[n2];
+  DualBoxArr *box[2] = {&box1, &box2};
+  for (k=0; k<n && nCand < maxCand; k++)
+   {
+    int c = endpt[k].curve, other = 1-c;
+    DualBox &b = (*box[c])[endpt[k].index];
+    int nKeep = 0;				// prune closed boxes of other curve
+    for (i=0; i<nLive[other]; i++)
+      if ((*box[other])[live[other][i]].max[0] >= b.min[0])
+	live[other][nKeep++] = live[other][i];
+    nLive[other] = nKeep;
+    for (i=0; i<nLive[other] && nCand < maxCand; i++)
+     {
+      DualBox &o = (*box[other])[live[other][i]];
+      if (b.min[1] <= o.max[1] && o.min[1] <= b.max[1])
+       {
+	cand1[nCand] = (c==0 ? endpt[k].index : live[other][i]);
+	cand2[nCand] = (c==0 ? live[other][i] : endpt[k].index);
+	nCand++;
+       }
+     }
+    live[c][nLive[c]++] = endpt[k].index;
+   }
+  delete [] live[0];  delete [] live[1];  delete [] endpt;
+  cand1.shrink (nCand);  cand2.shrink (nCand);
+  return nCand;
+}
+
+/******************************************************************************
+	Can the tangential curves with these boxes intersect?
+******************************************************************************/
+
+static inline int dualOverlap (DualBoxArr &box1, DualBoxArr &box2)
+{
+  IntArr cand1, cand2;
+  return sweepAndPrune (box1, box2, cand1, cand2, 1);
+}
+
+/******************************************************************************/
+/******************************************************************************/
+
+static inline void saveDualActive (TangentialCurve &dual, IntArr &save)
+{
+  int nSeg = dual.getnKnot() - 1;
+  save.allocate (nSeg > 0 ? nSeg : 0);
+  for (int k=0; k<save.getn(); k++) save[k] = dual.active[k];
+}
+
+static inline void restoreDualActive (TangentialCurve &dual, IntArr &save)
+{
+  for (int k=0; k<save.getn(); k++) dual.active[k] = save[k];
+}
+
+/******************************************************************************
+	Intersect the tangential curves dual1 and dual2 (with boxes box1 
+	and box2) at accuracy eps, intersecting only the segments that 
+	have a candidate partner in the other curve.
+	Returns 0 if no segment pair can meet (bitang is then empty),
+	otherwise the number of candidate segment pairs.
+******************************************************************************/
+
+static inline int intersectDual (TangentialCurve &dual1, DualBoxArr &box1,
+				 TangentialCurve &dual2, DualBoxArr &box2,
+				 CommonTangentArr &bitang, float eps)
+{
+  IntArr cand1, cand2, save1, save2;
+  int k, nCand = sweepAndPrune (box1, box2, cand1, cand2);
+  if (nCand == 0) { bitang.allocate(0);  return 0; }
+  saveDualActive (dual1, save1);  saveDualActive (dual2, save2);
+  char *keep1 = new char[save1.getn()+1], *keep2 = new char[save2.getn()+1];
+  for (k=0; k<save1.getn(); k++) keep1[k] = 0;
+  for (k=0; k<save2.getn(); k++) keep2[k] = 0;
+  for (k=0; k<nCand; k++) { keep1[box1[cand1[k]].seg] = 1;  keep2[box2[cand2[k]].seg] = 1; }
+  for (k=0; k<save1.getn(); k++) if (!keep1[k]) dual1.active[k] = 0;
+  for (k=0; k<save2.getn(); k++) if (!keep2[k]) dual2.active[k] = 0;
+  dual1.intersect (dual2, bitang, eps);
+  restoreDualActive (dual1, save1);  restoreDualActive (dual2, save2);
+  delete [] keep1;  delete [] keep2;
+  return nCand;
+}
+
+/******************************************************************************
+	Direction of segment k (of degree deg) of dual in coordinate c: 
+	1 (-1) if its control points strictly increase (decrease), else 0.
+******************************************************************************/
+
+static inline int dualMonotone (TangentialCurve &dual, int deg, int k, int c)
+{
+  int up=1, down=1;
+  for (int i=deg*k; i<deg*(k+1); i++)
+   {
+    float d = dual.getCtrlPt (i+1, c) - dual.getCtrlPt (i, c);
+    if (d <= 0) up = 0;
+    if (d >= 0) down = 0;
+   }
+  return (up ? 1 : (down ? -1 : 0));
+}
+
+/******************************************************************************
+	Self-intersect the tangential curve dual (with boxes box) at 
+	accuracy eps, intersecting only the segments that may take part
+	in a self-intersection.
+	Returns the number of active segments culled.
+******************************************************************************/
+
+static inline int selfIntersectDual (TangentialCurve &dual, DualBoxArr &box,
+				     CommonTangentArr &bitang, float eps)
+{
+  IntArr cand1, cand2, save;
+  int k, nSeg = dual.getnKnot() - 1, nCulled = 0;
+  if (nSeg < 1) { dual.selfIntersect (bitang, eps);  return 0; }
+  int deg = (dual.getnCtrlPt() - 1) / nSeg;
+  int nCand = sweepAndPrune (box, box, cand1, cand2);
+  saveDualActive (dual, save);
+  char *keep = new char[nSeg];
+  int  *dir  = new int[2*nSeg];			// monotone direction in x and y
+  for (k=0; k<nSeg; k++)
+   {
+    keep[k] = 0;
+    dir[2*k]   = (save[k] ? dualMonotone (dual, deg, k, 0) : 0);
+    dir[2*k+1] = (save[k] ? dualMonotone (dual, deg, k, 1) : 0);
+   }
+  for (k=0; k<nCand; k++)			// boxes of non-adjacent segments meet
+   {
+    int s = box[cand1[k]].seg, t = box[cand2[k]].seg;
+    if (abs (s-t) > 1) keep[s] = keep[t] = 1;
+   }
+  for (k=0; k<nSeg; k++)
+   {
+    if (!save[k]) continue;
+    if (!dir[2*k] && !dir[2*k+1]) keep[k] = 1;	// may loop on itself
+    for (int n=k-1; n<=k+1; n+=2)		// may cross a neighbour
+      if (n >= 0 && n < nSeg && save[n] && 
+	  !(dir[2*k] && dir[2*k] == dir[2*n]) && !(dir[2*k+1] && dir[2*k+1] == dir[2*n+1]))
+	keep[k] = 1;
+    if (!keep[k]) { dual.active[k] = 0;  nCulled++; }
+   }
+  dual.selfIntersect (bitang, eps);
+  restoreDualActive (dual, save);
+  delete [] keep;  delete [] dir;
+  return nCulled;
+}
+
+#endif
@@ -2,7 +2,7 @@
   File:          dynamicLocalBackUmbra.cpp
   Author:        J.K. Johnstone 
   Created:	 25 May 2004
-  Last Modified: 1 June 2004
+  Last Modified: 17 October 2026
   Purpose:       Analyze the local back umbra cast by an object B,
                  including dynamically changing B.
   Sequence:	 4th in a sequence (interpolate, tangCurve, bitang, dynamicLocalBackUmbra)
@@ -18,6 +18,15 @@
 		 The first curve is the distinguished object A.
   History: 	 5/24/04: Created from umbra.cpp.
                  6/28/04: Allowed exchange of A and B (to grow A).
+		 10/17/26: O(n log n) merge of a- and b-space bitangents
+		           (mergeCommonTangent).
+		 10/17/26: Incremental update: only recompute what depends on 
+		           the dynamic obstacle, and only when it changes (-x to disable).
+		 10/17/26: Headless batch mode (-b, -o, -j).
+		 10/17/26: Curvature-adaptive sampling of the back umbra boundary
+		           (chordal error -C) and streaming polygon construction.
+		 10/17/26: Envelope edits are computed on a background thread
+		           (computeThread.h), so the display never waits (-s to disable).
 */
 
 #include <GL/glut.h>
@@ -40,8 +49,16 @@ using std::string;
 #include "TangCurve.h"		// CommonTangent, intersect, draw, visible
 #include "UmbralBitang.h"
 #include "Scene2d.h"
+#include "bitangMerge.h"		// mergeCommonTangent
+#include "umbraUpdate.h"		// buildObBox, umbraDepends
+#include "workSteal.h"			// nProcessor
+#include "umbraBatch.h"			// batchRun, writeUmbra, markStage
+#include "bezierBatch.h"		// evalBezierBatch (for adaptiveSample.h)
+#include "adaptiveSample.h"		// addSegmentAdaptive, PolygonBuilder
+#include "computeThread.h"		// LatestSlot, ComputeThread
 
 #define PTSPERBEZSEGMENT 10      // # pts to draw on each Bezier segment
+#define POLLMSEC        15       // how often the display checks for a new umbra
 
 static char *RoutineName;
 static void usage()
@@ -66,6 +83,13 @@ static void usage()
   cout << "\t[-w]   (weird case: A surrounds L: don't compute everything)" << endl;
   cout << "\t[-S]   (scene input)" << endl;
   cout << "\t[-t]   (only compute tangents, for debugging)" << endl;
+  cout << "\t[-x]   (recompute everything on every redisplay, not just what the envelope changes)" << endl;
+  cout << "\t[-s]   (synchronous: recompute inside the display callback, not on a compute thread)" << endl;
+  cout << "\t[-C #] (chordal error of curve samples on umbra boundary; default .002)" << endl;
+  cout << "\t[-b]   (batch: no display; compute every <file>.pts given, in parallel," << endl;
+  cout << "\t\t\t\t and write results to <file>.pts.json or .umb)" << endl;
+  cout << "\t[-o json|bin] (batch output format; default json)" << endl;
+  cout << "\t[-j #] (number of cores: one per scene run in parallel in batch; default: all cores)" << endl;
   cout << "\t[-P #] (number of levels to compute)" << endl;
   cout << "\t    0: scene display" << endl;
   cout << "\t    1: bitangents"    << endl;
@@ -76,7 +100,7 @@ static void usage()
   //  cout << "\t    5: inner piercing bitangents" << endl;
   cout << "\t    6: local back umbra" << endl;
   cout << "\t[-h]   (this help message)" << endl;
-  cout << "\t <file>.pts" << endl;
+  cout << "\t <file>.pts ..." << endl;
  }
 
 static GLfloat   transxob, transyob, zoomob;
@@ -129,27 +153,24 @@ static GLboolean DYNAMICSPINE=0;        // is 2nd input curve the open spine of
 static GLboolean OTHERDYNAMICSPINE=0;   // is 1st input curve the open spine of a skeleton curve?
 int              level=15;              // computation level
 
-Array<BezierCurve2f> 	obstacle;	// interpolating cubic Bezier curves
+Array<BezierCurve2f> 	obstacle;	// interpolating cubic Bezier curves, as input
+					// (the envelope is grown in UmbraState::obstacle)
 int                     nOb=2;          // redundant, but useful
 float                   tGrow;          // present end parameter value of growing envelope
+static GLboolean INCREMENTAL=1;         // only update what depends on the dynamic obstacle?
+float            chordTol=.002;         // chordal error of curve samples of back umbra
+static GLboolean BATCH=0;               // headless: compute and write each scene, no display?
+int              outputFormat=UMBRAJSON;// UMBRAJSON or UMBRABINARY (batch output)
+UmbraTimer       umbraTimer;            // per-stage timings of present scene
+static GLboolean SYNCHRONOUS=0;         // recompute in the display callback, not on a thread?
 float                   R=.1;           // radius of envelope
 float                   delta=.1;       // sampling step size
 BezierCurve2f           spine;          // spine curve, defining the dynamic envelope if DYNAMICSPINE
 V2fArr			obCentroid;	// obstacle centroids
-Array<TangentialCurve>  obduala;	// associated tangential a-curves
-Array<TangentialCurve>  obdualb;	// associated tangential b-curves
-Array<UmbralBitangArr>  bitang;		// bitangents between curves and light
-					// curve i/j bitangents are stored in 
-					// index i*obstacle.getn() + j
-					// (0 is the light)
-Array<UmbralBitangArr>  selfbitang;     // selfbitangents of every curve
 int 			nextbitang=0;	// counter for cycling thru bitangents					
 int 			nextcurve=1;	// another counter for same purpose
 float 			radiusRoom=2;	// radius of bounding room's square (which is centered at origin)
 Polygon2f		room;		// bounding room
-Array<UmbralBitangArr>  outer;		// outer bitangents for each obstacle
-					// to light, 2 per obstacle
-Array<UmbralBitangArr>  selfinner;      // self-inner bitangents for each non-light obstacle
 Array<UmbralBitangArr>  inner;		// inner bitangents for each curve,
 					// stored like bitang;
 					// both [i*nOb+j] and [j*nOb+i] are stored
@@ -173,14 +194,12 @@ Array<UmbralBitangArr>  sweptOutPierce; // global umbral bitangents
                                         // generated by outer piercing sweep (for front umbra),
                                         // 1 per outer piercing bitangent (1 per component)
 Array<Polygon2f>	globalBackUmbra;		// (global) umbral polygon (bounded by room) for each obstacle
-Array<Polygon2f>	localBackUmbra;	// (local) back umbral polygon (bounded by room) for each obstacle
 Array<Polygon2f>	backPenumbra;	// maximal umbral polygon (bounded by room) for each obstacle
 Array<Polygon2fArr>     localFrontUmbra;// polygons of the local front umbra for each obstacle
 Array<Polygon2fArr>     frontPenumbra;  // polygons of the maximal front umbra for each obstacle
 Array<Polygon2fArr>     globalFrontUmbra; // polygons of the global front umbra for each obstacle
 int 			specialOb=1;	// animation of refinement of umbral bitangent
 					// will be performed for obstacle[specialOb!=0]
-BezierCurve2f		specialHodo;	// hodograph of obstacle[specialOb]					
 BezierCurve2f		lightHodo;	// hodograph of light
 int			specialUmb=0;	// index of umbral bitangent on specialOb to animate
 UmbralBitang		specialUmbTang; // the umbral bitangent being animated
@@ -206,6 +225,41 @@ float color[][3]  = {{0,0,0}, {.8,.8,.8}, {0.411765, 0.411765, 0.411765},  // Bl
 int			obstacleWin;	// primal window identifier 
 int       		nPtsPerSegment = PTSPERBEZSEGMENT;
 
+struct UmbraState		// everything that depends on the envelope
+{
+  Array<BezierCurve2f>    obstacle;	  // input curves, with the present envelope
+  Array<TangentialCurve>  obduala;	  // associated tangential a-curves
+  Array<TangentialCurve>  obdualb;	  // associated tangential b-curves
+  Array<UmbralBitangArr>  bitang;	  // bitangents between curves and light
+					  // curve i/j bitangents are stored in 
+					  // index i*obstacle.getn() + j
+					  // (0 is the light)
+  Array<UmbralBitangArr>  selfbitang;     // selfbitangents of every curve
+  Array<UmbralBitangArr>  outer;	  // outer bitangents for each obstacle
+					  // to light, 2 per obstacle
+  Array<UmbralBitangArr>  selfinner;      // self-inner bitangents for each non-light obstacle
+  Array<Polygon2f>	  localBackUmbra; // (local) back umbral polygon (bounded by room) 
+                                          // for each obstacle
+  ObBoxArr                obBox;          // obstacle bounding boxes (incremental update)
+  BezierBatch            *obBatch;        // batch evaluator of each obstacle (adaptiveSample.h)
+  BezierCurve2f		  specialHodo;	  // hodograph of obstacle[specialOb]
+  int                     built;          // has the umbra been built yet?
+  float                   tBuilt;         // value of tGrow when the umbra was last built
+  int                     edit;           // # of the envelope edit it was built for
+};
+
+struct UmbraEdit		// an envelope edit, posted to the compute thread
+{
+  float                   tGrow;
+  int                     edit;
+};
+
+LatestSlot<UmbraState>  umbra;		// shown umbra (read), next umbra (write)
+LatestSlot<UmbraEdit>   envelopeEdit;	// newest envelope edit
+ComputeThread           umbraThread;	// brings umbra up to date with envelopeEdit
+int                     nEdit=0;        // # envelope edits posted
+static GLboolean        POLLING=0;      // is the display waiting for a new umbra?
+
 /******************************************************************************/
 /******************************************************************************/
 
@@ -299,11 +353,39 @@ void motionob (int x, int y)
   glutPostRedisplay();
 }
 
+/******************************************************************************
+	Redisplay when the compute thread has published a newer umbra,
+	and keep polling until the umbra reflects the newest envelope edit.
+******************************************************************************/
+
+void pollUmbra (int value)
+{
+  if (takeSlot (umbra)) glutPostRedisplay();
+  if (readSlot(umbra).edit != nEdit) glutTimerFunc (POLLMSEC, pollUmbra, 0);
+  else                               POLLING = 0;
+}
+
+/******************************************************************************
+	Hand the present envelope (tGrow) to the compute thread.
+	The display goes on showing the last umbra until the new one is ready.
+******************************************************************************/
+
+void postEnvelopeEdit ()
+{
+  if (SYNCHRONOUS) return;		// displayOb recomputes
+  UmbraEdit &e = writeSlot (envelopeEdit);
+  e.tGrow = tGrow;  e.edit = ++nEdit;
+  publishSlot (envelopeEdit);
+  wakeComputeThread (umbraThread);
+  if (!POLLING) { POLLING = 1;  glutTimerFunc (POLLMSEC, pollUmbra, 0); }
+}
+
 /******************************************************************************/
 /******************************************************************************/
 
 void keyboard (unsigned char key, int x, int y)
 {
+  Array<UmbralBitangArr> &bitang = readSlot(umbra).bitang;
   switch (key) {
   case 27:	exit(1); 				    break; // ESCAPE
   case '1':	DRAWBITANG          = !DRAWBITANG;	    break;
@@ -415,10 +497,12 @@ void keyboard (unsigned char key, int x, int y)
                 if (tGrow > spine.getLastKnot())
 		  tGrow = spine.getLastKnot();  
 		cout << "Growing envelope to " << tGrow << endl;
+		postEnvelopeEdit();
 		break;
   case 'G':     if (tGrow > .2) 
                   tGrow -= .1;                        // backwards
 		cout << "Shrinking envelope to " << tGrow << endl;
+		postEnvelopeEdit();
 		break;
   default:                                                  break;
   }
@@ -513,7 +597,8 @@ void menuOb (int value)
   case 100:     DRAWOBSTACLE        = !DRAWOBSTACLE;        break;
   case 101:     tGrow += .1;                           // animate the envelope growth 
                 if (tGrow > spine.getLastKnot())
-		  tGrow = spine.getLastKnot();              break;
+		  tGrow = spine.getLastKnot();  
+		postEnvelopeEdit();                         break;
   case 103:     DRAWSELFINNER       = !DRAWSELFINNER;       break;
   case 104:     DRAWLATEALL         = !DRAWLATEALL;         break;
   default:   					            break;
@@ -552,14 +637,18 @@ void inputCurves (char *file, Array<BezierCurve2f> &obstacle)
 
 /******************************************************************************
 	Compute clipped tangential a/b-curves.
+	If moved != -1, only recompute those of obstacle moved.
 ******************************************************************************/
 
-void buildTangentialCurves (Array<BezierCurve2f> &obstacle)
+void buildTangentialCurves (Array<BezierCurve2f>   &obstacle,
+			    Array<TangentialCurve> &obduala,
+			    Array<TangentialCurve> &obdualb, int moved=-1)
 {
   cout << "Building tangential curves" << endl;
-  obduala.allocate(obstacle.getn());  obdualb.allocate(obstacle.getn());
+  if (moved == -1) { obduala.allocate(obstacle.getn());  obdualb.allocate(obstacle.getn()); }
   for (int i=0; i<obstacle.getn(); i++)	
    {
+    if (moved != -1 && i != moved) continue;
     obduala[i].createA(obstacle[i], i);
 // cout << "obduala[" << i << "]:" << endl;  obduala[i].print();    
     obdualb[i].createB(obstacle[i], i);
@@ -573,30 +662,29 @@ void buildTangentialCurves (Array<BezierCurve2f> &obstacle)
 	(i.e., light first so that index1 and param1 of CommonTangent
 	refer to the point of bitangency with the light):
 	this is needed in outer.
+	If moved != -1, bitang is kept and only the pairs involving 
+	obstacle moved (its row and column) are recomputed.
 ******************************************************************************/
 
 void buildBitangent      (Array<TangentialCurve> &obduala,
 		          Array<TangentialCurve> &obdualb,
 		          float epsIntersect, float featureSize,
-		          Array<UmbralBitangArr> &bitang)
+		          Array<UmbralBitangArr> &bitang, int moved=-1)
 {
   cout << "Building bitangents" << endl;    
   CommonTangentArr bitangA;	// bitangents from a-space 
   CommonTangentArr bitangB;	// bitangents from b-space 
   CommonTangentArr bitangAB;    // bitangents from both dual spaces
-  bitang.allocate(nOb*nOb);
+  if (moved == -1) bitang.allocate(nOb*nOb);
   for (int i=0; i<nOb; i++)
     for (int j=i+1; j<nOb; j++)		// bitangents between i and j
      {
+      if (moved != -1 && i != moved && j != moved) continue;
        cout << "Computing bitangents between " << i << " and " << j << endl;
       obduala[i].intersect (obduala[j], bitangA, epsIntersect);
       obdualb[i].intersect (obdualb[j], bitangB, epsIntersect); 
-      bitangAB.allocate (bitangA.getn() + bitangB.getn());
+      mergeCommonTangent (bitangA, bitangB, featureSize, bitangAB);
       int k;
-      for (k=0; k<bitangA.getn(); k++)  bitangAB[k] = bitangA[k];
-      for (k=0; k<bitangB.getn(); k++)  bitangAB[bitangA.getn() + k] = bitangB[k];
-      IntArr foo; 	bitangAB.bubbleSort (foo);
-      bitangAB.deleteApproxDuplicate(featureSize);
       bitang[i*nOb+j].allocate(bitangAB.getn());
       for (k=0; k<bitangAB.getn(); k++) bitang[i*nOb+j][k] = bitangAB[k];
 cout << "Bitangents from obstacle " << i << " to obstacle " << j << ":" << endl;
@@ -606,48 +694,52 @@ cout << "Bitangents from obstacle " << i << " to obstacle " << j << ":" << endl;
 
 /******************************************************************************
 	Intersect tangential curves to find self-bitangents.
+	If moved != -1, only recompute those of obstacle moved.
 ******************************************************************************/
 
 void buildSelfBitangent  (Array<TangentialCurve> &obduala,
 		          Array<TangentialCurve> &obdualb,
 		          float epsIntersect, float featureSize,
-		          Array<UmbralBitangArr> &selfbitang)
+		          Array<UmbralBitangArr> &selfbitang, int moved=-1)
 {
   cout << "Building self-bitangents" << endl;
   int i,j;
   CommonTangentArr bitangA;	// selfbitangents from a-space 
   CommonTangentArr bitangB;	// selfbitangents from b-space 
-  selfbitang.allocate(nOb);     // one set of self-bitangents per curve
+  CommonTangentArr bitangAB;	// sorted selfbitangents from both spaces
+  if (moved == -1) selfbitang.allocate(nOb);     // one set of self-bitangents per curve
 
      // self-intersect tangential curves to find bitangents
   for (i=0; i<nOb; i++)
    {
+    if (moved != -1 && i != moved) continue;
     obduala[i].selfIntersect (bitangA, epsIntersect);
     obdualb[i].selfIntersect (bitangB, epsIntersect);
-    selfbitang[i].allocate(bitangA.getn() + bitangB.getn());
-    for (j=0; j<bitangA.getn(); j++) selfbitang[i][j] = bitangA[j];
-    for (j=0; j<bitangB.getn(); j++) selfbitang[i][bitangA.getn() + j] = bitangB[j];
-    IntArr foo;  selfbitang[i].bubbleSort (foo);
-    selfbitang[i].deleteApproxDuplicate (featureSize);
+    mergeCommonTangent (bitangA, bitangB, featureSize, bitangAB);
+    selfbitang[i].allocate(bitangAB.getn());
+    for (j=0; j<bitangAB.getn(); j++) selfbitang[i][j] = bitangAB[j];
    }
 }
 
 /******************************************************************************
 	Filter bitangents down to outer bitangents.
 	Only compute between each obstacle and light, not between obstacles.
+	If dirty != NULL, outer is kept and only obstacles i with 
+	(*dirty)[i] are recomputed.
 ******************************************************************************/
 
 void buildOuterBitang  (Array<UmbralBitangArr> &bitang,
 			Array<BezierCurve2f>   &obstacle,
 			float epsIntersect, float closeEps, float featureSize, 
 			float sameSideEps,
-			Array<UmbralBitangArr> &outer)
+			Array<UmbralBitangArr> &outer, IntArr *dirty=NULL)
 {  
   cout << "Building outer bitangents" << endl;    
   int i,j;
-  outer.allocate(nOb); 
+  if (!dirty) outer.allocate(nOb); 
   for (i=1; i<nOb; i++)				// each obstacle
    {
+    if (dirty && !(*dirty)[i]) continue;
     outer[i].allocate(10); // arbitrarily assume 10 is the limit
     int npo=0;  V2f umbraOb, umbraExtreme; int ob; float tOb;
     for (j=0; j<bitang[i].getn(); j++)	// each bitangent from light to obstacle
@@ -686,19 +778,22 @@ void buildOuterBitang  (Array<UmbralBitangArr> &bitang,
 /******************************************************************************
 	Filter selfbitangents down to self-inner bitangents.
 	Only compute for non-light obstacles.
+	If dirty != NULL, selfinner is kept and only obstacles i with 
+	(*dirty)[i] are recomputed.
 ******************************************************************************/
 
 void buildSelfInnerBitang (Array<UmbralBitangArr> &selfbitang,
 			   Array<BezierCurve2f>   &obstacle,
 			   float epsIntersect, float featureSize, 
 			   float sameSideEps,
-			   Array<UmbralBitangArr> &selfinner)
+			   Array<UmbralBitangArr> &selfinner, IntArr *dirty=NULL)
 {  
   cout << "Building self-inner bitangents" << endl;    
   int i,j;
-  selfinner.allocate(nOb); 
+  if (!dirty) selfinner.allocate(nOb); 
   for (i=1; i<nOb; i++)			// each non-distinguished obstacle
    {
+    if (dirty && !(*dirty)[i]) continue;
      selfinner[i].allocate(10);  // assume arbitrarily that there are no more than 10
      int npbi=0; V2f umbraOb, umbraExtreme; int ob; float tOb;
      for (j=0; j<selfbitang[i].getn(); j++)
@@ -1013,6 +1108,7 @@ void outerSweep (Array<UmbralBitangArr> &outer,
 
   -> outerpierce:   outer piercing bitangents
   -> innerpierce:   inner piercing bitangents
+  -> outer:         outer          bitangents
   -> inner:         inner          bitangents
   -> sweptInner:    bitangents generated from inner sweep;
                     necessary if front umbra merges with back umbra; 
@@ -1025,6 +1121,7 @@ void outerSweep (Array<UmbralBitangArr> &outer,
 
 void innerPiercingSweep (Array<UmbralBitangArr> &outerpierce,
 			 Array<UmbralBitangArr> &innerpierce,
+			 Array<UmbralBitangArr> &outer,
 			 Array<UmbralBitangArr> &inner,
 			 Array<UmbralBitangArr> &sweptInner,
 			 Array<BezierCurve2f>   &obstacle,
@@ -1307,24 +1404,25 @@ void defineRoom (float radiusRoom, Polygon2f &room)
   The incorrect segment is found by casting a ray from the light to the obstacle.
 ******************************************************************************/
 
-void defineBackUmbra (Array<UmbralBitangArr> &ut, Array<Polygon2f> &backUmbra, 
-		      float epsIntersect, float sameSideEps)
+void defineBackUmbra (Array<UmbralBitangArr> &ut, Array<BezierCurve2f> &obstacle,
+		      BezierBatch *obBatch, Array<Polygon2f> &backUmbra, 
+		      float epsIntersect, float sameSideEps, IntArr *dirty=NULL)
 {
   cout << endl << "Building local back umbra" << endl;
-  int i,j;
-  backUmbra.allocate(nOb);
+  int i;
+  if (!dirty) backUmbra.allocate(nOb);
   //  V2f typicalPtOutside;		// typical pt outside present halfspace
   //  obstacle[0].eval (obstacle[0].getKnot(0), typicalPtOutside); // any pt of light
   for (i=1; i<nOb; i++)     // each obstacle has a local umbra
    {
+    if (dirty && !(*dirty)[i]) continue;
     cout << "Obstacle " << i << endl;
     Line2f L;
     // NEW VERSION: WORKS IN ALL CASES, WHETHER A SURROUNDS L OR NOT
-    // allocate more vertices than ever necessary
-    V2fArr backUmbraPt(obstacle[i].getnSample()+1000);
-    backUmbraPt[0] = ut[i][0].umbraExtreme;
-    backUmbraPt[1] = ut[i][0].umbraOb;
-    int nVert = 2;  // vertex count
+    // build the polygon vertex by vertex (no fixed over-allocation)
+    PolygonBuilder pb;  initPolygonBuilder (pb, chordTol/10);
+    addVertex (pb, ut[i][0].umbraExtreme);
+    addVertex (pb, ut[i][0].umbraOb);
 
     // now add curve samples
     V2f hit;  float tHit;  // parameter value of pt on curve segment *not* to be sampled
@@ -1340,30 +1438,24 @@ void defineBackUmbra (Array<UmbralBitangArr> &ut, Array<Polygon2f> &backUmbra,
     obstacle[i].shootRay (ptOnLight, ptOnObstacle, hit, tHit, epsIntersect, epsIntersect);
                         cout << "Got back from shootRay" << endl;
 			cout << "tHit = " << tHit << endl;
-    V2fArr sample;  // curve samples
+    float tFrom, tTo;  // curve segment to be sampled
     if ((ut[i][1].tOb < ut[i][0].tOb && tHit > ut[i][1].tOb && tHit < ut[i][0].tOb) ||
 	(ut[i][1].tOb > ut[i][0].tOb && (tHit > ut[i][1].tOb ||  tHit < ut[i][0].tOb))) 
                                  // wraparound from ut[i][1].tOb to ut[i][0].tOb
 	// tHit is on the segment (ut[i][1].tOb, ut[i][0].tOb) so choose other
-	 obstacle[i].sampleSegment (ut[i][0].tOb, ut[i][1].tOb, sample, .05); // was .01
-    else obstacle[i].sampleSegment (ut[i][1].tOb, ut[i][0].tOb, sample, .05);
-                        cout << "Sample = " << sample << endl;
-    if (backUmbraPt[1].dist (sample[0]) > 
-	backUmbraPt[1].dist (sample[sample.getn()-1]))
-      sample.reverseIt();      // curve was sampled in wrong direction (wrt polygon)
-    if (sample.getn() + 8 > backUmbraPt.getn())
-      {
-	cout << "backUmbraPt needs to be enlarged!" << endl;
-	exit(-1);
-      }
-    for (j=0; j<sample.getn(); j++) backUmbraPt[nVert++] = sample[j];
+         { tFrom = ut[i][0].tOb;  tTo = ut[i][1].tOb; }
+    else { tFrom = ut[i][1].tOb;  tTo = ut[i][0].tOb; }
+    V2f ptFrom, ptTo;  obstacle[i].eval (tFrom, ptFrom);  obstacle[i].eval (tTo, ptTo);
+    int reverse = (ut[i][0].umbraOb.dist (ptFrom) > ut[i][0].umbraOb.dist (ptTo));
+                             // sample in the right direction (wrt polygon)
+    addSegmentAdaptive (pb, obstacle[i], obBatch[i], tFrom, tTo, chordTol, reverse);
                         cout << "Added samples" << endl;
 
-    backUmbraPt[nVert++] = ut[i][1].umbraOb;
+    addVertex (pb, ut[i][1].umbraOb);
     if (ut[i][0].umbraExtreme != ut[i][1].umbraExtreme)
      { // not an umbra closed by an outer bitang intersection (so umbra touches the room)
                         cout << "Walking around the room" << endl;
-      backUmbraPt[nVert++] = ut[i][1].umbraExtreme;
+      addVertex (pb, ut[i][1].umbraExtreme);
 
       // finally, add room vertices between ut[i][1].umbraExtreme & ut[i][0].umbraExtreme
       int iEdge = -1;  // ut[i][1].umbraExtreme lies on [room[iEdge],room[iEdge+1]]
@@ -1390,15 +1482,14 @@ void defineBackUmbra (Array<UmbralBitangArr> &ut, Array<Polygon2f> &backUmbra,
                         cout << "walkingDir = " << walkingDir << endl;
       while (!L.insideLine (ut[i][0].umbraExtreme, .01))
        {
-	backUmbraPt[nVert++] = room[walkingDir == 1 ? (iEdge+1)%room.getn() : iEdge];
-                 	cout << "Added " << backUmbraPt[nVert-1] << endl;
+	addVertex (pb, room[walkingDir == 1 ? (iEdge+1)%room.getn() : iEdge]);
+                 	cout << "Added " << pb.pt[pb.n-1] << endl;
 	if (walkingDir == 1) iEdge = (iEdge+1)%room.getn();
 	else iEdge = mod(iEdge-1, room.getn());
 	L.create (room[iEdge], room[(iEdge+1)%room.getn()]);
        }
      }
-    backUmbraPt.shrink (nVert);
-    backUmbra[i].create (backUmbraPt);
+    buildPolygon (pb, backUmbra[i]);
                         cout << "backUmbra[" << i << "] = " << backUmbra[i] << endl;
     backUmbra[i].triangulate();
    }
@@ -1741,22 +1832,55 @@ defineGlobalFrontUmbra (Array<BezierCurve2f>   &obstacle,
   cout << "Exiting defineGlobalFrontUmbra" << endl;
 }
 
+/******************************************************************************
+	Start U from the input scene: nothing built yet.
+******************************************************************************/
+
+void initUmbraState (UmbraState &U)
+{
+  U.obstacle.allocate (nOb);
+  for (int i=0; i<nOb; i++) U.obstacle[i] = obstacle[i];
+  U.specialHodo.createHodograph (U.obstacle[1]);
+  U.obBatch = NULL;
+  U.built = 0;  U.edit = 0;
+}
+
 /******************************************************************************
 ******************************************************************************/
 
-void buildLocalBackUmbra()
+void buildLocalBackUmbra (UmbraState &U)
 {
+  int i;
+  U.obBox.allocate (nOb);
+  for (i=0; i<nOb; i++) buildObBox (U.obstacle[i], featureSize, U.obBox[i]);
+  if (U.obBatch)			// previous build
+   {
+    for (i=0; i<nOb; i++) freeBezierBatch (U.obBatch[i]);
+    delete [] U.obBatch;
+   }
+  U.obBatch = new BezierBatch[nOb];
+  for (i=0; i<nOb; i++) initCurveBatch (U.obstacle[i], U.obBatch[i]);
   if (level >= 1)
     {
-      buildTangentialCurves (obstacle);
-      buildBitangent     (obduala, obdualb, epsIntersect, featureSize, bitang);  
-      buildSelfBitangent (obduala, obdualb, epsIntersect, featureSize, selfbitang);
+      buildTangentialCurves (U.obstacle, U.obduala, U.obdualb);
+      markStage (umbraTimer, "tangential curves");
+      buildBitangent     (U.obduala, U.obdualb, epsIntersect, featureSize, U.bitang);  
+      markStage (umbraTimer, "bitangents");
+      buildSelfBitangent (U.obduala, U.obdualb, epsIntersect, featureSize, U.selfbitang);
+      markStage (umbraTimer, "self-bitangents");
     }
   if (level >= 2)
-    buildOuterBitang (bitang, obstacle, epsIntersect, closeEps, featureSize, sameSideEps, outer);
+    {
+      buildOuterBitang (U.bitang, U.obstacle, epsIntersect, closeEps, featureSize, sameSideEps, 
+			U.outer);
+      markStage (umbraTimer, "outer bitangents");
+    }
   if (level >= 3)
-    buildSelfInnerBitang (selfbitang, obstacle, epsIntersect, 
-			  featureSize, sameSideEps, selfinner);
+    {
+      buildSelfInnerBitang (U.selfbitang, U.obstacle, epsIntersect, 
+			    featureSize, sameSideEps, U.selfinner);
+      markStage (umbraTimer, "self-inner bitangents");
+    }
   /*
   if (level >= 3)
     buildInnerBitang (bitang, obstacle, epsIntersect, closeEps, featureSize, sameSideEps, inner);
@@ -1766,7 +1890,87 @@ void buildLocalBackUmbra()
     buildInnerPierce (bitang, obstacle, epsIntersect, closeEps, sameSideEps, innerpierce);
   */
   if (level >= 6)
-    defineBackUmbra (outer, localBackUmbra, epsIntersect, sameSideEps);
+    {
+      defineBackUmbra (U.outer, U.obstacle, U.obBatch, U.localBackUmbra, epsIntersect, sameSideEps);
+      markStage (umbraTimer, "local back umbra");
+    }
+}
+
+/******************************************************************************
+	Update the local back umbra after obstacle moved has changed:
+	only its tangential curves, its row and column of the bitangent table
+	and its self-bitangents are recomputed, and only the outer/self-inner 
+	bitangents and local back umbrae that depend on it (see umbraUpdate.h).
+******************************************************************************/
+
+void updateLocalBackUmbra (UmbraState &U, int moved)
+{
+  int i;
+  ObBox oldBox = U.obBox[moved];
+  buildObBox (U.obstacle[moved], featureSize, U.obBox[moved]);
+  freeBezierBatch (U.obBatch[moved]);  initCurveBatch (U.obstacle[moved], U.obBatch[moved]);
+  if (level >= 1)
+    {
+      buildTangentialCurves (U.obstacle, U.obduala, U.obdualb, moved);
+      buildBitangent     (U.obduala, U.obdualb, epsIntersect, featureSize, U.bitang, moved);  
+      buildSelfBitangent (U.obduala, U.obdualb, epsIntersect, featureSize, U.selfbitang, moved);
+    }
+  if (level < 2) return;
+  IntArr dirty(nOb), dirtySelf(nOb);	// umbral bitangents depending on moved
+  dirty[0] = dirtySelf[0] = 0;
+  for (i=1; i<nOb; i++)
+   {
+    dirty[i]     = umbraDepends (i, moved, U.bitang[i],     U.obstacle, oldBox, 
+				 U.obBox[moved], radiusRoom);
+    dirtySelf[i] = umbraDepends (i, moved, U.selfbitang[i], U.obstacle, oldBox, 
+				 U.obBox[moved], radiusRoom);
+   }
+  buildOuterBitang (U.bitang, U.obstacle, epsIntersect, closeEps, featureSize, sameSideEps, 
+		    U.outer, &dirty);
+  if (level >= 3)
+    buildSelfInnerBitang (U.selfbitang, U.obstacle, epsIntersect, 
+			  featureSize, sameSideEps, U.selfinner, &dirtySelf);
+  if (level >= 6)
+    defineBackUmbra (U.outer, U.obstacle, U.obBatch, U.localBackUmbra, epsIntersect, sameSideEps, 
+		     &dirty);
+}
+
+/******************************************************************************
+	Bring the umbra U up to date with the envelope grown to tGrow.
+	With INCREMENTAL, U is built once, and thereafter only
+	updated (for the dynamic obstacle) when the envelope has changed;
+	otherwise it is rebuilt every time.
+******************************************************************************/
+
+void refreshLocalBackUmbra (UmbraState &U, float tGrow)
+{
+  int moved = (DYNAMICSPINE ? 1 : (OTHERDYNAMICSPINE ? 0 : -1));
+  if (INCREMENTAL && U.built && (moved == -1 || tGrow == U.tBuilt)) return;  // up to date
+  if (moved != -1)
+    {
+      // build next envelope of spine
+      spine.buildEnvelope (spine.getKnot(0), tGrow, delta, R, U.obstacle[moved]);
+      U.specialHodo.createHodograph (U.obstacle[moved]);
+    }
+  if (INCREMENTAL && U.built) updateLocalBackUmbra (U, moved);
+  else                        buildLocalBackUmbra (U);
+  U.built = 1;  U.tBuilt = tGrow;
+}
+
+/******************************************************************************
+	Compute thread: bring the next umbra up to date with the newest 
+	envelope edit and publish it.  Edits posted in the meantime replace
+	each other in envelopeEdit, so only the newest is computed next.
+******************************************************************************/
+
+void umbraStep (void *arg)
+{
+  if (!takeSlot (envelopeEdit)) return;	// newest edit already computed
+  UmbraEdit  &e = readSlot  (envelopeEdit);
+  UmbraState &U = writeSlot (umbra);
+  refreshLocalBackUmbra (U, e.tGrow);
+  U.edit = e.edit;
+  publishSlot (umbra);
 }
 
 /******************************************************************************/
@@ -1834,21 +2038,16 @@ void displayOb ()
   glScalef  (zoomob, zoomob, zoomob);
 //glPolygonMode (GL_FRONT_AND_BACK, GL_LINE);
 
-  if (DYNAMICSPINE)
-    {
-      // build next envelope of spine
-      spine.buildEnvelope (spine.getKnot(0), tGrow, delta, R, obstacle[1]);
-      specialHodo.createHodograph (obstacle[1]);
-      buildLocalBackUmbra();
-    } 
-  else if (OTHERDYNAMICSPINE)
-    {
-      spine.buildEnvelope (spine.getKnot(0), tGrow, delta, R, obstacle[0]);
-      specialHodo.createHodograph (obstacle[0]);
-      buildLocalBackUmbra();
-    }
-  else
-    buildLocalBackUmbra ();
+  if (SYNCHRONOUS) refreshLocalBackUmbra (readSlot (umbra), tGrow);
+  else             takeSlot (umbra);	// newest umbra from the compute thread, if any
+  UmbraState             &U              = readSlot (umbra);
+  Array<BezierCurve2f>   &obstacle       = U.obstacle;
+  Array<UmbralBitangArr> &bitang         = U.bitang;
+  Array<UmbralBitangArr> &selfbitang     = U.selfbitang;
+  Array<UmbralBitangArr> &outer          = U.outer;
+  Array<UmbralBitangArr> &selfinner      = U.selfinner;
+  Array<Polygon2f>       &localBackUmbra = U.localBackUmbra;
+  BezierCurve2f          &specialHodo    = U.specialHodo;
   
   glColor3fv (Red);			// bounding room
   room.draw(1);
@@ -2273,13 +2472,49 @@ void displayOb ()
   //  glutPostRedisplay();	// to keep animation running in both windows
 }
 
+/******************************************************************************
+	Read the scene in file.
+******************************************************************************/
+
+void readScene (char *file)
+{
+  startTimer (umbraTimer);
+	cout << "Inputting curves" << endl;    
+  inputCurves(file, obstacle);
+  if (DYNAMICSPINE)           { spine = obstacle[1]; tGrow = spine.getKnot(0) + .2; }
+  else if (OTHERDYNAMICSPINE) { spine = obstacle[0]; tGrow = spine.getKnot(0) + .2; }
+  assert (specialUmb == 0 || specialUmb == 1);
+	cout << "Creating hodographs" << endl;    
+  lightHodo.createHodograph   (obstacle[0]);
+  markStage (umbraTimer, "input");
+}
+
+/******************************************************************************
+	Headless: compute the local back umbra of the scene in file 
+	(for the initial envelope, if dynamic) and write the bitangents, 
+	back umbrae and timings (see umbraBatch.h).
+******************************************************************************/
+
+int batchScene (char *file)
+{
+  readScene (file);
+  UmbraState U;  initUmbraState (U);
+  refreshLocalBackUmbra (U, tGrow);
+  if (level < 1) U.bitang.allocate (nOb*nOb);
+  UmbraRegion region[1] = {{"localBackUmbra", &U.localBackUmbra, 1}};
+  return writeUmbra (file, outputFormat, nOb, U.bitang, (level >= 6 ? 1 : 0), region, 
+		     umbraTimer);
+}
+
 /******************************************************************************
 ******************************************************************************/
 
 int main (int argc, char **argv)
 {
-  int       i;
   int       ArgsParsed=0;
+  char    **scene = new char*[argc];	// scene files
+  int       nScene=0;
+  int       nJob = nProcessor();	// # cores, one per scene computed in parallel (batch)
 
   RoutineName = argv[ArgsParsed++];
   if (argc == 1) { usage(); exit(-1); }
@@ -2304,23 +2539,33 @@ int main (int argc, char **argv)
       case 't': COMPUTETANGONLY=1;                              break;
       case 'u': specialUmb = atoi (argv[ArgsParsed++]);		break;
       case 'w': SURROUND=1;                                     break;
+      case 'x': INCREMENTAL=0;                                  break;
+      case 's': SYNCHRONOUS=1;                                  break;
+      case 'C': chordTol = atof(argv[ArgsParsed++]);            break;
+      case 'b': BATCH=1;                                        break;
+      case 'o': outputFormat = (strcmp(argv[ArgsParsed++], "bin") == 0 
+				? UMBRABINARY : UMBRAJSON);     break;
+      case 'j': nJob = atoi(argv[ArgsParsed++]);
+	        if (nJob < 1) { usage(); exit(-1); }            break;
       case 'h': 
       default:	usage(); exit(-1);				break;
       }
-   else ArgsParsed++;
+   else scene[nScene++] = argv[ArgsParsed++];
   }
 
   if (closeEps == -1)  closeEps = .1/radiusRoom;  // not set by 'c' parameter
         cout << "closeEps = " << closeEps << endl;
   defineRoom (radiusRoom, room);
-	cout << "Inputting curves" << endl;    
-  inputCurves(argv[argc-1], obstacle);
-  if (DYNAMICSPINE)           { spine = obstacle[1]; tGrow = spine.getKnot(0) + .2; }
-  else if (OTHERDYNAMICSPINE) { spine = obstacle[0]; tGrow = spine.getKnot(0) + .2; }
-  assert (specialUmb == 0 || specialUmb == 1);
-	cout << "Creating hodographs" << endl;    
-  lightHodo.createHodograph   (obstacle[0]);
-  specialHodo.createHodograph (obstacle[1]);
+  if (BATCH)
+   {
+    if (nScene == 0) { usage(); exit(-1); }
+    exit (batchRun (nScene, scene, (nJob < nScene ? nJob : nScene), batchScene));
+   }
+  readScene (argv[argc-1]);
+  initLatestSlot (umbra);  initLatestSlot (envelopeEdit);
+  for (int k=0; k<3; k++) initUmbraState (umbra.slot[k]);
+  refreshLocalBackUmbra (readSlot (umbra), tGrow);	// first umbra, before display
+  if (!SYNCHRONOUS) startComputeThread (umbraThread, umbraStep, NULL);
 
   /************************************************************/
 
@@ -0,0 +1,269 @@
+/*
+  File:          fragStitch.h
+  Created:	 17 October 2026
+  Purpose:       Stitch curve fragments (e.g., the pieces of a silhouette
+                 traced in the three dual spaces) into curves, in one pass.
+		 The endpoints of the open fragments are bucketed in a hash
+		 grid of cell size tol, so every pair of endpoints closer than
+		 tol is found among neighbouring cells.  The pairs are sorted
+		 by distance and joined greedily, closest first: a pair is
+		 joined if both of its endpoints are still free; a pair that
+		 joins the two ends of one chain closes it.  This is the
+		 result of splicing the closest pair of ends repeatedly
+		 (PatchIntersection::spliceClosest), in O(n log n) rather
+		 than a rescan of every endpoint per splice.
+		 Stitching gives a plan (fragments of each curve, in order,
+		 and which run backwards), which may be applied to any set of
+		 fragments in one-to-one correspondence with those stitched:
+		 the directrices of a bitangent developable on the second
+		 surface follow the stitching of those on the first.
+		 Fragments that are already closed are left alone.  Where two
+		 fragments meet, the first point of the second is dropped if
+		 it lies within tol of the last point of the first.
+  Usage:	 StitchFrags F;  readFrags (silhouette, F);
+  		 StitchPlan P;  planStitch (F, 10*epsInt, P);
+		 StitchCurves C;  applyStitch (P, F, C);
+		 ... C.nCurve, C.nPt[i], C.closed[i], stitchPt (C, i, k) ...
+		 freeStitchCurves (C);  freeStitchPlan (P);  freeFrags (F);
+*/
+
+#ifndef _FRAGSTITCH_H_
+#define _FRAGSTITCH_H_
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+struct StitchFrags		// fragments, as read from a PatchIntersection
+{
+  int    n;
+  int   *nPt, *closed;
+  int   *start;			// first point of each fragment in pt
+  float *pt;			// xyz of every point, fragment after fragment
+};
+
+struct StitchPlan
+{
+  int    nCurve;
+  int   *first;			// first entry of each curve in frag and rev
+  int   *nFrag;			// fragments in each curve
+  int   *closed;
+  int   *frag;			// fragments of all curves, in order
+  char  *rev;			// fragment runs backwards?
+  char  *skip;			// first point of fragment dropped (duplicate)?
+};
+
+struct StitchCurves		// same layout as StitchFrags
+{
+  int    nCurve;
+  int   *nPt, *closed;
+  int   *start;
+  float *pt;
+};
+
+struct StitchPair		// endpoints a and b (2*fragment + end) closer than tol
+{
+  float  d;
+  int    a, b;
+};
+
+static inline float *stitchPt (StitchCurves &C, int i, int k)	{ return C.pt + 3*(C.start[i]+k); }
+
+/******************************************************************************
+	Read the curves of iCurve as fragments.
+******************************************************************************/
+
+static void readFrags (PatchIntersection &iCurve, StitchFrags &F)
+{
+  int i, k, m=0;
+  F.n      = iCurve.getnCurve();
+  F.nPt    = new int[F.n];  F.closed = new int[F.n];  F.start = new int[F.n];
+  for (i=0; i<F.n; i++)
+   {
+    F.nPt[i] = iCurve.getnPt(i);  F.closed[i] = iCurve.getClosed(i);
+    F.start[i] = m;  m += F.nPt[i];
+   }
+  F.pt = new float[3*m];
+  for (i=0; i<F.n; i++)
+    for (k=0; k<F.nPt[i]; k++)
+     {
+      V3f p;  iCurve.getPt (i, k, p);
+      float *q = F.pt + 3*(F.start[i]+k);
+      q[0] = p[0];  q[1] = p[1];  q[2] = p[2];
+     }
+}
+
+static void freeFrags (StitchFrags &F)
+{
+  delete [] F.nPt;  delete [] F.closed;  delete [] F.start;  delete [] F.pt;
+}
+
+static void freeStitchPlan (StitchPlan &P)
+{
+  delete [] P.first;  delete [] P.nFrag;  delete [] P.closed;
+  delete [] P.frag;   delete [] P.rev;    delete [] P.skip;
+}
+
+static void freeStitchCurves (StitchCurves &C)
+{
+  delete [] C.nPt;  delete [] C.closed;  delete [] C.start;  delete [] C.pt;
+}
+
+/******************************************************************************/
+/******************************************************************************/
+
+static inline float *fragEnd (StitchFrags &F, int e)	// endpoint e = 2*fragment + end
+{
+  int i = e/2;
+  return F.pt + 3*(F.start[i] + (e%2 ? F.nPt[i]-1 : 0));
+}
+
+static inline unsigned stitchCell (int x, int y, int z, unsigned size)
+{
+  return ((unsigned) x * 73856093u ^ (unsigned) y * 19349663u ^ (unsigned) z * 83492791u) % size;
+}
+
+static int compareStitchPair (const void *a, const void *b)
+{
+  float d = ((StitchPair *) a)->d - ((StitchPair *) b)->d;
+  return (d < 0 ? -1 : (d > 0 ? 1 : 0));
+}
+
+/******************************************************************************
+	Plan the stitching of the fragments of F at tolerance tol.
+******************************************************************************/
+
+static void planStitch (StitchFrags &F, float tol, StitchPlan &P)
+{
+  int i, e, k, nEnd = 2*F.n;
+  if (tol <= 0) tol = 1e-30;
+  // hash grid of the endpoints of open fragments
+  unsigned size = (nEnd > 0 ? 2*nEnd : 1);
+  int *head = new int[size], *next = new int[nEnd > 0 ? nEnd : 1];
+  int *cell = new int[3*(nEnd > 0 ? nEnd : 1)];
+  for (k=0; k<(int) size; k++) head[k] = -1;
+  for (e=0; e<nEnd; e++)
+   {
+    if (F.closed[e/2] || F.nPt[e/2] == 0) continue;
+    float *p = fragEnd (F, e);
+    for (k=0; k<3; k++) cell[3*e+k] = (int) floor (p[k] / tol);
+    unsigned h = stitchCell (cell[3*e], cell[3*e+1], cell[3*e+2], size);
+    next[e] = head[h];  head[h] = e;
+   }
+  // pairs of endpoints closer than tol, from neighbouring cells
+  int nPair=0, maxPair = (nEnd > 0 ? nEnd : 1);
+  StitchPair *pair = new StitchPair[maxPair];
+  for (e=0; e<nEnd; e++)
+   {
+    if (F.closed[e/2] || F.nPt[e/2] == 0) continue;
+    float *p = fragEnd (F, e);
+    for (int dx=-1; dx<=1; dx++)
+      for (int dy=-1; dy<=1; dy++)
+        for (int dz=-1; dz<=1; dz++)
+	  for (int f=head[stitchCell (cell[3*e]+dx, cell[3*e+1]+dy, cell[3*e+2]+dz, size)]; f!=-1; f=next[f])
+	   {
+	    if (f <= e || (f/2 == e/2 && F.nPt[e/2] < 3)) continue;	// each pair once; no 2-point loops
+	    if (abs (cell[3*f]-cell[3*e]-dx) + abs (cell[3*f+1]-cell[3*e+1]-dy) +
+	        abs (cell[3*f+2]-cell[3*e+2]-dz)) continue;		// hash collision
+	    float *q = fragEnd (F, f);
+	    float d = sqrt ((p[0]-q[0])*(p[0]-q[0]) + (p[1]-q[1])*(p[1]-q[1]) + (p[2]-q[2])*(p[2]-q[2]));
+	    if (d > tol) continue;
+	    if (nPair == maxPair)
+	     {
+	      StitchPair *bigger = new StitchPair[2*maxPair];
+	      memcpy (bigger, pair, nPair*sizeof(StitchPair));
+	      delete [] pair;  pair = bigger;  maxPair *= 2;
+	     }
+	    pair[nPair].d = d;  pair[nPair].a = e;  pair[nPair++].b = f;
+	   }
+   }
+  qsort (pair, nPair, sizeof(StitchPair), compareStitchPair);
+  // join greedily, closest first; chain ends tracked by union of fragments
+  int *link  = new int[nEnd > 0 ? nEnd : 1];	// endpoint joined to (-1: free)
+  int *chain = new int[F.n > 0 ? F.n : 1];	// union-find over fragments
+  int *loop  = new int[F.n > 0 ? F.n : 1];	// chain closed (by root)?
+  for (e=0; e<nEnd; e++) link[e] = -1;
+  for (i=0; i<F.n; i++) { chain[i] = i;  loop[i] = 0; }
+  for (k=0; k<nPair; k++)
+   {
+    int a = pair[k].a, b = pair[k].b;
+    if (link[a] != -1 || link[b] != -1) continue;
+    int ra = a/2, rb = b/2;
+    while (chain[ra] != ra) ra = chain[ra] = chain[chain[ra]];
+    while (chain[rb] != rb) rb = chain[rb] = chain[chain[rb]];
+    if (loop[ra] || loop[rb]) continue;
+    link[a] = b;  link[b] = a;
+    if (ra == rb) loop[ra] = 1;		// two free ends of one chain: close it
+    else chain[ra] = rb;
+   }
+  // walk the chains: open ones from a free end, then the loops
+  P.first = new int[F.n+1];  P.nFrag = new int[F.n+1];  P.closed = new int[F.n+1];
+  P.frag  = new int[F.n+1];  P.rev   = new char[F.n+1]; P.skip   = new char[F.n+1];
+  char *seen = new char[F.n > 0 ? F.n : 1];
+  for (i=0; i<F.n; i++) seen[i] = 0;
+  int m=0;
+  P.nCurve = 0;
+  for (int pass=0; pass<2; pass++)
+    for (e=0; e<nEnd; e++)
+     {
+      if (seen[e/2] || (pass == 0 && link[e] != -1)) continue;
+      if (F.nPt[e/2] == 0) { seen[e/2] = 1;  continue; }
+      int c = P.nCurve++;
+      P.first[c] = m;  P.nFrag[c] = 0;
+      P.closed[c] = (pass == 1 || F.closed[e/2]);
+      int at = e;			// entering fragment at/2 at endpoint at
+      while (!seen[at/2])
+       {
+        seen[at/2] = 1;
+	P.frag[m] = at/2;  P.rev[m] = at%2;  P.skip[m] = 0;
+	if (P.nFrag[c] > 0)
+	 {
+	  float *p = fragEnd (F, link[at]), *q = fragEnd (F, at);
+	  P.skip[m] = ((p[0]-q[0])*(p[0]-q[0]) + (p[1]-q[1])*(p[1]-q[1]) + (p[2]-q[2])*(p[2]-q[2]) <= tol*tol);
+	 }
+	m++;  P.nFrag[c]++;
+	int out = at ^ 1;		// leave by the other end
+	if (link[out] == -1) break;
+	at = link[out];
+       }
+      if (pass == 1)			// closing join
+       {
+        float *p = fragEnd (F, P.frag[m-1]*2 + !P.rev[m-1]), *q = fragEnd (F, e);
+	P.skip[P.first[c]] = ((p[0]-q[0])*(p[0]-q[0]) + (p[1]-q[1])*(p[1]-q[1]) +
+			      (p[2]-q[2])*(p[2]-q[2]) <= tol*tol);
+       }
+     }
+  delete [] head;  delete [] next;  delete [] cell;  delete [] pair;
+  delete [] link;  delete [] chain; delete [] loop;  delete [] seen;
+}
+
+/******************************************************************************
+	Stitch F (the fragments planned, or fragments in one-to-one
+	correspondence with them) into C, following P.
+******************************************************************************/
+
+static void applyStitch (StitchPlan &P, StitchFrags &F, StitchCurves &C)
+{
+  int i, j, k, m=0;
+  C.nCurve = P.nCurve;
+  C.nPt    = new int[P.nCurve+1];  C.closed = new int[P.nCurve+1];  C.start = new int[P.nCurve+1];
+  for (i=0; i<F.n; i++) m += F.nPt[i];
+  C.pt = new float[3*m+1];
+  m = 0;
+  for (i=0; i<P.nCurve; i++)
+   {
+    C.start[i] = m;  C.closed[i] = P.closed[i];
+    for (j=P.first[i]; j<P.first[i]+P.nFrag[i]; j++)
+     {
+      int f = P.frag[j], n = F.nPt[f];
+      for (k=P.skip[j]; k<n; k++)
+       {
+        float *p = F.pt + 3*(F.start[f] + (P.rev[j] ? n-1-k : k));
+	C.pt[3*m] = p[0];  C.pt[3*m+1] = p[1];  C.pt[3*m+2] = p[2];  m++;
+       }
+     }
+    C.nPt[i] = m - C.start[i];
+   }
+}
+
+#endif
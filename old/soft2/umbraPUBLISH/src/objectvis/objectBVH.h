@@ -0,0 +1,229 @@
+/*
+  File:          objectBVH.h
+  Created:	 17 October 2026
+  Purpose:       Bounding volume hierarchy over the objects of a scene,
+                 for the global probes of firstObjectHit.
+		 The hierarchy is built once per scene (median split on the
+		 longer axis of the box centres) and traversed front to back
+		 along the probe: a subtree is only visited if the probe enters
+		 its box before the first hit found so far, so the exact (and
+		 expensive) probe/curve intersection is only computed for
+		 the few objects near the probe, nearest first.
+		 Object boxes are built from the display samples, padded by
+		 half the longest chord between samples plus epsInt
+		 (a cubic segment sampled this densely strays less than this
+		 from its chords).
+  Usage:	 ObjectBVH bvh;  buildObjectBVH (obstacle, epsInt, bvh);
+  		 ObjectBVHCursor c;  startProbe (bvh, probe, c);
+		 while ((i = nextProbeObject (bvh, c, sBest)) != -1) ...
+*/
+
+#ifndef _OBJECTBVH_H_
+#define _OBJECTBVH_H_
+
+#include <math.h>
+#include <stdlib.h>		// qsort
+
+struct ObjectBVHNode
+{
+  float min[2], max[2];		// bounding box of subtree
+  int   left, right;		// children (internal node)
+  int   object;			// object index (leaf), -1 for internal node
+};
+
+struct ObjectBVH
+{
+  Array<BezierCurve2f> *object;	// objects indexed (NULL if not built)
+  int                   nObject;
+  ObjectBVHNode        *node;	// node[0] is the root
+  int                   nNode;
+};
+
+struct ObjectBVHCursor		// state of a front-to-back traversal along a probe
+{
+  V2f    P, d;			// probe is P + s d, 0 <= s <= 1
+  int   *stack;			// nodes still to visit ...
+  float *sEnter;		// ... and where the probe enters them
+  int    nStack;
+};
+
+/******************************************************************************/
+/******************************************************************************/
+
+struct ObjectBVHKeyed		// an object index with its sort key (box centre)
+{
+  float key;
+  int   index;
+};
+
+static int compareObjectBVHKeyed (const void *a, const void *b)
+{
+  float ka = ((const ObjectBVHKeyed *) a)->key, kb = ((const ObjectBVHKeyed *) b)->key;
+  return (ka < kb ? -1 : (ka > kb ? 1 : 0));
+}
+
+/******************************************************************************
+	Build the subtree over objects index[lo..hi-1], whose boxes are
+	box[i] (4 floats: xmin,ymin,xmax,ymax); returns its root.
+******************************************************************************/
+
+static int buildObjectBVHNode (ObjectBVH &bvh, float *box, int *index, int lo, int hi)
+{
+  int i, c, n = bvh.nNode++;
+  ObjectBVHNode &nd = bvh.node[n];
+  nd.min[0] = nd.min[1] =  1e30;  nd.max[0] = nd.max[1] = -1e30;
+  for (i=lo; i<hi; i++)
+    for (c=0; c<2; c++)
+     {
+      if (box[4*index[i]+c]   < nd.min[c]) nd.min[c] = box[4*index[i]+c];
+      if (box[4*index[i]+2+c] > nd.max[c]) nd.max[c] = box[4*index[i]+2+c];
+     }
+  if (hi - lo == 1) { nd.object = index[lo];  nd.left = nd.right = -1;  return n; }
+
+  int axis = (nd.max[0] - nd.min[0] >= nd.max[1] - nd.min[1] ? 0 : 1);
+  ObjectBVHKeyed *keyed = new ObjectBVHKeyed[hi-lo];	// sort by box centre
+  for (i=lo; i<hi; i++)
+   {
+    keyed[i-lo].key   = (box[4*index[i]+axis] + box[4*index[i]+2+axis]) / 2;
+    keyed[i-lo].index = index[i];
+   }
+  qsort (keyed, hi-lo, sizeof(ObjectBVHKeyed), compareObjectBVHKeyed);
+  for (i=lo; i<hi; i++) index[i] = keyed[i-lo].index;
+  delete [] keyed;
+  int mid = (lo + hi) / 2;
+  int left  = buildObjectBVHNode (bvh, box, index, lo,  mid);
+  int right = buildObjectBVHNode (bvh, box, index, mid, hi);
+  bvh.node[n].object = -1;  bvh.node[n].left = left;  bvh.node[n].right = right;
+  return n;
+}
+
+/******************************************************************************
+	Build the hierarchy over the objects (which must have display samples).
+******************************************************************************/
+
+void buildObjectBVH (Array<BezierCurve2f> &object, float epsInt, ObjectBVH &bvh)
+{
+  int i, j, c;
+  bvh.object  = &object;
+  bvh.nObject = object.getn();
+  bvh.nNode   = 0;
+  bvh.node    = new ObjectBVHNode[2*bvh.nObject + 1];
+  if (bvh.nObject == 0) return;
+  float *box   = new float[4*bvh.nObject];
+  int   *index = new int[bvh.nObject];
+  for (i=0; i<bvh.nObject; i++)
+   {
+    V2f pt, prev;  float maxChord = 0;
+    object[i].getSample (0, pt);
+    for (c=0; c<2; c++) box[4*i+c] = box[4*i+2+c] = pt[c];
+    for (j=1; j<object[i].getnSample(); j++)
+     {
+      prev = pt;  object[i].getSample (j, pt);
+      if (pt.dist (prev) > maxChord) maxChord = pt.dist (prev);
+      for (c=0; c<2; c++)
+       {
+	if (pt[c] < box[4*i+c])   box[4*i+c]   = pt[c];
+	if (pt[c] > box[4*i+2+c]) box[4*i+2+c] = pt[c];
+       }
+     }
+    for (c=0; c<2; c++)
+     { box[4*i+c] -= maxChord/2 + epsInt;  box[4*i+2+c] += maxChord/2 + epsInt; }
+    index[i] = i;
+   }
+  buildObjectBVHNode (bvh, box, index, 0, bvh.nObject);
+  delete [] box;  delete [] index;
+}
+
+/******************************************************************************
+	Where does the probe P + s d (0 <= s <= 1) enter the box of nd?
+	Returns 0 if it misses the box.
+******************************************************************************/
+
+static int probeEntersNode (ObjectBVHCursor &cur, ObjectBVHNode &nd, float &sEnter)
+{
+  float s0 = 0, s1 = 1;
+  for (int c=0; c<2; c++)
+   {
+    if (cur.d[c] == 0)
+     {
+      if (cur.P[c] < nd.min[c] || cur.P[c] > nd.max[c]) return 0;
+      continue;
+     }
+    float sa = (nd.min[c] - cur.P[c]) / cur.d[c], sb = (nd.max[c] - cur.P[c]) / cur.d[c];
+    if (sa > sb) { float tmp = sa;  sa = sb;  sb = tmp; }
+    if (sa > s0) s0 = sa;
+    if (sb < s1) s1 = sb;
+    if (s0 > s1) return 0;
+   }
+  sEnter = s0;
+  return 1;
+}
+
+/******************************************************************************
+	Start a front-to-back traversal along probe.
+******************************************************************************/
+
+void startProbe (ObjectBVH &bvh, BezierCurve2f &probe, ObjectBVHCursor &cur)
+{
+  V2f Q;
+  probe.eval (probe.getKnot(0),    cur.P);
+  probe.eval (probe.getLastKnot(), Q);
+  for (int c=0; c<2; c++) cur.d[c] = Q[c] - cur.P[c];
+  cur.stack  = new int  [bvh.nNode + 1];
+  cur.sEnter = new float[bvh.nNode + 1];
+  cur.nStack = 0;
+  float s;
+  if (bvh.nNode > 0 && probeEntersNode (cur, bvh.node[0], s))
+   { cur.stack[0] = 0;  cur.sEnter[0] = s;  cur.nStack = 1; }
+}
+
+void endProbe (ObjectBVHCursor &cur)
+{
+  delete [] cur.stack;  delete [] cur.sEnter;
+}
+
+/******************************************************************************
+	Position of pt along the probe (in the units of s).
+******************************************************************************/
+
+float probePosition (ObjectBVHCursor &cur, V2f &pt)
+{
+  float dd = cur.d[0]*cur.d[0] + cur.d[1]*cur.d[1];
+  if (dd == 0) return 0;
+  return ((pt[0] - cur.P[0]) * cur.d[0] + (pt[1] - cur.P[1]) * cur.d[1]) / dd;
+}
+
+/******************************************************************************
+	Next object whose box the probe enters, in (roughly) front-to-back
+	order, skipping every subtree entered beyond sBest
+	(the position of the first hit so far; pass a value > 1 if none).
+	Returns -1 when no object can beat sBest.
+******************************************************************************/
+
+int nextProbeObject (ObjectBVH &bvh, ObjectBVHCursor &cur, float sBest)
+{
+  while (cur.nStack > 0)
+   {
+    cur.nStack--;
+    int n = cur.stack[cur.nStack];
+    if (cur.sEnter[cur.nStack] > sBest) continue;	// entered behind first hit
+    ObjectBVHNode &nd = bvh.node[n];
+    if (nd.object != -1) return nd.object;
+    float sl, sr;
+    int hitl = probeEntersNode (cur, bvh.node[nd.left],  sl);
+    int hitr = probeEntersNode (cur, bvh.node[nd.right], sr);
+    if (hitl && hitr && sl < sr)		// push nearer child last (visited first)
+     {
+      cur.stack[cur.nStack] = nd.right;  cur.sEnter[cur.nStack++] = sr;
+      cur.stack[cur.nStack] = nd.left;   cur.sEnter[cur.nStack++] = sl;
+     }
+    else
+     {
+      if (hitl) { cur.stack[cur.nStack] = nd.left;   cur.sEnter[cur.nStack++] = sl; }
+      if (hitr) { cur.stack[cur.nStack] = nd.right;  cur.sEnter[cur.nStack++] = sr; }
+     }
+   }
+  return -1;
+}
+
+#endif
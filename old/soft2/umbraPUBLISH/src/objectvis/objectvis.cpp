@@ -2,7 +2,7 @@
   File:          objectvis.cpp
   Author:        J.K. Johnstone 
   Created:	 27 September 2005 (from 2d/tangthrupt/src/poletang.cpp)
-  Last Modified: 9 February 2006
+  Last Modified: 17 October 2026
   Purpose:       To analyze the visibility of a certain curve 
                  from a certain viewpoint in a scene of curves.
   Sequence:	 interpolate -> tangCurve -> poletang -> objectvis
@@ -17,6 +17,10 @@
                  J.K. Johnstone (2005)
   History: 	 November 2005: touchups for paper submission
                  2/9/06: expository mode added
+		 10/17/26: spatial index (BVH) of objects for firstObjectHit
+		 10/17/26: batch visibility of many objects from many viewpoints (-V)
+		 10/17/26: precomputed arrangement of visual events (-A)
+		 10/17/26: disk cache of the bitangents of the visual events (-k)
 */
 
 #include <GL/glut.h>
@@ -30,6 +34,7 @@
 #include <string>
 using std::string;
 #include <time.h>
+#include <sys/time.h>
 
 #include "basic/AllColor.h"
 #include "basic/Miscellany.h"		
@@ -38,6 +43,12 @@ using std::string;
 #include "curve/BezierCurve.h"	
 #include "tangcurve/TangCurve.h" // BitangentArr, intersect, draw, visible
 #include "basic2/Line.h"         // createRayInsideSquare
+#include "objectBVH.h"           // buildObjectBVH, nextProbeObject
+#include "../workSteal.h"        // workStealFor, nProcessor
+#include "../bitangMerge.h"      // mergeCommonTangent
+#include "visArrangement.h"      // buildVisArrangement, locateVisArrangement
+#include "../tangCache.h"        // tangCacheKey, openTangCache, beginTangCache
+#include "../bezierBatch.h"      // initCurveBatch, evalBezierBatch
 
 #define PTSPERBEZSEGMENT 30      // # pts to draw on each Bezier segment
 #define WINDOWS 0		 // 0 for running on Linux, 1 for Windows
@@ -86,6 +97,7 @@ int isStarVisible (int star, BezierCurve2fArr &obstacle, TangThruPtArrArr &tangT
 		   V2f viewpt, float epsInt, float radiusRoom);
 // scene
 Array<BezierCurve2f>   obstacle;     // scene objects = interpolating cubic Bezier curves
+BezierBatch           *obBatch=NULL; // batch evaluator of each object (evalObstacle)
 int                    star=0;       // index of distinguished object
 V2f		       viewpt(-2,0); // point through which to compute tangents
 float                  radiusRoom=2; // radius of room enclosing the scene (for clipping)
@@ -140,6 +152,15 @@ float                  epsAngle;     // radian increment in angle between consec
 float                  featureSize;  // the smallest recognizable feature;
                                      // points closer than this are indistinguishable;
                                      // used to filter intersections near pt of tangency
+ObjectBVH              objectBVH;    // spatial index of obstacles, for global probes
+static GLboolean       OBJECTINDEX=1;// use objectBVH in firstObjectHit?
+static GLboolean       VERBOSE=1;    // report the steps of each visibility test?
+VisArrangement         visArrangement; // arrangement of visual events
+IntArrArr              faceVisible;  // objects visible from each face (empty: unlabelled)
+static GLboolean       ARRANGEMENT=0;// precompute visibility in the arrangement?
+static GLboolean       VIEWMOVED=0;  // viewpoint dragged since the overlays were computed?
+static GLboolean       TANGCACHE=0;  // cache the bitangents of the arrangement on disk?
+char                  *sceneFile;    // input scene
 /******************************************************************************/
 // GUI variables
 static GLfloat   transxob, transyob, zoomob, zoomdual;
@@ -208,6 +229,14 @@ static void usage()
   cout << "\t[-R] (reverse the probe pass direction)" << endl;
   cout << "\t[-p] (use first piercing tangent in backtracking: a hack)" << endl;
   cout << "\t[-t] (expository or teaching mode)" << endl;
+  cout << "\t[-n] (no spatial index: intersect every probe with every object)" << endl;
+  cout << "\t[-V viewfile] (batch: visibility of every object from each viewpoint" << endl
+       << "\t \t (x y per line) of viewfile, printed as a matrix; no display)" << endl;
+  cout << "\t[-j #] (number of threads in batch mode: default all cores)" << endl;
+  cout << "\t[-A] (precompute visibility on the arrangement of visual events;" << endl
+       << "\t \t the middle mouse then drags the viewpoint, and -V is answered by lookup)"
+       << endl;
+  cout << "\t[-k] (with -A, cache the bitangents in <file>.pts.objectvis.tcache)" << endl;
   cout << "\t[-h] (this help message)" << endl;
   cout << "\t <file>.pts" << endl;
  }
@@ -302,6 +331,12 @@ void motionob (int x, int y)
     if (firstx)  firstx=0; else transxob += .01*(x-oldx); /* TRANSLATION: X */
     if (firsty)  firsty=0; else transyob += .01*(y-oldy); /* TRANSLATION: Y */
    }
+  else if (middleMouseDown && ARRANGEMENT && zoomob > 0)  /* MOVE VIEWPOINT */
+   {
+    if (firstx)  firstx=0; else viewpt[0] += .01*(x-oldx)/zoomob;
+    if (firsty)  firsty=0; else viewpt[1] -= .01*(y-oldy)/zoomob;
+    VIEWMOVED = 1;		// viewpoint overlays no longer apply
+   }
   oldx = x;  
   oldy = y;
   glutPostRedisplay();
@@ -429,6 +464,22 @@ void displayOb ()
 	    }
 	}
     }
+  if (ARRANGEMENT)	// objects visible from viewpoint, by lookup in the arrangement
+   {
+    int f = locateVisibility (viewpt);
+    if (f != -1)
+     {
+      glLineWidth(3.0);  glColor3fv (Black);
+      for (i=0; i<nOb; i++) if (faceVisible[f][i]) obstacle[i].draw();
+      glLineWidth(1.0);
+     }
+   }
+  if (VIEWMOVED)	// the overlays below were computed for the initial viewpoint
+   {
+    glPopMatrix();
+    glutSwapBuffers ();
+    return;
+   }
   if (DRAWTANG)
    {
     glColor3fv (Black);
@@ -714,11 +765,18 @@ void inputCurves (char *file, Array<BezierCurve2f> &obstacle)
   V2fArrArr Pt;		// data points, organized into polygons
   read (infile, Pt);
   scaleToUnitSquare (Pt);
+  if (obBatch)				// previous scene
+   {
+    for (int i=0; i<obstacle.getn(); i++) freeBezierBatch (obBatch[i]);
+    delete [] obBatch;
+   }
   obstacle.allocate(Pt.getn());
+  obBatch = new BezierBatch[Pt.getn()];
   for (int i=0; i<Pt.getn(); i++)
    { 
     obstacle[i].fitClosed (Pt[i]);
     obstacle[i].prepareDisplay (nPtsPerSegment);
+    initCurveBatch (obstacle[i], obBatch[i]);
    }
 }
 
@@ -867,9 +925,11 @@ isExtreme (TangThruPt &T, BezierCurve2f &clippedT, BezierCurve2f &B,
     -->fSize:           tolerance for recognizable features; 
                         intersections of the tangent with B within this neighbourhood
                         of the point of tangency are ignored
+    <--: 0, or -1 if some object does not have exactly 2 extreme tangents
+         (a degenerate viewpoint)
 ******************************************************************************/
 
-void findExtreme (Array<BezierCurve2f> &obstacle, 
+int findExtreme (Array<BezierCurve2f> &obstacle, 
 		  Array<TangThruPtArr> &tangThruView, 
 		  Array<BezierCurve2fArr> &tangSegThruView, 
 		  V2iArr &extreme,
@@ -879,13 +939,14 @@ void findExtreme (Array<BezierCurve2f> &obstacle,
   for (int i=0; i<obstacle.getn(); i++)
    {
     int nExtreme=0;
-    cout << "for object " << i << endl;
+    if (VERBOSE) cout << "for object " << i << endl;
     for (int j=0; j<tangThruView[i].getn(); j++)
      if (isExtreme(tangThruView[i][j], tangSegThruView[i][j], obstacle[i], epsInt, fSize))
-       if (nExtreme==2) { cout << "Found too many extreme tangents" << endl; exit(-1); }
+       if (nExtreme==2) { cout << "Found too many extreme tangents" << endl; return -1; }
        else extreme[i][nExtreme++] = j;
-    assert (nExtreme==2);
+    if (nExtreme != 2) { cout << "Found too few extreme tangents" << endl;  return -1; }
    }
+  return 0;
 }
 
 /******************************************************************************
@@ -900,6 +961,7 @@ void findExtreme (Array<BezierCurve2f> &obstacle,
     -->T:            a tangent through the viewpoint
     -->Tprobe:       associated tangent probe (from viewpoint to wall)
     -->B:            a smooth object
+    -->viewpt:       the viewpoint
     <--pierceHit:    if this is a piercing tangent, the piercing intersection
     <--tPierceHit:   if this is a piercing tangent, the piercing intersection's parameter
     -->epsIntersect: tolerance for intersection computation
@@ -912,8 +974,8 @@ void findExtreme (Array<BezierCurve2f> &obstacle,
 ******************************************************************************/
 
 int 
-isPiercing (TangThruPt &T, BezierCurve2f &Tprobe, BezierCurve2f &B, V2f &pierceHit,
-	    float &tPierceHit, float epsIntersect, float featureSize)
+isPiercing (TangThruPt &T, BezierCurve2f &Tprobe, BezierCurve2f &B, V2f viewpt,
+	    V2f &pierceHit, float &tPierceHit, float epsIntersect, float featureSize)
 {
   // intersect probe with B, ignoring intersections near point of tangency
   int nHit; V2fArr ptHit; FloatArr tHit,tCurve;
@@ -938,17 +1000,19 @@ isPiercing (TangThruPt &T, BezierCurve2f &Tprobe, BezierCurve2f &B, V2f &pierceH
     -->probeThruView:   associated probes
     <--piercing:        piercing tangents, as indices of tangents through viewpoint
     <--piercingTang:    piercing tangents, directly
+    -->viewpt:          the viewpoint
     -->epsInt:          tolerance for intersection computation
     -->fSize:           tolerance for recognizable features; 
                         intersections of the tangent with B within this neighbourhood
                         of the point of tangency are ignored
+    <--: 0, or -1 if an object has too many piercing tangents
 ******************************************************************************/
 
-void findPiercing (Array<BezierCurve2f> &obstacle, 
+int findPiercing (Array<BezierCurve2f> &obstacle, 
 		   Array<TangThruPtArr> &tangThruView, 
 		   Array<BezierCurve2fArr> &probeThruView, 
 		   IntArrArr &piercing,  Array<PiercingTangArr> &piercingTang,
-		   float epsInt, float fSize)
+		   V2f viewpt, float epsInt, float fSize)
 {
   piercing.allocate(obstacle.getn());
   piercingTang.allocate(obstacle.getn());
@@ -959,11 +1023,11 @@ void findPiercing (Array<BezierCurve2f> &obstacle,
     FloatArr tHit(1000); // parameter values of the piercing points
     int j, nPiercing=0;
     for (j=0; j<tangThruView[i].getn(); j++)
-     if (isPiercing(tangThruView[i][j], probeThruView[i][j], obstacle[i], hit[nPiercing], 
-		    tHit[nPiercing], epsInt,fSize))
+     if (isPiercing(tangThruView[i][j], probeThruView[i][j], obstacle[i], viewpt,
+		    hit[nPiercing], tHit[nPiercing], epsInt,fSize))
       {
        if (nPiercing == 1000) 
-	 { cout << "Too many piercing tangents on object " << i << endl; exit(-1); }
+	 { cout << "Too many piercing tangents on object " << i << endl; return -1; }
        pierce[nPiercing++] = j;
       }
     piercing[i].allocate(nPiercing); // transfer to piercing, now that we know how many
@@ -976,6 +1040,7 @@ void findPiercing (Array<BezierCurve2f> &obstacle,
       piercingTang[i][j].tPierce = tHit[j];
      }
    }
+  return 0;
 }
 
 /******************************************************************************
@@ -1009,8 +1074,8 @@ int firstPtHit (BezierCurve2f &ob, BezierCurve2f &probe, V2f &ptFirstHit,
     Probe #2: What is the first object in the scene hit by this probe?
     And what is the point hit on this first object?
 
-    Compute first intersection with each object (EVENTUALLY: ONLY THOSE OBJECTS
-    WHOSE RANGE OVERLAPS THE PROBE).
+    Only the objects whose box the probe enters before the first hit found so
+    far are intersected, nearest first (objectBVH, built once per scene).
     Keep track of the closest intersection.
 
     -->object:     smooth objects in the scene
@@ -1024,20 +1089,8 @@ int firstPtHit (BezierCurve2f &ob, BezierCurve2f &probe, V2f &ptFirstHit,
 int firstObjectHit (Array<BezierCurve2f> &object, BezierCurve2f &probe,
 		    V2f &ptFirstHit, float radiusRoom, float epsInt)
 {
-  float tFirstHit = -1;  
-  int   objFirstHit = -1;
-  for (int i=0; i<object.getn(); i++)
-    {
-      V2f ptFirstHitHere;  float tFirstHitHere; 
-      if (firstPtHit(object[i], probe, ptFirstHitHere, tFirstHitHere, radiusRoom, epsInt))
-	if (tFirstHit == -1 || tFirstHitHere < tFirstHit)
-	  {
-	    tFirstHit = tFirstHitHere;
-	    ptFirstHit = ptFirstHitHere;
-	    objFirstHit = i;
-	  }
-    }
-  return objFirstHit;
+  V2f noPt;
+  return firstObjectHit (object, probe, ptFirstHit, noPt, -1, 0, radiusRoom, epsInt);
 }
 
 /******************************************************************************
@@ -1076,6 +1129,7 @@ int firstPtHit (BezierCurve2f &ob, BezierCurve2f &probe, V2f &ptFirstHit,
     Version of firstObjectHit that ignores intersections with a prescribed object
     near a prescribed point.  This is primarily necessary to avoid counting a 
     point of tangency as an intersection.
+    (objToIgnore = -1: ignore nothing.)
 
     see isPiercing for inspiration
 
@@ -1092,37 +1146,54 @@ int firstPtHit (BezierCurve2f &ob, BezierCurve2f &probe, V2f &ptFirstHit,
     <--:            index of the first object hit (-1 if no object hit)
 ******************************************************************************/
 
+static int firstPtHitOnObject (Array<BezierCurve2f> &object, int i, BezierCurve2f &probe, 
+			       V2f &ptFirstHit, float &tFirstHit, 
+			       V2f ptToIgnore, int objToIgnore, float featureSize,
+			       float radiusRoom, float epsInt)
+{
+  if (i == objToIgnore)
+    return firstPtHit (object[i], probe, ptFirstHit, tFirstHit, 
+		       ptToIgnore, featureSize, radiusRoom, epsInt);
+  else 
+    return firstPtHit (object[i], probe, ptFirstHit, tFirstHit, radiusRoom, epsInt);
+}
+
 int firstObjectHit (Array<BezierCurve2f> &object, BezierCurve2f &probe, V2f &ptFirstHit, 
 		    V2f ptToIgnore, int objToIgnore, float featureSize,
 		    float radiusRoom, float epsInt)
 {
   float tFirstHit = -1;  
   int   objFirstHit = -1;
-  for (int i=0; i<object.getn(); i++)
-    {
-      V2f ptFirstHitHere; float tFirstHitHere; 
-      if (i == objToIgnore)
-       {
-	if (firstPtHit(object[i], probe, ptFirstHitHere, tFirstHitHere, 
-		       ptToIgnore, featureSize, radiusRoom, epsInt))
-	  if (tFirstHit == -1 || tFirstHitHere < tFirstHit)
-	   {
-	    tFirstHit = tFirstHitHere;
-	    ptFirstHit = ptFirstHitHere;
-	    objFirstHit = i;
-	   }
-       }
-      else 
+  int   i;
+  V2f   ptFirstHitHere;  float tFirstHitHere; 
+  if (!OBJECTINDEX || objectBVH.object != &object || objectBVH.nObject != object.getn())
+   { // no index over these objects: try them all
+    for (i=0; i<object.getn(); i++)
+      if (firstPtHitOnObject (object, i, probe, ptFirstHitHere, tFirstHitHere, 
+			      ptToIgnore, objToIgnore, featureSize, radiusRoom, epsInt))
+	if (tFirstHit == -1 || tFirstHitHere < tFirstHit)
+	 {
+	  tFirstHit = tFirstHitHere;
+	  ptFirstHit = ptFirstHitHere;
+	  objFirstHit = i;
+	 }
+    return objFirstHit;
+   }
+  ObjectBVHCursor cur;
+  startProbe (objectBVH, probe, cur);
+  float sFirstHit = 2;		// position of first hit along probe (none yet)
+  while ((i = nextProbeObject (objectBVH, cur, sFirstHit)) != -1)
+    if (firstPtHitOnObject (object, i, probe, ptFirstHitHere, tFirstHitHere, 
+			    ptToIgnore, objToIgnore, featureSize, radiusRoom, epsInt))
+      if (tFirstHit == -1 || tFirstHitHere < tFirstHit ||
+	  (tFirstHitHere == tFirstHit && i < objFirstHit)) // as in index order
        {
-	if (firstPtHit(object[i], probe, ptFirstHitHere, tFirstHitHere, radiusRoom, epsInt))
-	  if (tFirstHit == -1 || tFirstHitHere < tFirstHit)
-	   {
-	    tFirstHit = tFirstHitHere;
-	    ptFirstHit = ptFirstHitHere;
-	    objFirstHit = i;
-	   }
+	tFirstHit = tFirstHitHere;
+	ptFirstHit = ptFirstHitHere;
+	objFirstHit = i;
+	sFirstHit = probePosition (cur, ptFirstHit);
        }
-    }
+  endProbe (cur);
   return objFirstHit;
 }
 
@@ -1385,7 +1456,7 @@ int isStarVisible (int star, BezierCurve2fArr &obstacle, TangThruPtArrArr &tangT
   probeOb.allocate (1000); 
   probePt.allocate(1000);
   probePtA.allocate(1000);
-  cout << "Probing at extreme tangent of A" << endl;
+  if (VERBOSE) cout << "Probing at extreme tangent of A" << endl;
   int extremeProbeIndex; // which extreme tangent of A should we start probing at?
   if ((!reversePass && angExtreme[star][0] == angRange[star][0]) ||
        (reversePass && angExtreme[star][0] == angRange[star][1]))
@@ -1403,15 +1474,15 @@ int isStarVisible (int star, BezierCurve2fArr &obstacle, TangThruPtArrArr &tangT
 			  (so, in practice, dont need to ignore pt)
   */
   nProbe++;
-  cout << "Probe hits " << B << endl;
+  if (VERBOSE) cout << "Probe hits " << B << endl;
   if (B == star || B == -1) 
     { witness[0] = viewpt; probeAlg[0].getCtrlPt(1,witness[1]); return 1; }
-  cout << "Testing if this object completely blocks the star" << endl;
+  if (VERBOSE) cout << "Testing if this object completely blocks the star" << endl;
   if (objLiesBehind (obstacle[star], angRange[star],   // is A blocked by B alone?
 		     obstacle[B], angRange[B], conInterval[B], 
 		     viewpt, epsInt, radiusRoom))
     return 0;
-  cout << "Testing if any concavity of this object contains the star" << endl;
+  if (VERBOSE) cout << "Testing if any concavity of this object contains the star" << endl;
   for (i=0; i<piercing[B].getn(); i++)
     if (objInConcavity (obstacle[star], 
 			tangThruView[star][extreme[star][0]],
@@ -1422,7 +1493,7 @@ int isStarVisible (int star, BezierCurve2fArr &obstacle, TangThruPtArrArr &tangT
   probePtA[0] = tangThruView[star][extreme[star][extremeProbeIndex]].ptTang;
   int inConcavity=0; float angleProbe; 
   V2f ptTangOnOldB;  // pt of tangency of the next probe
-  cout << "Testing if probed pt of star lies in a concavity of this object" << endl;
+  if (VERBOSE) cout << "Testing if probed pt of star lies in a concavity of this object" << endl;
   for (i=0; i<conInterval[B].getn(); i++)
     if (ptInConcavity (probePtA[0], obstacle[B], conInterval[B][i], 
 		       viewpt, epsInt, radiusRoom))
@@ -1465,12 +1536,12 @@ int isStarVisible (int star, BezierCurve2fArr &obstacle, TangThruPtArrArr &tangT
   do
    {
     int oldB = B;
-    cout << "Probing" << endl;
+    if (VERBOSE) cout << "Probing" << endl;
     // probe, but ignore pts of intersection near the pt of tangency
     B = probeOb[nProbe] = firstObjectHit (obstacle, probeAlg[nProbe], probePt[nProbe],
 					  ptTangOnOldB, oldB, featureSize,
 					  radiusRoom, epsInt);
-    cout << "Next probe hit " << B << endl;
+    if (VERBOSE) cout << "Next probe hit " << B << endl;
     nProbe++;  // we've now actually probed at this ray
     if (B == star || B == -1) 
       { witness[0] = viewpt; probeAlg[nProbe-1].getCtrlPt(1,witness[1]); return 1; } 
@@ -1522,7 +1593,7 @@ int isStarVisible (int star, BezierCurve2fArr &obstacle, TangThruPtArrArr &tangT
        }
     if (piercingNotInRange != -1)
      {
-       cout << "Next probe is at a piercing tangent" << endl;
+       if (VERBOSE) cout << "Next probe is at a piercing tangent" << endl;
        buildProbe (viewpt, tangThruView[B][piercing[B][piercingNotInRange]].ptTang,
 		   probeAlg[nProbe], radiusRoom);
        angleProbe = angPiercing[B][piercingNotInRange];
@@ -1530,7 +1601,7 @@ int isStarVisible (int star, BezierCurve2fArr &obstacle, TangThruPtArrArr &tangT
      }
     else // choose extreme tangent
      {
-      cout << "Next probe is at an extreme tangent" << endl;
+      if (VERBOSE) cout << "Next probe is at an extreme tangent" << endl;
       if (range.contains (angExtreme[B][0]))
        {  
 	buildProbe (viewpt,  
@@ -1548,13 +1619,638 @@ int isStarVisible (int star, BezierCurve2fArr &obstacle, TangThruPtArrArr &tangT
 	ptTangOnOldB = tangThruView[B][extreme[B][0]].ptTang;
        }
      }
-    cout << "Extending to angle " << angleProbe << endl;
+    if (VERBOSE) cout << "Extending to angle " << angleProbe << endl;
     if (reversePass) range[0] = angleProbe; else range[1] = angleProbe;
    } 
   while (angRange[star].contains(angleProbe)); // haven't yet swept past the object
   return 0; // have swept past: it is not visible
 }
 
+/******************************************************************************
+    Evaluate object ob at t[0..n-1] (wrapping past the last knot, since the 
+    object is closed; t is overwritten): in one batch by its evaluator B
+    (built once, in inputCurves) if ob is a cubic spline, otherwise one
+    eval at a time.
+******************************************************************************/
+
+void evalObstacle (BezierCurve2f &ob, BezierBatch &B, float *t, int n, V2f *pt)
+{
+  int i;
+  float first = ob.getKnot(0), last = ob.getLastKnot();
+  for (i=0; i<n; i++) if (t[i] > last) t[i] -= last - first;
+  if (n == 0 || B.L == 0)
+   {
+    for (i=0; i<n; i++) ob.eval (t[i], pt[i]);
+    return;
+   }
+  float *x = new float[2*n], *y = x + n;
+  evalBezierBatch (B, t, n, x, y);
+  for (i=0; i<n; i++) { pt[i][0] = x[i];  pt[i][1] = y[i]; }
+  delete [] x;
+}
+
+/******************************************************************************
+    Viewpoint-dependent data of the visibility algorithm
+    (levels 2-10 of main, without the display-only data).
+******************************************************************************/
+
+struct ViewpointData
+{
+  TangThruPtArrArr        tangThruView;    // viewpoint tangents for each object
+  Array<BezierCurve2fArr> tangSegThruView; // viewpoint tangents clipped to room
+  Array<BezierCurve2fArr> probeThruView;   // probes for viewpoint tangents
+  V2iArr                  extreme;         // extreme tangents of each object
+  IntArrArr               piercing;        // piercing tangents of each object
+  Array<PiercingTangArr>  piercingTang;    // ... directly
+  V2fArr                  angExtreme;      // angle of extreme tangents
+  FloatArrArr             angPiercing;     // angle of piercing tangents
+  V2fArrArr               conInterval;     // parameter interval of each concavity
+  V2fArr                  angRange;        // angular range of each object
+  V2fArrArr               angRangeCon;     // angular range of each concavity
+};
+
+/******************************************************************************
+    Prepare the data of the visibility algorithm for one viewpoint,
+    up to the given level of main (levels 2-10; display-only data excepted).
+    Only the objects, their batch evaluators (obBatch) and their tangential
+    curves (obduala, obdualb) are shared between viewpoints, and they are
+    only read, so viewpoints may be prepared in parallel.
+    The concavity intervals (conInterval) are not viewpoint-independent:
+    they are bounded by the piercing tangents through the viewpoint.
+
+    -->view:       the viewpoint (outside every object)
+    -->obstacle:   objects in the scene
+    -->obBatch:    batch evaluator of each object (see evalObstacle)
+    -->obduala/b:  tangential a/b-curves of the objects
+    <--tangThruView, ..., angRangeCon: viewpoint-dependent data (see globals)
+    -->epsDual:    accuracy of intersection in dual space
+    -->epsInt:     tolerance for intersection computation
+    -->fSize:      tolerance for recognizable features
+    -->epsInside:  step size to test which side of tangent the curve lies on
+    -->radiusRoom: radius of bounding room
+    -->level:      last level of main to compute
+    <--: 0, or -1 if the viewpoint is degenerate 
+         (findExtreme or findPiercing failed)
+******************************************************************************/
+
+int prepareViewpoint (V2f view, BezierCurve2fArr &obstacle, BezierBatch *obBatch,
+		      Array<TangentialCurve> &obduala, Array<TangentialCurve> &obdualb,
+		      Array<TangThruPtArr> &tangThruView, 
+		      Array<BezierCurve2fArr> &tangSegThruView,
+		      Array<BezierCurve2fArr> &probeThruView, V2iArr &extreme,
+		      IntArrArr &piercing, Array<PiercingTangArr> &piercingTang,
+		      V2fArr &angExtreme, FloatArrArr &angPiercing, 
+		      V2fArrArr &conInterval, V2fArr &angRange, V2fArrArr &angRangeCon,
+		      float epsDual, float epsInt, float fSize,
+		      float epsInside, float radiusRoom, int level=10)
+{
+  int i,j,k, nOb = obstacle.getn();
+  if (level > 1)				// tangents through viewpoint
+   {
+    TangentialCurve viewduala, viewdualb;
+    viewduala.createA (view, -1);
+    viewdualb.createB (view, -1);
+    tangThruView.allocate(nOb);
+    for (i=0; i<nOb; i++)
+     {
+      TangThruPtArr tangA, tangB;
+      obduala[i].intersect (viewduala, tangA, epsDual);
+      obdualb[i].intersect (viewdualb, tangB, epsDual);
+      tangThruView[i].append (tangA, tangB);
+     }
+   }
+  if (level > 2)
+   {
+    buildTangSegThruView (tangThruView, tangSegThruView, radiusRoom);
+    buildProbeThruView (tangThruView, probeThruView, radiusRoom);
+   }
+  if (level > 3 && 
+      findExtreme (obstacle, tangThruView, tangSegThruView, extreme, epsInt, fSize) == -1)
+    return -1;
+  if (level > 4 &&
+      findPiercing (obstacle, tangThruView, probeThruView, piercing, 
+		    piercingTang, view, epsInt, fSize) == -1)
+    return -1;
+  if (level > 5)				// angles of extreme and piercing tangents
+   {
+    angExtreme.allocate(nOb);
+    angPiercing.allocate(nOb);
+    for (i=0; i<nOb; i++)
+     {
+      for (j=0; j<2; j++)
+	angExtreme[i][j] = tangThruView[i][extreme[i][j]].angle();
+      angPiercing[i].allocate(piercing[i].getn());
+      for (j=0; j<piercing[i].getn(); j++)
+	angPiercing[i][j] = tangThruView[i][piercing[i][j]].angle();
+     }
+    conInterval.allocate(nOb);			// parameter interval of each concavity
+    for (i=0; i<nOb; i++)			// (Definition 11)
+     {
+      int n = piercingTang[i].getn();
+      conInterval[i].allocate(n);
+      float *tForward = new float[n+1];		// B(t2 + eps), in one batch
+      V2f *ptForward = new V2f[n+1];
+      for (j=0; j<n; j++) tForward[j] = piercingTang[i][j].tPierce + epsInside;
+      evalObstacle (obstacle[i], obBatch[i], tForward, n, ptForward);
+      for (j=0; j<n; j++)
+       {
+	float t1 = piercingTang[i][j].tTang,	// parameter of point of tangency
+	      t2 = piercingTang[i][j].tPierce;	// parameter of piercing point
+	// interval depends on whether ptForward lies inside tangent
+	if (piercingTang[i][j].inside (ptForward[j], obstacle, epsInside)) 
+	 { conInterval[i][j][0] = t2;  conInterval[i][j][1] = t1; }
+	else
+	 { conInterval[i][j][0] = t1;  conInterval[i][j][1] = t2; }
+       }
+      delete [] tForward;  delete [] ptForward;
+     }
+   }
+  if (level > 8)				// angular range of each object
+   {						// (Definition 8)
+    angRange.allocate(nOb);
+    for (i=0; i<nOb; i++)
+      {
+	// local probe at midAngle to find intersections with obstacle[i]
+	float midAngle = (angExtreme[i][0] + angExtreme[i][1]) / 2;
+	float minAngle = min(angExtreme[i][0], angExtreme[i][1]);
+	float maxAngle = max(angExtreme[i][0], angExtreme[i][1]);
+	BezierCurve2f midProbe;
+	V2f towards (view[0] + cos(midAngle), view[1] + sin(midAngle));
+	buildProbe (view, towards, midProbe, radiusRoom); V2f ptHit; float tHit;
+	if (firstPtHit (obstacle[i], midProbe, ptHit, tHit, radiusRoom, epsInt))
+	  { angRange[i][0] = minAngle;  angRange[i][1] = maxAngle; }
+	else	// angular range wraps around the other way
+	  { angRange[i][0] = maxAngle;  angRange[i][1] = minAngle; }
+      }
+   }
+  if (level > 9)				// angular range of each concavity,
+   {						// from its extreme tangents (Definition 13)
+    angRangeCon.allocate(nOb);
+    for (i=0; i<nOb; i++)
+     {
+      angRangeCon[i].allocate(piercing[i].getn());
+      for (j=0; j<piercing[i].getn(); j++)
+       {
+	float minAngle, maxAngle;
+	minAngle = maxAngle = tangThruView[i][piercing[i][j]].angle();
+	for (k=0; k<tangThruView[i].getn(); k++)
+	  // does point of tangency lie in concavity?
+	  if (obstacle[i].ptLiesOnSeg (tangThruView[i][k].tTang, conInterval[i][j]))
+	    {
+	      float angle = tangThruView[i][k].angle();
+	      if (angle < minAngle) minAngle = angle;
+	      if (angle > maxAngle) maxAngle = angle;
+	    }
+	float midAngle = (minAngle + maxAngle) / 2;
+	BezierCurve2f midProbe;			// probe at midangle
+	V2f towards (view[0] + cos(midAngle), view[1] + sin(midAngle));
+	buildProbe (view, towards, midProbe, radiusRoom);
+	int nHit;  V2fArr ptHit;  FloatArr tHitProbe, tHitOb; 
+	midProbe.intersect (obstacle[i], nHit, ptHit, tHitProbe, tHitOb, epsInt);
+	int found=0;
+	for (k=0; !found && k<nHit; k++)
+	  if (obstacle[i].ptLiesOnSeg (tHitOb[k], conInterval[i][j]))
+	    found=1;
+	if (found)
+	  { angRangeCon[i][j][0] = minAngle;  angRangeCon[i][j][1] = maxAngle; }
+	else
+	  { angRangeCon[i][j][0] = maxAngle;  angRangeCon[i][j][1] = minAngle; }
+       }
+     }
+   }
+  return 0;
+}
+
+int prepareViewpoint (V2f view, BezierCurve2fArr &obstacle, BezierBatch *obBatch,
+		      Array<TangentialCurve> &obduala, Array<TangentialCurve> &obdualb,
+		      ViewpointData &vd, float epsDual, float epsInt, float fSize,
+		      float epsInside, float radiusRoom)
+{
+  return prepareViewpoint (view, obstacle, obBatch, obduala, obdualb, vd.tangThruView, 
+			   vd.tangSegThruView, vd.probeThruView, vd.extreme,
+			   vd.piercing, vd.piercingTang, vd.angExtreme, vd.angPiercing,
+			   vd.conInterval, vd.angRange, vd.angRangeCon,
+			   epsDual, epsInt, fSize, epsInside, radiusRoom);
+}
+
+/******************************************************************************
+	Shared state of the batch visibility engine: 
+	task v answers every target from viewpoint view[v].
+******************************************************************************/
+
+struct VisibilityTasks
+{
+  BezierCurve2fArr       *obstacle;
+  BezierBatch            *obBatch;
+  Array<TangentialCurve> *obduala, *obdualb;
+  V2fArr                 *view;
+  IntArr                 *target;
+  IntArrArr              *visible;
+  int                     piercingInBacktrack, reversePass;
+  float                   epsDual, epsInt, fSize, epsInside, radiusRoom;
+};
+
+void visibilityTask (int v, void *arg)
+{
+  VisibilityTasks &t = *(VisibilityTasks *) arg;
+  ViewpointData vd;
+  int k;
+  if (prepareViewpoint ((*t.view)[v], *t.obstacle, t.obBatch, *t.obduala, *t.obdualb, vd,
+			t.epsDual, t.epsInt, t.fSize, t.epsInside, t.radiusRoom) == -1)
+   {
+    cerr << "Degenerate viewpoint " << v << ": visibility unknown" << endl;
+    for (k=0; k<t.target->getn(); k++) (*t.visible)[v][k] = -1;
+    return;
+   }
+  for (k=0; k<t.target->getn(); k++)
+   {
+    int nProbe=0;  BezierCurve2fArr probeAlg;  IntArr probeOb;
+    V2fArr probePt, probePtA;  Line2f witness;  V2f range;
+    (*t.visible)[v][k] = 
+      isStarVisible ((*t.target)[k], *t.obstacle, vd.tangThruView, vd.extreme, 
+		     vd.piercing, t.piercingInBacktrack, vd.conInterval, vd.angRange,
+		     vd.angRangeCon, vd.angExtreme, vd.angPiercing, nProbe, probeAlg,
+		     probeOb, probePt, probePtA, witness, range, t.reversePass, 
+		     (*t.view)[v], t.epsInt, t.radiusRoom);
+   }
+}
+
+/******************************************************************************
+    Which of the target objects are visible from each of the viewpoints?
+    The tangential curves and batch evaluators of the objects (and the spatial
+    index of firstObjectHit) are built once and shared; everything that depends
+    on the viewpoint is rebuilt per viewpoint, and viewpoints are distributed 
+    over nThread work-stealing threads.  No hodographs are shared: none are
+    used by the visibility test (only by the display of a spinning tangent
+    in the other tools).  Each viewpoint writes only its own row of visible,
+    so the matrix is independent of the schedule.
+
+    -->view:       viewpoints (each outside every object)
+    -->target:     indices of the objects to test
+    -->obstacle:   objects in the scene
+    -->obBatch:    batch evaluator of each object (see evalObstacle)
+    -->obduala/b:  tangential a/b-curves of the objects
+    <--visible:    visible[v][k] = 1 iff object target[k] is visible from view[v]
+                   (-1 if view[v] is degenerate)
+    -->nThread:    # threads (1 is serial)
+    (remaining parameters as in isStarVisible and prepareViewpoint)
+******************************************************************************/
+
+void isStarVisible (V2fArr &view, IntArr &target, BezierCurve2fArr &obstacle,
+		    BezierBatch *obBatch, 
+		    Array<TangentialCurve> &obduala, Array<TangentialCurve> &obdualb,
+		    IntArrArr &visible, int nThread, int piercingInBacktrack, 
+		    int reversePass, float epsDual, float epsInt, float fSize,
+		    float epsInside, float radiusRoom)
+{
+  VisibilityTasks t;
+  t.obstacle = &obstacle;  t.obBatch = obBatch;
+  t.obduala = &obduala;  t.obdualb = &obdualb;
+  t.view = &view;  t.target = &target;  t.visible = &visible;
+  t.piercingInBacktrack = piercingInBacktrack;  t.reversePass = reversePass;
+  t.epsDual = epsDual;  t.epsInt = epsInt;  t.fSize = fSize;
+  t.epsInside = epsInside;  t.radiusRoom = radiusRoom;
+  visible.allocate(view.getn());
+  for (int v=0; v<view.getn(); v++) visible[v].allocate(target.getn());
+  if (nThread <= 1)
+    for (int v=0; v<view.getn(); v++) visibilityTask (v, &t);
+  else workStealFor (view.getn(), nThread, visibilityTask, &t);
+}
+
+/******************************************************************************
+    Clip the line through p and q to the room.
+    <--s:  endpoints of the clipped line (x0,y0,x1,y1)
+    <--:   1 iff the line meets the room
+******************************************************************************/
+
+int clipLineToRoom (V2f p, V2f q, float radiusRoom, double *s)
+{
+  double t0 = -1e30, t1 = 1e30, d[2];
+  for (int c=0; c<2; c++)
+   {
+    d[c] = q[c] - p[c];
+    if (d[c] == 0)
+     {
+      if (p[c] < -radiusRoom || p[c] > radiusRoom) return 0;
+      continue;
+     }
+    double ta = (-radiusRoom - p[c]) / d[c], tb = (radiusRoom - p[c]) / d[c];
+    if (ta > tb) { double tmp = ta;  ta = tb;  tb = tmp; }
+    if (ta > t0) t0 = ta;
+    if (tb < t1) t1 = tb;
+   }
+  if (t0 >= t1) return 0;
+  s[0] = p[0] + t0*d[0];  s[1] = p[1] + t0*d[1];
+  s[2] = p[0] + t1*d[0];  s[3] = p[1] + t1*d[1];
+  return 1;
+}
+
+/******************************************************************************
+    Does pt lie inside the object, approximated by its display samples?
+******************************************************************************/
+
+int ptInsideObject (V2f &pt, BezierCurve2f &ob)
+{
+  int inside=0, n=ob.getnSample();
+  V2f a, b;
+  ob.getSample (n-1, a);
+  for (int k=0; k<n; k++, a=b)
+   {
+    ob.getSample (k, b);
+    if ((a[1] > pt[1]) != (b[1] > pt[1]) &&
+	pt[0] < a[0] + (b[0]-a[0]) * (pt[1]-a[1]) / (b[1]-a[1]))
+      inside = !inside;
+   }
+  return inside;
+}
+
+/******************************************************************************
+    Clip the bitangent line through its points of tangency p and q 
+    to its free part: the line is a visual event only where both points
+    of tangency can be seen along it, that is, from the room boundary or 
+    the first object boundary (display samples) beyond p, through p and q, 
+    to the first one beyond q.  If an object lies between p and q, 
+    the line is no event.
+    Boundary crossings within fSize of p or q belong to the tangencies
+    and are ignored.
+    <--s:  endpoints of the free part (x0,y0,x1,y1)
+    <--:   1 iff the line has a free part
+******************************************************************************/
+
+int clipLineToFree (V2f p, V2f q, BezierCurve2fArr &obstacle, float fSize, 
+		    float radiusRoom, double *s)
+{
+  double room[4];
+  if (!clipLineToRoom (p, q, radiusRoom, room)) return 0;
+  double dx = q[0]-p[0], dy = q[1]-p[1], len2 = dx*dx + dy*dy;
+  double lo = ((room[0]-p[0])*dx + (room[1]-p[1])*dy) / len2;	// line is p + t(q-p)
+  double hi = ((room[2]-p[0])*dx + (room[3]-p[1])*dy) / len2;
+  if (lo > hi) { double tmp = lo;  lo = hi;  hi = tmp; }
+  double ignore = fSize / sqrt (len2);
+  for (int i=0; i<obstacle.getn(); i++)
+   {
+    int n = obstacle[i].getnSample();
+    V2f a, b;
+    obstacle[i].getSample (n-1, a);
+    for (int k=0; k<n; k++, a=b)
+     {
+      obstacle[i].getSample (k, b);
+      double ex = b[0]-a[0], ey = b[1]-a[1], den = dx*ey - dy*ex;
+      if (den == 0) continue;				// parallel
+      double u = ((a[0]-p[0])*dy - (a[1]-p[1])*dx) / den;	// on chord ab
+      if (u < 0 || u > 1) continue;
+      double t = ((a[0]-p[0])*ey - (a[1]-p[1])*ex) / den;	// on line
+      if (fabs (t) < ignore || fabs (t-1) < ignore) continue;
+      if (t > 0 && t < 1) return 0;			// blocked between tangencies
+      if (t < 0 && t > lo) lo = t;
+      if (t > 1 && t < hi) hi = t;
+     }
+   }
+  s[0] = p[0] + lo*dx;  s[1] = p[1] + lo*dy;
+  s[2] = p[0] + hi*dx;  s[3] = p[1] + hi*dy;
+  return 1;
+}
+
+/******************************************************************************
+    Collect the segments of the visibility arrangement, all clipped to the room:
+    the free parts of the bitangent and self-bitangent lines (visual events 
+    where an object begins or ends hiding part of another, or of itself),
+    the inflection tangents (where the number of viewpoint tangents changes),
+    the object boundaries (display samples) and the room boundary.
+    Inflections are found as sign changes of the turning direction
+    of the display samples, so they are only as accurate as the sampling.
+
+    -->obstacle:   objects in the scene
+    -->obBatch:    batch evaluator of each object (see evalObstacle)
+    -->obduala/b:  tangential a/b-curves of the objects
+    <--nSeg:       # segments
+    <--seg:        segment k is (seg[4k],seg[4k+1]) to (seg[4k+2],seg[4k+3])
+    -->epsDual:    accuracy of intersection in dual space
+    -->fSize:      bitangents closer than this (in parameter space) are merged
+    -->radiusRoom: radius of bounding room
+******************************************************************************/
+
+void buildEventSegments (BezierCurve2fArr &obstacle, BezierBatch *obBatch,
+			 Array<TangentialCurve> &obduala, Array<TangentialCurve> &obdualb,
+			 int &nSeg, double *&seg, float epsDual, float fSize,
+			 float radiusRoom)
+{
+  int i,j,k, nOb = obstacle.getn();
+  Array<CommonTangentArr> bitang(nOb*(nOb+1)/2);	// all bitangents, per pair
+  int nPair=0, nLine=0, nSample=0;
+  float param[2] = {epsDual, fSize};
+  unsigned long long key = (TANGCACHE ? tangCacheKey (sceneFile, "objectvis", 2, param) : 0);
+  TangCache cache;
+  int cached = TANGCACHE && openTangCache (sceneFile, "objectvis", key, nOb*(nOb+1)/2, cache);
+  if (cached) cout << "Reading bitangents from cache" << endl;
+  for (i=0; i<nOb; i++)
+    for (j=i; j<nOb; j++)
+     {
+      CommonTangentArr bitangA, bitangB;
+      if (cached)
+	getTangCacheList (cache, nPair, bitang[nPair]);
+      else
+       {
+	if (i == j)
+	 {
+	  obduala[i].selfIntersect (bitangA, epsDual);
+	  obdualb[i].selfIntersect (bitangB, epsDual);
+	 }
+	else
+	 {
+	  obduala[i].intersect (obduala[j], bitangA, epsDual);
+	  obdualb[i].intersect (obdualb[j], bitangB, epsDual);
+	 }
+	mergeCommonTangent (bitangA, bitangB, fSize, bitang[nPair]);
+       }
+      nLine += bitang[nPair++].getn();
+     }
+  if (cached) closeTangCache (cache);
+  else if (TANGCACHE)
+   {
+    TangCacheWriter w;
+    beginTangCache (sceneFile, "objectvis", key, nPair, w);
+    for (k=0; k<nPair; k++) addTangCacheList (w, bitang[k]);
+    endTangCache (w);
+   }
+  for (i=0; i<nOb; i++) nSample += obstacle[i].getnSample();
+  seg = new double[4*(nLine + 2*nSample + 4)];  nSeg = 0;
+  // endpoints of the bitangent lines, bucketed by object and evaluated
+  // one object at a time in one batch (end e of line m is ptEnd[end[2m+e]])
+  int m, e, *start = new int[nOb+1], *end = new int[2*nLine+1];
+  for (i=0; i<=nOb; i++) start[i] = 0;
+  for (k=0; k<nPair; k++)
+    for (j=0; j<bitang[k].getn(); j++)
+     { start[bitang[k][j].index1+1]++;  start[bitang[k][j].index2+1]++; }
+  for (i=0; i<nOb; i++) start[i+1] += start[i];
+  float *tEnd = new float[2*nLine+1];
+  V2f *ptEnd = new V2f[2*nLine+1];
+  int *at = new int[nOb+1];
+  for (i=0; i<nOb; i++) at[i] = start[i];
+  for (m=0, k=0; k<nPair; k++)
+    for (j=0; j<bitang[k].getn(); j++, m++)
+     {
+      e = at[bitang[k][j].index1]++;  tEnd[e] = bitang[k][j].param1;  end[2*m]   = e;
+      e = at[bitang[k][j].index2]++;  tEnd[e] = bitang[k][j].param2;  end[2*m+1] = e;
+     }
+  for (i=0; i<nOb; i++)
+    evalObstacle (obstacle[i], obBatch[i], tEnd + start[i], start[i+1] - start[i], 
+		  ptEnd + start[i]);
+  for (m=0; m<nLine; m++)			// bitangent lines
+   {
+    V2f p = ptEnd[end[2*m]], q = ptEnd[end[2*m+1]];
+    if (p != q && clipLineToFree (p, q, obstacle, fSize, radiusRoom, seg + 4*nSeg)) nSeg++;
+   }
+  delete [] start;  delete [] end;  delete [] tEnd;  delete [] ptEnd;  delete [] at;
+  for (i=0; i<nOb; i++)				// boundaries and inflection tangents
+   {
+    int n = obstacle[i].getnSample();
+    V2f a, b, c;  float turn, prevTurn=0;
+    obstacle[i].getSample (n-2, a);  obstacle[i].getSample (n-1, b);
+    for (k=0; k<n; k++, a=b, b=c)
+     {
+      obstacle[i].getSample (k, c);
+      seg[4*nSeg] = b[0];  seg[4*nSeg+1] = b[1];  seg[4*nSeg+2] = c[0];  seg[4*nSeg+3] = c[1];
+      nSeg++;
+      turn = (b[0]-a[0])*(c[1]-b[1]) - (b[1]-a[1])*(c[0]-b[0]);
+      if (turn == 0) continue;
+      if (prevTurn != 0 && (turn > 0) != (prevTurn > 0) && a != b)
+	if (clipLineToRoom (a, b, radiusRoom, seg + 4*nSeg)) nSeg++;
+      prevTurn = turn;
+     }
+   }
+  float r = radiusRoom;				// room
+  double room[16] = {-r,-r,r,-r,  r,-r,r,r,  r,r,-r,r,  -r,r,-r,-r};
+  for (k=0; k<16; k++) seg[4*nSeg+k] = room[k];
+  nSeg += 4;
+}
+
+/******************************************************************************
+    Precompute visibility for every viewpoint in the room:
+    build the arrangement of the visual events and label each face
+    with the objects visible from it (by running the probing algorithm
+    once, at an interior point of the face).
+    Faces inside an object are left unlabelled.
+    Afterwards, locateVisibility answers a viewpoint in O(log n).
+******************************************************************************/
+
+void buildVisibilityArrangement (BezierCurve2fArr &obstacle, int nThread,
+				 int piercingInBacktrack, int reversePass,
+				 float epsDual, float epsInside)
+{
+  int nSeg, i, f, k, nOb = obstacle.getn();  double *seg;
+  cout << "Building visual events" << endl;
+  buildEventSegments (obstacle, obBatch, obduala, obdualb, nSeg, seg, epsDual, featureSize,
+		      radiusRoom);
+  cout << "Building arrangement of " << nSeg << " segments" << endl;
+  buildVisArrangement (nSeg, seg, visArrangement);
+  delete [] seg;
+  IntArr faceOfView(visArrangement.nFace);	// face of each labelled viewpoint
+  V2fArr view(visArrangement.nFace);  int nView=0;
+  for (f=0; f<visArrangement.nFace; f++)
+   {
+    if (visArrangement.faceOutside[f]) continue;
+    for (i=0; i<nOb && !ptInsideObject (visArrangement.faceRep[f], obstacle[i]); i++) ;
+    if (i < nOb) continue;
+    faceOfView[nView] = f;  view[nView++] = visArrangement.faceRep[f];
+   }
+  view.shrink(nView);
+  cout << "Labelling " << nView << " faces (of " << visArrangement.nFace << ")" << endl;
+  IntArr target(nOb);  for (k=0; k<nOb; k++) target[k] = k;
+  IntArrArr visible;
+  GLboolean verbose = VERBOSE;  VERBOSE = 0;
+  isStarVisible (view, target, obstacle, obBatch, obduala, obdualb, visible, nThread,
+		 piercingInBacktrack, reversePass, epsDual, epsIntersect, featureSize,
+		 epsInside, radiusRoom);
+  VERBOSE = verbose;
+  faceVisible.allocate(visArrangement.nFace);
+  for (i=0; i<nView; i++)
+   {
+    faceVisible[faceOfView[i]].allocate(nOb);
+    for (k=0; k<nOb; k++) faceVisible[faceOfView[i]][k] = visible[i][k];
+   }
+}
+
+/******************************************************************************
+    Face of the visibility arrangement containing viewpoint pt, 
+    or -1 if it is outside the room or inside an object.
+    faceVisible[f][k] is then the visibility of object k from pt.
+******************************************************************************/
+
+int locateVisibility (V2f &pt)
+{
+  int f = locateVisArrangement (visArrangement, pt);
+  if (f == -1 || faceVisible[f].getn() == 0) return -1;
+  return f;
+}
+
+/******************************************************************************
+    Read viewpoints, one 'x y' per line.
+    <--: # viewpoints read (0 if the file cannot be read)
+******************************************************************************/
+
+int inputViewpoints (char *file, V2fArr &view)
+{
+  ifstream infile;  infile.open(file);
+  if (!infile) return 0;
+  float x,y;  int n=0;
+  while (infile >> x >> y) n++;
+  infile.close();  infile.clear();  infile.open(file);
+  view.allocate(n);
+  for (int i=0; i<n; i++) { infile >> x >> y;  view[i][0] = x;  view[i][1] = y; }
+  return n;
+}
+
+/******************************************************************************
+    Batch mode: print the visibility of every object from every viewpoint 
+    of viewFile, one row per viewpoint: x y vis_0 vis_1 ... vis_{n-1}
+******************************************************************************/
+
+int batchVisibility (char *viewFile, int nThread, int piercingInBacktrack, 
+		     int reversePass, float epsDual, float epsInside)
+{
+  V2fArr view;
+  if (inputViewpoints (viewFile, view) == 0)
+    { cerr << "No viewpoints in " << viewFile << endl;  return -1; }
+  int i,k, nOb = obstacle.getn();
+  IntArr target(nOb);  for (k=0; k<nOb; k++) target[k] = k;
+  IntArrArr visible;
+  VERBOSE = 0;
+  struct timeval start, end;  gettimeofday (&start, NULL);
+  buildTangentialCurves (obstacle);
+  if (ARRANGEMENT)				// precompute, then look up
+   {
+    buildVisibilityArrangement (obstacle, nThread, piercingInBacktrack, reversePass,
+				epsDual, epsInside);
+    gettimeofday (&end, NULL);
+    cerr << "Arrangement labelled in " << (end.tv_sec - start.tv_sec) + 
+      (end.tv_usec - start.tv_usec) * 1e-6 << " seconds" << endl;
+    start = end;
+    visible.allocate(view.getn());
+    for (i=0; i<view.getn(); i++)
+     {
+      int f = locateVisibility (view[i]);
+      visible[i].allocate(nOb);
+      for (k=0; k<nOb; k++) visible[i][k] = (f == -1 ? -1 : faceVisible[f][k]);
+     }
+   }
+  else isStarVisible (view, target, obstacle, obBatch, obduala, obdualb, visible, nThread,
+		      piercingInBacktrack, reversePass, epsDual, epsIntersect, featureSize,
+		      epsInside, radiusRoom);
+  gettimeofday (&end, NULL);
+  for (i=0; i<view.getn(); i++)
+   {
+    cout << view[i][0] << " " << view[i][1];
+    for (k=0; k<nOb; k++) cout << " " << visible[i][k];
+    cout << endl;
+   }
+  cerr << view.getn() * nOb << " visibility queries (" << view.getn() << " viewpoints x "
+       << nOb << " objects) on " << nThread << " threads in "
+       << (end.tv_sec - start.tv_sec) + (end.tv_usec - start.tv_usec) * 1e-6 
+       << " seconds" << endl;
+  return 0;
+}
+
 /******************************************************************************
 ******************************************************************************/
 
@@ -1566,6 +2262,8 @@ int main (int argc, char **argv)
   float     epsSample;       // parameter distance between consecutive samples
   int       reversePass=0;   // should we reverse the pass direction (cw instead of ccw)
   int       piercingInBacktrack=0; // should we backtrack to piercing tangent instead (a hack)?
+  char     *viewFile=NULL;  // viewpoints of batch mode
+  int       nThread=-1;     // # threads of batch mode (-1: all cores)
   int	    i,j;
 
   epsIntersect = .001; featureSize = .05; epsAngle = .1; zoomob = 1;
@@ -1590,14 +2288,27 @@ int main (int argc, char **argv)
       case 'p': piercingInBacktrack = 1;                        break;
       case 'L': LAPTOP = 1;                                     break;
       case 't': EXPOSITORY = 1;                                 break;
+      case 'n': OBJECTINDEX = 0;                                break;
+      case 'V': viewFile = argv[ArgsParsed++];                  break;
+      case 'j': nThread = atoi(argv[ArgsParsed++]);             break;
+      case 'A': ARRANGEMENT = 1;                                break;
+      case 'k': TANGCACHE = 1;                                  break;
       case 'h': 
       default:	usage(); exit(-1);				break;
       }
    else ArgsParsed++;
   }
 
-  inputCurves(argv[argc-1], obstacle);
+  sceneFile = argv[argc-1];
+  inputCurves(sceneFile, obstacle);
   int nOb = obstacle.getn();
+  buildObjectBVH (obstacle, epsIntersect, objectBVH);	// for global probes
+  if (viewFile)
+   {
+    if (nThread == -1) nThread = nProcessor();     // not set by 'j' parameter
+    exit (batchVisibility (viewFile, nThread, piercingInBacktrack, reversePass,
+                           epsDual, epsInside));
+   }
 if (level > 0) 
 {
 cout << "Dualizing" << endl;
@@ -1606,22 +2317,20 @@ cout << "Dualizing" << endl;
   viewptduala.createA (viewpt, -1);
   viewptdualb.createB (viewpt, -1);
 }
-  // compute tangents through viewpt
+  // viewpoint-dependent data: tangents through viewpt, probes, extreme and
+  // piercing tangents, angles, concavity intervals and angular ranges
 if (level > 1)
 {
-cout << "Computing tangents through the viewpoint" << endl;
-  int nTang=0; 
-  Array<TangThruPtArr>   tangA(nOb);    // viewpoint tangents from a-space for each curve
-  Array<TangThruPtArr>   tangB(nOb);    // viewpoint tangents from b-space for each curve
-  tangThruView.allocate(nOb);
-  for (i=0; i<nOb; i++)
-   {
-    obduala[i].intersect (viewptduala, tangA[i], epsDual);
-    obdualb[i].intersect (viewptdualb, tangB[i], epsDual);
-    tangThruView[i].append (tangA[i], tangB[i]);
-    nTang += tangThruView[i].getn();
-   }
+cout << "Preparing the viewpoint" << endl;
+  if (prepareViewpoint (viewpt, obstacle, obBatch, obduala, obdualb, tangThruView, 
+			tangSegThruView, probeThruView, extreme, piercing, piercingTang,
+			angExtreme, angPiercing, conInterval, angRange, angRangeCon,
+			epsDual, epsIntersect, featureSize, epsInside, radiusRoom, 
+			level) == -1)
+    { cout << "Degenerate viewpoint" << endl;  exit(-1); }
   // collect all tangents
+  int nTang=0; 
+  for (i=0; i<nOb; i++) nTang += tangThruView[i].getn();
   Array<TangThruPt> alltangorig(nTang);  nTang=0;
   for (i=0; i<nOb; i++)
     for (j=0; j<tangThruView[i].getn(); j++)
@@ -1661,9 +2370,6 @@ cout << "Computing tangents through the viewpoint" << endl;
 if (level > 2)
 {
 cout << "Computing all probes" << endl;
-  buildTangSegThruView (tangThruView, tangSegThruView, radiusRoom);
-  buildProbeThruView (tangThruView, probeThruView, radiusRoom);
-
   // global probe at each tangent through viewpoint 
   // and compute first point of intersection of each probe
   probeHitAll.allocate(nOb);
@@ -1677,64 +2383,6 @@ cout << "Computing all probes" << endl;
 					       probeHitAll[i][j], 
 					       radiusRoom, epsIntersect);
     }
-}
-  // compute extreme tangents of each object
-if (level > 3)
-{
-cout << "Computing extreme tangents" << endl;
-  findExtreme (obstacle, tangThruView, tangSegThruView, extreme, 
-	       epsIntersect, featureSize);
-}
-  // compute piercing tangents, again by filtering
-if (level > 4)
-{
-cout << "Computing piercing tangents" << endl;
-  findPiercing (obstacle, tangThruView, probeThruView, piercing, piercingTang,
-		epsIntersect, featureSize);
-}
-  // compute angles of extreme tangents
-if (level > 5)
-{
-  cout << "Computing angles of extreme tangents" << endl;
-  angExtreme.allocate(nOb);
-  for (i=0; i<nOb; i++)
-    for (j=0; j<2; j++)
-      angExtreme[i][j] = tangThruView[i][extreme[i][j]].angle();
-  cout << "Computing angles of piercing tangents" << endl;
-  angPiercing.allocate(nOb);
-  for (i=0; i<nOb; i++)
-   {
-    angPiercing[i].allocate(piercing[i].getn());
-    for (j=0; j<piercing[i].getn(); j++)
-      angPiercing[i][j] = tangThruView[i][piercing[i][j]].angle();
-   }
-}
-  // compute parameter interval of each concavity (Definition 11)
-if (level > 5)
-{
-cout << "Computing parameter interval of each concavity" << endl;
-  conInterval.allocate(nOb);
-  for (i=0; i<nOb; i++) 
-   {
-    conInterval[i].allocate(piercingTang[i].getn());
-    for (j=0; j<conInterval[i].getn(); j++)
-     {
-      float t1 = piercingTang[i][j].tTang,   // parameter of point of tangency
-	    t2 = piercingTang[i][j].tPierce; // parameter of piercing point
-      V2f ptForward; obstacle[i].eval (t2 + epsInside, ptForward); // B(t2 + eps)
-      // interval depends on whether ptForward lies inside tangent
-      if (piercingTang[i][j].inside (ptForward, obstacle, epsInside)) 
-       {
-	conInterval[i][j][0] = t2;
-	conInterval[i][j][1] = t1;
-       }
-      else
-       {
-	conInterval[i][j][0] = t1;
-	conInterval[i][j][1] = t2;
-       }
-     }
-   }
 }
   // prepare curve samples on each concavity (for display only)
 if (level > 6)
@@ -1787,77 +2435,6 @@ cout << "minAngle = maxAngle = " << minAngle << endl;
 	}
     }
 }  
-  // compute angular range of each object (and store elegantly): Definition 8
-if (level > 8)
-{
-  cout << "Computing angular range of each object" << endl;
-  angRange.allocate(nOb);
-  for (i=0; i<nOb; i++)
-    {
-      // local probe at midAngle to find intersections with obstacle[i]
-      float midAngle = (angExtreme[i][0] + angExtreme[i][1]) / 2;
-      float minAngle = min(angExtreme[i][0], angExtreme[i][1]);
-      float maxAngle = max(angExtreme[i][0], angExtreme[i][1]);
-      BezierCurve2f midProbe;
-      V2f towards (viewpt[0] + cos(midAngle), viewpt[1] + sin(midAngle));
-      buildProbe (viewpt, towards, midProbe, radiusRoom); V2f ptHit; float tHit;
-      if (firstPtHit (obstacle[i], midProbe, ptHit, tHit, radiusRoom, epsIntersect))
-	{ 
-	  angRange[i][0] = minAngle;
-	  angRange[i][1] = maxAngle;
-	}
-      else
-	{
-	  angRange[i][0] = maxAngle;  // angular range wraps around the other way
-	  angRange[i][1] = minAngle;
-	}
-    }
-}
-  // compute angular range of each concavity (Definition 13)
-if (level > 9)
-{
-  cout << "Computing angular range of concavity" << endl;
-  angRangeCon.allocate(nOb);
-  for (i=0; i<nOb; i++)
-   {
-     cout << "A" << endl;
-    if (piercingTang.getn()>0) angRangeCon[i].allocate(piercingTang.getn());
-    for (j=0; j<piercingTang[i].getn(); j++)
-     {
-     cout << "B" << endl;
-      float angle1=extremeCon[i][j][0].angle(); // angle of concavity's extreme tangents
-     cout << "C" << endl;
-      float angle2=extremeCon[i][j][1].angle();
-      float minAngle = min(angle1,angle2), maxAngle = max(angle1,angle2);
-      float midAngle=(angle1+angle2)/2;
-     cout << "D" << endl;
-      BezierCurve2f midProbe;                     // probe at midangle
-      V2f towards (viewpt[0] + cos(midAngle), viewpt[1] + sin(midAngle));
-      buildProbe (viewpt, towards, midProbe, radiusRoom);
-      cout << "E" << endl;
-      int nHit;  V2fArr ptHit;                    // look for intersections w concavity
-      FloatArr tHitProbe, tHitOb; 
-      midProbe.intersect (obstacle[i], nHit, ptHit, tHitProbe, tHitOb, epsIntersect);
-      cout << "F" << endl;
-      int found=0;
-      for (int k=0; !found && k<nHit; k++)
-	if (obstacle[i].ptLiesOnSeg (tHitOb[k], conInterval[i][j]))
-	  found=1;
-      cout << "G" << endl;
-      if (found)                                  // assign angular range accordingly
-	{
-	  angRangeCon[i][j][0] = minAngle;
-	  angRangeCon[i][j][1] = maxAngle;
-	}
-      else
-	{
-	  angRangeCon[i][j][0] = maxAngle;
-	  angRangeCon[i][j][1] = minAngle;
-	}
-      cout << "H" << endl;
-     }
-   }
-}
   cout << "Prep complete..." << endl;
  
   // probing pass
@@ -1880,6 +2457,14 @@ if (level > 10)
       probeAlg[i].getCtrlPt(1, probeLine[i][1]);
     }
     
+}
+if (ARRANGEMENT)
+{
+  cout << "Precomputing visibility in the arrangement of visual events" << endl;
+  if (level == 0) buildTangentialCurves (obstacle);
+  if (nThread == -1) nThread = nProcessor();     // not set by 'j' parameter
+  buildVisibilityArrangement (obstacle, nThread, piercingInBacktrack, reversePass,
+			      epsDual, epsInside);
 }
 
   /************************************************************/
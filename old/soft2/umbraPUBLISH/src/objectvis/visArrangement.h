@@ -0,0 +1,260 @@
+/*
+  File:          visArrangement.h
+  Created:	 17 October 2026
+  Purpose:       Planar arrangement of line segments with point location,
+                 for precomputed visibility: the visibility of every object
+		 is constant as long as the viewpoint does not cross a visual
+		 event (bitangent or inflection tangent), so if the events,
+		 the object boundaries and the room are entered as segments,
+		 each face of the arrangement has one visibility label.
+		 Construction: the plane is cut into vertical slabs at every
+		 segment endpoint and intersection; inside a slab the segments
+		 crossing it are totally ordered, so the slab is a stack of
+		 trapezoidal cells.  Cells of neighbouring slabs that overlap
+		 on their common boundary lie in the same face (union-find).
+		 Point location: binary search on the slabs, then on the
+		 segments of the slab, so O(log n).
+		 The scene is first rotated by a fixed generic angle,
+		 so that no segment is vertical.
+		 The cost grows with the number of crossings, so visual
+		 events should be entered as segments (their free parts),
+		 not as whole lines.
+		 Reentrant: no global state.
+  Usage:	 VisArrangement A;  buildVisArrangement (nSeg, seg, A);
+  		 for (f=0; f<A.nFace; f++) if (!A.faceOutside[f]) label f at A.faceRep[f]
+		 f = locateVisArrangement (A, pt);	// -1 outside
+*/
+
+#ifndef _VISARRANGEMENT_H_
+#define _VISARRANGEMENT_H_
+
+#include <math.h>
+#include <stdlib.h>		// qsort
+
+#define VISARRANGEMENTANGLE .0123456789	// rotation to general position
+
+struct VisArrangement
+{
+  double  cosA, sinA;		// rotation to general position
+  int     nSeg;
+  double *seg;			// segment k: seg[4k..4k+3] = x0,y0,x1,y1 (rotated, x0<x1)
+  int     nSlab;		// slab s is X[s] < x < X[s+1]
+  double *X;			// nSlab+1 slab boundaries
+  int    *slabStart;		// segments crossing slab s, bottom to top, are
+  int    *slabSeg;		//   slabSeg[slabStart[s] .. slabStart[s+1]-1]
+  int    *cellFace;		// face of cell j (j=0: below all) of slab s is
+				//   cellFace[slabStart[s] + s + j]
+  int     nFace;
+  V2f    *faceRep;		// interior point of each face (original frame)
+  int    *faceOutside;		// is face unbounded (outside the room)?
+};
+
+/******************************************************************************/
+/******************************************************************************/
+
+struct VisKeyed			// an index with its sort key
+{
+  double key;
+  int    index;
+};
+
+static int compareVisKeyed (const void *a, const void *b)
+{
+  double ka = ((const VisKeyed *) a)->key, kb = ((const VisKeyed *) b)->key;
+  return (ka < kb ? -1 : (ka > kb ? 1 : 0));
+}
+
+static void visSortByKey (int *index, int n, double *key, VisKeyed *buf)	// sort index[0..n-1] by key[index[i]]
+{
+  int i;
+  for (i=0; i<n; i++) { buf[i].key = key[index[i]];  buf[i].index = index[i]; }
+  qsort (buf, n, sizeof(VisKeyed), compareVisKeyed);
+  for (i=0; i<n; i++) index[i] = buf[i].index;
+}
+
+static int compareVisArrangementDouble (const void *a, const void *b)
+{
+  double ka = *(const double *) a, kb = *(const double *) b;
+  return (ka < kb ? -1 : (ka > kb ? 1 : 0));
+}
+
+static inline double visSegY (VisArrangement &A, int k, double x)	// y of segment k at x
+{
+  double *s = A.seg + 4*k;
+  return s[1] + (s[3] - s[1]) * (x - s[0]) / (s[2] - s[0]);
+}
+
+static int visFind (int *parent, int i)
+{
+  while (parent[i] != i) { parent[i] = parent[parent[i]];  i = parent[i]; }
+  return i;
+}
+
+static void visGrow (int *&a, int &size, int needed)	// grow a to hold needed ints
+{
+  if (needed <= size) return;
+  int newSize = (2*size > needed ? 2*size : needed);
+  int *b = new int[newSize];
+  for (int i=0; i<size; i++) b[i] = a[i];
+  delete [] a;  a = b;  size = newSize;
+}
+
+/******************************************************************************
+	Build the arrangement of nSeg segments,
+	segment k from (seg[4k],seg[4k+1]) to (seg[4k+2],seg[4k+3]).
+******************************************************************************/
+
+void buildVisArrangement (int nSeg, double *seg, VisArrangement &A)
+{
+  int i,j,k,s;
+  A.cosA = cos (VISARRANGEMENTANGLE);  A.sinA = sin (VISARRANGEMENTANGLE);
+  A.seg  = new double[4*nSeg+4];  A.nSeg = 0;
+  for (k=0; k<nSeg; k++)		// rotate, orient left to right, drop points
+   {
+    double x0 = A.cosA*seg[4*k]   + A.sinA*seg[4*k+1], y0 = -A.sinA*seg[4*k]   + A.cosA*seg[4*k+1];
+    double x1 = A.cosA*seg[4*k+2] + A.sinA*seg[4*k+3], y1 = -A.sinA*seg[4*k+2] + A.cosA*seg[4*k+3];
+    if (x0 == x1) continue;
+    double *t = A.seg + 4*A.nSeg++;
+    if (x0 < x1) { t[0] = x0;  t[1] = y0;  t[2] = x1;  t[3] = y1; }
+    else         { t[0] = x1;  t[1] = y1;  t[2] = x0;  t[3] = y0; }
+   }
+  nSeg = A.nSeg;
+  int *order = new int[nSeg+1];		// segments by left endpoint
+  double *key = new double[nSeg+1];
+  VisKeyed *keyed = new VisKeyed[nSeg+1];
+  for (k=0; k<nSeg; k++) { order[k] = k;  key[k] = A.seg[4*k]; }
+  visSortByKey (order, nSeg, key, keyed);
+
+  int nX=0, sizeX = 2*nSeg + 16;	// slab boundaries: endpoints and intersections
+  double *X = new double[sizeX];
+  for (k=0; k<nSeg; k++) { X[nX++] = A.seg[4*k];  X[nX++] = A.seg[4*k+2]; }
+  for (i=0; i<nSeg; i++)
+    for (j=i+1; j<nSeg && A.seg[4*order[j]] <= A.seg[4*order[i]+2]; j++)
+     {
+      double *p = A.seg + 4*order[i], *q = A.seg + 4*order[j];
+      double dpx = p[2]-p[0], dpy = p[3]-p[1], dqx = q[2]-q[0], dqy = q[3]-q[1];
+      double den = dpx*dqy - dpy*dqx;
+      if (den == 0) continue;		// parallel
+      double t = ((q[0]-p[0])*dqy - (q[1]-p[1])*dqx) / den;
+      double u = ((q[0]-p[0])*dpy - (q[1]-p[1])*dpx) / den;
+      if (t < 0 || t > 1 || u < 0 || u > 1) continue;
+      if (nX == sizeX)
+       {
+	double *Y = new double[2*sizeX];
+	for (k=0; k<nX; k++) Y[k] = X[k];
+	delete [] X;  X = Y;  sizeX *= 2;
+       }
+      X[nX++] = p[0] + t*dpx;
+     }
+  qsort (X, nX, sizeof(double), compareVisArrangementDouble);
+  double tol = (nX > 0 ? 1e-9 * (fabs(X[0]) + fabs(X[nX-1]) + 1) : 0);
+  int nUnique=0;
+  for (k=0; k<nX; k++)
+    if (nUnique == 0 || X[k] - X[nUnique-1] > tol) X[nUnique++] = X[k];
+  A.X = X;  A.nSlab = (nUnique > 0 ? nUnique-1 : 0);
+
+  // segments crossing each slab, sorted by height at the middle of the slab
+  A.slabStart = new int[A.nSlab+1];
+  int sizeSlabSeg = 4*nSeg + 16;  A.slabSeg = new int[sizeSlabSeg];
+  int *active = new int[nSeg+1], nActive=0, next=0, nSlabSeg=0;
+  for (s=0; s<A.nSlab; s++)
+   {
+    double xm = (X[s] + X[s+1]) / 2;
+    while (next < nSeg && A.seg[4*order[next]] < xm) active[nActive++] = order[next++];
+    for (i=j=0; i<nActive; i++)
+      if (A.seg[4*active[i]+2] > xm) active[j++] = active[i];
+    nActive = j;
+    for (i=0; i<nActive; i++) key[active[i]] = visSegY (A, active[i], xm);
+    visSortByKey (active, nActive, key, keyed);
+    A.slabStart[s] = nSlabSeg;
+    visGrow (A.slabSeg, sizeSlabSeg, nSlabSeg + nActive);
+    for (i=0; i<nActive; i++) A.slabSeg[nSlabSeg++] = active[i];
+   }
+  A.slabStart[A.nSlab] = nSlabSeg;
+
+  // faces: union cells of neighbouring slabs that overlap on the common boundary
+  int nCell = nSlabSeg + A.nSlab;
+  int *parent = new int[nCell+1];
+  for (i=0; i<nCell; i++) parent[i] = i;
+  for (s=0; s+1<A.nSlab; s++)
+   {
+    double xb = X[s+1];
+    int nl = A.slabStart[s+1] - A.slabStart[s], nr = A.slabStart[s+2] - A.slabStart[s+1];
+    int *L = A.slabSeg + A.slabStart[s], *R = A.slabSeg + A.slabStart[s+1];
+    int cl = A.slabStart[s] + s, cr = A.slabStart[s+1] + s+1;	// first cells
+    i = j = 0;			// cell i of left slab, cell j of right slab
+    while (i <= nl && j <= nr)
+     {
+      double loL = (i == 0  ? -1e30 : visSegY (A, L[i-1], xb));
+      double hiL = (i == nl ?  1e30 : visSegY (A, L[i],   xb));
+      double loR = (j == 0  ? -1e30 : visSegY (A, R[j-1], xb));
+      double hiR = (j == nr ?  1e30 : visSegY (A, R[j],   xb));
+      double lo = (loL > loR ? loL : loR), hi = (hiL < hiR ? hiL : hiR);
+      if (hi - lo > tol)
+	parent[visFind (parent, cl+i)] = visFind (parent, cr+j);
+      if (hiL < hiR) i++; else j++;
+     }
+   }
+
+  // number the faces; representative = centre of the widest bounded cell
+  int *faceOf = new int[nCell+1];
+  double *best = new double[nCell+1];
+  for (i=0; i<nCell; i++) faceOf[i] = -1;
+  A.nFace = 0;
+  for (i=0; i<nCell; i++)
+    if (visFind (parent, i) == i) faceOf[i] = A.nFace++;
+  A.cellFace    = new int[nCell+1];
+  A.faceRep     = new V2f[A.nFace+1];
+  A.faceOutside = new int[A.nFace+1];
+  for (i=0; i<A.nFace; i++) { A.faceOutside[i] = 0;  best[i] = -1; }
+  for (s=0; s<A.nSlab; s++)
+   {
+    int n = A.slabStart[s+1] - A.slabStart[s];
+    int *S = A.slabSeg + A.slabStart[s];
+    double xm = (X[s] + X[s+1]) / 2, w = X[s+1] - X[s];
+    for (j=0; j<=n; j++)
+     {
+      int c = A.slabStart[s] + s + j, f = faceOf[visFind (parent, c)];
+      A.cellFace[c] = f;
+      if (j == 0 || j == n) { A.faceOutside[f] = 1;  continue; }
+      double lo = visSegY (A, S[j-1], xm), hi = visSegY (A, S[j], xm);
+      if (w * (hi - lo) > best[f])
+       {
+	best[f] = w * (hi - lo);
+	double ym = (lo + hi) / 2;	// rotate back
+	A.faceRep[f] = V2f (A.cosA*xm - A.sinA*ym, A.sinA*xm + A.cosA*ym);
+       }
+     }
+   }
+  delete [] order;  delete [] key;  delete [] keyed;  delete [] active;
+  delete [] parent;  delete [] faceOf;  delete [] best;
+}
+
+/******************************************************************************
+	Face of the arrangement containing pt, or -1 if pt lies outside.
+******************************************************************************/
+
+int locateVisArrangement (VisArrangement &A, V2f &pt)
+{
+  double x =  A.cosA*pt[0] + A.sinA*pt[1];
+  double y = -A.sinA*pt[0] + A.cosA*pt[1];
+  if (A.nSlab == 0 || x <= A.X[0] || x >= A.X[A.nSlab]) return -1;
+  int lo = 0, hi = A.nSlab;		// find slab: X[lo] <= x < X[lo+1]
+  while (hi - lo > 1)
+   {
+    int mid = (lo + hi) / 2;
+    if (A.X[mid] <= x) lo = mid; else hi = mid;
+   }
+  int s = lo, *S = A.slabSeg + A.slabStart[s];
+  int nBelow = 0, n = A.slabStart[s+1] - A.slabStart[s];	// # segments below pt
+  while (n > 0)
+   {
+    int half = n / 2;
+    if (visSegY (A, S[nBelow + half], x) < y) { nBelow += half + 1;  n -= half + 1; }
+    else n = half;
+   }
+  int f = A.cellFace[A.slabStart[s] + s + nBelow];
+  return (A.faceOutside[f] ? -1 : f);
+}
+
+#endif
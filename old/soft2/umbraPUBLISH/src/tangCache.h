@@ -0,0 +1,233 @@
+/*
+  File:          tangCache.h
+  Created:	 17 October 2026
+  Purpose:       Disk cache of the intersections of a scene's tangential
+                 curves (the bitangent and self-bitangent lists, as
+		 CommonTangent index/parameter pairs), so that rerunning a
+		 program on an unchanged scene skips the dual-space
+		 intersections, which dominate the start-up time.
+		 The cache of <scene> is <scene>.<tag>.tcache; it is keyed by
+		 a 64-bit FNV-1a hash of the bytes of <scene>, the tag (the
+		 program, since programs store different lists) and the
+		 parameters the lists depend on (eps, featureSize, ...),
+		 so a stale cache is never read: it is simply rewritten.
+
+		 Binary format (native byte order), mapped read-only:
+		   char[4] "TCAC", int version (1),
+		   unsigned long long key, int nList, int pad,
+		   int start[nList+1]	(list l is record[start[l]..start[l+1]-1])
+		   per record: int index1, int index2, float param1, float param2
+  Usage:	 unsigned long long key = tangCacheKey (file, "umbra", nParam, param);
+  		 TangCache c;
+  		 if (openTangCache (file, "umbra", key, nList, c))
+		  { getTangCacheList (c, l, list);  ...  closeTangCache (c); }
+		 else
+		  { ...compute...
+		    TangCacheWriter w;  beginTangCache (file, "umbra", key, nList, w);
+		    addTangCacheList (w, list);  ...  endTangCache (w); }
+*/
+
+#ifndef _TANGCACHE_H_
+#define _TANGCACHE_H_
+
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define TANGCACHEVERSION 1
+
+struct TangCacheRecord
+{
+  int   index1, index2;
+  float param1, param2;
+};
+
+struct TangCacheHeader
+{
+  char               magic[4];
+  int                version;
+  unsigned long long key;
+  int                nList, pad;
+};
+
+struct TangCache			// a mapped cache file
+{
+  void                  *map;
+  size_t                 size;
+  int                    nList;
+  const int             *start;
+  const TangCacheRecord *record;
+};
+
+struct TangCacheWriter
+{
+  FILE *fp;
+  char *file;
+  int   nList, n;			// # lists expected, written
+  int  *start;
+};
+
+/******************************************************************************/
+/******************************************************************************/
+
+static inline unsigned long long fnv1a (unsigned long long h, const void *data, size_t n)
+{
+  const unsigned char *p = (const unsigned char *) data;
+  for (size_t i=0; i<n; i++) { h ^= p[i];  h *= 1099511628211ULL; }
+  return h;
+}
+
+static char *tangCacheFile (const char *scene, const char *tag)	// <scene>.<tag>.tcache
+{
+  char *file = new char[strlen(scene) + strlen(tag) + 9];
+  sprintf (file, "%s.%s.tcache", scene, tag);
+  return file;
+}
+
+/******************************************************************************
+	Key of the cache of scene: hash of its contents, the tag
+	and the nParam parameters param.  Returns 0 if scene is unreadable.
+******************************************************************************/
+
+unsigned long long tangCacheKey (const char *scene, const char *tag,
+				 int nParam, const float *param)
+{
+  FILE *fp = fopen (scene, "rb");
+  if (!fp) return 0;
+  unsigned long long h = 14695981039346656037ULL;
+  char buf[8192];  size_t n;
+  while ((n = fread (buf, 1, sizeof(buf), fp)) > 0) h = fnv1a (h, buf, n);
+  fclose (fp);
+  h = fnv1a (h, tag, strlen(tag));
+  h = fnv1a (h, param, nParam*sizeof(float));
+  return (h == 0 ? 1 : h);
+}
+
+void closeTangCache (TangCache &c)
+{
+  if (c.map) munmap (c.map, c.size);
+  c.map = NULL;
+}
+
+/******************************************************************************
+	Map the cache of scene; returns 0 (and maps nothing) if it is missing,
+	truncated, does not match key and nList, or its list table is not
+	nondecreasing (so every list lies within the records).
+******************************************************************************/
+
+int openTangCache (const char *scene, const char *tag, unsigned long long key,
+		   int nList, TangCache &c)
+{
+  c.map = NULL;
+  if (key == 0) return 0;
+  char *file = tangCacheFile (scene, tag);
+  int fd = open (file, O_RDONLY);
+  delete [] file;
+  if (fd < 0) return 0;
+  struct stat st;
+  if (fstat (fd, &st) != 0 || (size_t) st.st_size < sizeof(TangCacheHeader))
+   { close (fd);  return 0; }
+  c.size = st.st_size;
+  c.map  = mmap (NULL, c.size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close (fd);
+  if (c.map == MAP_FAILED) { c.map = NULL;  return 0; }
+  const TangCacheHeader *h = (const TangCacheHeader *) c.map;
+  size_t tableEnd = sizeof(TangCacheHeader) + (nList+1)*sizeof(int);
+  c.nList  = nList;
+  c.start  = (const int *) ((const char *) c.map + sizeof(TangCacheHeader));
+  c.record = (const TangCacheRecord *) ((const char *) c.map + tableEnd);
+  if (memcmp (h->magic, "TCAC", 4) != 0 || h->version != TANGCACHEVERSION ||
+      h->key != key || h->nList != nList || c.size < tableEnd ||
+      c.start[0] != 0 ||
+      c.size != tableEnd + c.start[nList]*sizeof(TangCacheRecord))
+   { closeTangCache (c);  return 0; }
+  for (int l=0; l<nList; l++)
+    if (c.start[l+1] < c.start[l]) { closeTangCache (c);  return 0; }
+  return 1;
+}
+
+/******************************************************************************
+	List l of the cache (CommonTangentArr or UmbralBitangArr).
+******************************************************************************/
+
+template <class BitangArr>
+void getTangCacheList (TangCache &c, int l, BitangArr &list)
+{
+  CommonTangent t;
+  list.allocate (c.start[l+1] - c.start[l]);
+  for (int k=0; k<list.getn(); k++)
+   {
+    const TangCacheRecord &r = c.record[c.start[l] + k];
+    t.index1 = r.index1;  t.index2 = r.index2;  t.param1 = r.param1;  t.param2 = r.param2;
+    list[k] = t;
+   }
+}
+
+/******************************************************************************
+	Write the cache of scene: beginTangCache, then addTangCacheList for
+	each of the nList lists in order, then endTangCache.
+	The file is written under a temporary name and renamed when complete,
+	so a concurrent or interrupted run never sees a partial cache.
+	Returns 0 on success.
+******************************************************************************/
+
+int beginTangCache (const char *scene, const char *tag, unsigned long long key,
+		    int nList, TangCacheWriter &w)
+{
+  w.file  = tangCacheFile (scene, tag);
+  w.nList = nList;  w.n = 0;
+  w.start = new int[nList+1];  w.start[0] = 0;
+  char *tmp = new char[strlen(w.file) + 24];
+  sprintf (tmp, "%s.%d", w.file, (int) getpid());
+  w.fp = fopen (tmp, "wb");
+  delete [] tmp;
+  if (!w.fp) return -1;
+  TangCacheHeader h;
+  memcpy (h.magic, "TCAC", 4);  h.version = TANGCACHEVERSION;
+  h.key = key;  h.nList = nList;  h.pad = 0;
+  fwrite (&h, sizeof(h), 1, w.fp);
+  fwrite (w.start, sizeof(int), nList+1, w.fp);	// filled in by endTangCache
+  return 0;
+}
+
+template <class BitangArr>
+void addTangCacheList (TangCacheWriter &w, BitangArr &list)
+{
+  if (!w.fp || w.n == w.nList) return;
+  for (int k=0; k<list.getn(); k++)
+   {
+    TangCacheRecord r;
+    r.index1 = list[k].index1;  r.index2 = list[k].index2;
+    r.param1 = list[k].param1;  r.param2 = list[k].param2;
+    fwrite (&r, sizeof(r), 1, w.fp);
+   }
+  w.start[w.n+1] = w.start[w.n] + list.getn();
+  w.n++;
+}
+
+int endTangCache (TangCacheWriter &w)
+{
+  int err = -1;
+  char *tmp = new char[strlen(w.file) + 24];
+  sprintf (tmp, "%s.%d", w.file, (int) getpid());
+  if (w.fp)
+   {
+    if (w.n == w.nList)
+     {
+      fseek (w.fp, sizeof(TangCacheHeader), SEEK_SET);
+      fwrite (w.start, sizeof(int), w.nList+1, w.fp);
+      err = ferror (w.fp);
+     }
+    if (fclose (w.fp) != 0) err = -1;		// buffered writes may fail here
+    if (err == 0 && rename (tmp, w.file) == 0)
+      cout << "Wrote " << w.file << endl;
+    else { unlink (tmp);  err = -1; }
+   }
+  delete [] tmp;  delete [] w.file;  delete [] w.start;
+  return err;
+}
+
+#endif
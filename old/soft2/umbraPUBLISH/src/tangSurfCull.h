@@ -0,0 +1,404 @@
+/*
+  File:          tangSurfCull.h
+  Created:	 17 October 2026
+  Purpose:       Broad phase for the intersection of two tangential surfaces
+                 (TangentialSurf::intersect, in bidev and silhouette):
+		 patches of either surface that cannot meet the other are
+		 made inactive before intersecting.
+		 A tangential surface is a rational Bezier spline surface with
+		 a flag per patch (patches clipped away are inactive); its
+		 control net is read back from the text of storeTangSurf:
+		   type
+		   degu degv nSegu nSegv
+		   nSegu+1 u knots
+		   nSegv+1 v knots
+		   (degu*nSegu+1)*(degv*nSegv+1) points x y z w (v fastest)
+		   nSegu*nSegv active flags (v fastest)
+		 An active patch is bounded by the box of its projected control
+		 net, which holds as long as its weights have one sign (they
+		 do for every active patch; a patch whose weights change sign
+		 is never culled).  The boxes of each surface form a binary
+		 hierarchy over its grid of patches.  The two hierarchies are
+		 traversed together, descending only into overlapping boxes,
+		 and each overlapping pair of patches is confirmed by recursive
+		 subdivision of their control nets (de Casteljau, in homogeneous
+		 coordinates) to depth CULLDEPTH.
+		 A patch with no confirmed partner is made inactive, in a copy
+		 of its surface read back with readTangSurf (Cbin surfaces are
+		 built only by their readers); the copies are intersected by
+		 the existing marching and tracing code, which still pairs all
+		 of the remaining active patches.  A surface with nothing
+		 culled is intersected as is, without a copy.
+		 The text of a surface is written to a temporary file once
+		 and read back once (into memory, parsed in place); a net may
+		 be kept and reused for other intersections of its surface
+		 (cullIntersectNets).
+		 The grid of patches is unchanged, so patch indices in the
+		 intersection and its trace are those of the original surfaces.
+  Usage:	 cullIntersect (obdualA[0], obdualA[1], iCurve, iCurveTrace, epsInt, "a");
+  		 or, reusing the net of T:
+		 TangSurfNet N;  readTangSurfNet (T, N);
+		 cullIntersectNets (S, NULL, T, &N, iCurve, trace, epsInt, "a");
+		 ...  freeTangSurfNet (N);
+*/
+
+#ifndef _TANGSURFCULL_H_
+#define _TANGSURFCULL_H_
+
+#include <ctype.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define CULLDEPTH  8		// subdivisions to confirm an overlapping patch pair
+#define CULLMAXDEG 15		// maximum degree of a culled surface
+
+struct TangSurfNet		// control net of a tangential surface, as stored
+{
+  int     degu, degv, nSegu, nSegv;
+  float  *ctrl;			// (degu*nSegu+1)*(degv*nSegv+1) homogeneous points
+  int     ownCtrl;		// ctrl allocated here (else borrowed, e.g. mapped)?
+  int    *active;		// nSegu*nSegv flags
+  int    *keep;			// active and confirmed against the other surface?
+  float  *box;			// 6 per patch (as in CullNode), or NULL: from ctrl
+  char   *text;			// stored text, or NULL (see write)
+  long    activeBegin, activeEnd;	// span of the active flags in text
+  void  (*write) (TangSurfNet &N, const int *active, FILE *f);
+  				// writes the text with the given flags, if no text
+  void   *src;  int srcSurf;	// source of write
+};
+
+struct CullNode			// patches [u0,u1) x [v0,v1)
+{
+  int     u0, u1, v0, v1;
+  int     child[2];		// -1: leaf (one patch)
+  int     empty;		// no active patch?
+  float   box[6];		// xmin,xmax,ymin,ymax,zmin,zmax (unbounded: infinite)
+};
+
+struct CullTree
+{
+  TangSurfNet *net;
+  CullNode    *node;
+  int          n;
+};
+
+/******************************************************************************/
+/******************************************************************************/
+
+static void initTangSurfNet (TangSurfNet &N)
+{
+  N.ctrl = NULL;  N.ownCtrl = 0;  N.active = N.keep = NULL;  N.box = NULL;
+  N.text = NULL;  N.activeBegin = N.activeEnd = 0;
+  N.write = NULL;  N.src = NULL;  N.srcSurf = 0;
+}
+
+static void freeTangSurfNet (TangSurfNet &N)
+{
+  if (N.ownCtrl) delete [] N.ctrl;
+  delete [] N.active;  delete [] N.keep;  delete [] N.box;  delete [] N.text;
+  initTangSurfNet (N);
+}
+
+/******************************************************************************
+	Store S in a temporary file, and read back its control net
+	(one write, one read).
+	Returns 0 on success, -1 if the text is not understood.
+******************************************************************************/
+
+static int readTangSurfNet (TangentialSurf &S, TangSurfNet &N)
+{
+  int i;
+  char file[] = "/tmp/tangSurfCullXXXXXX";
+  initTangSurfNet (N);
+  int fd = mkstemp (file);
+  if (fd == -1) return -1;
+  close (fd);
+  ofstream outfile (file);  S.storeTangSurf (outfile);  outfile.close();
+  FILE *f = fopen (file, "r");
+  if (!f) { unlink (file);  return -1; }
+  fseek (f, 0, SEEK_END);  long n = ftell (f);  fseek (f, 0, SEEK_SET);
+  N.text = new char[n+1];
+  n = fread (N.text, 1, n, f);  N.text[n] = 0;
+  fclose (f);
+  unlink (file);
+
+  char *c = N.text, *end;
+  while (isspace (*c)) c++;
+  if (isalpha (*c)) c++;				// type
+  int head[4], ok=1;
+  for (i=0; i<4 && ok; i++) { head[i] = strtol (c, &end, 10);  ok = (end != c && head[i] > 0);  c = end; }
+  if (!ok) { freeTangSurfNet (N);  return -1; }
+  N.degu = head[0];  N.degv = head[1];  N.nSegu = head[2];  N.nSegv = head[3];
+  int nCtrl = (N.degu*N.nSegu+1) * (N.degv*N.nSegv+1), nPatch = N.nSegu*N.nSegv;
+  for (i=0; i<N.nSegu+1 + N.nSegv+1 && ok; i++) { strtod (c, &end);  ok = (end != c);  c = end; }
+  N.ctrl   = new float[4*nCtrl];  N.ownCtrl = 1;
+  N.active = new int[nPatch];
+  N.keep   = new int[nPatch];
+  for (i=0; i<4*nCtrl && ok; i++) { N.ctrl[i] = strtod (c, &end);  ok = (end != c);  c = end; }
+  while (isspace (*c)) c++;
+  N.activeBegin = c - N.text;
+  for (i=0; i<nPatch && ok; i++)
+   {
+    N.active[i] = strtol (c, &end, 10);  ok = (end != c);  c = end;  N.keep[i] = 0;
+   }
+  N.activeEnd = c - N.text;
+  if (!ok) { freeTangSurfNet (N);  return -1; }
+  return 0;
+}
+
+/******************************************************************************
+	Read into T a copy of the stored surface, with only its kept patches
+	active.  Returns 0 on success.
+******************************************************************************/
+
+static int readCulledTangSurf (TangSurfNet &N, TangentialSurf &T)
+{
+  char file[] = "/tmp/tangSurfCullXXXXXX";
+  if (!N.text && !N.write) return -1;
+  int fd = mkstemp (file);
+  if (fd == -1) { cerr << "tangSurfCull: no temporary file" << endl;  return -1; }
+  FILE *f = fdopen (fd, "w");
+  if (N.text)
+   {
+    fwrite (N.text, 1, N.activeBegin, f);
+    for (int i=0; i<N.nSegu*N.nSegv; i++) fprintf (f, "%d ", N.keep[i]);
+    fputs (N.text + N.activeEnd, f);
+   }
+  else N.write (N, N.keep, f);
+  fclose (f);
+  ifstream infile (file);  T.readTangSurf (infile);  infile.close();
+  unlink (file);
+  return 0;
+}
+
+/******************************************************************************
+	Control net of patch (iu,iv), (degu+1) x (degv+1) homogeneous points.
+******************************************************************************/
+
+static void patchNet (TangSurfNet &N, int iu, int iv, float *P)
+{
+  int nv = N.degv*N.nSegv + 1;
+  for (int i=0; i<=N.degu; i++)
+    for (int j=0; j<=N.degv; j++)
+      memcpy (P + 4*(i*(N.degv+1)+j), N.ctrl + 4*((iu*N.degu+i)*nv + iv*N.degv+j), 4*sizeof(float));
+}
+
+/******************************************************************************
+	Box of the projected control net P of m points.
+	Returns 0 if the weights change sign (no bound).
+******************************************************************************/
+
+static int netBox (float *P, int m, float *box)
+{
+  int k, c, pos=0, neg=0;
+  for (k=0; k<m; k++) if (P[4*k+3] > 0) pos++;  else if (P[4*k+3] < 0) neg++;
+  if (pos != m && neg != m) return 0;
+  for (c=0; c<3; c++) { box[2*c] = 1e30;  box[2*c+1] = -1e30; }
+  for (k=0; k<m; k++)
+    for (c=0; c<3; c++)
+     {
+      float x = P[4*k+c] / P[4*k+3];
+      if (x < box[2*c])   box[2*c]   = x;
+      if (x > box[2*c+1]) box[2*c+1] = x;
+     }
+  return 1;
+}
+
+static inline int boxesOverlap (float *a, float *b)
+{
+  for (int c=0; c<3; c++)
+    if (a[2*c] > b[2*c+1] || b[2*c] > a[2*c+1]) return 0;
+  return 1;
+}
+
+/******************************************************************************
+	Split net P (du+1 x dv+1 points) at the middle of u (alongU) or v,
+	into L and R (de Casteljau).
+******************************************************************************/
+
+static void splitNet (float *P, int du, int dv, int alongU, float *L, float *R)
+{
+  int d = (alongU ? du : dv), nRow = (alongU ? dv : du), r, i, k, c;
+  float tmp[4*(CULLMAXDEG+1)];
+  for (r=0; r<=nRow; r++)
+   {
+    #define NETPT(Q,i) (Q + 4*(alongU ? (i)*(dv+1)+r : r*(dv+1)+(i)))
+    for (i=0; i<=d; i++) memcpy (tmp + 4*i, NETPT(P,i), 4*sizeof(float));
+    for (k=0; k<=d; k++)
+     {
+      memcpy (NETPT(L,k),   tmp,         4*sizeof(float));
+      memcpy (NETPT(R,d-k), tmp + 4*(d-k), 4*sizeof(float));
+      for (i=0; i<d-k; i++)
+	for (c=0; c<4; c++) tmp[4*i+c] = .5 * (tmp[4*i+c] + tmp[4*(i+1)+c]);
+     }
+    #undef NETPT
+   }
+}
+
+/******************************************************************************
+	Do the nets P (of S) and Q (of T) overlap after depth subdivisions?
+	Splits the net with the larger box, across its longer direction.
+******************************************************************************/
+
+static int netsOverlap (float *P, int pu, int pv, float *Q, int qu, int qv, int depth)
+{
+  float boxP[6], boxQ[6];
+  if (!netBox (P, (pu+1)*(pv+1), boxP) || !netBox (Q, (qu+1)*(qv+1), boxQ)) return 1;
+  if (!boxesOverlap (boxP, boxQ)) return 0;
+  if (depth == 0) return 1;
+  float sizeP = boxP[1]-boxP[0] + boxP[3]-boxP[2] + boxP[5]-boxP[4];
+  float sizeQ = boxQ[1]-boxQ[0] + boxQ[3]-boxQ[2] + boxQ[5]-boxQ[4];
+  int   splitP = (sizeP >= sizeQ);
+  float *X = (splitP ? P : Q);
+  int   du = (splitP ? pu : qu), dv = (splitP ? pv : qv);
+  // longer direction: compare the control polygons along u and along v
+  float lenU=0, lenV=0;
+  for (int c=0; c<3; c++)
+   {
+    float *p00 = X, *pu0 = X + 4*(du*(dv+1)), *p0v = X + 4*dv;
+    lenU += fabs (pu0[c]/pu0[3] - p00[c]/p00[3]);
+    lenV += fabs (p0v[c]/p0v[3] - p00[c]/p00[3]);
+   }
+  float *L = new float[8*(du+1)*(dv+1)], *R = L + 4*(du+1)*(dv+1);
+  splitNet (X, du, dv, lenU >= lenV, L, R);
+  int overlap = (splitP ? netsOverlap (L, pu, pv, Q, qu, qv, depth-1) ||
+			  netsOverlap (R, pu, pv, Q, qu, qv, depth-1)
+			: netsOverlap (P, pu, pv, L, qu, qv, depth-1) ||
+			  netsOverlap (P, pu, pv, R, qu, qv, depth-1));
+  delete [] L;
+  return overlap;
+}
+
+/******************************************************************************
+	Build the hierarchy of patches [u0,u1) x [v0,v1) in T.node,
+	splitting the longer side.  Returns the index of its root.
+******************************************************************************/
+
+static int buildCullTree (CullTree &T, int u0, int u1, int v0, int v1)
+{
+  TangSurfNet &N = *T.net;
+  int k = T.n++, c;
+  CullNode &nd = T.node[k];
+  nd.u0 = u0;  nd.u1 = u1;  nd.v0 = v0;  nd.v1 = v1;
+  nd.child[0] = nd.child[1] = -1;
+  if (u1-u0 == 1 && v1-v0 == 1)
+   {
+    nd.empty = !N.active[u0*N.nSegv+v0];
+    if (nd.empty) return k;
+    if (N.box) { memcpy (nd.box, N.box + 6*(u0*N.nSegv+v0), 6*sizeof(float));  return k; }
+    float *P = new float[4*(N.degu+1)*(N.degv+1)];
+    patchNet (N, u0, v0, P);
+    if (!netBox (P, (N.degu+1)*(N.degv+1), nd.box))
+      for (c=0; c<3; c++) { nd.box[2*c] = -1e30;  nd.box[2*c+1] = 1e30; }
+    delete [] P;
+    return k;
+   }
+  int c0, c1;
+  if (u1-u0 >= v1-v0)
+   { c0 = buildCullTree (T, u0, (u0+u1)/2, v0, v1);  c1 = buildCullTree (T, (u0+u1)/2, u1, v0, v1); }
+  else
+   { c0 = buildCullTree (T, u0, u1, v0, (v0+v1)/2);  c1 = buildCullTree (T, u0, u1, (v0+v1)/2, v1); }
+  nd.child[0] = c0;  nd.child[1] = c1;
+  nd.empty = T.node[c0].empty && T.node[c1].empty;
+  for (c=0; c<3; c++) { nd.box[2*c] = 1e30;  nd.box[2*c+1] = -1e30; }
+  for (int h=0; h<2; h++)
+   {
+    CullNode &ch = T.node[nd.child[h]];
+    if (!ch.empty)
+      for (c=0; c<3; c++)
+       {
+        if (ch.box[2*c]   < nd.box[2*c])   nd.box[2*c]   = ch.box[2*c];
+	if (ch.box[2*c+1] > nd.box[2*c+1]) nd.box[2*c+1] = ch.box[2*c+1];
+       }
+   }
+  return k;
+}
+
+/******************************************************************************
+	Traverse the hierarchies of S (node a) and T (node b) together,
+	marking the patches of confirmed pairs.  Returns # confirmed pairs.
+******************************************************************************/
+
+static int cullPairs (CullTree &S, int a, CullTree &T, int b)
+{
+  CullNode &na = S.node[a], &nb = T.node[b];
+  if (na.empty || nb.empty || !boxesOverlap (na.box, nb.box)) return 0;
+  if (na.child[0] == -1 && nb.child[0] == -1)
+   {
+    TangSurfNet &M = *S.net, &N = *T.net;
+    float *P = new float[4*(M.degu+1)*(M.degv+1)], *Q = new float[4*(N.degu+1)*(N.degv+1)];
+    patchNet (M, na.u0, na.v0, P);  patchNet (N, nb.u0, nb.v0, Q);
+    int overlap = netsOverlap (P, M.degu, M.degv, Q, N.degu, N.degv, CULLDEPTH);
+    delete [] P;  delete [] Q;
+    if (overlap) M.keep[na.u0*M.nSegv+na.v0] = N.keep[nb.u0*N.nSegv+nb.v0] = 1;
+    return overlap;
+   }
+  // descend into the larger node (or the one that is not a leaf)
+  int intoA = (nb.child[0] == -1 ||
+	       (na.child[0] != -1 && (na.u1-na.u0)*(na.v1-na.v0) >= (nb.u1-nb.u0)*(nb.v1-nb.v0)));
+  if (intoA) return cullPairs (S, na.child[0], T, b) + cullPairs (S, na.child[1], T, b);
+  else       return cullPairs (S, a, T, nb.child[0]) + cullPairs (S, a, T, nb.child[1]);
+}
+
+/******************************************************************************
+	Intersect S and T (as S.intersect (T, iCurve, trace, eps)), after
+	culling the patches that cannot meet, given the net of S (NS) and
+	of T (NT); a NULL net is read here.  The given nets may be reused.
+	Falls back to intersecting S and T directly if their stored form is
+	not understood, or if a degree exceeds CULLMAXDEG.
+******************************************************************************/
+
+static void cullIntersectNets (TangentialSurf &S, TangSurfNet *NS, TangentialSurf &T, TangSurfNet *NT,
+			       PatchIntersection &iCurve, PatchIntArrArrArr &trace, float eps,
+			       const char *space)
+{
+  TangSurfNet read[2], *N[2] = {NS, NT};
+  TangentialSurf *surf[2] = {&S, &T};
+  int i, k, ok=1;
+  for (k=0; k<2; k++)
+   {
+    initTangSurfNet (read[k]);
+    if (!N[k]) { ok = ok && !readTangSurfNet (*surf[k], read[k]);  N[k] = &read[k]; }
+   }
+  for (k=0; k<2 && ok; k++) ok = N[k]->ctrl && N[k]->degu <= CULLMAXDEG && N[k]->degv <= CULLMAXDEG;
+  if (!ok)
+   {
+    cout << "No patch culling in " << space << "-space" << endl;
+    freeTangSurfNet (read[0]);  freeTangSurfNet (read[1]);
+    S.intersect (T, iCurve, trace, eps);
+    return;
+   }
+  CullTree tree[2];
+  int root[2];
+  for (k=0; k<2; k++)
+   {
+    for (i=0; i<N[k]->nSegu*N[k]->nSegv; i++) N[k]->keep[i] = 0;
+    tree[k].net  = N[k];
+    tree[k].node = new CullNode[2*N[k]->nSegu*N[k]->nSegv - 1];
+    tree[k].n    = 0;
+    root[k] = buildCullTree (tree[k], 0, N[k]->nSegu, 0, N[k]->nSegv);
+   }
+  int nPair = cullPairs (tree[0], root[0], tree[1], root[1]);
+  int nActive[2] = {0,0}, nKeep[2] = {0,0};
+  for (k=0; k<2; k++)
+    for (i=0; i<N[k]->nSegu*N[k]->nSegv; i++) { nActive[k] += N[k]->active[i];  nKeep[k] += N[k]->keep[i]; }
+  cout << space << "-space: " << nPair << " of " << nActive[0]*nActive[1]
+       << " active patch pairs overlap; intersecting " << nKeep[0] << " of " << nActive[0]
+       << " and " << nKeep[1] << " of " << nActive[1] << " patches" << endl;
+  TangentialSurf culled[2], *use[2] = {&S, &T};
+  for (k=0; k<2; k++)				// copy only a surface with culled patches
+    if (nKeep[k] < nActive[k] && readCulledTangSurf (*N[k], culled[k]) == 0) use[k] = &culled[k];
+  use[0]->intersect (*use[1], iCurve, trace, eps);
+  for (k=0; k<2; k++) { delete [] tree[k].node;  freeTangSurfNet (read[k]); }
+}
+
+static void cullIntersect (TangentialSurf &S, TangentialSurf &T, PatchIntersection &iCurve,
+			   PatchIntArrArrArr &trace, float eps, const char *space)
+{
+  cullIntersectNets (S, NULL, T, NULL, iCurve, trace, eps, space);
+}
+
+#endif
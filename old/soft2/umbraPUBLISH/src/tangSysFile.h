@@ -0,0 +1,507 @@
+/*
+  File:          tangSysFile.h
+  Created:	 17 October 2026
+  Purpose:       Binary storage of tangential surface systems (bidev -s/-S),
+                 memory-mapped and checked on restart.
+		 A system of nOb obstacles holds 4 surfaces per obstacle,
+		 surface 4*i+k: the primal Bezier surface (k=0) and its
+		 tangential a-, b- and c-surfaces (k=1,2,3), as in the text
+		 format of storeBezSurf and storeTangSurf (a .tangsurf file):
+		   [ comment ]
+		   { primal: degu degv nSegu nSegv, knots, xyz points }
+		   { tangential: type, degu degv nSegu nSegv, knots,
+		     xyzw points (v fastest), active flag per patch }
+		   ...
+		 The binary file (.tangbin), in native byte order:
+		   header	   magic, version, byte order check, nOb, nSurf,
+		   		   offset of the surface index, file size, and
+				   checksums of the header and the index
+		   surface index   per surface: type, dimension, degrees,
+		   		   segments, offsets of its arrays, checksum
+		   per surface	   u and v knots (float),
+		   		   control points (float, 3 or 4 per point),
+				   patch index: per patch its active flag, its
+				   first control point and the box of its
+				   control net (projected: for a tangential
+				   patch whose weights change sign, unbounded)
+		 Every array starts on a TANGSYSALIGN-byte boundary, so the
+		 mapping can be used in place: code that works on control nets
+		 reads them from the mapping (e.g., tangSysCullNet, for the
+		 patch culling of tangSurfCull.h, uses the mapped control
+		 points and patch boxes).  A primal surface is built
+		 straight from its mapped knots and control points
+		 (BezierSurf3f::create, as bidev's inputSurfaces does).
+		 A tangential surface has no such constructor (it is built
+		 by createA/B/C or by readTangSurf), so loadTangSysSurf
+		 writes its text (exactly, %.9g) to a temporary file for
+		 readTangSurf to parse: restart is not faster for tangential
+		 surfaces, only independent of one another, so parallel.
+		 The binary file is written from the text, since Cbin
+		 surfaces give their nets only as text.
+		 Checksums are 64-bit FNV-1a.
+		 Bump TANGSYSVERSION on any change of layout.
+  Usage:	 convertTangSys ("x.tangsurf", "x.tangbin");	// text to binary
+  		 TangSys T;  if (mapTangSys ("x.tangbin", T, 1) == 0) ...
+		 tangSysKnotu (T, s), tangSysCtrl (T, s), tangSysPatch (T, s) ...
+		 loadTangSysSurf (T, 4*i, obstacle[i]);  loadTangSysSurf (T, 4*i+1, obdualA[i]);
+		 TangSurfNet N;  tangSysCullNet (T, 4*i+1, N);	// (tangSurfCull.h first)
+		 ...  freeTangSurfNet (N);  unmapTangSys (T);
+*/
+
+#ifndef _TANGSYSFILE_H_
+#define _TANGSYSFILE_H_
+
+#include <ctype.h>
+#include <fcntl.h>
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define TANGSYSMAGIC   "TANGSYS"
+#define TANGSYSVERSION 1
+#define TANGSYSORDER   0x01020304	// reads otherwise in the other byte order
+#define TANGSYSALIGN   64		// alignment of every array
+
+struct TangSysHeader		// 64 bytes
+{
+  char     magic[8];
+  uint32_t version, order, nOb, nSurf;
+  uint64_t indexOffset, fileSize;
+  uint64_t indexSum;		// checksum of the surface index
+  uint64_t headerSum;		// checksum of the header up to here
+  uint64_t reserved;
+};
+
+struct TangSysSurf		// 64 bytes
+{
+  uint32_t type;		// 'p' (primal), 'a', 'b' or 'c'
+  uint32_t dim;			// 3 (primal) or 4 (homogeneous)
+  int32_t  degu, degv, nSegu, nSegv;
+  uint64_t knotOffset, ctrlOffset, patchOffset;
+  uint64_t dataSize;		// from knotOffset to the end of the patch index
+  uint64_t sum;			// checksum of knots, control points and patch index
+};
+
+struct TangSysPatch		// 32 bytes
+{
+  int32_t  active;
+  int32_t  ctrl;		// first control point (row of degu*i, column of degv*j)
+  float    box[6];		// xmin,xmax,ymin,ymax,zmin,zmax of its control net
+};
+
+struct TangSys			// a mapped file
+{
+  char          *base;
+  size_t         size;
+  TangSysHeader *header;
+  TangSysSurf   *surf;
+};
+
+struct TangSysNet		// one surface, in memory (text conversion)
+{
+  char   type;
+  int    dim, degu, degv, nSegu, nSegv;
+  float *knot;			// nSegu+1 u knots, then nSegv+1 v knots
+  float *ctrl;			// (degu*nSegu+1)*(degv*nSegv+1) points, v fastest
+  int   *active;		// nSegu*nSegv flags, v fastest
+};
+
+static inline float       *tangSysKnotu (TangSys &T, int s) { return (float *) (T.base + T.surf[s].knotOffset); }
+static inline float       *tangSysKnotv (TangSys &T, int s) { return tangSysKnotu (T, s) + T.surf[s].nSegu+1; }
+static inline float       *tangSysCtrl  (TangSys &T, int s) { return (float *) (T.base + T.surf[s].ctrlOffset); }
+static inline TangSysPatch *tangSysPatch (TangSys &T, int s) { return (TangSysPatch *) (T.base + T.surf[s].patchOffset); }
+
+static inline uint64_t tangSysAlign (uint64_t offset)
+{
+  return (offset + TANGSYSALIGN-1) / TANGSYSALIGN * TANGSYSALIGN;
+}
+
+/******************************************************************************
+	64-bit FNV-1a checksum of n bytes, continuing from sum
+	(start from TANGSYSSUM0).
+******************************************************************************/
+
+#define TANGSYSSUM0 14695981039346656037ULL
+
+static uint64_t tangSysSum (const void *data, size_t n, uint64_t sum)
+{
+  const unsigned char *c = (const unsigned char *) data;
+  for (size_t i=0; i<n; i++) { sum ^= c[i];  sum *= 1099511628211ULL; }
+  return sum;
+}
+
+/******************************************************************************/
+/******************************************************************************/
+
+static void freeTangSysNets (TangSysNet *net, int nSurf)
+{
+  for (int s=0; s<nSurf; s++) { delete [] net[s].knot;  delete [] net[s].ctrl;  delete [] net[s].active; }
+  delete [] net;
+}
+
+static inline int tangSysNCtrl (int degu, int degv, int nSegu, int nSegv)
+{
+  return (degu*nSegu+1) * (degv*nSegv+1);
+}
+
+/******************************************************************************
+	Read the text of a stored system (a .tangsurf file) into nSurf nets.
+	Returns 0 on success, -1 if the text is not understood.
+******************************************************************************/
+
+static int readTangSysText (const char *file, int &nSurf, TangSysNet *&net)
+{
+  FILE *f = fopen (file, "r");
+  if (!f) { fprintf (stderr, "tangSysFile: cannot open %s\n", file);  return -1; }
+  fseek (f, 0, SEEK_END);  long n = ftell (f);  fseek (f, 0, SEEK_SET);
+  char *text = new char[n+1];
+  n = fread (text, 1, n, f);  text[n] = 0;
+  fclose (f);
+  int i, maxSurf = 8;
+  nSurf = 0;  net = new TangSysNet[maxSurf];
+  char *c = text, *end;
+  if ((c = strchr (c, ']')) == NULL) c = text;		// skip comment
+  int ok = 1;
+  while (ok && (c = strchr (c, '{')) != NULL)
+   {
+    c++;
+    if (nSurf == maxSurf)
+     {
+      TangSysNet *bigger = new TangSysNet[2*maxSurf];
+      memcpy (bigger, net, nSurf*sizeof(TangSysNet));
+      delete [] net;  net = bigger;  maxSurf *= 2;
+     }
+    TangSysNet &N = net[nSurf];
+    N.knot = N.ctrl = NULL;  N.active = NULL;
+    while (isspace (*c)) c++;
+    if (isalpha (*c)) { N.type = *c++;  N.dim = 4; }		// tangential
+    else              { N.type = 'p';   N.dim = 3; }		// primal
+    int head[4];
+    for (i=0; i<4 && ok; i++) { head[i] = strtol (c, &end, 10);  ok = (end != c && head[i] > 0);  c = end; }
+    nSurf++;
+    if (!ok) break;
+    N.degu = head[0];  N.degv = head[1];  N.nSegu = head[2];  N.nSegv = head[3];
+    int nKnot = N.nSegu+1 + N.nSegv+1, nCtrl = tangSysNCtrl (N.degu, N.degv, N.nSegu, N.nSegv);
+    int nPatch = N.nSegu*N.nSegv;
+    N.knot   = new float[nKnot];
+    N.ctrl   = new float[N.dim*nCtrl];
+    N.active = new int[nPatch];
+    for (i=0; i<nKnot && ok; i++)       { N.knot[i] = strtod (c, &end);  ok = (end != c);  c = end; }
+    for (i=0; i<N.dim*nCtrl && ok; i++) { N.ctrl[i] = strtod (c, &end);  ok = (end != c);  c = end; }
+    for (i=0; i<nPatch && ok; i++)
+      if (N.type == 'p') N.active[i] = 1;
+      else { N.active[i] = strtol (c, &end, 10);  ok = (end != c);  c = end; }
+    while (ok && isspace (*c)) c++;
+    ok = ok && (*c == '}');
+   }
+  delete [] text;
+  if (!ok || nSurf == 0 || nSurf % 4)
+   {
+    fprintf (stderr, "tangSysFile: %s is not a stored tangential surface system (surface %d)\n", file, nSurf);
+    freeTangSysNets (net, nSurf);  net = NULL;  nSurf = 0;
+    return -1;
+   }
+  return 0;
+}
+
+/******************************************************************************
+	Box of the control net of patch (i,j) of N.  Returns 0 (and an
+	unbounded box) if homogeneous weights change sign.
+******************************************************************************/
+
+static int tangSysPatchBox (int dim, int degu, int degv, int nv, float *P, float *box)
+{
+  int k, l, c, sign=0;
+  for (c=0; c<3; c++) { box[2*c] = 1e30;  box[2*c+1] = -1e30; }
+  for (k=0; k<=degu; k++)
+    for (l=0; l<=degv; l++)
+     {
+      float *Q = P + dim*(k*nv + l), w = (dim == 4 ? Q[3] : 1);
+      int sw = (w > 0 ? 1 : (w < 0 ? -1 : 0));
+      if (sw == 0 || (sign && sw != sign))
+       {
+        for (c=0; c<3; c++) { box[2*c] = -1e30;  box[2*c+1] = 1e30; }
+	return 0;
+       }
+      sign = sw;
+      for (c=0; c<3; c++)
+       {
+        if (Q[c]/w < box[2*c])   box[2*c]   = Q[c]/w;
+	if (Q[c]/w > box[2*c+1]) box[2*c+1] = Q[c]/w;
+       }
+     }
+  return 1;
+}
+
+/******************************************************************************
+	Write nSurf nets as a binary system.  Returns 0 on success.
+******************************************************************************/
+
+static int writeTangSys (const char *file, int nSurf, TangSysNet *net)
+{
+  int s, i, j;
+  TangSysHeader H;
+  memset (&H, 0, sizeof(H));
+  strcpy (H.magic, TANGSYSMAGIC);
+  H.version = TANGSYSVERSION;  H.order = TANGSYSORDER;
+  H.nOb = nSurf/4;  H.nSurf = nSurf;
+  H.indexOffset = tangSysAlign (sizeof(H));
+  TangSysSurf *index = new TangSysSurf[nSurf];
+  memset (index, 0, nSurf*sizeof(TangSysSurf));
+  uint64_t offset = H.indexOffset + nSurf*sizeof(TangSysSurf);
+  for (s=0; s<nSurf; s++)			// layout
+   {
+    TangSysNet &N = net[s];  TangSysSurf &S = index[s];
+    S.type = N.type;  S.dim = N.dim;
+    S.degu = N.degu;  S.degv = N.degv;  S.nSegu = N.nSegu;  S.nSegv = N.nSegv;
+    S.knotOffset  = tangSysAlign (offset);
+    S.ctrlOffset  = tangSysAlign (S.knotOffset + (N.nSegu+1 + N.nSegv+1)*sizeof(float));
+    S.patchOffset = tangSysAlign (S.ctrlOffset + N.dim*tangSysNCtrl (N.degu, N.degv, N.nSegu, N.nSegv)*sizeof(float));
+    offset = S.patchOffset + N.nSegu*N.nSegv*sizeof(TangSysPatch);
+    S.dataSize = offset - S.knotOffset;
+   }
+  H.fileSize = offset;
+  char *buf = new char[H.fileSize];
+  memset (buf, 0, H.fileSize);
+  for (s=0; s<nSurf; s++)			// arrays, patch index and checksums
+   {
+    TangSysNet &N = net[s];  TangSysSurf &S = index[s];
+    int nv = N.degv*N.nSegv + 1;
+    memcpy (buf + S.knotOffset, N.knot, (N.nSegu+1 + N.nSegv+1)*sizeof(float));
+    memcpy (buf + S.ctrlOffset, N.ctrl, N.dim*tangSysNCtrl (N.degu, N.degv, N.nSegu, N.nSegv)*sizeof(float));
+    TangSysPatch *patch = (TangSysPatch *) (buf + S.patchOffset);
+    for (i=0; i<N.nSegu; i++)
+      for (j=0; j<N.nSegv; j++)
+       {
+        TangSysPatch &p = patch[i*N.nSegv+j];
+	p.active = N.active[i*N.nSegv+j];
+	p.ctrl   = N.degu*i*nv + N.degv*j;
+	tangSysPatchBox (N.dim, N.degu, N.degv, nv, N.ctrl + N.dim*p.ctrl, p.box);
+       }
+    S.sum = tangSysSum (buf + S.knotOffset, S.dataSize, TANGSYSSUM0);
+   }
+  H.indexSum  = tangSysSum (index, nSurf*sizeof(TangSysSurf), TANGSYSSUM0);
+  H.headerSum = tangSysSum (&H, offsetof (TangSysHeader, headerSum), TANGSYSSUM0);
+  memcpy (buf, &H, sizeof(H));
+  memcpy (buf + H.indexOffset, index, nSurf*sizeof(TangSysSurf));
+  FILE *f = fopen (file, "wb");
+  int ok = (f && fwrite (buf, 1, H.fileSize, f) == H.fileSize);
+  if (f) ok = (fclose (f) == 0) && ok;
+  if (!ok) fprintf (stderr, "tangSysFile: cannot write %s\n", file);
+  delete [] buf;  delete [] index;
+  return (ok ? 0 : -1);
+}
+
+/******************************************************************************
+	Convert a stored system from text (.tangsurf) to binary (.tangbin).
+	Returns 0 on success.
+******************************************************************************/
+
+static int convertTangSys (const char *textFile, const char *binFile)
+{
+  int nSurf;
+  TangSysNet *net;
+  if (readTangSysText (textFile, nSurf, net)) return -1;
+  int result = writeTangSys (binFile, nSurf, net);
+  freeTangSysNets (net, nSurf);
+  return result;
+}
+
+/******************************************************************************
+	Is file a binary system (by its magic number)?
+******************************************************************************/
+
+static int isTangSysFile (const char *file)
+{
+  char magic[8];
+  FILE *f = fopen (file, "rb");
+  if (!f) return 0;
+  int is = (fread (magic, 1, 8, f) == 8 && !memcmp (magic, TANGSYSMAGIC, 8));
+  fclose (f);
+  return is;
+}
+
+/******************************************************************************
+	Map a binary system, checking its version, layout and header and
+	index checksums, and (if verify) the checksum of every surface.
+	Returns 0 on success, -1 (with a message) otherwise.
+******************************************************************************/
+
+static void unmapTangSys (TangSys &T)
+{
+  if (T.base) munmap (T.base, T.size);
+  T.base = NULL;
+}
+
+static int mapTangSys (const char *file, TangSys &T, int verify)
+{
+  T.base = NULL;
+  int fd = open (file, O_RDONLY);
+  if (fd == -1) { fprintf (stderr, "tangSysFile: cannot open %s\n", file);  return -1; }
+  struct stat st;
+  if (fstat (fd, &st) || (size_t) st.st_size < sizeof(TangSysHeader))
+   { fprintf (stderr, "tangSysFile: %s is too short\n", file);  close (fd);  return -1; }
+  T.size = st.st_size;
+  void *base = mmap (NULL, T.size, PROT_READ, MAP_SHARED, fd, 0);
+  close (fd);
+  if (base == MAP_FAILED) { fprintf (stderr, "tangSysFile: cannot map %s\n", file);  return -1; }
+  T.base = (char *) base;
+  T.header = (TangSysHeader *) T.base;
+  TangSysHeader &H = *T.header;
+  const char *error = NULL;
+  if (memcmp (H.magic, TANGSYSMAGIC, 8))			error = "not a binary tangential surface system";
+  else if (H.order != TANGSYSORDER)				error = "written in the other byte order";
+  else if (H.version != TANGSYSVERSION)				error = "of another version";
+  else if (H.headerSum != tangSysSum (&H, offsetof (TangSysHeader, headerSum), TANGSYSSUM0))
+								error = "header checksum fails";
+  else if (H.fileSize != T.size)				error = "truncated";
+  else if (H.nSurf != 4*H.nOb || H.indexOffset % TANGSYSALIGN ||
+	   H.indexOffset + (uint64_t) H.nSurf*sizeof(TangSysSurf) > T.size)
+								error = "surface index out of bounds";
+  else if (H.indexSum != tangSysSum (T.base + H.indexOffset, H.nSurf*sizeof(TangSysSurf), TANGSYSSUM0))
+								error = "surface index checksum fails";
+  T.surf = (TangSysSurf *) (T.base + H.indexOffset);
+  for (uint32_t s=0; s<H.nSurf && !error; s++)
+   {
+    TangSysSurf &S = T.surf[s];
+    uint64_t nCtrl = (uint64_t) (S.degu*S.nSegu+1) * (S.degv*S.nSegv+1);
+    if (S.degu < 1 || S.degv < 1 || S.nSegu < 1 || S.nSegv < 1 || (S.dim != 3 && S.dim != 4) ||
+	S.knotOffset % TANGSYSALIGN || S.ctrlOffset % TANGSYSALIGN || S.patchOffset % TANGSYSALIGN ||
+	S.ctrlOffset  < S.knotOffset + (S.nSegu+1 + S.nSegv+1)*sizeof(float) ||
+	S.patchOffset < S.ctrlOffset + S.dim*nCtrl*sizeof(float) ||
+	S.knotOffset + S.dataSize != S.patchOffset + (uint64_t) S.nSegu*S.nSegv*sizeof(TangSysPatch) ||
+	S.knotOffset + S.dataSize > T.size)
+      error = "surface out of bounds";
+    else if (S.type != (uint32_t) (s%4 ? "abc"[s%4-1] : 'p') || S.dim != (s%4 ? 4u : 3u))
+      error = "surface of the wrong type (4 per obstacle: primal, a, b, c)";
+    else if (verify && S.sum != tangSysSum (T.base + S.knotOffset, S.dataSize, TANGSYSSUM0))
+      error = "surface checksum fails";
+   }
+  if (error)
+   {
+    fprintf (stderr, "tangSysFile: %s: %s\n", file, error);
+    unmapTangSys (T);
+    return -1;
+   }
+  return 0;
+}
+
+/******************************************************************************
+	Write surface s of T in the text of storeBezSurf/storeTangSurf,
+	exactly (9 significant digits round-trip a float); with the
+	given active flags if not NULL.
+******************************************************************************/
+
+static void writeTangSysSurfText (TangSys &T, int s, FILE *f, const int *active=NULL)
+{
+  int i, k;
+  TangSysSurf &S = T.surf[s];
+  float *knot = tangSysKnotu (T, s), *P = tangSysCtrl (T, s);
+  TangSysPatch *patch = tangSysPatch (T, s);
+  if (S.type != 'p') fprintf (f, "%c\n", S.type);
+  fprintf (f, "%d %d %d %d\n", S.degu, S.degv, S.nSegu, S.nSegv);
+  for (i=0; i<S.nSegu+1; i++) fprintf (f, "%.9g ", knot[i]);
+  fprintf (f, "\n");
+  for (; i<S.nSegu+1 + S.nSegv+1; i++) fprintf (f, "%.9g ", knot[i]);
+  fprintf (f, "\n");
+  int nCtrl = tangSysNCtrl (S.degu, S.degv, S.nSegu, S.nSegv);
+  for (i=0; i<nCtrl; i++, P += S.dim)
+    if (S.dim == 4) fprintf (f, "%.9g %.9g %.9g %.9g\n", P[0], P[1], P[2], P[3]);
+    else            fprintf (f, "%.9g %.9g %.9g\n", P[0], P[1], P[2]);
+  if (S.type != 'p')
+   {
+    for (k=0; k<S.nSegu*S.nSegv; k++) fprintf (f, "%d ", (active ? active[k] : patch[k].active));
+    fprintf (f, "\n");
+   }
+}
+
+/******************************************************************************
+	Build surface s of T as a primal (S) or tangential (T) surface.
+	A primal surface is built from the mapping; a tangential surface
+	is written as text to a temporary file and parsed by readTangSurf.
+	Surfaces are independent, so they may be loaded in parallel.
+	Returns 0 on success, -1 if s is of the other kind or cannot be read.
+******************************************************************************/
+
+static int loadTangSysSurf (TangSys &T, int s, BezierSurf3f &S)
+{
+  TangSysSurf &D = T.surf[s];
+  if (D.type != 'p' || D.dim != 3) return -1;
+  int i, j, nu = D.degu*D.nSegu + 1, nv = D.degv*D.nSegv + 1;
+  float *knot = tangSysKnotu (T, s), *P = tangSysCtrl (T, s);
+  FloatArr knotu(D.nSegu+1), knotv(D.nSegv+1);
+  for (i=0; i<=D.nSegu; i++) knotu[i] = knot[i];
+  for (i=0; i<=D.nSegv; i++) knotv[i] = knot[D.nSegu+1 + i];
+  V3fArrArr Pt(nu);
+  for (i=0; i<nu; i++)
+   {
+    Pt[i].allocate (nv);
+    for (j=0; j<nv; j++, P += 3) { Pt[i][j][0] = P[0];  Pt[i][j][1] = P[1];  Pt[i][j][2] = P[2]; }
+   }
+  S.create (3, D.degu, D.degv, D.nSegu, D.nSegv, Pt, knotu, knotv);
+  return 0;
+}
+
+static int loadTangSysSurf (TangSys &T, int s, TangentialSurf &S)
+{
+  char file[] = "/tmp/tangSysXXXXXX";
+  if (T.surf[s].type == 'p') return -1;
+  int fd = mkstemp (file);
+  if (fd == -1) { fprintf (stderr, "tangSysFile: no temporary file\n");  return -1; }
+  FILE *f = fdopen (fd, "w");
+  if (!f) { close (fd);  unlink (file);  return -1; }
+  writeTangSysSurfText (T, s, f);
+  int ok = (fclose (f) == 0);
+  if (ok)
+   {
+    ifstream infile (file);
+    S.readTangSurf (infile);
+    ok = !infile.fail();
+    infile.close();
+   }
+  unlink (file);
+  return (ok ? 0 : -1);
+}
+
+/******************************************************************************
+	Net N (tangSurfCull.h) of tangential surface s of T, in place:
+	its control points are the mapped ones, its patch boxes those of
+	the patch index, and a culled copy is written from the mapping.
+	Only if tangSurfCull.h is included first.  Returns 0 on success.
+******************************************************************************/
+
+#ifdef _TANGSURFCULL_H_
+
+static void tangSysWriteNet (TangSurfNet &N, const int *active, FILE *f)
+{
+  writeTangSysSurfText (*(TangSys *) N.src, N.srcSurf, f, active);
+}
+
+static int tangSysCullNet (TangSys &T, int s, TangSurfNet &N)
+{
+  initTangSurfNet (N);
+  TangSysSurf &S = T.surf[s];
+  if (S.type == 'p' || S.dim != 4) return -1;
+  int k, nPatch = S.nSegu*S.nSegv;
+  TangSysPatch *patch = tangSysPatch (T, s);
+  N.degu = S.degu;  N.degv = S.degv;  N.nSegu = S.nSegu;  N.nSegv = S.nSegv;
+  N.ctrl   = tangSysCtrl (T, s);
+  N.active = new int[nPatch];  N.keep = new int[nPatch];  N.box = new float[6*nPatch];
+  for (k=0; k<nPatch; k++)
+   {
+    N.active[k] = patch[k].active;  N.keep[k] = 0;
+    memcpy (N.box + 6*k, patch[k].box, 6*sizeof(float));
+   }
+  N.write = tangSysWriteNet;  N.src = &T;  N.srcSurf = s;
+  return 0;
+}
+
+#endif
+
+#endif
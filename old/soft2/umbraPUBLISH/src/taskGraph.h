@@ -0,0 +1,219 @@
+/*
+  File:          taskGraph.h
+  Created:	 17 October 2026
+  Purpose:       Execution of a small acyclic graph of dependent tasks over a
+                 pool of POSIX threads, timing every task.
+		 A task is ready once all of its predecessors have finished;
+		 ready tasks are run in the order they became ready, by
+		 whichever thread is free.
+		 Each task belongs to a named stage (e.g., "createA"); the
+		 report gives the wall time of every task and, per stage,
+		 the span from its first start to its last finish.
+		 As with workStealFor, tasks must write to disjoint,
+		 preallocated storage.
+  Usage:	 void task (int k, void *arg);
+  		 TaskGraph G;  initTaskGraph (G, maxTask);
+  		 int t = addTask (G, "stage", k, task, arg);
+		 addDependency (G, t, u);		// u waits for t
+		 runTaskGraph (G, nThread);
+		 reportTaskGraph (G);  freeTaskGraph (G);
+		 Link with -lpthread.
+*/
+
+#ifndef _TASKGRAPH_H_
+#define _TASKGRAPH_H_
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include "workSteal.h"		// WorkStealTask, nProcessor
+
+struct TaskGraphNode
+{
+  const char    *stage;
+  int            k;		// task (k, arg)
+  WorkStealTask  task;
+  void          *arg;
+  int            nWait;		// unfinished predecessors
+  int            succ;		// first successor edge (-1: none)
+  double         start, end;	// seconds since runTaskGraph
+};
+
+struct TaskGraph
+{
+  int            n, maxTask;
+  TaskGraphNode *node;
+  int            nEdge, maxEdge;
+  int           *edgeTo, *edgeNext;	// successor lists
+  double         sec;			// wall time of runTaskGraph
+  // state of a run
+  pthread_mutex_t lock;
+  pthread_cond_t  ready;
+  int            *queue, qHead, qTail;	// ready tasks
+  int             nDone;
+  double          t0;
+};
+
+static inline double taskClock ()
+{
+  struct timeval tv;
+  gettimeofday (&tv, NULL);
+  return tv.tv_sec + tv.tv_usec * 1e-6;
+}
+
+/******************************************************************************/
+/******************************************************************************/
+
+static void initTaskGraph (TaskGraph &G, int maxTask)
+{
+  G.n = 0;      G.maxTask = maxTask;  G.node = new TaskGraphNode[maxTask];
+  G.nEdge = 0;  G.maxEdge = 2*maxTask;
+  G.edgeTo = new int[G.maxEdge];  G.edgeNext = new int[G.maxEdge];
+  G.queue = new int[maxTask];
+  G.sec = 0;
+}
+
+static void freeTaskGraph (TaskGraph &G)
+{
+  delete [] G.node;  delete [] G.edgeTo;  delete [] G.edgeNext;  delete [] G.queue;
+  G.n = G.nEdge = 0;
+}
+
+/******************************************************************************
+	Add task(k,arg), in stage, and return its identifier.
+******************************************************************************/
+
+static int addTask (TaskGraph &G, const char *stage, int k, WorkStealTask task, void *arg)
+{
+  if (G.n == G.maxTask) { fprintf (stderr, "taskGraph: more than %d tasks\n", G.maxTask);  exit (-1); }
+  TaskGraphNode &t = G.node[G.n];
+  t.stage = stage;  t.k = k;  t.task = task;  t.arg = arg;
+  t.nWait = 0;  t.succ = -1;  t.start = t.end = 0;
+  return G.n++;
+}
+
+/******************************************************************************
+	Task after may not start until task before has finished.
+******************************************************************************/
+
+static void addDependency (TaskGraph &G, int before, int after)
+{
+  if (G.nEdge == G.maxEdge)
+   {
+    int *to = new int[2*G.maxEdge], *next = new int[2*G.maxEdge];
+    memcpy (to,   G.edgeTo,   G.nEdge * sizeof(int));
+    memcpy (next, G.edgeNext, G.nEdge * sizeof(int));
+    delete [] G.edgeTo;  delete [] G.edgeNext;
+    G.edgeTo = to;  G.edgeNext = next;  G.maxEdge *= 2;
+   }
+  G.edgeTo[G.nEdge] = after;  G.edgeNext[G.nEdge] = G.node[before].succ;
+  G.node[before].succ = G.nEdge++;
+  G.node[after].nWait++;
+}
+
+/******************************************************************************/
+/******************************************************************************/
+
+static void *taskGraphRun (void *g)
+{
+  TaskGraph &G = *(TaskGraph *) g;
+  pthread_mutex_lock (&G.lock);
+  while (1)
+   {
+    while (G.qHead == G.qTail && G.nDone < G.n) pthread_cond_wait (&G.ready, &G.lock);
+    if (G.qHead == G.qTail) break;		// all done
+    TaskGraphNode &t = G.node[G.queue[G.qHead++]];
+    pthread_mutex_unlock (&G.lock);
+    t.start = taskClock() - G.t0;
+    t.task (t.k, t.arg);
+    t.end   = taskClock() - G.t0;
+    pthread_mutex_lock (&G.lock);
+    G.nDone++;
+    for (int e=t.succ; e!=-1; e=G.edgeNext[e])
+      if (--G.node[G.edgeTo[e]].nWait == 0) G.queue[G.qTail++] = G.edgeTo[e];
+    pthread_cond_broadcast (&G.ready);
+   }
+  pthread_mutex_unlock (&G.lock);
+  return NULL;
+}
+
+/******************************************************************************
+	Number of tasks that a topological sort (Kahn's algorithm) reaches:
+	G.n unless some tasks lie on or after a cycle of dependencies.
+******************************************************************************/
+
+static int taskGraphSorted (TaskGraph &G)
+{
+  int i, e, head=0, tail=0, *nWait = new int[G.n+1];
+  for (i=0; i<G.n; i++) 
+    if ((nWait[i] = G.node[i].nWait) == 0) G.queue[tail++] = i;
+  while (head < tail)
+    for (e=G.node[G.queue[head++]].succ; e!=-1; e=G.edgeNext[e])
+      if (--nWait[G.edgeTo[e]] == 0) G.queue[tail++] = G.edgeTo[e];
+  delete [] nWait;
+  return tail;
+}
+
+/******************************************************************************
+	Run every task on nThread threads (the calling thread included),
+	returning when all have finished.
+	nThread <= 1 runs them on the calling thread, in dependency order.
+	Cyclic dependencies (which would leave tasks waiting forever)
+	are rejected before any task runs.
+******************************************************************************/
+
+static void runTaskGraph (TaskGraph &G, int nThread)
+{
+  int i;
+  if (nThread > G.n) nThread = G.n;
+  if (nThread < 1)   nThread = 1;
+  pthread_mutex_init (&G.lock, NULL);
+  pthread_cond_init  (&G.ready, NULL);
+  G.qHead = G.qTail = G.nDone = 0;
+  if (taskGraphSorted (G) < G.n) { fprintf (stderr, "taskGraph: cyclic dependencies\n");  exit (-1); }
+  for (i=0; i<G.n; i++) if (G.node[i].nWait == 0) G.queue[G.qTail++] = i;
+  G.t0 = taskClock();
+  pthread_t *thread = new pthread_t[nThread];
+  for (i=1; i<nThread; i++) pthread_create (&thread[i], NULL, taskGraphRun, &G);
+  taskGraphRun (&G);
+  for (i=1; i<nThread; i++) pthread_join (thread[i], NULL);
+  G.sec = taskClock() - G.t0;
+  pthread_mutex_destroy (&G.lock);  pthread_cond_destroy (&G.ready);
+  delete [] thread;
+}
+
+/******************************************************************************
+	Print the wall time of every task, then of every stage
+	(first start to last finish, in order of first appearance).
+******************************************************************************/
+
+static void reportTaskGraph (TaskGraph &G)
+{
+  int i, j;
+  double busy=0;
+  for (i=0; i<G.n; i++)
+   {
+    TaskGraphNode &t = G.node[i];
+    printf ("  %-20s %3d: %9.3f s  (%.3f to %.3f)\n", t.stage, t.k, t.end - t.start, t.start, t.end);
+    busy += t.end - t.start;
+   }
+  for (i=0; i<G.n; i++)
+   {
+    for (j=0; j<i && strcmp (G.node[j].stage, G.node[i].stage); j++) ;
+    if (j < i) continue;			// stage already reported
+    double first = G.node[i].start, last = G.node[i].end;
+    for (j=i+1; j<G.n; j++)
+      if (!strcmp (G.node[j].stage, G.node[i].stage))
+       {
+        if (G.node[j].start < first) first = G.node[j].start;
+	if (G.node[j].end   > last)  last  = G.node[j].end;
+       }
+    printf ("  stage %-14s %9.3f s\n", G.node[i].stage, last - first);
+   }
+  printf ("  total %-14s %9.3f s  (%.3f s of tasks, %.1fx)\n", "", G.sec, busy,
+	  (G.sec > 0 ? busy / G.sec : 0));
+}
+
+#endif
@@ -2,7 +2,7 @@
   File:          umbra.cpp
   Author:        J.K. Johnstone 
   Created:	 15 February 2002
-  Last Modified: 28 February 2006
+  Last Modified: 17 October 2026
   Purpose:       Compute the umbra cast by a scene.
 		 Builds on bitang.c++, which computes bitangents.
   Sequence:	 4th in a sequence (interpolate, tangCurve, bitang, umbra)
@@ -59,6 +59,21 @@
 		          visual events.
 		 6/28/04:  Light --> distinguished object.
 		 2/28/06: updated to modern C++ library
+		 10/17/26: Parallel all-pairs bitangents (work-stealing threads, -j).
+		 10/17/26: Broad phase: skip tangential curve intersections whose 
+		           segment boxes do not overlap (-n to disable).
+		 10/17/26: O(n log n) merge of a- and b-space bitangents with 
+		           grid-hash near-duplicate removal (replaces bubbleSort 
+			   and deleteApproxDuplicate).
+		 10/17/26: Incremental update when one obstacle moves 
+		           (keys h,k,u,n; -x to disable).
+		 10/17/26: Headless batch mode (-b) over many scenes, in parallel,
+		           with JSON/binary output of bitangents, back umbrae 
+			   and timings (-o).
+		 10/17/26: Curvature-adaptive sampling of the back umbra boundary
+		           (chordal error -C) and streaming polygon construction.
+		 10/17/26: Disk cache of bitangents and self-bitangents, keyed by
+		           scene contents and parameters (-k).
 */
 
 #include <GL/glut.h>
@@ -81,6 +96,14 @@ using std::string;
 #include "curve/Scene2d.h"
 #include "tangcurve/TangCurve.h"		// CommonTangent, intersect, draw, visible
 #include "umbra/UmbralBitang.h"
+#include "workSteal.h"			// workStealFor, nProcessor
+#include "dualBox.h"			// buildDualBox, intersectDual, selfIntersectDual
+#include "bitangMerge.h"		// mergeCommonTangent
+#include "umbraUpdate.h"		// buildObBox, umbraDepends
+#include "umbraBatch.h"			// batchRun, writeUmbra, markStage
+#include "bezierBatch.h"		// evalBezierBatch (for adaptiveSample.h)
+#include "adaptiveSample.h"		// addSegmentAdaptive, PolygonBuilder
+#include "tangCache.h"			// tangCacheKey, openTangCache, beginTangCache
 
 #define PTSPERBEZSEGMENT 10      // # pts to draw on each Bezier segment
 #define MAXDIRECT        10      // maximum number of direct bitangents to one obstacle 
@@ -109,6 +132,15 @@ static void usage()
   cout << "\t[-w]   (weird case: A surrounds L: don't compute everything)" << endl;
   cout << "\t[-S]   (scene input)" << endl;
   cout << "\t[-t]   (only compute tangents, for debugging)" << endl;
+  cout << "\t[-n]   (no broad phase: intersect every pair of tangential curves)" << endl;
+  cout << "\t[-j #] (number of cores: threads for bitangent computation, shared by the scenes run in parallel in batch; 1 is serial; default: all cores)" << endl;
+  cout << "\t[-x]   (recompute everything when obstacle s is moved [keys h,k,u,n])" << endl;
+  cout << "\t[-C #] (chordal error of curve samples on umbra boundary; default .002)" << endl;
+  cout << "\t[-k]   (cache bitangents in <file>.pts.umbra.tcache, reused while" << endl;
+  cout << "\t\t\t\t the scene and -e, -F, -d are unchanged)" << endl;
+  cout << "\t[-b]   (batch: no display; compute every <file>.pts given, in parallel," << endl;
+  cout << "\t\t\t\t and write results to <file>.pts.json or .umb)" << endl;
+  cout << "\t[-o json|bin] (batch output format; default json)" << endl;
   cout << "\t[-P #] (number of levels to compute)" << endl;
   cout << "\t    0: scene display" << endl;
   cout << "\t    1: bitangents"    << endl;
@@ -127,7 +159,7 @@ static void usage()
   cout << "\t   14: global back umbra" << endl;
   cout << "\t   15: global front umbra" << endl;
   cout << "\t[-h]   (this help message)" << endl;
-  cout << "\t <file>.pts" << endl;
+  cout << "\t <file>.pts ..." << endl;
  }
 
 static GLfloat   transxob, transyob, zoomob;
@@ -177,13 +209,26 @@ static GLboolean SCENEINPUT=0;          // scene input?
 static GLboolean DRAWORIGIN=0;          // draw the origin?
 static GLboolean SURROUND=0;            // does A surround L?
 static GLboolean COMPUTETANGONLY=0;     // only compute bitangents, not umbra (for debugging)?
+static GLboolean BROADPHASE=1;          // cull pairs whose tangential curves cannot intersect?
 int              level=15;              // computation level
+int              nThread=-1;            // # threads for bitangents (-1: all cores)
+static GLboolean INCREMENTAL=1;         // after a move, only recompute what depends on it?
+float            chordTol=.002;         // chordal error of curve samples of back umbra
+static GLboolean TANGCACHE=0;           // cache bitangents on disk (tangCache.h)?
+static GLboolean BATCH=0;               // headless: compute and write each scene, no display?
+int              outputFormat=UMBRAJSON;// UMBRAJSON or UMBRABINARY (batch output)
+UmbraTimer       umbraTimer;            // per-stage timings of present scene
 
 Array<BezierCurve2f> 	obstacle;	// interpolating cubic Bezier curves
 int                     nOb;            // redundant, but useful
 V2fArr			obCentroid;	// obstacle centroids
+V2fArrArr		obPt;		// data points of obstacles (kept for moving them)
+ObBoxArr		obBox;		// obstacle bounding boxes (incremental update)
+BezierBatch	       *obBatch=NULL;	// batch evaluator of each obstacle (adaptiveSample.h)
 Array<TangentialCurve>  obduala;	// associated tangential a-curves
 Array<TangentialCurve>  obdualb;	// associated tangential b-curves
+Array<DualBoxArr>       obboxa;		// segment bounding boxes of obduala (broad phase)
+Array<DualBoxArr>       obboxb;		// segment bounding boxes of obdualb (broad phase)
 Array<UmbralBitangArr>  bitang;		// bitangents between curves and 'light'
 					// curve i/j bitangents are stored in 
 					// index i*obstacle.getn() + j
@@ -256,6 +301,8 @@ float color[][3]  = {{0,0,0}, {.8,.8,.8}, {0.411765, 0.411765, 0.411765},  // Bl
 int			obstacleWin;	// primal window identifier 
 int       		nPtsPerSegment = PTSPERBEZSEGMENT;
 
+void moveObstacle (int moved, float dx, float dy);	// keyboard edit of the scene
+
 /******************************************************************************/
 /******************************************************************************/
 
@@ -464,6 +511,10 @@ void keyboard (unsigned char key, int x, int y)
 		  Pause = 1;
 		 }
 		 					    break;
+  case 'h':	moveObstacle (specialOb, -.05, 0);	    break; // move left
+  case 'k':	moveObstacle (specialOb,  .05, 0);	    break; // move right
+  case 'u':	moveObstacle (specialOb, 0,  .05);	    break; // move up
+  case 'n':	moveObstacle (specialOb, 0, -.05);	    break; // move down
   default:                                                  break;
   }
   glutPostRedisplay();
@@ -1076,7 +1127,7 @@ void inputCurves (char *file, Array<BezierCurve2f> &obstacle)
 {
   int i,j;
   ifstream infile;  infile.open(file);  
-  V2fArrArr Pt;		// data points, organized into polygons
+  V2fArrArr &Pt = obPt;	// data points, organized into polygons
   read (infile, Pt);
   scaleToUnitSquare (Pt);
   obstacle.allocate(Pt.getn());
@@ -1092,52 +1143,193 @@ void inputCurves (char *file, Array<BezierCurve2f> &obstacle)
 }
 
 /******************************************************************************
-	Compute clipped tangential a/b-curves.
+	Compute clipped tangential a/b-curves,
+	and the bounding boxes of their segments for the broad phase.
+	If moved != -1, only recompute those of obstacle moved.
 ******************************************************************************/
 
-void buildTangentialCurves (Array<BezierCurve2f> &obstacle)
+void buildTangentialCurves (Array<BezierCurve2f> &obstacle, int moved=-1)
 {
-  obduala.allocate(obstacle.getn());  obdualb.allocate(obstacle.getn());
+  if (moved == -1)
+   {
+    obduala.allocate(obstacle.getn());  obdualb.allocate(obstacle.getn());
+    obboxa.allocate(obstacle.getn());   obboxb.allocate(obstacle.getn());
+   }
   for (int i=0; i<obstacle.getn(); i++)	
    {
+    if (moved != -1 && i != moved) continue;
     obduala[i].createA(obstacle[i], i);
 // cout << "obduala[" << i << "]:" << endl;  obduala[i].print();    
     obdualb[i].createB(obstacle[i], i);
 // cout << "obdualb[" << i << "]:" << endl;  obdualb[i].print();    
+    buildDualBox (obduala[i], epsIntersect, obboxa[i]);
+    buildDualBox (obdualb[i], epsIntersect, obboxb[i]);
    }
 }
 
+/******************************************************************************
+	Intersect the tangential curves of obstacles i and j (i<j) 
+	to find their bitangents, merging a- and b-space results.
+	The exact intersection in a dual space is skipped when no pair of 
+	segment boxes overlaps there (broad phase), and otherwise restricted 
+	to the segments that overlap a segment of the other curve.
+	This deactivates segments of the curves of i and j for the duration
+	of the intersection, so in parallel each thread intersects its own
+	copies of the curves (see bitangentTask).
+	Returns the number of dual spaces (0-2) culled by the broad phase.
+******************************************************************************/
+
+int buildBitangentPair   (Array<TangentialCurve> &obduala,
+		          Array<TangentialCurve> &obdualb,
+		          int i, int j, float epsIntersect, float featureSize,
+		          UmbralBitangArr &bitangij)
+{
+  CommonTangentArr bitangA;	// bitangents from a-space 
+  CommonTangentArr bitangB;	// bitangents from b-space 
+  CommonTangentArr bitangAB;    // bitangents from both dual spaces
+  int nCulled=0;
+  if (!BROADPHASE)
+   {
+    obduala[i].intersect (obduala[j], bitangA, epsIntersect);
+    obdualb[i].intersect (obdualb[j], bitangB, epsIntersect); 
+   }
+  else
+   {
+    if (!intersectDual (obduala[i], obboxa[i], obduala[j], obboxa[j], bitangA, epsIntersect))
+      nCulled++;
+    if (!intersectDual (obdualb[i], obboxb[i], obdualb[j], obboxb[j], bitangB, epsIntersect))
+      nCulled++;
+   }
+  mergeCommonTangent (bitangA, bitangB, featureSize, bitangAB);
+  int k;
+  bitangij.allocate(bitangAB.getn());
+  for (k=0; k<bitangAB.getn(); k++) bitangij[k] = bitangAB[k];
+  return nCulled;
+}
+
+/******************************************************************************
+	Shared state of the parallel bitangent engine: 
+	task k computes the kth pair (pairI[k],pairJ[k]), i<j.
+	At most nThread tasks run at once, so nThread sets of private
+	copies of the tangential curves suffice: a task takes a free set,
+	builds the copies of i and j in it if not yet built (createA/B of
+	the obstacle, as in buildTangentialCurves), and returns the set.
+	Copies are built at most once per set and obstacle, and the
+	shared curves are only read.
+******************************************************************************/
+
+struct DualCopies		// one set of private copies of the tangential curves
+{
+  Array<TangentialCurve> a, b;
+  char                  *made;	// copy of obstacle i built?
+};
+
+struct BitangentTasks
+{
+  Array<BezierCurve2f>   *obstacle;
+  Array<UmbralBitangArr> *bitang;
+  IntArr                  pairI, pairJ;
+  IntArr                  nCulled;	// # dual spaces culled for pair k
+  float                   epsIntersect, featureSize;
+  DualCopies             *copy;		// nThread sets
+  int                    *freeCopy, nFree;	// sets not in use
+  pthread_mutex_t         copyLock;	// of freeCopy
+};
+
+void bitangentTask (int k, void *arg)
+{
+  BitangentTasks &t = *(BitangentTasks *) arg;
+  int i = t.pairI[k], j = t.pairJ[k];
+  pthread_mutex_lock (&t.copyLock);
+  int c = t.freeCopy[--t.nFree];
+  pthread_mutex_unlock (&t.copyLock);
+  DualCopies &d = t.copy[c];
+  int ob[2] = {i, j};
+  for (int e=0; e<2; e++)
+    if (!d.made[ob[e]])
+     {
+      int o = ob[e];
+      d.a[o].createA ((*t.obstacle)[o], o);
+      d.b[o].createB ((*t.obstacle)[o], o);
+      d.made[o] = 1;
+     }
+  t.nCulled[k] = buildBitangentPair (d.a, d.b, i, j, t.epsIntersect, 
+				     t.featureSize, (*t.bitang)[i*nOb+j]);
+  pthread_mutex_lock (&t.copyLock);
+  t.freeCopy[t.nFree++] = c;
+  pthread_mutex_unlock (&t.copyLock);
+}
+
 /******************************************************************************
 	Intersect tangential curves to find bitangents.
 	Ensure that bitangents are found from light to obstacle
 	(i.e., light first so that index1 and param1 of CommonTangent
 	refer to the point of bitangency with the light):
 	this is needed in outer.
+	The obstacle pairs are independent, so they are distributed over
+	nThread work-stealing threads; each pair writes only its own slot
+	bitang[i*nOb+j], so the result is identical to the serial loop 
+	(nThread=1).
+	If moved != -1, bitang is kept and only the pairs involving 
+	obstacle moved (its row and column) are recomputed.
 ******************************************************************************/
 
 void buildBitangent      (Array<TangentialCurve> &obduala,
 		          Array<TangentialCurve> &obdualb,
-		          float epsIntersect, float featureSize,
-		          Array<UmbralBitangArr> &bitang)
+		          float epsIntersect, float featureSize, int nThread,
+		          Array<UmbralBitangArr> &bitang, int moved=-1)
 {
-  CommonTangentArr bitangA;	// bitangents from a-space 
-  CommonTangentArr bitangB;	// bitangents from b-space 
-  CommonTangentArr bitangAB;    // bitangents from both dual spaces
-  bitang.allocate(nOb*nOb);
-  for (int i=0; i<nOb; i++)
-    for (int j=i+1; j<nOb; j++)		// bitangents between i and j
+  int i,j,k;
+  int nCulled=0;			// # pair intersections culled by broad phase
+  int nPair=0;				// # pairs recomputed
+  if (moved == -1) bitang.allocate(nOb*nOb);
+  if (nThread <= 1)
+   {
+    for (i=0; i<nOb; i++)
+      for (j=i+1; j<nOb; j++)		// bitangents between i and j
+       {
+	if (moved != -1 && i != moved && j != moved) continue;
+	nPair++;
+	cout << "Computing bitangents between " << i << " and " << j << endl;
+	nCulled += buildBitangentPair (obduala, obdualb, i, j, epsIntersect, featureSize, 
+				       bitang[i*nOb+j]);
+       }
+   }
+  else
+   {
+    BitangentTasks t;
+    t.obstacle = &obstacle;  t.bitang = &bitang;
+    t.epsIntersect = epsIntersect;  t.featureSize = featureSize;
+    t.pairI.allocate (nOb*(nOb-1)/2);  t.pairJ.allocate (nOb*(nOb-1)/2);
+    t.nCulled.allocate (nOb*(nOb-1)/2);
+    for (i=0; i<nOb; i++)
+      for (j=i+1; j<nOb; j++) 
+	if (moved == -1 || i == moved || j == moved)
+	 { t.pairI[nPair] = i;  t.pairJ[nPair++] = j; }
+    cout << "Computing bitangents of " << nPair << " pairs on " << nThread 
+	 << " threads" << endl;
+    t.copy = new DualCopies[nThread];  t.freeCopy = new int[nThread];  t.nFree = nThread;
+    for (k=0; k<nThread; k++)
      {
-       cout << "Computing bitangents between " << i << " and " << j << endl;
-      obduala[i].intersect (obduala[j], bitangA, epsIntersect);
-      obdualb[i].intersect (obdualb[j], bitangB, epsIntersect); 
-      bitangAB.allocate (bitangA.getn() + bitangB.getn());
-      int k;
-      for (k=0; k<bitangA.getn(); k++)  bitangAB[k] = bitangA[k];
-      for (k=0; k<bitangB.getn(); k++)  bitangAB[bitangA.getn() + k] = bitangB[k];
-      IntArr foo; 	bitangAB.bubbleSort (foo);
-      bitangAB.deleteApproxDuplicate(featureSize);
-      bitang[i*nOb+j].allocate(bitangAB.getn());
-      for (k=0; k<bitangAB.getn(); k++) bitang[i*nOb+j][k] = bitangAB[k];
+      t.copy[k].a.allocate(nOb);  t.copy[k].b.allocate(nOb);
+      t.copy[k].made = new char[nOb];
+      for (i=0; i<nOb; i++) t.copy[k].made[i] = 0;
+      t.freeCopy[k] = k;
+     }
+    pthread_mutex_init (&t.copyLock, NULL);
+    workStealFor (nPair, nThread, bitangentTask, &t);
+    pthread_mutex_destroy (&t.copyLock);
+    for (k=0; k<nThread; k++) delete [] t.copy[k].made;
+    delete [] t.copy;  delete [] t.freeCopy;
+    for (k=0; k<nPair; k++) nCulled += t.nCulled[k];
+   }
+  if (BROADPHASE)
+    cout << "Broad phase culled " << nCulled << " of " << 2*nPair
+	 << " tangential curve intersections" << endl;
+  for (i=0; i<nOb; i++)			// report in pair order, independent of schedule
+    for (j=i+1; j<nOb; j++)
+     {
+      if (moved != -1 && i != moved && j != moved) continue;
 cout << "Bitangents from obstacle " << i << " to obstacle " << j << ":" << endl;
  for (k=0; k<bitang[i*nOb+j].getn(); k++) cout << bitang[i*nOb+j][k] << endl;
      }
@@ -1145,30 +1337,92 @@ cout << "Bitangents from obstacle " << i << " to obstacle " << j << ":" << endl;
 
 /******************************************************************************
 	Intersect tangential curves to find self-bitangents.
+	The broad phase leaves out the segments that cannot take part
+	in a self-intersection.
+	If moved != -1, only recompute those of obstacle moved.
 ******************************************************************************/
 
 void buildSelfBitangent  (Array<TangentialCurve> &obduala,
 		          Array<TangentialCurve> &obdualb,
 		          float epsIntersect, float featureSize,
-		          Array<UmbralBitangArr> &selfbitang)
+		          Array<UmbralBitangArr> &selfbitang, int moved=-1)
 {
   cout << "Building self-bitangents" << endl;
   int i,j;
   CommonTangentArr bitangA;	// selfbitangents from a-space 
   CommonTangentArr bitangB;	// selfbitangents from b-space 
-  selfbitang.allocate(nOb);     // one set of self-bitangents per curve
+  CommonTangentArr bitangAB;	// sorted selfbitangents from both spaces
+  int nCulled=0;		// # segments culled by broad phase
+  if (moved == -1) selfbitang.allocate(nOb);     // one set of self-bitangents per curve
 
      // self-intersect tangential curves to find bitangents
   for (i=0; i<nOb; i++)
    {
-    obduala[i].selfIntersect (bitangA, epsIntersect);
-    obdualb[i].selfIntersect (bitangB, epsIntersect);
-    selfbitang[i].allocate(bitangA.getn() + bitangB.getn());
-    for (j=0; j<bitangA.getn(); j++) selfbitang[i][j] = bitangA[j];
-    for (j=0; j<bitangB.getn(); j++) selfbitang[i][bitangA.getn() + j] = bitangB[j];
-    IntArr foo;  selfbitang[i].bubbleSort (foo);
-    selfbitang[i].deleteApproxDuplicate (featureSize);
+    if (moved != -1 && i != moved) continue;
+    if (BROADPHASE)
+     {
+      nCulled += selfIntersectDual (obduala[i], obboxa[i], bitangA, epsIntersect);
+      nCulled += selfIntersectDual (obdualb[i], obboxb[i], bitangB, epsIntersect);
+     }
+    else
+     {
+      obduala[i].selfIntersect (bitangA, epsIntersect);
+      obdualb[i].selfIntersect (bitangB, epsIntersect);
+     }
+    mergeCommonTangent (bitangA, bitangB, featureSize, bitangAB);
+    selfbitang[i].allocate(bitangAB.getn());
+    for (j=0; j<bitangAB.getn(); j++) selfbitang[i][j] = bitangAB[j];
    }
+  if (BROADPHASE)
+    cout << "Broad phase culled " << nCulled << " tangential curve segments" << endl;
+}
+
+/******************************************************************************
+	Key of the bitangent cache of scene file: the bitangents depend on
+	the scene and on epsIntersect and featureSize (and, for scene input,
+	on the display density used to build the curves).
+******************************************************************************/
+
+unsigned long long bitangentCacheKey (char *file)
+{
+  float param[4] = {epsIntersect, featureSize, 
+		    (float) (SCENEINPUT ? nPtsPerSegment : 0), (float) SCENEINPUT};
+  return tangCacheKey (file, "umbra", 4, param);
+}
+
+/******************************************************************************
+	Read bitang and selfbitang from the cache of file, if it is valid:
+	lists 0..nOb*(nOb-1)/2-1 are the pairs i<j in order, 
+	followed by the nOb self-bitangent lists.
+	Returns 0 if there is no valid cache.
+******************************************************************************/
+
+int readBitangentCache (char *file, Array<UmbralBitangArr> &bitang,
+			Array<UmbralBitangArr> &selfbitang)
+{
+  int i,j,l=0;
+  TangCache c;
+  if (!openTangCache (file, "umbra", bitangentCacheKey (file), nOb*(nOb-1)/2 + nOb, c))
+    return 0;
+  bitang.allocate(nOb*nOb);  selfbitang.allocate(nOb);
+  for (i=0; i<nOb; i++)
+    for (j=i+1; j<nOb; j++) getTangCacheList (c, l++, bitang[i*nOb+j]);
+  for (i=0; i<nOb; i++)     getTangCacheList (c, l++, selfbitang[i]);
+  closeTangCache (c);
+  cout << "Read bitangents from cache" << endl;
+  return 1;
+}
+
+void writeBitangentCache (char *file, Array<UmbralBitangArr> &bitang,
+			  Array<UmbralBitangArr> &selfbitang)
+{
+  int i,j;
+  TangCacheWriter w;
+  beginTangCache (file, "umbra", bitangentCacheKey (file), nOb*(nOb-1)/2 + nOb, w);
+  for (i=0; i<nOb; i++)
+    for (j=i+1; j<nOb; j++) addTangCacheList (w, bitang[i*nOb+j]);
+  for (i=0; i<nOb; i++)     addTangCacheList (w, selfbitang[i]);
+  endTangCache (w);
 }
 
 /******************************************************************************
@@ -1264,18 +1518,21 @@ void buildIndirectBitang (Array<UmbralBitangArr> &bitang,
 /******************************************************************************
 	Filter bitangents down to outer bitangents.
 	Only compute between each obstacle and light, not between obstacles.
+	If dirty != NULL, outer is kept and only obstacles i with 
+	(*dirty)[i] are recomputed.
 ******************************************************************************/
 
 void buildOuterBitang  (Array<UmbralBitangArr> &bitang,
 			Array<BezierCurve2f>   &obstacle,
 			float epsIntersect, float closeEps, float featureSize, 
 			float sameSideEps,
-			Array<UmbralBitangArr> &outer)
+			Array<UmbralBitangArr> &outer, IntArr *dirty=NULL)
 {  
   int i,j;
-  outer.allocate(nOb); 
+  if (!dirty) outer.allocate(nOb); 
   for (i=1; i<nOb; i++)				// each obstacle
    {
+    if (dirty && !(*dirty)[i]) continue;
     outer[i].allocate(MAXDIRECT);
     int npo=0;  V2f umbraOb, umbraExtreme; int ob; float tOb;
     for (j=0; j<bitang[i].getn(); j++)	// each bitangent from light to obstacle
@@ -1894,17 +2151,21 @@ NOT TWO.
   A1, P, and A2 are then inserted into the polygon between P1 and P2.
   Then A1 P A2 is replaced by the correct curve segment between A1 and A2.
   The incorrect segment is found by casting a ray from the light to the obstacle.
+  If dirty != NULL, backUmbra is kept and only obstacles i with (*dirty)[i]
+  are recomputed.
 ******************************************************************************/
 
-void defineBackUmbra (Array<UmbralBitangArr> &ut, Array<Polygon2f> &backUmbra, float epsIntersect, float sameSideEps)
+void defineBackUmbra (Array<UmbralBitangArr> &ut, Array<Polygon2f> &backUmbra, float epsIntersect, float sameSideEps,
+		      IntArr *dirty=NULL)
 {
   cout << endl << "Entering defineBackUmbra" << endl;
   int i,j;
-  backUmbra.allocate(nOb);
+  if (!dirty) backUmbra.allocate(nOb);
   //  V2f typicalPtOutside;		// typical pt outside present halfspace
   //  obstacle[0].eval (obstacle[0].getKnot(0), typicalPtOutside); // any pt of light
   for (i=1; i<nOb; i++)     // each obstacle has a local umbra
    {
+    if (dirty && !(*dirty)[i]) continue;
     cout << "Obstacle " << i << endl;
     Line2f L;
       /* OLD VERSION: ONLY WORKS WHEN A DOES NOT SURROUND L 
@@ -1955,11 +2216,10 @@ void defineBackUmbra (Array<UmbralBitangArr> &ut, Array<Polygon2f> &backUmbra, f
       else  // A surrounds L
        {
       */  // NEW VERSION: WORKS IN ALL CASES, WHETHER A SURROUNDS L OR NOT
-    // allocate more vertices than ever necessary
-    V2fArr backUmbraPt(obstacle[i].getnSample()+1000);
-    backUmbraPt[0] = ut[i][0].umbraExtreme;
-    backUmbraPt[1] = ut[i][0].umbraOb;
-    int nVert = 2;  // vertex count
+    // build the polygon vertex by vertex (no fixed over-allocation)
+    PolygonBuilder pb;  initPolygonBuilder (pb, chordTol/10);
+    addVertex (pb, ut[i][0].umbraExtreme);
+    addVertex (pb, ut[i][0].umbraOb);
 
     // now add curve samples
     V2f hit;  float tHit;  // parameter value of pt on curve segment *not* to be sampled
@@ -1974,30 +2234,24 @@ void defineBackUmbra (Array<UmbralBitangArr> &ut, Array<Polygon2f> &backUmbra, f
     obstacle[i].shootRay (ptOnLight, ptOnObstacle, hit, tHit, epsIntersect, epsIntersect);
     cout << "Got back from shootRay" << endl;
     cout << "tHit = " << tHit << endl;
-    V2fArr sample;  // curve samples
+    float tFrom, tTo;  // curve segment to be sampled
     if ((ut[i][1].tOb < ut[i][0].tOb && tHit > ut[i][1].tOb && tHit < ut[i][0].tOb) ||
 	(ut[i][1].tOb > ut[i][0].tOb && (tHit > ut[i][1].tOb ||  tHit < ut[i][0].tOb))) 
                                  // wraparound from ut[i][1].tOb to ut[i][0].tOb
 	// tHit is on the segment (ut[i][1].tOb, ut[i][0].tOb) so choose other
-	 obstacle[i].sampleSegment (ut[i][0].tOb, ut[i][1].tOb, sample, .05); // was .01
-    else obstacle[i].sampleSegment (ut[i][1].tOb, ut[i][0].tOb, sample, .05);
-    cout << "Sample = " << sample << endl;
-    if (backUmbraPt[1].dist (sample[0]) > 
-	backUmbraPt[1].dist (sample[sample.getn()-1]))
-      sample.reverseIt();      // curve was sampled in wrong direction (wrt polygon)
-    if (sample.getn() + 8 > backUmbraPt.getn())
-      {
-	cout << "backUmbraPt needs to be enlarged!" << endl;
-	exit(-1);
-      }
-    for (j=0; j<sample.getn(); j++) backUmbraPt[nVert++] = sample[j];
+         { tFrom = ut[i][0].tOb;  tTo = ut[i][1].tOb; }
+    else { tFrom = ut[i][1].tOb;  tTo = ut[i][0].tOb; }
+    V2f ptFrom, ptTo;  obstacle[i].eval (tFrom, ptFrom);  obstacle[i].eval (tTo, ptTo);
+    int reverse = (ut[i][0].umbraOb.dist (ptFrom) > ut[i][0].umbraOb.dist (ptTo));
+                             // sample in the right direction (wrt polygon)
+    addSegmentAdaptive (pb, obstacle[i], obBatch[i], tFrom, tTo, chordTol, reverse);
     cout << "Added samples" << endl;
 
-    backUmbraPt[nVert++] = ut[i][1].umbraOb;
+    addVertex (pb, ut[i][1].umbraOb);
     if (ut[i][0].umbraExtreme != ut[i][1].umbraExtreme)
      { // not an umbra closed by an outer bitang intersection (so umbra touches the room)
       cout << "Walking around the room" << endl;
-      backUmbraPt[nVert++] = ut[i][1].umbraExtreme;
+      addVertex (pb, ut[i][1].umbraExtreme);
 
       // finally, add room vertices between ut[i][1].umbraExtreme & ut[i][0].umbraExtreme
       int iEdge = -1;  // ut[i][1].umbraExtreme lies on [room[iEdge],room[iEdge+1]]
@@ -2024,15 +2278,14 @@ void defineBackUmbra (Array<UmbralBitangArr> &ut, Array<Polygon2f> &backUmbra, f
       cout << "walkingDir = " << walkingDir << endl;
       while (!L.insideLine (ut[i][0].umbraExtreme, .01))
        {
-	backUmbraPt[nVert++] = room[walkingDir == 1 ? (iEdge+1)%room.getn() : iEdge];
-	cout << "Added " << backUmbraPt[nVert-1] << endl;
+	addVertex (pb, room[walkingDir == 1 ? (iEdge+1)%room.getn() : iEdge]);
+	cout << "Added " << pb.pt[pb.n-1] << endl;
 	if (walkingDir == 1) iEdge = (iEdge+1)%room.getn();
 	else iEdge = mod(iEdge-1, room.getn());
 	L.create (room[iEdge], room[(iEdge+1)%room.getn()]);
        }
      }
-    backUmbraPt.shrink (nVert);
-    backUmbra[i].create (backUmbraPt);
+    buildPolygon (pb, backUmbra[i]);
     cout << "backUmbra[" << i << "] = " << backUmbra[i] << endl;
     backUmbra[i].triangulate();
    }
@@ -2376,79 +2629,16 @@ defineGlobalFrontUmbra (Array<BezierCurve2f>   &obstacle,
 }
 
 /******************************************************************************
+	Compute levels 2 and up (visual events, umbral bitangents, umbrae)
+	from the bitangents.
+	If dirty != NULL, the outer bitangents and local back umbra are only 
+	recomputed for obstacles i with (*dirty)[i]; the remaining levels
+	are filters and sweeps over the (kept) bitangent table and are redone.
 ******************************************************************************/
 
-int main (int argc, char **argv)
+void buildUmbra (IntArr *dirty=NULL)
 {
-  int       i;
-  int       ArgsParsed=0;
-
-  RoutineName = argv[ArgsParsed++];
-  if (argc == 1) { usage(); exit(-1); }
-  while (ArgsParsed < argc)
-   {
-    if ('-' == argv[ArgsParsed][0])
-      switch (argv[ArgsParsed++][1])
-      {
-      case 'd': nPtsPerSegment = atoi(argv[ArgsParsed++]);	break;
-      case 'c': closeEps = atof(argv[ArgsParsed++]);            break;
-      case 'F': featureSize = atof(argv[ArgsParsed++]);         break;
-      case 'e': epsIntersect = atof(argv[ArgsParsed++]);	break;
-      case 'E': epsIntersectSmall = atof(argv[ArgsParsed++]);	break;
-      case 'f': sameSideEps = atof(argv[ArgsParsed++]);         break;
-      case 's': specialOb = atoi(argv[ArgsParsed++]);		break;
-      case 'u': specialUmb = atoi (argv[ArgsParsed++]);		break;
-      case 'r': radiusRoom = atof (argv[ArgsParsed++]);		break;
-      case 'w': SURROUND=1;                                     break;
-      case 'S': SCENEINPUT = 1;                                 break;
-      case 't': COMPUTETANGONLY=1;                              break;
-      case 'P': level = atoi(argv[ArgsParsed++]);               break;
-      case 'h': 
-      default:	usage(); exit(-1);				break;
-      }
-   else ArgsParsed++;
-  }
-
-  if (closeEps == -1)  closeEps = .1/radiusRoom;  // not set by 'c' parameter
-  cout << "closeEps = " << closeEps << endl;
-  defineRoom (radiusRoom, room);
-	cout << "Inputting curves" << endl;    
-  if (SCENEINPUT)
-    {
-      Scene2d scene;
-      ifstream infile;  infile.open(argv[argc-1]);
-      scene.read (infile);
-      cout << "Finished reading" << endl;
-      infile.close();
-      scene.build (nPtsPerSegment);
-      cout << "Finished building" << endl;
-      scene.extract (obstacle);
-      for (i=0; i<obstacle.getn(); i++) obstacle[i].prepareDisplay (nPtsPerSegment);
-      obCentroid.allocate (obstacle.getn());
-      for (i=0; i<obstacle.getn(); i++) scene.centroid (i, obCentroid[i]);
-    }
-  else inputCurves(argv[argc-1], obstacle);
-  for (i=0; i<obstacle.getn(); i++) cout << "Obstacle " << i << ":" << obstacle[i]<<endl;
-  nOb = obstacle.getn(); 
-  assert (specialOb >= 1 && specialOb < nOb);
-  assert (specialUmb == 0 || specialUmb == 1);
-	cout << "Creating hodographs" << endl;    
-  specialHodo.createHodograph (obstacle[specialOb]);
-  lightHodo.createHodograph   (obstacle[0]);
-
-  /*  V2f foo;
-  obstacle[0].eval (2.70535, foo);
-  cout << "Point at 2.70535 on light is " << foo << endl;
-  */
-
-  if (level >= 1)
-    {
-        cout << "Building tangential curves" << endl; 
-      buildTangentialCurves (obstacle);
-	cout << "Building bitangents" << endl;    
-      buildBitangent     (obduala, obdualb, epsIntersect, featureSize, bitang);
-      buildSelfBitangent (obduala, obdualb, epsIntersect, featureSize, selfbitang);
-    }
+  int i;
   if (level >= 2)
    {
         cout << "Building bitangents associated with direct visual events" << endl;
@@ -2462,46 +2652,54 @@ int main (int argc, char **argv)
 			 featureSize, sameSideEps, indirect);
 	cout << "Building outer bitangents" << endl;    
     buildOuterBitang (bitang, obstacle, epsIntersect, closeEps, featureSize, sameSideEps, 
-		      outer); // just to light
+		      outer, dirty); // just to light
     cout << "Outer bitangents = " << outer << endl;
+    markStage (umbraTimer, "visual events");
    }
   if (level >= 3)
    {
 	cout << "Building inner bitangents" << endl;
     buildInnerBitang (bitang, obstacle, epsIntersect, closeEps, featureSize, sameSideEps, inner); // all pairs
+    markStage (umbraTimer, "inner bitangents");
    }
   if (level >= 4)
    {
 	cout << "Building outer piercing bitangents" << endl;   
     buildOuterPierce (bitang, obstacle, epsIntersect, closeEps, sameSideEps, 
 		      outerpierce); // just to light
+    markStage (umbraTimer, "outer piercing bitangents");
    }
   if (level >= 5)
    {
 	cout << "Building inner piercing bitangents" << endl;    
     buildInnerPierce (bitang, obstacle, epsIntersect, closeEps, sameSideEps, 
 		      innerpierce); // all pairs
+    markStage (umbraTimer, "inner piercing bitangents");
    }
   if (level >= 6)
     {
         cout << "Building local back umbra" << endl;
-      defineBackUmbra (outer, localBackUmbra, epsIntersect, sameSideEps);
+      defineBackUmbra (outer, localBackUmbra, epsIntersect, sameSideEps, dirty);
+    markStage (umbraTimer, "local back umbra");
     }
   if (level >= 7)
     {
         cout << "Building local back penumbra" << endl;
       defineBackUmbra (inner, backPenumbra,   epsIntersect, sameSideEps);
+    markStage (umbraTimer, "back penumbra");
     }
   if (level >= 8)
     {
         cout << "Building local front umbra" << endl;
       defineFrontUmbra (outerpierce, localFrontUmbra, .01, 1);
+    markStage (umbraTimer, "local front umbra");
     }
   if (level >= 9)
     {
       // SHOULD CHANGE .01 TO SAMESIDEEPS
         cout << "Building local front penumbra" << endl;
       defineFrontUmbra (innerpierce, frontPenumbra,   .01, 0);
+    markStage (umbraTimer, "front penumbra");
     }
   if (level >= 10)
    {
@@ -2513,6 +2711,7 @@ int main (int argc, char **argv)
 	innerSweep (outer, inner, 
 		    obstacle, sameSideEps, sweptInner);
       }
+    markStage (umbraTimer, "inner sweep");
    }
   if (level >= 11)
    {
@@ -2523,6 +2722,7 @@ int main (int argc, char **argv)
         outerSweep (outer, sweptInner, 
 		    obstacle, sameSideEps, sweptOuter);
       }
+    markStage (umbraTimer, "outer sweep");
    }
   if (level >= 12)
    {
@@ -2534,6 +2734,7 @@ int main (int argc, char **argv)
       innerPiercingSweep (outerpierce, innerpierce, inner, sweptInner, 
 			  obstacle, sameSideEps, sweptInPierce); 
      }
+    markStage (umbraTimer, "inner piercing sweep");
    }
   if (level >= 13)
    {
@@ -2550,6 +2751,7 @@ int main (int argc, char **argv)
 	        cout << sweptOutPierce[i][j].abandon << " ";
 	    cout << endl;
       }
+    markStage (umbraTimer, "outer piercing sweep");
    }
   if (level >= 14)
    {
@@ -2560,6 +2762,7 @@ int main (int argc, char **argv)
       defineGlobalBackUmbra (obstacle, room, sweptInner, sweptOuter, globalBackUmbra,
 			     epsIntersect);
       }
+    markStage (umbraTimer, "global back umbra");
    }
   if (level >= 15)
    {
@@ -2573,7 +2776,207 @@ int main (int argc, char **argv)
 			      sameSideEps, epsIntersectSmall);
    // defineFrontUmbra (sweptInPierce, globalFrontUmbra, .01, 1); 
       }
+    markStage (umbraTimer, "global front umbra");
+   }
+}
+
+/******************************************************************************
+	Translate obstacle moved by (dx,dy), and update the umbra incrementally:
+	only its tangential curves, its row and column of the bitangent table,
+	its self-bitangents, and the outer bitangents and local back umbrae
+	that depend on it are recomputed (see umbraUpdate.h).
+	With INCREMENTAL off, everything is recomputed, for comparison.
+******************************************************************************/
+
+void moveObstacle (int moved, float dx, float dy)
+{
+  int i,j;
+  if (SCENEINPUT) 
+   { cout << "Moving an obstacle of a scene is not supported" << endl;  return; }
+  for (j=0; j<obPt[moved].getn(); j++) { obPt[moved][j][0] += dx;  obPt[moved][j][1] += dy; }
+  obstacle[moved].fitClosed (obPt[moved]);
+  obstacle[moved].prepareDisplay (nPtsPerSegment);
+  obCentroid[moved][0] += dx;  obCentroid[moved][1] += dy;
+  if (moved == specialOb) specialHodo.createHodograph (obstacle[specialOb]);
+  if (moved == 0)         lightHodo.createHodograph   (obstacle[0]);
+  ObBox oldBox = obBox[moved];
+  buildObBox (obstacle[moved], featureSize, obBox[moved]);
+  freeBezierBatch (obBatch[moved]);  initCurveBatch (obstacle[moved], obBatch[moved]);
+  cout << "Moved obstacle " << moved << " by (" << dx << "," << dy << ")" << endl;
+  if (!INCREMENTAL)
+   {
+    if (level >= 1)
+     {
+      buildTangentialCurves (obstacle);
+      buildBitangent     (obduala, obdualb, epsIntersect, featureSize, nThread, bitang);
+      buildSelfBitangent (obduala, obdualb, epsIntersect, featureSize, selfbitang);
+     }
+    buildUmbra ();
+    return;
+   }
+  if (level >= 1)
+   {
+    buildTangentialCurves (obstacle, moved);
+    buildBitangent     (obduala, obdualb, epsIntersect, featureSize, nThread, bitang, moved);
+    buildSelfBitangent (obduala, obdualb, epsIntersect, featureSize, selfbitang, moved);
+   }
+  if (level < 2) return;
+  IntArr dirty(nOb);		// obstacles whose local umbra depends on moved
+  int nDirty=0;
+  dirty[0] = 0;
+  for (i=1; i<nOb; i++)
+    nDirty += dirty[i] = umbraDepends (i, moved, bitang[i], obstacle, 
+				       oldBox, obBox[moved], radiusRoom);
+  cout << "Recomputing local back umbra of " << nDirty << " of " << nOb-1 
+       << " obstacles" << endl;
+  buildUmbra (&dirty);
+}
+
+/******************************************************************************
+	Read the scene in file and compute its umbra, up to level.
+******************************************************************************/
+
+void computeScene (char *file)
+{
+  int i;
+  startTimer (umbraTimer);
+  if (obBatch)				// previous scene
+   {
+    for (i=0; i<nOb; i++) freeBezierBatch (obBatch[i]);
+    delete [] obBatch;
+   }
+	cout << "Inputting curves" << endl;    
+  if (SCENEINPUT)
+    {
+      Scene2d scene;
+      ifstream infile;  infile.open(file);
+      scene.read (infile);
+      cout << "Finished reading" << endl;
+      infile.close();
+      scene.build (nPtsPerSegment);
+      cout << "Finished building" << endl;
+      scene.extract (obstacle);
+      for (i=0; i<obstacle.getn(); i++) obstacle[i].prepareDisplay (nPtsPerSegment);
+      obCentroid.allocate (obstacle.getn());
+      for (i=0; i<obstacle.getn(); i++) scene.centroid (i, obCentroid[i]);
+    }
+  else inputCurves(file, obstacle);
+  for (i=0; i<obstacle.getn(); i++) cout << "Obstacle " << i << ":" << obstacle[i]<<endl;
+  nOb = obstacle.getn(); 
+  assert (specialOb >= 1 && specialOb < nOb);
+  assert (specialUmb == 0 || specialUmb == 1);
+	cout << "Creating hodographs" << endl;    
+  specialHodo.createHodograph (obstacle[specialOb]);
+  lightHodo.createHodograph   (obstacle[0]);
+  obBox.allocate (nOb);
+  for (i=0; i<nOb; i++) buildObBox (obstacle[i], featureSize, obBox[i]);
+  obBatch = new BezierBatch[nOb];
+  for (i=0; i<nOb; i++) initCurveBatch (obstacle[i], obBatch[i]);
+  markStage (umbraTimer, "input");
+
+  /*  V2f foo;
+  obstacle[0].eval (2.70535, foo);
+  cout << "Point at 2.70535 on light is " << foo << endl;
+  */
+
+  if (level >= 1)
+    {
+        cout << "Building tangential curves" << endl; 
+      buildTangentialCurves (obstacle);
+      markStage (umbraTimer, "tangential curves");
+      if (TANGCACHE && readBitangentCache (file, bitang, selfbitang))
+	markStage (umbraTimer, "cached bitangents");
+      else
+       {
+	cout << "Building bitangents" << endl;    
+	buildBitangent     (obduala, obdualb, epsIntersect, featureSize, nThread, bitang);
+	markStage (umbraTimer, "bitangents");
+	buildSelfBitangent (obduala, obdualb, epsIntersect, featureSize, selfbitang);
+	markStage (umbraTimer, "self-bitangents");
+	if (TANGCACHE) writeBitangentCache (file, bitang, selfbitang);
+       }
+    }
+  buildUmbra ();
+}
+
+/******************************************************************************
+	Headless: compute the umbra of the scene in file and write
+	the bitangents, back umbrae/penumbrae and timings (see umbraBatch.h).
+******************************************************************************/
+
+int batchScene (char *file)
+{
+  computeScene (file);
+  if (level < 1) bitang.allocate (nOb*nOb);
+  UmbraRegion region[6] = {{"localBackUmbra",   &localBackUmbra,  1, NULL},
+			   {"backPenumbra",     &backPenumbra,    1, NULL},
+			   {"localFrontUmbra",  NULL,             1, &localFrontUmbra},
+			   {"frontPenumbra",    NULL,             1, &frontPenumbra},
+			   {"globalBackUmbra",  &globalBackUmbra, 1, NULL},
+			   {"globalFrontUmbra", NULL,             1, &globalFrontUmbra}};
+  int regionLevel[6] = {6, 7, 8, 9, 14, 15};	// level that computes each region
+  int nRegion=0;
+  for (int r=0; r<6; r++)
+    if (level >= regionLevel[r]) region[nRegion++] = region[r];
+  return writeUmbra (file, outputFormat, nOb, bitang, nRegion, region, umbraTimer);
+}
+
+/******************************************************************************
+******************************************************************************/
+
+int main (int argc, char **argv)
+{
+  int       ArgsParsed=0;
+  char    **scene = new char*[argc];	// scene files
+  int       nScene=0;
+
+  RoutineName = argv[ArgsParsed++];
+  if (argc == 1) { usage(); exit(-1); }
+  while (ArgsParsed < argc)
+   {
+    if ('-' == argv[ArgsParsed][0])
+      switch (argv[ArgsParsed++][1])
+      {
+      case 'd': nPtsPerSegment = atoi(argv[ArgsParsed++]);	break;
+      case 'c': closeEps = atof(argv[ArgsParsed++]);            break;
+      case 'F': featureSize = atof(argv[ArgsParsed++]);         break;
+      case 'e': epsIntersect = atof(argv[ArgsParsed++]);	break;
+      case 'E': epsIntersectSmall = atof(argv[ArgsParsed++]);	break;
+      case 'f': sameSideEps = atof(argv[ArgsParsed++]);         break;
+      case 's': specialOb = atoi(argv[ArgsParsed++]);		break;
+      case 'u': specialUmb = atoi (argv[ArgsParsed++]);		break;
+      case 'r': radiusRoom = atof (argv[ArgsParsed++]);		break;
+      case 'w': SURROUND=1;                                     break;
+      case 'S': SCENEINPUT = 1;                                 break;
+      case 't': COMPUTETANGONLY=1;                              break;
+      case 'P': level = atoi(argv[ArgsParsed++]);               break;
+      case 'j': nThread = atoi(argv[ArgsParsed++]);
+	        if (nThread < 1) { usage(); exit(-1); }         break;
+      case 'n': BROADPHASE=0;                                   break;
+      case 'x': INCREMENTAL=0;                                  break;
+      case 'C': chordTol = atof(argv[ArgsParsed++]);            break;
+      case 'k': TANGCACHE=1;                                    break;
+      case 'b': BATCH=1;                                        break;
+      case 'o': outputFormat = (strcmp(argv[ArgsParsed++], "bin") == 0 
+				? UMBRABINARY : UMBRAJSON);     break;
+      case 'h': 
+      default:	usage(); exit(-1);				break;
+      }
+   else scene[nScene++] = argv[ArgsParsed++];
+  }
+
+  if (closeEps == -1)  closeEps = .1/radiusRoom;  // not set by 'c' parameter
+  if (nThread == -1)   nThread = nProcessor();     // not set by 'j' parameter
+  cout << "closeEps = " << closeEps << endl;
+  defineRoom (radiusRoom, room);
+  if (BATCH)
+   {
+    if (nScene == 0) { usage(); exit(-1); }
+    int nJob = (nThread < nScene ? nThread : nScene);	// scenes in parallel,
+    nThread  = nThread / nJob;				// remaining cores per scene
+    exit (batchRun (nScene, scene, nJob, batchScene));
    }
+  computeScene (argv[argc-1]);
 
   /************************************************************/
 
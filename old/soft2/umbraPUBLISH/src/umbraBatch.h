@@ -0,0 +1,298 @@
+/*
+  File:          umbraBatch.h
+  Created:	 17 October 2026
+  Purpose:       Headless batch mode of the umbra programs
+                 (umbra, dmesh, dynamicLocalBackUmbra): no display is opened;
+		 the -P level pipeline is run on each scene file and the
+		 bitangents, the umbral polygons and per-stage timings are
+		 written to <scene>.json or <scene>.umb.
+		 The programs keep their scene in global state, so scenes are
+		 run in parallel as separate processes (fork), at most nJob
+		 at a time; the log of each scene goes to <scene>.log.
+
+		 Binary format (<scene>.umb, native byte order):
+		   char[4] "UMBR", int version (1), int nOb
+		   int nPair; per pair: int i, int j, int n;
+		              per bitangent: int index1, float param1, int index2, float param2
+		   int nRegion; per region: string name, int nPoly;
+		              per polygon: int obstacle, int nVert, nVert*(float x, float y)
+		   int nStage; per stage: string name, double seconds
+		 where a string is int length followed by its characters.
+		 The JSON output has the same fields in the same order;
+		 a coordinate that is not finite is written as null.
+		 A region may have several polygons per obstacle 
+		 (e.g., the front umbra), each tagged with its obstacle.
+  Usage:	 UmbraTimer timer;  startTimer (timer);  ...  markStage (timer, "bitangents");
+  		 UmbraRegion region[2] = {{"localBackUmbra", &localBackUmbra, 1}, 
+		   {"localFrontUmbra", NULL, 1, &localFrontUmbra}};
+		 writeUmbra (file, UMBRAJSON, nOb, bitang, 2, region, timer);
+		 batchRun (nScene, scene, nJob, runScene);
+*/
+
+#ifndef _UMBRABATCH_H_
+#define _UMBRABATCH_H_
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#define UMBRAJSON	0		// output formats
+#define UMBRABINARY	1
+#define MAXSTAGE	32		// maximum # timed stages
+
+/******************************************************************************
+	Per-stage wall-clock timings.
+******************************************************************************/
+
+struct UmbraTimer
+{
+  int         nStage;
+  const char *name[MAXSTAGE];
+  double      sec[MAXSTAGE];
+  double      last;			// time of last mark
+};
+
+static inline double wallClock ()
+{
+  struct timeval tv;
+  gettimeofday (&tv, NULL);
+  return tv.tv_sec + tv.tv_usec * 1e-6;
+}
+
+static inline void startTimer (UmbraTimer &timer)
+{
+  timer.nStage = 0;
+  timer.last   = wallClock();
+}
+
+static inline void markStage (UmbraTimer &timer, const char *name)	// end of stage
+{
+  double now = wallClock();
+  if (timer.nStage < MAXSTAGE)
+   {
+    timer.name[timer.nStage] = name;
+    timer.sec [timer.nStage++] = now - timer.last;
+   }
+  timer.last = now;
+}
+
+/******************************************************************************
+	A named set of umbral polygons: one per obstacle (poly) or 
+	several per obstacle (polys), of obstacles first.. .
+******************************************************************************/
+
+struct UmbraRegion
+{
+  const char          *name;
+  Array<Polygon2f>    *poly;
+  int                  first;
+  Array<Polygon2fArr> *polys;		// if poly is NULL
+};
+
+static int regionObstacles (UmbraRegion &r)	// # obstacle slots
+{
+  return (r.poly ? r.poly->getn() : r.polys->getn());
+}
+
+static int regionPolygons (UmbraRegion &r, int i)	// # polygons of obstacle i
+{
+  return (r.poly ? 1 : (*r.polys)[i].getn());
+}
+
+static Polygon2f &regionPolygon (UmbraRegion &r, int i, int k)	// kth polygon of obstacle i
+{
+  return (r.poly ? (*r.poly)[i] : (*r.polys)[i][k]);
+}
+
+/******************************************************************************/
+/******************************************************************************/
+
+static void writeJSONString (FILE *fp, const char *s)
+{
+  fputc ('"', fp);
+  for (; *s; s++)
+    if (*s == '"' || *s == '\\') { fputc ('\\', fp);  fputc (*s, fp); }
+    else fputc (*s, fp);
+  fputc ('"', fp);
+}
+
+static void writeJSONFloat (FILE *fp, double x)
+{
+  if (isfinite (x)) fprintf (fp, "%.9g", x);
+  else              fprintf (fp, "null");
+}
+
+template <class BitangArr>
+void writeUmbraJSON (FILE *fp, const char *scene, int nOb, Array<BitangArr> &bitang,
+		     int nRegion, UmbraRegion *region, UmbraTimer &timer)
+{
+  int i,j,k;
+  V2f pt;
+  fprintf (fp, "{\n  \"scene\": ");  writeJSONString (fp, scene);
+  fprintf (fp, ",\n  \"nObstacle\": %d,\n  \"bitangents\": [", nOb);
+  for (i=0; i<nOb; i++)
+    for (j=i+1; j<nOb; j++)
+     {
+      BitangArr &b = bitang[i*nOb+j];
+      fprintf (fp, "%s\n    {\"i\": %d, \"j\": %d, \"tangents\": [",
+	       (i==0 && j==1 ? "" : ","), i, j);
+      for (k=0; k<b.getn(); k++)
+       {
+	fprintf (fp, "%s[%d, ", (k ? ", " : ""), b[k].index1);
+	writeJSONFloat (fp, b[k].param1);  fprintf (fp, ", %d, ", b[k].index2);
+	writeJSONFloat (fp, b[k].param2);  fprintf (fp, "]");
+       }
+      fprintf (fp, "]}");
+     }
+  fprintf (fp, "\n  ],\n  \"regions\": {");
+  for (int r=0; r<nRegion; r++)
+   {
+    fprintf (fp, "%s\n    ", (r ? "," : ""));  writeJSONString (fp, region[r].name);
+    fprintf (fp, ": [");
+    int nPoly=0;
+    for (i=region[r].first; i<regionObstacles (region[r]); i++)
+      for (j=0; j<regionPolygons (region[r], i); j++)
+       {
+	Polygon2f &p = regionPolygon (region[r], i, j);
+	fprintf (fp, "%s\n      {\"obstacle\": %d, \"polygon\": [", (nPoly++ ? "," : ""), i);
+	for (k=0; k<p.getn(); k++)
+	 {
+	  pt = p[k];
+	  fprintf (fp, "%s[", (k ? ", " : ""));  writeJSONFloat (fp, pt[0]);
+	  fprintf (fp, ", ");  writeJSONFloat (fp, pt[1]);  fprintf (fp, "]");
+	 }
+	fprintf (fp, "]}");
+       }
+    fprintf (fp, "\n    ]");
+   }
+  fprintf (fp, "\n  },\n  \"timings\": {");
+  for (i=0; i<timer.nStage; i++)
+   {
+    fprintf (fp, "%s\n    ", (i ? "," : ""));  writeJSONString (fp, timer.name[i]);
+    fprintf (fp, ": %.6f", timer.sec[i]);
+   }
+  fprintf (fp, "\n  }\n}\n");
+}
+
+/******************************************************************************/
+/******************************************************************************/
+
+static void writeBinaryInt    (FILE *fp, int x)    { fwrite (&x, sizeof(int),    1, fp); }
+static void writeBinaryFloat  (FILE *fp, float x)  { fwrite (&x, sizeof(float),  1, fp); }
+static void writeBinaryDouble (FILE *fp, double x) { fwrite (&x, sizeof(double), 1, fp); }
+static void writeBinaryString (FILE *fp, const char *s)
+{
+  writeBinaryInt (fp, strlen(s));  fwrite (s, 1, strlen(s), fp);
+}
+
+template <class BitangArr>
+void writeUmbraBinary (FILE *fp, int nOb, Array<BitangArr> &bitang,
+		       int nRegion, UmbraRegion *region, UmbraTimer &timer)
+{
+  int i,j,k;
+  V2f pt;
+  fwrite ("UMBR", 1, 4, fp);  writeBinaryInt (fp, 1);  writeBinaryInt (fp, nOb);
+  writeBinaryInt (fp, nOb*(nOb-1)/2);
+  for (i=0; i<nOb; i++)
+    for (j=i+1; j<nOb; j++)
+     {
+      BitangArr &b = bitang[i*nOb+j];
+      writeBinaryInt (fp, i);  writeBinaryInt (fp, j);  writeBinaryInt (fp, b.getn());
+      for (k=0; k<b.getn(); k++)
+       {
+	writeBinaryInt (fp, b[k].index1);  writeBinaryFloat (fp, b[k].param1);
+	writeBinaryInt (fp, b[k].index2);  writeBinaryFloat (fp, b[k].param2);
+       }
+     }
+  writeBinaryInt (fp, nRegion);
+  for (int r=0; r<nRegion; r++)
+   {
+    writeBinaryString (fp, region[r].name);
+    int nPoly=0;
+    for (i=region[r].first; i<regionObstacles (region[r]); i++) 
+      nPoly += regionPolygons (region[r], i);
+    writeBinaryInt (fp, nPoly);
+    for (i=region[r].first; i<regionObstacles (region[r]); i++)
+      for (j=0; j<regionPolygons (region[r], i); j++)
+       {
+	Polygon2f &p = regionPolygon (region[r], i, j);
+	writeBinaryInt (fp, i);  writeBinaryInt (fp, p.getn());
+	for (k=0; k<p.getn(); k++)
+	 { pt = p[k];  writeBinaryFloat (fp, pt[0]);  writeBinaryFloat (fp, pt[1]); }
+       }
+   }
+  writeBinaryInt (fp, timer.nStage);
+  for (i=0; i<timer.nStage; i++)
+   { writeBinaryString (fp, timer.name[i]);  writeBinaryDouble (fp, timer.sec[i]); }
+}
+
+/******************************************************************************
+	Write the results of scene to <scene>.json or <scene>.umb.
+	Returns 0 on success.
+******************************************************************************/
+
+template <class BitangArr>
+int writeUmbra (const char *scene, int format, int nOb, Array<BitangArr> &bitang,
+		int nRegion, UmbraRegion *region, UmbraTimer &timer)
+{
+  char *file = new char[strlen(scene) + 6];
+  strcpy (file, scene);  strcat (file, (format == UMBRABINARY ? ".umb" : ".json"));
+  FILE *fp = fopen (file, (format == UMBRABINARY ? "wb" : "w"));
+  if (!fp) { cerr << "Cannot write " << file << endl;  delete [] file;  return -1; }
+  if (format == UMBRABINARY) writeUmbraBinary (fp, nOb, bitang, nRegion, region, timer);
+  else                       writeUmbraJSON   (fp, scene, nOb, bitang, nRegion, region, timer);
+  int err = ferror (fp);
+  if (fclose (fp) != 0) err = 1;		// buffered writes may fail here
+  if (err) cerr << "Error writing " << file << endl;
+  else     cerr << "Wrote " << file << endl;
+  delete [] file;
+  return (err ? -1 : 0);
+}
+
+/******************************************************************************
+	Run runScene(scene[k]) for every scene, in at most nJob child
+	processes at a time; the standard output of each child is
+	redirected to <scene>.log.
+	Returns the number of scenes that failed (nonzero exit or crash).
+******************************************************************************/
+
+int batchRun (int nScene, char **scene, int nJob, int (*runScene) (char *scene))
+{
+  int k, nRunning=0, nFailed=0, status;
+  if (nJob < 1) nJob = 1;
+  for (k=0; k<nScene || nRunning>0; )
+   {
+    if (k < nScene && nRunning < nJob)
+     {
+      fflush (stdout);  cout.flush();
+      pid_t pid = fork();
+      if (pid == 0)			// child: one scene
+       {
+	char *log = new char[strlen(scene[k]) + 5];
+	strcpy (log, scene[k]);  strcat (log, ".log");
+	if (!freopen (log, "w", stdout)) exit (-1);
+	int err = runScene (scene[k]);
+	cout.flush();  fflush (stdout);
+	_exit (err ? 1 : 0);
+       }
+      if (pid < 0) { cerr << "Cannot fork for " << scene[k] << endl;  nFailed++; }
+      else nRunning++;
+      k++;
+     }
+    else if (wait (&status) > 0)
+     {
+      nRunning--;
+      if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) nFailed++;
+     }
+    else break;
+   }
+  cerr << nScene - nFailed << " of " << nScene << " scenes succeeded" << endl;
+  return nFailed;
+}
+
+#endif
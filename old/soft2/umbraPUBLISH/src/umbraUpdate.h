@@ -0,0 +1,113 @@
+/*
+  File:          umbraUpdate.h
+  Created:	 17 October 2026
+  Purpose:       Dependency test for incremental umbra recomputation
+                 when one obstacle (moved) changes.
+		 The bitangent table only changes in the row and column of
+		 moved, but the outer (and self-inner) bitangents of another
+		 obstacle i are classified by testing their lines against
+		 every obstacle of the scene.
+		 They can therefore only change if moved is the light,
+		 moved is i itself, or the line of one of i's candidate
+		 bitangents (clipped to the room) meets the bounding box
+		 of moved before or after the move.
+		 The local back umbra of i depends only on its outer bitangents.
+  Usage:	 ObBox oldBox = obBox[moved];  ...move obstacle...
+  		 buildObBox (obstacle[moved], featureSize, obBox[moved]);
+		 dirty[i] = umbraDepends (i, moved, bitang[i], obstacle,
+		 			  oldBox, obBox[moved], radiusRoom);
+*/
+
+#ifndef _UMBRAUPDATE_H_
+#define _UMBRAUPDATE_H_
+
+struct ObBox			// axis-aligned bounding box of an obstacle
+{
+  float min[2], max[2];
+};
+
+typedef Array<ObBox> ObBoxArr;
+
+/******************************************************************************
+	Bounding box of the display samples of ob, padded by pad
+	(to cover the curve between samples).
+******************************************************************************/
+
+void buildObBox (BezierCurve2f &ob, float pad, ObBox &box)
+{
+  V2f pt;
+  ob.getSample (0, pt);
+  for (int c=0; c<2; c++) box.min[c] = box.max[c] = pt[c];
+  for (int i=1; i<ob.getnSample(); i++)
+   {
+    ob.getSample (i, pt);
+    for (int c=0; c<2; c++)
+     {
+      if (pt[c] < box.min[c]) box.min[c] = pt[c];
+      if (pt[c] > box.max[c]) box.max[c] = pt[c];
+     }
+   }
+  for (int c=0; c<2; c++) { box.min[c] -= pad;  box.max[c] += pad; }
+}
+
+/******************************************************************************
+	Does the line through p and q meet box inside the room
+	(the square of radius radiusRoom centred at the origin)?
+	Slab test on the intersection of box and room.
+******************************************************************************/
+
+int lineHitsBox (V2f &p, V2f &q, ObBox &box, float radiusRoom)
+{
+  float t0 = -1e30, t1 = 1e30;
+  for (int c=0; c<2; c++)
+   {
+    float lo = (box.min[c] > -radiusRoom ? box.min[c] : -radiusRoom);
+    float hi = (box.max[c] <  radiusRoom ? box.max[c] :  radiusRoom);
+    if (lo > hi) return 0;
+    float d = q[c] - p[c];
+    if (d == 0)
+     {
+      if (p[c] < lo || p[c] > hi) return 0;
+      continue;
+     }
+    float ta = (lo - p[c]) / d, tb = (hi - p[c]) / d;
+    if (ta > tb) { float tmp = ta;  ta = tb;  tb = tmp; }
+    if (ta > t0) t0 = ta;
+    if (tb < t1) t1 = tb;
+    if (t0 > t1) return 0;
+   }
+  return 1;
+}
+
+/******************************************************************************
+	Does the line of some bitangent of ut meet box inside the room?
+******************************************************************************/
+
+int bitangHitsBox (UmbralBitangArr &ut, Array<BezierCurve2f> &obstacle,
+		   ObBox &box, float radiusRoom)
+{
+  V2f p, q;
+  for (int k=0; k<ut.getn(); k++)
+   {
+    obstacle[ut[k].index1].eval (ut[k].param1, p);
+    obstacle[ut[k].index2].eval (ut[k].param2, q);
+    if (p != q && lineHitsBox (p, q, box, radiusRoom)) return 1;
+   }
+  return 0;
+}
+
+/******************************************************************************
+	Must the umbral bitangents of obstacle i, filtered from the
+	candidate bitangents cand, be recomputed after obstacle moved
+	moved from oldBox to newBox?
+******************************************************************************/
+
+int umbraDepends (int i, int moved, UmbralBitangArr &cand, Array<BezierCurve2f> &obstacle,
+		  ObBox &oldBox, ObBox &newBox, float radiusRoom)
+{
+  if (i == moved || moved == 0) return 1;	// own bitangents, or light, changed
+  return (bitangHitsBox (cand, obstacle, oldBox, radiusRoom) ||
+	  bitangHitsBox (cand, obstacle, newBox, radiusRoom));
+}
+
+#endif
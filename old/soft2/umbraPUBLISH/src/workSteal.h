@@ -0,0 +1,162 @@
+/*
+  File:          workSteal.h
+  Created:	 17 October 2026
+  Purpose:       Work-stealing execution of n independent tasks over a pool
+                 of POSIX threads.
+		 Each thread owns a contiguous block of task indices and
+		 consumes it from the front; an idle thread steals the back
+		 half of the fullest remaining block.
+		 Tasks must write their results to disjoint, preallocated
+		 storage (e.g., bitang[i*nOb+j]), so the output does not
+		 depend on the schedule.
+  Usage:	 void task (int k, void *arg);
+  		 workStealFor (nTask, nThread, task, arg);
+		 Link with -lpthread.
+*/
+
+#ifndef _WORKSTEAL_H_
+#define _WORKSTEAL_H_
+
+#include <pthread.h>
+#include <unistd.h>
+
+typedef void (*WorkStealTask) (int k, void *arg);
+
+struct WorkStealBlock 		// tasks [lo,hi) still owned by one thread
+{
+  pthread_mutex_t lock;
+  int             lo, hi;
+};
+
+struct WorkStealPool
+{
+  int             nThread;
+  WorkStealBlock *block;	// one per thread
+  WorkStealTask   task;
+  void           *arg;
+};
+
+struct WorkStealWorker
+{
+  WorkStealPool  *pool;
+  int             id;
+};
+
+/******************************************************************************
+	Number of online processors (at least 1).
+******************************************************************************/
+
+static inline int nProcessor ()
+{
+  long n = sysconf (_SC_NPROCESSORS_ONLN);
+  return (n < 1 ? 1 : (int) n);
+}
+
+/******************************************************************************
+	Pop the next task from the front of a block, or -1 if it is empty.
+******************************************************************************/
+
+static inline int workStealPop (WorkStealBlock &b)
+{
+  int k = -1;
+  pthread_mutex_lock (&b.lock);
+  if (b.lo < b.hi) k = b.lo++;
+  pthread_mutex_unlock (&b.lock);
+  return k;
+}
+
+/******************************************************************************
+	Move the back half of the fullest other block into thief's block.
+	Returns 0 when every block is empty (no work left anywhere).
+	Each size is read under its block's lock (the owner is changing it),
+	and rechecked under the victim's lock before taking half.
+******************************************************************************/
+
+static inline int workSteal (WorkStealPool &pool, int thief)
+{
+  while (1)
+   {
+    int victim = -1, most = 0;
+    for (int v=0; v<pool.nThread; v++)
+     {
+      if (v == thief) continue;
+      pthread_mutex_lock (&pool.block[v].lock);
+      int size = pool.block[v].hi - pool.block[v].lo;
+      pthread_mutex_unlock (&pool.block[v].lock);
+      if (size > most) { most = size;  victim = v; }
+     }
+    if (victim == -1) return 0;
+
+    WorkStealBlock &b = pool.block[victim];
+    int lo, hi;
+    pthread_mutex_lock (&b.lock);
+    lo = b.lo + (b.hi - b.lo) / 2;	// owner keeps the front half
+    hi = b.hi;
+    b.hi = lo;
+    pthread_mutex_unlock (&b.lock);
+    if (lo < hi)
+     {
+      WorkStealBlock &mine = pool.block[thief];
+      pthread_mutex_lock (&mine.lock);
+      mine.lo = lo;  mine.hi = hi;
+      pthread_mutex_unlock (&mine.lock);
+      return 1;
+     }
+    // victim drained between scan and lock: rescan
+   }
+}
+
+/******************************************************************************/
+/******************************************************************************/
+
+static inline void *workStealRun (void *w)
+{
+  WorkStealWorker *worker = (WorkStealWorker *) w;
+  WorkStealPool   &pool   = *worker->pool;
+  do {
+    int k;
+    while ((k = workStealPop (pool.block[worker->id])) != -1)
+      pool.task (k, pool.arg);
+  } while (workSteal (pool, worker->id));
+  return NULL;
+}
+
+/******************************************************************************
+	Execute task(k,arg) for k=0..nTask-1 on nThread threads.
+	nThread <= 1 runs the tasks serially, in order, on the calling thread.
+******************************************************************************/
+
+static inline void workStealFor (int nTask, int nThread, WorkStealTask task, void *arg)
+{
+  int i;
+  if (nThread > nTask) nThread = nTask;
+  if (nThread <= 1)
+   {
+    for (i=0; i<nTask; i++) task (i, arg);
+    return;
+   }
+  WorkStealPool pool;
+  pool.nThread = nThread;
+  pool.block   = new WorkStealBlock[nThread];
+  pool.task    = task;
+  pool.arg     = arg;
+  for (i=0; i<nThread; i++)	// initial even partition
+   {
+    pthread_mutex_init (&pool.block[i].lock, NULL);
+    pool.block[i].lo = (int) ((long) nTask *  i    / nThread);
+    pool.block[i].hi = (int) ((long) nTask * (i+1) / nThread);
+   }
+  WorkStealWorker *worker = new WorkStealWorker[nThread];
+  pthread_t       *thread = new pthread_t[nThread];
+  for (i=0; i<nThread; i++)
+   {
+    worker[i].pool = &pool;  worker[i].id = i;
+    if (i > 0) pthread_create (&thread[i], NULL, workStealRun, &worker[i]);
+   }
+  workStealRun (&worker[0]);		// calling thread is worker 0
+  for (i=1; i<nThread; i++) pthread_join (thread[i], NULL);
+  for (i=0; i<nThread; i++) pthread_mutex_destroy (&pool.block[i].lock);
+  delete [] thread;  delete [] worker;  delete [] pool.block;
+}
+
+#endif
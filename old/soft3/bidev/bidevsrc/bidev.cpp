@@ -2,10 +2,23 @@
   File:          bidev.cpp
   Author:        J.K. Johnstone 
   Created:	 15 August 2001
-  Last Modified: 1 November 2002
+  Last Modified: 17 October 2026
   Purpose:       Compute the bitangent developables of two surfaces,
   Sequence:	 3rd in a sequence (surfinterpolate, tangentialSurf, bidev)
-  History: 	 
+  History: 	 10/17/26: Tangential surfaces of each obstacle and dual space, and
+  			   their display, built in parallel as a task graph
+			   (taskGraph.h), with the wall time of every stage (-t).
+		 10/17/26: Patches that cannot meet culled before intersecting
+		 	   tangential surfaces (tangSurfCull.h, -c to disable).
+		 10/17/26: Directrix fragments stitched in one pass through a
+		 	   hash grid of their endpoints (fragStitch.h), directrix1
+			   following the stitching of directrix0.
+		 10/17/26: Tangential surface systems also stored in binary
+		 	   (.tangbin, tangSysFile.h), memory-mapped by -S and
+			   loaded surface by surface in parallel (obstacles
+			   built from the mapping, tangential surfaces still
+			   through readTangSurf); patch culling reads the
+			   mapped nets; -b converts a stored .tangsurf.
 */
 
 #include <GL/glut.h>
@@ -25,6 +38,10 @@ using std::string;
 #include "MiscVector.h"		
 #include "BezierSurf.h"
 #include "TangSurf.h"	
+#include "taskGraph.h"		// runTaskGraph, nProcessor (umbraPUBLISH/src)
+#include "tangSurfCull.h"	// cullIntersectNets (umbraPUBLISH/src)
+#include "fragStitch.h"		// planStitch, applyStitch (umbraPUBLISH/src)
+#include "tangSysFile.h"	// mapTangSys, convertTangSys, tangSysCullNet (umbraPUBLISH/src)
 
 #define PTSPERBEZSEGMENT 5   	// # pts to draw on each Bezier segment
 #define WINDOWS 0		// running on Windows?
@@ -41,8 +58,11 @@ static void usage()
   cout << "\t[-M] (unified bicubic Bezier control mesh input)" << endl;
   cout << "\t[-j] (just tangential a-surface)" << endl;
   cout << "\t[-s] (store)" << endl;
-  cout << "\t[-S] (use stored tangential surface systems)" << endl;
+  cout << "\t[-S] (use stored tangential surface systems: <file>.tangbin or <file>.tangsurf)" << endl;
+  cout << "\t[-b] (convert stored <file>.tangsurf to binary <file>.tangbin, and exit)" << endl;
   cout << "\t[-D] (don't display tangential surfaces)" << endl;
+  cout << "\t[-t #] (number of threads building tangential surfaces: default all processors)" << endl;
+  cout << "\t[-c] (intersect all patches, without culling those that cannot meet)" << endl;
   cout << "\t[-h] (this help message)" << endl;
   cout << "\t <file>.pts3 or <file>.cpt3" << endl;
  }
@@ -84,9 +104,12 @@ static GLboolean DRAWBBOX=1;		// draw box in b-dual space?
 static GLboolean DRAWCBOX=1;		// draw box in c-dual space?
 static GLboolean STORE=0;		// store the tangential surface systems?
 static GLboolean STORED=0;		// use stored tangential surface systems, rather than computing from scratch
+static GLboolean CONVERT=0;		// convert stored text systems to binary?
 static GLboolean NOTANGDISPLAY=0;	// don't display tangential surfaces?
+static GLboolean CULL=1;		// cull patches that cannot meet before intersecting?
 static GLboolean DRAWDIRECTRIX=0;	// draw directrix curves?
 static GLboolean DRAWLOFTING=0;		// draw bitangent developables?
+static GLboolean DIRECTRIXMATCHED=0;	// directrix1 stitched by the plan of directrix0, point for point?
 
 Array<BezierSurf3f> 	obstacle;	// primal surfaces
 Array<TangentialSurf>   obdualA; 	// associated tangential a-surfaces
@@ -104,7 +127,8 @@ PatchIntersection	iCurveAprimalOnFirst,	// image of intersection curves wrt 0th
 			iCurveBprimalOnFirst, iCurveCprimalOnFirst;
 PatchIntersection	iCurveAprimalOnSecond,	// image of intersection curves wrt 1st obstacle
 			iCurveBprimalOnSecond, iCurveCprimalOnSecond;
-PatchIntersection	directrix0,directrix1;	// directrix curves of developables
+PatchIntersection	directrix0,directrix1;	// directrix fragments of developables
+StitchCurves		directrix0Curves,directrix1Curves;	// directrix curves, stitched from the fragments
 int			level=0;	// trace level
 float 			uActive,vActive;// parameters of active point
 float 			uDelta,vDelta;	// increment of parameter value per step
@@ -114,6 +138,9 @@ int			dualWinA,dualWinB,dualWinC; // dual window identifiers
 int       		density = PTSPERBEZSEGMENT;
 float 			eps = .01;	// accuracy at which to clip tangential surfaces
 float     		epsInt = .0001;	// accuracy at which to intersect tangential surfaces
+int			nThread=-1;	// # threads building tangential surfaces (-1: # processors)
+TangSys			tangSys;	// mapped binary tangential surface systems
+int			*loadError;	// load task 4*i+k failed (surface k of obstacle i)?
 
 /******************************************************************************/
 /******************************************************************************/
@@ -515,6 +542,20 @@ void menuDualC (int value)
   glutPostRedisplay();
 }
 
+/******************************************************************************
+	Draw stitched curves.
+******************************************************************************/
+
+void drawStitch (StitchCurves &C)
+{
+  for (int i=0; i<C.nCurve; i++)
+   {
+    glBegin (C.closed[i] ? GL_LINE_LOOP : GL_LINE_STRIP);
+    for (int k=0; k<C.nPt[i]; k++) glVertex3fv (stitchPt (C, i, k));
+    glEnd();
+   }
+}
+
 /******************************************************************************/
 /******************************************************************************/
 
@@ -579,24 +620,21 @@ void displayOb ()
    {
     glDisable (GL_LIGHTING);
     if (PRINTOUT) glColor3fv (Black); else glColor3fv (Black);
-    directrix0.draw();
-    directrix1.draw();
+    drawStitch (directrix0Curves);
+    drawStitch (directrix1Curves);
     glEnable (GL_LIGHTING);
    }
-  if (DRAWLOFTING)
+  if (DRAWLOFTING && DIRECTRIXMATCHED)	// rulings join corresponding points
    {
     glDisable (GL_LIGHTING);
     glColor3fv (Blue);
 //    glBegin (GL_TRIANGLE_STRIP);	need to merge curves first
     glBegin(GL_LINES);
-    for (i=0; i<directrix0.getnCurve(); i++)
-      for (j=0; j<directrix0.getnPt(i); j++)
+    for (i=0; i<directrix0Curves.nCurve; i++)
+      for (j=0; j<directrix0Curves.nPt[i]; j++)
        {
-        V3f pt;
-        directrix0.getPt (i,j,pt);
-        glVertex3f (pt[0], pt[1], pt[2]);
-        directrix1.getPt (i,j,pt);
-        glVertex3f (pt[0], pt[1], pt[2]);
+        glVertex3fv (stitchPt (directrix0Curves, i, j));
+        glVertex3fv (stitchPt (directrix1Curves, i, j));
        }
     glEnd();
     glEnable (GL_LIGHTING);
@@ -954,10 +992,67 @@ void inputSurfaces (char *file, Array<BezierSurf3f> &obstacle)
       obstacle[i].create (3, 3, 3, numSegu[i], numSegv[i], Pt[i], knotu, knotv);
      }
     else obstacle[i].fit (Pt[i]);
-    if (!STORE) obstacle[i].prepareDisplay (density);
    }
 }
 
+/******************************************************************************
+	Tasks of the tangential surface systems (see readInput):
+	for obstacle i, the components of its tangential surfaces,
+	then its tangential a-, b- and c-surfaces, then their display.
+	Each writes only to obstacle i's own surfaces.
+******************************************************************************/
+
+struct TangSurfComponents	// shared by the a-, b- and c-surface of an obstacle
+{
+  BezierSurf1f a,b,c,d;
+};
+
+void componentsTask (int i, void *comp)
+{
+  TangSurfComponents &C = ((TangSurfComponents *) comp)[i];
+  obdualA[i].tangSurfComponents (obstacle[i], C.a, C.b, C.c, C.d);
+}
+
+void createATask (int i, void *comp)
+{
+  TangSurfComponents &C = ((TangSurfComponents *) comp)[i];
+  obdualA[i].createA (i, C.a, C.b, C.c, C.d, eps);
+}
+
+void createBTask (int i, void *comp)
+{
+  TangSurfComponents &C = ((TangSurfComponents *) comp)[i];
+  obdualB[i].createB (i, C.a, C.b, C.c, C.d, eps);
+}
+
+void createCTask (int i, void *comp)
+{
+  TangSurfComponents &C = ((TangSurfComponents *) comp)[i];
+  obdualC[i].createC (i, C.a, C.b, C.c, C.d, eps);
+}
+
+static inline int loadFailed (int i, int k)	// surface k of obstacle i not loaded?
+{
+  return loadError && loadError[4*i+k];
+}
+
+void displayObstacleTask (int i, void *) { if (!loadFailed (i,0)) obstacle[i].prepareDisplay (density); }
+void displayATask        (int i, void *) { if (!loadFailed (i,1)) obdualA[i].prepareDisplay (density); }
+void displayBTask        (int i, void *) { if (!loadFailed (i,2)) obdualB[i].prepareDisplay (density); }
+void displayCTask        (int i, void *) { if (!loadFailed (i,3)) obdualC[i].prepareDisplay (density); }
+
+void loadObstacleTask (int i, void *) { loadError[4*i]   = loadTangSysSurf (tangSys, 4*i,   obstacle[i]); }
+void loadATask        (int i, void *) { loadError[4*i+1] = loadTangSysSurf (tangSys, 4*i+1, obdualA[i]); }
+void loadBTask        (int i, void *) { loadError[4*i+2] = loadTangSysSurf (tangSys, 4*i+2, obdualB[i]); }
+void loadCTask        (int i, void *) { loadError[4*i+3] = loadTangSysSurf (tangSys, 4*i+3, obdualC[i]); }
+
+static WorkStealTask createTask[3]   = {createATask,  createBTask,  createCTask};
+static WorkStealTask displayTask[3]  = {displayATask, displayBTask, displayCTask};
+static WorkStealTask loadTask[3]     = {loadATask,    loadBTask,    loadCTask};
+static const char   *createStage[3]  = {"createA",  "createB",  "createC"};
+static const char   *displayStage[3] = {"displayA", "displayB", "displayC"};
+static const char   *loadStage[3]    = {"loadA",    "loadB",    "loadC"};
+
 /******************************************************************************
 	Read Bezier surfaces.
 	Either build their tangential surface systems, or read them.
@@ -965,8 +1060,19 @@ void inputSurfaces (char *file, Array<BezierSurf3f> &obstacle)
 
 void readInput(char *file)
 {
-  int i,nOb;
-  if (STORED)		// read in tangential surface system from file storage
+  int i,s,nOb;
+  TangSurfComponents *comp=NULL;
+  int binary = STORED && isTangSysFile (file);
+  if (binary)		// map binary tangential surface systems, to load in parallel below
+   {
+    if (mapTangSys (file, tangSys, 1)) exit(-1);
+   		cout << "Using stored binary tangential surface systems" << endl;
+    nOb = tangSys.header->nOb;
+    obstacle.allocate(nOb); obdualA.allocate(nOb); obdualB.allocate(nOb); obdualC.allocate(nOb);
+    loadError = new int[4*nOb];
+    for (i=0; i<4*nOb; i++) loadError[i] = 0;
+   }
+  else if (STORED)	// read in tangential surface system from file storage
    {
    		cout << "Using stored tangential surface systems" << endl;
     nOb = 2;
@@ -986,25 +1092,68 @@ void readInput(char *file)
       getRightBrace (infile);
      }
     infile.close();
-		cout << "Preparing display of obstacle" << endl;
-    for (i=0; i<nOb; i++) obstacle[i].prepareDisplay (density);
    }
   else			// compute tangential surface system from scratch
    {
     inputSurfaces (file, obstacle);
     nOb = obstacle.getn();
     obdualA.allocate(nOb); obdualB.allocate(nOb); obdualC.allocate(nOb);
-    for (i=0; i<nOb; i++)	// build tangential surfaces in 3 dual spaces
+    comp = new TangSurfComponents[nOb];
+   }
+  // one task per obstacle and dual space, and per display,
+  // each waiting only for what it uses
+  int storing = STORE && !STORED;	// exit after storing, without display
+  TaskGraph G;
+  initTaskGraph (G, 8*nOb);
+  for (i=0; i<nOb; i++)
+   {
+    int built[3] = {-1,-1,-1};		// tasks building a-, b- and c-surface
+    int loaded = -1;			// task loading the obstacle
+    int c = -1;				// task reading its components
+    if (binary)
+     {
+      loaded = addTask (G, "loadObstacle", i, loadObstacleTask, NULL);
+      for (s=0; s<3; s++) built[s] = addTask (G, loadStage[s], i, loadTask[s], NULL);
+     }
+    if (!STORED)
      {
-      BezierSurf1f a,b,c,d;
-      obdualA[i].tangSurfComponents (obstacle[i], a, b, c, d);
-      obdualA[i].createA (i,a,b,c,d,eps);
-      if (ALLTS)
+      c = addTask (G, "components", i, componentsTask, comp);
+      for (s=0; s<(ALLTS ? 3 : 1); s++)
        {
-        obdualB[i].createB (i,a,b,c,d,eps);
-        obdualC[i].createC (i,a,b,c,d,eps);
+        built[s] = addTask (G, createStage[s], i, createTask[s], comp);
+	addDependency (G, c, built[s]);
        }
      }
+    if (!storing)			// display data of the obstacle is
+     {					// written only after its components are read
+      int d = addTask (G, "displayObstacle", i, displayObstacleTask, NULL);
+      if (loaded != -1) addDependency (G, loaded, d);
+      if (c != -1)      addDependency (G, c, d);
+     }
+    if (!NOTANGDISPLAY && !storing)
+      for (s=0; s<(ALLTS ? 3 : 1); s++)
+       {
+        int d = addTask (G, displayStage[s], i, displayTask[s], NULL);
+	if (built[s] != -1) addDependency (G, built[s], d);
+       }
+   }
+  if (nThread == -1) nThread = nProcessor();	// not set by 't' parameter
+  cout << "Building tangential surfaces (" << G.n << " tasks on " << nThread << " threads)..." << endl;
+  runTaskGraph (G, nThread);
+  reportTaskGraph (G);
+  freeTaskGraph (G);
+  delete [] comp;
+  if (binary)		// mapping kept for patch culling (unmapped in main)
+   {
+    static const char *surfName[4] = {"obstacle", "a-surface", "b-surface", "c-surface"};
+    int failed=0;
+    for (i=0; i<4*nOb; i++)
+      if (loadError[i]) { cerr << "Cannot load " << surfName[i%4] << " " << i/4 << endl;  failed=1; }
+    delete [] loadError;  loadError = NULL;
+    if (failed) exit(-1);
+   }
+  if (!STORED)
+   {
     if (STORE)
      {
       string outfileName(file);
@@ -1027,22 +1176,13 @@ void readInput(char *file)
 	outfile << "}" << endl;
        }
       outfile.close();
+      string binfileName(file);
+      changeSuffix (binfileName, ".tangbin");
+      if (convertTangSys (outfileName.c_str(), binfileName.c_str()) == 0)
+        cout << "Stored " << outfileName << " and " << binfileName << endl;
       exit(1);
      }
    } 
-  if (!NOTANGDISPLAY)
-    for (i=0; i<nOb; i++)
-     {
-		cout << "Preparing display of tangential a-surface for obstacle " << i << "..." << endl; 
-      obdualA[i].prepareDisplay (density);
-      if (ALLTS)
-       {
-		cout << "Preparing display of tangential b-surface for obstacle " << i << "..." << endl; 
-        obdualB[i].prepareDisplay (density);
-		cout << "Preparing display of tangential c-surface for obstacle " << i << "..." << endl; 
-        obdualC[i].prepareDisplay (density);
-       }
-     }
 }
 
 /******************************************************************************
@@ -1127,21 +1267,46 @@ int main (int argc, char **argv)
       case 'j': ALLTS = 0;				break;
       case 's': STORE  = 1;				break;
       case 'S': STORED = 1;				break;
+      case 'b': CONVERT = 1;				break;
       case 'D': NOTANGDISPLAY = 1;			break;
+      case 't': nThread = atoi(argv[ArgsParsed++]);	break;
+      case 'c': CULL = 0;				break;
       case 'h': 
       default:	usage(); exit(-1);			break;
       }
    else ArgsParsed++;
   }
   
+  if (CONVERT)				// text to binary storage only
+   {
+    string binfileName(argv[argc-1]);
+    changeSuffix (binfileName, ".tangbin");
+    if (convertTangSys (argv[argc-1], binfileName.c_str())) exit(-1);
+    cout << "Converted " << argv[argc-1] << " to " << binfileName << endl;
+    exit(1);
+   }
   readInput(argv[argc-1]);
   
+  TangSurfNet net[4][2];			// nets of the dual surfaces, in place
+  TangSurfNet *use[4][2];		// in the mapping (NULL: read from text)
+  int k, l;
+  for (k=1; k<4; k++)
+    for (l=0; l<2; l++)
+      use[k][l] = (CULL && tangSys.base && 4*l+k < (int) tangSys.header->nSurf &&
+		   tangSysCullNet (tangSys, 4*l+k, net[k][l]) == 0 ?
+		   &net[k][l] : NULL);
 	cout << "Intersecting tangential a-surfaces..." << endl;  
-  obdualA[0].intersect (obdualA[1], iCurveAdual, iCurveATrace, epsInt);
+  if (CULL) cullIntersectNets (obdualA[0], use[1][0], obdualA[1], use[1][1], iCurveAdual, iCurveATrace, epsInt, "a");
+  else      obdualA[0].intersect (obdualA[1], iCurveAdual, iCurveATrace, epsInt);
 	cout << "Intersecting tangential b-surfaces..." << endl;  
-  obdualB[0].intersect (obdualB[1], iCurveBdual, iCurveBTrace, epsInt); 
+  if (CULL) cullIntersectNets (obdualB[0], use[2][0], obdualB[1], use[2][1], iCurveBdual, iCurveBTrace, epsInt, "b");
+  else      obdualB[0].intersect (obdualB[1], iCurveBdual, iCurveBTrace, epsInt);
 	cout << "Intersecting tangential c-surfaces..." << endl;
-  obdualC[0].intersect (obdualC[1], iCurveCdual, iCurveCTrace, epsInt); 
+  if (CULL) cullIntersectNets (obdualC[0], use[3][0], obdualC[1], use[3][1], iCurveCdual, iCurveCTrace, epsInt, "c");
+  else      obdualC[0].intersect (obdualC[1], iCurveCdual, iCurveCTrace, epsInt);
+  for (k=1; k<4; k++)
+    for (l=0; l<2; l++) if (use[k][l]) freeTangSurfNet (net[k][l]);
+  if (tangSys.base) unmapTangSys (tangSys);
 cout << "iCurveAdual: " << endl;	iCurveAdual.print(); 
 cout << "iCurveBdual: " << endl;	iCurveBdual.print();
 cout << "iCurveCdual: " << endl;	iCurveCdual.print();  
@@ -1164,7 +1329,24 @@ cout << "iCurveCdual: " << endl;	iCurveCdual.print();
   directrix1 += iCurveCprimalOnSecond;
 
   // splice directrix0 together, with directrix1 mimicking its splicing
-  // ...
+  StitchFrags frag0, frag1;  StitchPlan plan;
+  readFrags (directrix0, frag0);
+  readFrags (directrix1, frag1);
+  int matched = (frag0.n == frag1.n);	// same fragments, point for point?
+  for (int i=0; i<frag0.n && matched; i++) matched = (frag0.nPt[i] == frag1.nPt[i]);
+  planStitch (frag0, 10*epsInt, plan);
+  applyStitch (plan, frag0, directrix0Curves);
+  if (!matched)
+   {
+    cout << "Directrices do not correspond: stitching directrix1 separately"
+	 << " (no bitangent developables drawn)" << endl;
+    freeStitchPlan (plan);
+    planStitch (frag1, 10*epsInt, plan);
+   }
+  applyStitch (plan, frag1, directrix1Curves);
+  DIRECTRIXMATCHED = matched;
+  cout << "Stitched " << frag0.n << " directrix fragments into " << directrix0Curves.nCurve << " curves" << endl;
+  freeStitchPlan (plan);  freeFrags (frag0);  freeFrags (frag1);
   
   // merge directrix0 components with directrix1 components
   // to form loftings
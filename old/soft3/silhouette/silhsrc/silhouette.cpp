@@ -2,7 +2,7 @@
   File:          silhouette.cpp
   Author:        J.K. Johnstone 
   Created:	 18 December 2002 (from tangentialSurf.cpp)
-  Last Modified: 23 December 2002
+  Last Modified: 17 October 2026
   Purpose:       Compute the smooth silhouette of the given surface,
   		 using tangential surfaces.
 		 Builds on tangentialSurf.cpp.
@@ -15,6 +15,18 @@
 			   and silhouette curve.
 			   Add -D option (preparing tangential surfaces for
 			   display dominates silhouette computation).
+		 10/17/26: Tangential surfaces of each dual space and the
+		 	   viewpoint duals, and their display, built in parallel
+			   as a task graph (taskGraph.h), with the wall time of
+			   every stage (-t).
+		 10/17/26: Patches that cannot meet culled before intersecting
+		 	   tangential surfaces (tangSurfCull.h, -c to disable).
+		 10/17/26: Moving viewpoint (O, [, ]): silhouette tracked by
+		 	   predictor-corrector continuation from the previous
+			   frame, recomputed only on a change of topology.
+		 10/17/26: Silhouette fragments stitched in one pass through a
+		 	   hash grid of their endpoints (fragStitch.h), rather
+			   than by repeated spliceClosest.
 */
 
 #include <GL/glut.h>
@@ -36,6 +48,9 @@ using std::string;
 				// BezierSurf1f
 #include "TangSurf.h"		// tangSurfComponents, createA/B/C, 
 				// prepareDisplay, drawT
+#include "taskGraph.h"		// runTaskGraph, nProcessor (umbraPUBLISH/src)
+#include "tangSurfCull.h"	// cullIntersectNets, readTangSurfNet (umbraPUBLISH/src)
+#include "fragStitch.h"		// planStitch, applyStitch (umbraPUBLISH/src)
 
 #define PTSPERBEZSEGMENT 5   	// # pts to draw on each Bezier segment
 #define WINDOWS 0		// running on Windows?
@@ -53,6 +68,8 @@ static void usage()
   cout << "\t[-S] (use stored tangential surface system)" << endl;
   cout << "\t[-D] (don't display tangential surfaces)" << endl;
   cout << "\t[-v] x y z (viewpoint)" << endl;
+  cout << "\t[-t #] (number of threads building tangential surfaces: default all processors)" << endl;
+  cout << "\t[-c] (intersect all patches, without culling those that cannot meet)" << endl;
   cout << "\t[-h] (this help message)" << endl;
   cout << "\t <file>.pts3" << endl;
  }
@@ -96,6 +113,9 @@ static GLboolean DRAWSILHOUETTE=1;	// draw full silhouette?
 static GLboolean STORED=0;		// use stored tangential surface system, rather than computing from scratch
 static GLboolean ORTHO=0;		// orthographic projection?
 static GLboolean NOTANGDISPLAY=0;	// don't display tangential surfaces?
+static GLboolean CULL=1;		// cull patches that cannot meet before intersecting?
+static GLboolean ORBIT=0;		// orbit the viewpoint, tracking the silhouette?
+static GLboolean TRACKED=0;		// silhouette tracked (components and duals stale)?
 
 Array<BezierSurf3f> 	obstacle;	// primal surfaces
 Array<TangentialSurf>   obdualA; 	// associated tangential a-surfaces
@@ -105,7 +125,8 @@ V3f			viewpt(2,2,2);	// viewpoint w.r.t silhouette is computed
 TangentialSurf 		viewptadual,viewptbdual,viewptcdual;	// duals of viewpoint (each a plane)
 PatchIntersection	iCurveadual,iCurvebdual,iCurvecdual;	// intersection of viewpoint dual and tangential surfaces
 PatchIntersection 	iCurveaprimal,iCurvebprimal,iCurvecprimal; // silhouette, as primal version of iCurvea/b/cdual (same parameter values, different points)
-PatchIntersection	silhouette;	// silhouette curve, spliced from 3 dual spaces
+PatchIntersection	silhouette;	// silhouette fragments from 3 dual spaces
+StitchCurves		silhCurves;	// silhouette curves, stitched from the fragments
 float 			uActive,vActive;// parameters of active point
 float 			uDelta,vDelta;	// increment of parameter value per step
 float			uFirstKnot,uLastKnot,vFirstKnot, vLastKnot;
@@ -114,6 +135,7 @@ int			dualWinA,dualWinB,dualWinC; // dual window identifiers
 int       		density = PTSPERBEZSEGMENT;
 float 			eps = .01;	// accuracy at which to clip tangential surfaces
 float     		epsInt = .0001;	// accuracy at which to intersect tangential surfaces
+int			nThread=-1;	// # threads building tangential surfaces (-1: # processors)
 
 /******************************************************************************/
 /******************************************************************************/
@@ -226,6 +248,590 @@ void PanOb (void)
   glutPostRedisplay();
 }
 
+/******************************************************************************
+	Silhouette tracking for a moving viewpoint (orbit, 'O').
+	The silhouette of obstacle[0] from viewpoint E is the zero set, in
+	its parameter space, of the cosine
+		g(u,v) = (S(u,v) - E) . N(u,v) / (|S(u,v) - E| |N(u,v)|).
+	After a full computation (computeSilhouette: intersection with the
+	viewpoint duals), every curve point is projected to parameters
+	(u,v).  When the viewpoint moves, each point is corrected by
+	Newton's method along the gradient of g (the old point is the
+	predictor), the curves are resampled to spacing TRACKSTEP, and
+	open ends are extended along their tangents.
+	The global computation is repeated only on a change of topology:
+	a point that cannot be corrected (e.g., at a critical point of g,
+	where components are born, merge or split), two distinct pieces
+	of curve meeting, a sign change of g on a coarse grid of the
+	parameter space with no tracked point nearby (a new component,
+	detected once it spans a grid cell), or a change in the number
+	of cusps.
+	Parameters (u,v) run over [0,nSegu] x [0,nSegv] (segment i of the
+	Bezier spline is [i,i+1]); the surface is evaluated here from its
+	control net, as written by storeBezSurf.
+******************************************************************************/
+
+#define TRACKSTEP  .02		// spacing of tracked points (in segments)
+#define TRACKGRID  4		// cells per segment of the coarse grid for new components
+#define TRACKTOL   1e-7		// |g| at which a point is on the silhouette
+#define ORBITSTEP  1.		// degrees of orbit of the viewpoint per frame
+
+struct SilhSurf			// obstacle[0], from its control net
+{
+  int     degu, degv, nSegu, nSegv;
+  double *ctrl;			// (degu*nSegu+1)*(degv*nSegv+1) points, v fastest
+};
+
+struct SilhCurve		// tracked silhouette curve, in parameters of obstacle[0]
+{
+  int     n, max, closed;
+  double *u, *v;
+};
+
+SilhSurf	silhSurf;	// obstacle[0], for tracking
+SilhCurve      *track=NULL;	// tracked silhouette curves
+int		nTrack=0;
+int		nCusp;		// cusps of the tracked silhouette
+int		nTracked=0, nRecomputed=0;	// frames since the last report
+double		trackSec=0;	// time spent tracking since the last report
+
+/******************************************************************************
+	Read the control net of S into F.  Returns 0 on success.
+******************************************************************************/
+
+int readSilhSurf (BezierSurf3f &S, SilhSurf &F)
+{
+  char file[] = "/tmp/silhSurfXXXXXX";
+  int i, fd = mkstemp (file);
+  if (fd == -1) return -1;
+  close (fd);
+  ofstream outfile (file);  S.storeBezSurf (outfile);  outfile.close();
+  ifstream infile (file);
+  float knot;
+  infile >> F.degu >> F.degv >> F.nSegu >> F.nSegv;
+  for (i=0; i < F.nSegu+1 + F.nSegv+1; i++) infile >> knot;
+  int nCtrl = (F.degu*F.nSegu+1) * (F.degv*F.nSegv+1);
+  F.ctrl = new double[3*nCtrl];
+  for (i=0; i<3*nCtrl; i++) infile >> F.ctrl[i];
+  int ok = !infile.fail();
+  infile.close();
+  unlink (file);
+  return (ok ? 0 : -1);
+}
+
+/******************************************************************************
+	Bernstein polynomials of degree n at s, and their derivatives.
+******************************************************************************/
+
+static void bernstein (int n, double s, double *B, double *dB)
+{
+  int i, k;
+  double lower[16];
+  for (i=0; i<=n; i++) B[i] = 0;
+  B[0] = 1;
+  for (k=1; k<=n; k++)				// degree k from degree k-1
+   {
+    if (k == n) for (i=0; i<n; i++) lower[i] = B[i];
+    for (i=k; i>0; i--) B[i] = (1-s)*B[i] + s*B[i-1];
+    B[0] *= (1-s);
+   }
+  for (i=0; i<=n; i++)
+    dB[i] = n * ((i > 0 ? lower[i-1] : 0) - (i < n ? lower[i] : 0));
+}
+
+/******************************************************************************
+	Point P, and partial derivatives Pu and Pv, of F at (u,v).
+******************************************************************************/
+
+void evalSilhSurf (SilhSurf &F, double u, double v, double *P, double *Pu, double *Pv)
+{
+  int su = (int) floor (u), sv = (int) floor (v), i, j, c;
+  if (su < 0) su = 0;  if (su > F.nSegu-1) su = F.nSegu-1;
+  if (sv < 0) sv = 0;  if (sv > F.nSegv-1) sv = F.nSegv-1;
+  double Bu[16], dBu[16], Bv[16], dBv[16];
+  bernstein (F.degu, u-su, Bu, dBu);
+  bernstein (F.degv, v-sv, Bv, dBv);
+  int nv = F.degv*F.nSegv + 1;
+  for (c=0; c<3; c++) P[c] = Pu[c] = Pv[c] = 0;
+  for (i=0; i<=F.degu; i++)
+    for (j=0; j<=F.degv; j++)
+     {
+      double *Q = F.ctrl + 3*((su*F.degu+i)*nv + sv*F.degv+j);
+      for (c=0; c<3; c++)
+       {
+        P[c]  += Bu[i]*Bv[j]*Q[c];
+	Pu[c] += dBu[i]*Bv[j]*Q[c];
+	Pv[c] += Bu[i]*dBv[j]*Q[c];
+       }
+     }
+}
+
+/******************************************************************************
+	g at (u,v) from viewpoint E (see above), and optionally the
+	point P and unnormalized normal N there.
+******************************************************************************/
+
+double silhFn (SilhSurf &F, double u, double v, double *E, double *P=NULL, double *N=NULL)
+{
+  double Q[3], Qu[3], Qv[3], M[3], V[3];
+  evalSilhSurf (F, u, v, Q, Qu, Qv);
+  M[0] = Qu[1]*Qv[2] - Qu[2]*Qv[1];
+  M[1] = Qu[2]*Qv[0] - Qu[0]*Qv[2];
+  M[2] = Qu[0]*Qv[1] - Qu[1]*Qv[0];
+  for (int c=0; c<3; c++) { V[c] = Q[c] - E[c];  if (P) P[c] = Q[c];  if (N) N[c] = M[c]; }
+  double len = sqrt ((V[0]*V[0]+V[1]*V[1]+V[2]*V[2]) * (M[0]*M[0]+M[1]*M[1]+M[2]*M[2]));
+  return (len > 0 ? (V[0]*M[0]+V[1]*M[1]+V[2]*M[2]) / len : 0);
+}
+
+static inline int inDomain (SilhSurf &F, double u, double v)
+{
+  return u >= 0 && u <= F.nSegu && v >= 0 && v <= F.nSegv;
+}
+
+/******************************************************************************
+	Move (u,v) onto the silhouette from E by Newton's method along the
+	gradient of g.  Returns 0 if this fails: no convergence, a vanishing
+	gradient (a critical point: a change of topology) or leaving the
+	parameter space.
+******************************************************************************/
+
+int correctSilhPt (SilhSurf &F, double *E, double &u, double &v)
+{
+  const double h = 1e-5;
+  for (int iter=0; iter<10; iter++)
+   {
+    double g = silhFn (F, u, v, E);
+    if (fabs (g) < TRACKTOL) return 1;
+    double gu = (silhFn (F, u+h, v, E) - silhFn (F, u-h, v, E)) / (2*h);
+    double gv = (silhFn (F, u, v+h, E) - silhFn (F, u, v-h, E)) / (2*h);
+    double grad2 = gu*gu + gv*gv;
+    if (grad2 < 1e-12) return 0;
+    double du = -g*gu/grad2, dv = -g*gv/grad2, step = sqrt (du*du + dv*dv);
+    if (step > 5*TRACKSTEP) return 0;		// not near the old curve
+    u += du;  v += dv;
+    if (!inDomain (F, u, v)) return 0;
+   }
+  return fabs (silhFn (F, u, v, E)) < 100*TRACKTOL;
+}
+
+/******************************************************************************/
+/******************************************************************************/
+
+static void addTrackPt (SilhCurve &C, double u, double v)
+{
+  if (C.n == C.max)
+   {
+    C.max = (C.max ? 2*C.max : 64);
+    double *nu = new double[C.max], *nv = new double[C.max];
+    memcpy (nu, C.u, C.n*sizeof(double));  memcpy (nv, C.v, C.n*sizeof(double));
+    delete [] C.u;  delete [] C.v;
+    C.u = nu;  C.v = nv;
+   }
+  C.u[C.n] = u;  C.v[C.n++] = v;
+}
+
+static void freeTrack ()
+{
+  for (int i=0; i<nTrack; i++) { delete [] track[i].u;  delete [] track[i].v; }
+  delete [] track;
+  track = NULL;  nTrack = 0;
+}
+
+/******************************************************************************
+	Resample C (already on the silhouette from E) to spacing TRACKSTEP,
+	correcting inserted points.  Returns 0 if one cannot be corrected.
+******************************************************************************/
+
+int resampleTrack (SilhSurf &F, double *E, SilhCurve &C)
+{
+  SilhCurve R;
+  R.n = R.max = 0;  R.u = R.v = NULL;  R.closed = C.closed;
+  for (int k=0; k<C.n; k++)
+   {
+    if (R.n > 0)
+     {
+      double du = C.u[k] - R.u[R.n-1], dv = C.v[k] - R.v[R.n-1];
+      double d = sqrt (du*du + dv*dv);
+      if (d < TRACKSTEP/2 && k < C.n-1) continue;	// too close: drop
+      int m = (int) (d / TRACKSTEP);			// too far: insert
+      double u0 = R.u[R.n-1], v0 = R.v[R.n-1];
+      for (int l=1; l<m; l++)
+       {
+        double u = u0 + du*l/m, v = v0 + dv*l/m;
+	if (!correctSilhPt (F, E, u, v)) { delete [] R.u;  delete [] R.v;  return 0; }
+	addTrackPt (R, u, v);
+       }
+     }
+    addTrackPt (R, C.u[k], C.v[k]);
+   }
+  delete [] C.u;  delete [] C.v;
+  C = R;
+  return 1;
+}
+
+/******************************************************************************
+	Extend the ends of open curve C along their tangents while the
+	silhouette continues inside the parameter space.
+******************************************************************************/
+
+void extendTrack (SilhSurf &F, double *E, SilhCurve &C)
+{
+  if (C.closed || C.n < 2) return;
+  for (int end=0; end<2; end++)
+   {
+    if (end == 1)			// reverse, to extend the front
+      for (int k=0; k<C.n/2; k++)
+       {
+        double t = C.u[k];  C.u[k] = C.u[C.n-1-k];  C.u[C.n-1-k] = t;
+	t = C.v[k];  C.v[k] = C.v[C.n-1-k];  C.v[C.n-1-k] = t;
+       }
+    for (int step=0; step<1000; step++)
+     {
+      double du = C.u[C.n-1] - C.u[C.n-2], dv = C.v[C.n-1] - C.v[C.n-2];
+      double d = sqrt (du*du + dv*dv);
+      if (d == 0) break;
+      double u = C.u[C.n-1] + TRACKSTEP*du/d, v = C.v[C.n-1] + TRACKSTEP*dv/d;
+      if (!inDomain (F, u, v) || !correctSilhPt (F, E, u, v)) break;
+      double eu = u - C.u[C.n-1], ev = v - C.v[C.n-1];
+      if (eu*du + ev*dv <= 0 || sqrt (eu*eu + ev*ev) < TRACKSTEP/2) break;	// no progress
+      addTrackPt (C, u, v);
+     }
+   }
+}
+
+/******************************************************************************
+	Number of cusps of the silhouette from E: sign changes along each
+	curve of (T x (P-E)) . N, which vanishes where the tangent T of
+	the curve points at the viewpoint (also across the seam, from the
+	last point back to the first, of a closed curve).
+******************************************************************************/
+
+int countCusps (SilhSurf &F, double *E)
+{
+  int i, k, c, count=0;
+  for (i=0; i<nTrack; i++)
+   {
+    SilhCurve &C = track[i];
+    double P[3], N[3], Pa[3], Pb[3], foo[3], firstSign=0, lastSign=0;
+    for (k=0; k<C.n; k++)
+     {
+      int a = (k > 0 ? k-1 : (C.closed ? C.n-1 : k)), b = (k < C.n-1 ? k+1 : (C.closed ? 0 : k));
+      if (a == b) continue;
+      silhFn (F, C.u[k], C.v[k], E, P, N);
+      evalSilhSurf (F, C.u[a], C.v[a], Pa, foo, foo);
+      evalSilhSurf (F, C.u[b], C.v[b], Pb, foo, foo);
+      double T[3], V[3];
+      for (c=0; c<3; c++) { T[c] = Pb[c] - Pa[c];  V[c] = P[c] - E[c]; }
+      double s = (T[1]*V[2]-T[2]*V[1])*N[0] + (T[2]*V[0]-T[0]*V[2])*N[1] + (T[0]*V[1]-T[1]*V[0])*N[2];
+      if (s != 0)
+       {
+        if (lastSign != 0 && (s > 0) != (lastSign > 0)) count++;
+        if (firstSign == 0) firstSign = s;
+	lastSign = s;
+       }
+     }
+    if (C.closed && firstSign != 0 && (firstSign > 0) != (lastSign > 0)) count++;
+   }
+  return count;
+}
+
+/******************************************************************************
+	Is the tracked silhouette from E complete?  Fails (0) if pieces of
+	curve meet (points of different curves, or distant along one curve,
+	closer than TRACKSTEP/2), or if a cell of the coarse grid has a sign
+	change of g but no tracked point in or next to it.
+******************************************************************************/
+
+int trackComplete (SilhSurf &F, double *E)
+{
+  int i, j, k, l, a, b;
+  int nu = F.nSegu*TRACKGRID, nv = F.nSegv*TRACKGRID;
+  double cell = 1. / TRACKGRID;
+  int *mark  = new int[nu*nv];		// cells with (or next to) a tracked point
+  int *head  = new int[nu*nv];		// tracked points by cell
+  int  nPt   = 0;
+  for (i=0; i<nTrack; i++) nPt += track[i].n;
+  int *next  = new int[nPt], *curve = new int[nPt], *index = new int[nPt];
+  for (k=0; k<nu*nv; k++) { mark[k] = 0;  head[k] = -1; }
+  int ok=1, p=0;
+  for (i=0; i<nTrack; i++)
+    for (k=0; k<track[i].n; k++, p++)
+     {
+      a = (int) (track[i].u[k] / cell);  if (a >= nu) a = nu-1;  if (a < 0) a = 0;
+      b = (int) (track[i].v[k] / cell);  if (b >= nv) b = nv-1;  if (b < 0) b = 0;
+      for (j=a-1; j<=a+1; j++)
+        for (l=b-1; l<=b+1; l++)
+	  if (j >= 0 && j < nu && l >= 0 && l < nv) mark[j*nv+l] = 1;
+      // pieces meeting: earlier points in this and neighbouring cells
+      for (j=a-1; j<=a+1 && ok; j++)
+        for (l=b-1; l<=b+1 && ok; l++)
+	  if (j >= 0 && j < nu && l >= 0 && l < nv)
+	    for (int q=head[j*nv+l]; q!=-1 && ok; q=next[q])
+	     {
+	      SilhCurve &D = track[curve[q]];
+	      double du = D.u[index[q]] - track[i].u[k], dv = D.v[index[q]] - track[i].v[k];
+	      int apart = curve[q] != i || 
+			  (abs (index[q]-k) > 3 && (!track[i].closed || track[i].n - abs (index[q]-k) > 3));
+	      if (apart && du*du + dv*dv < TRACKSTEP*TRACKSTEP/4) ok = 0;
+	     }
+      curve[p] = i;  index[p] = k;
+      next[p] = head[a*nv+b];  head[a*nv+b] = p;
+     }
+  if (ok)				// new components: uncovered sign changes
+   {
+    double *g = new double[(nu+1)*(nv+1)];
+    for (j=0; j<=nu; j++)
+      for (l=0; l<=nv; l++) g[j*(nv+1)+l] = silhFn (F, j*cell, l*cell, E);
+    for (j=0; j<nu && ok; j++)
+      for (l=0; l<nv && ok; l++)
+       {
+        double g0 = g[j*(nv+1)+l], g1 = g[(j+1)*(nv+1)+l], g2 = g[j*(nv+1)+l+1], g3 = g[(j+1)*(nv+1)+l+1];
+	int change = (g0 > 0) != (g1 > 0) || (g0 > 0) != (g2 > 0) || (g0 > 0) != (g3 > 0);
+	if (change && !mark[j*nv+l]) ok = 0;
+       }
+    delete [] g;
+   }
+  delete [] mark;  delete [] head;  delete [] next;  delete [] curve;  delete [] index;
+  return ok;
+}
+
+/******************************************************************************
+	Start tracking from the silhouette just computed: project each of
+	its points to parameters of obstacle[0] (nearest sample, then
+	Gauss-Newton), and correct it onto the silhouette from E.
+******************************************************************************/
+
+void seedTrack (double *E)
+{
+  int i, j, k, l, c, iter;
+  freeTrack ();
+  if (!silhSurf.ctrl) return;			// not understood: no tracking
+  SilhSurf &F = silhSurf;
+  int su = 8*F.nSegu, sv = 8*F.nSegv;		// samples for a first guess
+  double *sample = new double[3*(su+1)*(sv+1)], foo[3];
+  for (j=0; j<=su; j++)
+    for (l=0; l<=sv; l++)
+      evalSilhSurf (F, (double) j*F.nSegu/su, (double) l*F.nSegv/sv, sample + 3*(j*(sv+1)+l), foo, foo);
+  nTrack = silhCurves.nCurve;
+  track  = new SilhCurve[nTrack];
+  for (i=0; i<nTrack; i++)
+   {
+    SilhCurve &C = track[i];
+    C.n = C.max = 0;  C.u = C.v = NULL;  C.closed = silhCurves.closed[i];
+    for (k=0; k<silhCurves.nPt[i]; k++)
+     {
+      float *pt = stitchPt (silhCurves, i, k);
+      double p[3] = {pt[0], pt[1], pt[2]}, best=1e30, u=0, v=0;
+      for (j=0; j<=su; j++)
+        for (l=0; l<=sv; l++)
+	 {
+	  double *q = sample + 3*(j*(sv+1)+l);
+	  double d = (q[0]-p[0])*(q[0]-p[0]) + (q[1]-p[1])*(q[1]-p[1]) + (q[2]-p[2])*(q[2]-p[2]);
+	  if (d < best) { best = d;  u = (double) j*F.nSegu/su;  v = (double) l*F.nSegv/sv; }
+	 }
+      for (iter=0; iter<10; iter++)		// minimize |S(u,v) - p|
+       {
+        double P[3], Pu[3], Pv[3], r[3];
+	evalSilhSurf (F, u, v, P, Pu, Pv);
+	for (c=0; c<3; c++) r[c] = p[c] - P[c];
+	double a11=0, a12=0, a22=0, b1=0, b2=0;
+	for (c=0; c<3; c++)
+	 { a11 += Pu[c]*Pu[c];  a12 += Pu[c]*Pv[c];  a22 += Pv[c]*Pv[c];  b1 += Pu[c]*r[c];  b2 += Pv[c]*r[c]; }
+	double det = a11*a22 - a12*a12;
+	if (fabs (det) < 1e-20) break;
+	u += (a22*b1 - a12*b2) / det;  v += (a11*b2 - a12*b1) / det;
+	if (u < 0) u = 0;  if (u > F.nSegu) u = F.nSegu;
+	if (v < 0) v = 0;  if (v > F.nSegv) v = F.nSegv;
+       }
+      if (correctSilhPt (F, E, u, v)) addTrackPt (C, u, v);
+     }
+    if (!resampleTrack (F, E, C)) C.n = 0;
+   }
+  delete [] sample;
+  nCusp = countCusps (F, E);
+}
+
+/******************************************************************************
+	Move the tracked silhouette to viewpoint E.
+	Returns 0 on a change of topology (see above).
+******************************************************************************/
+
+int trackSilhouette (double *E)
+{
+  SilhSurf &F = silhSurf;
+  if (!F.ctrl || !track) return 0;
+  for (int i=0; i<nTrack; i++)
+   {
+    SilhCurve &C = track[i];
+    int k, m=0, first=-1, last=-1, lost=0;
+    for (k=0; k<C.n; k++)
+     {
+      double u = C.u[k], v = C.v[k];
+      if (correctSilhPt (F, E, u, v))
+       {
+        C.u[k] = u;  C.v[k] = v;
+	if (first == -1) first = k;
+	lost += (last != -1 && last < k-1);		// gap after a kept point
+	last = k;
+       }
+     }
+    // an open curve may lose its ends (across the boundary of the
+    // parameter space), but not a point in between
+    if (lost || (C.closed && (first != 0 || last != C.n-1)) || first == -1) return 0;
+    for (k=first; k<=last; k++) { C.u[m] = C.u[k];  C.v[m++] = C.v[k]; }
+    C.n = m;
+    if (!resampleTrack (F, E, C)) return 0;
+    extendTrack (F, E, C);
+   }
+  if (!trackComplete (F, E)) return 0;
+  int cusps = countCusps (F, E);
+  if (cusps != nCusp) { nCusp = cusps;  return 0; }
+  return 1;
+}
+
+/******************************************************************************
+	Draw stitched curves.
+******************************************************************************/
+
+void drawStitch (StitchCurves &C)
+{
+  for (int i=0; i<C.nCurve; i++)
+   {
+    glBegin (C.closed[i] ? GL_LINE_LOOP : GL_LINE_STRIP);
+    for (int k=0; k<C.nPt[i]; k++) glVertex3fv (stitchPt (C, i, k));
+    glEnd();
+   }
+}
+
+/******************************************************************************
+	Draw the tracked silhouette.
+******************************************************************************/
+
+void drawTrack ()
+{
+  double P[3], foo[3];
+  for (int i=0; i<nTrack; i++)
+   {
+    glBegin (track[i].closed ? GL_LINE_LOOP : GL_LINE_STRIP);
+    for (int k=0; k<track[i].n; k++)
+     {
+      evalSilhSurf (silhSurf, track[i].u[k], track[i].v[k], P, foo, foo);
+      glVertex3f (P[0], P[1], P[2]);
+     }
+    glEnd();
+   }
+}
+
+/******************************************************************************
+	Full computation of the silhouette from viewpt: duals of the
+	viewpoint (if newViewpt), their intersections with the tangential
+	surfaces, mapped back to obstacle[0] and stitched.  Then start
+	tracking from it.
+******************************************************************************/
+
+void computeSilhouette (int newViewpt)
+{
+  PatchIntArrArrArr fooTrace;
+  static TangSurfNet obNet[3];		// nets of obdualA/B/C[0], read once
+  static int obNetRead=0;		// for every viewpoint
+  int s;
+  if (newViewpt)
+   {
+    viewptadual.createA (0,viewpt);  viewptadual.prepareDisplay (density);
+    viewptbdual.createB (0,viewpt);  viewptbdual.prepareDisplay (density);
+    viewptcdual.createC (0,viewpt);  viewptcdual.prepareDisplay (density);
+   }
+  if (CULL && !obNetRead)
+   {
+    TangentialSurf *obdual[3] = {&obdualA[0], &obdualB[0], &obdualC[0]};
+    for (s=0; s<3; s++) readTangSurfNet (*obdual[s], obNet[s]);
+    obNetRead = 1;
+   }
+  TangSurfNet *net[3];
+  for (s=0; s<3; s++) net[s] = (CULL && obNet[s].ctrl ? &obNet[s] : NULL);
+  cout << "Intersection in a-space" << endl;
+  if (CULL) cullIntersectNets (viewptadual, NULL, obdualA[0], net[0], iCurveadual, fooTrace, epsInt, "a");
+  else      viewptadual.intersect (obdualA[0], iCurveadual, fooTrace, epsInt);
+  cout << "Intersection in b-space" << endl;
+  if (CULL) cullIntersectNets (viewptbdual, NULL, obdualB[0], net[1], iCurvebdual, fooTrace, epsInt, "b");
+  else      viewptbdual.intersect (obdualB[0], iCurvebdual, fooTrace, epsInt);
+  cout << "Intersection in c-space" << endl;
+  if (CULL) cullIntersectNets (viewptcdual, NULL, obdualC[0], net[2], iCurvecdual, fooTrace, epsInt, "c");
+  else      viewptcdual.intersect (obdualC[0], iCurvecdual, fooTrace, epsInt);
+  // cout << "Dual of a-silhouette: " << endl;  iCurveadual.print();
+  // cout << "Dual of b-silhouette: " << endl;  iCurvebdual.print();
+  // cout << "Dual of c-silhouette: " << endl;  iCurvecdual.print();
+  cout << "Computing silhouette from intersection curve" << endl;
+  obstacle[0].bMap (iCurveadual, iCurveaprimal);
+  obstacle[0].bMap (iCurvebdual, iCurvebprimal);
+  obstacle[0].bMap (iCurvecdual, iCurvecprimal);
+  // cout << "a-silhouette: " << endl;  iCurveaprimal.print();
+  // cout << "b-silhouette: " << endl;  iCurvebprimal.print();
+  // cout << "c-silhouette: " << endl;  iCurvecprimal.print();
+  // stitch together the silhouette curves from the three dual spaces
+  silhouette =  iCurveaprimal;
+  silhouette += iCurvebprimal;
+  silhouette += iCurvecprimal;
+  StitchFrags frag;  StitchPlan plan;
+  readFrags (silhouette, frag);
+  planStitch (frag, 10*epsInt, plan);
+  freeStitchCurves (silhCurves);
+  applyStitch (plan, frag, silhCurves);
+  cout << "Stitched " << frag.n << " silhouette fragments into " << silhCurves.nCurve << " curves" << endl;
+  freeStitchPlan (plan);  freeFrags (frag);
+  // cout << "Full silhouette: " << endl; silhouette.print();
+  double E[3] = {viewpt[0], viewpt[1], viewpt[2]};
+  seedTrack (E);
+  TRACKED = 0;
+}
+
+/******************************************************************************
+	Orbit the viewpoint by degrees about the vertical (y) axis through
+	the origin, updating the silhouette.
+******************************************************************************/
+
+void orbitViewpt (float degrees)
+{
+  float a = degrees * M_PI / 180., x = viewpt[0], z = viewpt[2];
+  viewpt[0] =  cos(a)*x + sin(a)*z;
+  viewpt[2] = -sin(a)*x + cos(a)*z;
+  double E[3] = {viewpt[0], viewpt[1], viewpt[2]};
+  double t = taskClock();
+  if (trackSilhouette (E))
+   {
+    // the viewpoint duals are planes: cheap to keep current
+    viewptadual.createA (0,viewpt);  viewptadual.prepareDisplay (density);
+    viewptbdual.createB (0,viewpt);  viewptbdual.prepareDisplay (density);
+    viewptcdual.createC (0,viewpt);  viewptcdual.prepareDisplay (density);
+    TRACKED = 1;  nTracked++;
+   }
+  else { computeSilhouette (1);  nRecomputed++; }
+  trackSec += taskClock() - t;
+  if (nTracked + nRecomputed == 90)
+   {
+    cout << nTracked << " frames tracked, " << nRecomputed << " recomputed; " 
+	 << 1000*trackSec/90 << " ms per frame" << endl;
+    nTracked = nRecomputed = 0;  trackSec = 0;
+   }
+  int win = glutGetWindow(), all[4] = {obstacleWin, dualWinA, dualWinB, dualWinC};
+  for (int w=0; w<4; w++)			// cameras follow the viewpoint
+   {
+    glutSetWindow (all[w]);
+    reshape (glutGet (GLUT_WINDOW_WIDTH), glutGet (GLUT_WINDOW_HEIGHT));
+    glutPostRedisplay();
+   }
+  glutSetWindow (win);
+}
+
+/******************************************************************************/
+/******************************************************************************/
+
+void OrbitView (void)
+{
+  orbitViewpt (ORBITSTEP);
+  glutPostRedisplay();
+}
+
 /******************************************************************************/
 /******************************************************************************/
 
@@ -235,6 +841,7 @@ void visibility (int status)
     glutIdleFunc (NULL);
   else if (ROTATEOB) glutIdleFunc (RotateOb);
   else if (PANOB)    glutIdleFunc (PanOb);
+  else if (ORBIT)    glutIdleFunc (OrbitView);
 }
 
 /******************************************************************************/
@@ -417,6 +1024,12 @@ void keyboard (unsigned char key, int x, int y)
   case 's': 	DRAWSILHOUETTE=!DRAWSILHOUETTE; break;
   case 'c': 	DRAWSILHOUETTECOMP=!DRAWSILHOUETTECOMP; break;
   case 'o':	ORTHO = !ORTHO;			break;
+  case 'O':	ORBIT = !ORBIT;				// orbit viewpoint
+		if (ORBIT) 
+		     glutIdleFunc (OrbitView); 
+		else glutIdleFunc (NULL); 	break;
+  case '[':	orbitViewpt (-ORBITSTEP);	break;	// step viewpoint
+  case ']':	orbitViewpt (ORBITSTEP);	break;
   case 'f':	break;
   default:      break;
   }
@@ -452,6 +1065,10 @@ void menuOb (int value)
   case 11: 	DRAWSILHOUETTECOMP=!DRAWSILHOUETTECOMP; break;
   case 12: 	DRAWSILHOUETTE=!DRAWSILHOUETTE; break;
   case 13: 	ORTHO = !ORTHO;			break;
+  case 14:	ORBIT = !ORBIT;
+		if (ORBIT) 
+		     glutIdleFunc (OrbitView); 
+		else glutIdleFunc (NULL); 	break;
   }
   glutPostRedisplay();
 }
@@ -573,7 +1190,7 @@ void displayOb ()
     glEnd();
     glEnable (GL_LIGHTING);    
    }
-  if (DRAWSILHOUETTECOMP)
+  if (DRAWSILHOUETTECOMP && !TRACKED)
    {
     glDisable (GL_LIGHTING);
     glLineWidth (3.0);
@@ -590,7 +1207,7 @@ void displayOb ()
    {
     glDisable (GL_LIGHTING);
     if (PRINTOUT) glColor3fv (Black); else glColor3fv (Black);
-    silhouette.draw();
+    if (TRACKED) drawTrack(); else drawStitch (silhCurves);
     glEnable (GL_LIGHTING);
    }
 
@@ -698,7 +1315,7 @@ void displayDualA ()
       viewptadual.drawT(density,0);
      }
    }
-  if (DRAWSILHOUETTECOMP)
+  if (DRAWSILHOUETTECOMP && !TRACKED)
    {
     glDisable (GL_LIGHTING);	// draw silhouette in dual space
     glLineWidth (3.0);
@@ -809,7 +1426,7 @@ void displayDualB ()
       viewptbdual.drawT(density,0);
      }
    }
-  if (DRAWSILHOUETTECOMP)
+  if (DRAWSILHOUETTECOMP && !TRACKED)
    {
     glDisable (GL_LIGHTING);	// draw silhouette in dual space
     glLineWidth (3.0);
@@ -921,7 +1538,7 @@ void displayDualC ()
       viewptcdual.drawT(density,0);
      }
    }
-  if (DRAWSILHOUETTECOMP)
+  if (DRAWSILHOUETTECOMP && !TRACKED)
    {
     glDisable (GL_LIGHTING);	// draw silhouette in dual space
     glLineWidth (3.0);
@@ -966,16 +1583,69 @@ void inputSurfaces (char *file, Array<BezierSurf3f> &obstacle)
       obstacle[i].create (3, 3, 3, numSegu, numSegv, Pt[i], knotu, knotv);
      }
     else obstacle[i].fit (Pt[i]);
-    obstacle[i].prepareDisplay (density);
    }
 }
 
+/******************************************************************************
+	Tasks of the tangential surface system (see readInput):
+	for obstacle i, the components of its tangential surfaces,
+	then its tangential a-, b- and c-surfaces, then their display;
+	and the a-, b- and c-duals of the viewpoint, then their display.
+	Each writes only to its own surface.
+******************************************************************************/
+
+struct TangSurfComponents	// shared by the a-, b- and c-surface of an obstacle
+{
+  BezierSurf1f a,b,c,d;
+};
+
+void componentsTask (int i, void *comp)
+{
+  TangSurfComponents &C = ((TangSurfComponents *) comp)[i];
+  obdualA[i].tangSurfComponents (obstacle[i], C.a, C.b, C.c, C.d);
+}
+
+void createATask (int i, void *comp)
+{
+  TangSurfComponents &C = ((TangSurfComponents *) comp)[i];
+  obdualA[i].createA (i, C.a, C.b, C.c, C.d, eps);
+}
+
+void createBTask (int i, void *comp)
+{
+  TangSurfComponents &C = ((TangSurfComponents *) comp)[i];
+  obdualB[i].createB (i, C.a, C.b, C.c, C.d, eps);
+}
+
+void createCTask (int i, void *comp)
+{
+  TangSurfComponents &C = ((TangSurfComponents *) comp)[i];
+  obdualC[i].createC (i, C.a, C.b, C.c, C.d, eps);
+}
+
+void displayObstacleTask (int i, void *) { obstacle[i].prepareDisplay (density); }
+void displayATask        (int i, void *) { obdualA[i].prepareDisplay (density); }
+void displayBTask        (int i, void *) { obdualB[i].prepareDisplay (density); }
+void displayCTask        (int i, void *) { obdualC[i].prepareDisplay (density); }
+
+void viewptATask (int, void *) { viewptadual.createA (0,viewpt);  viewptadual.prepareDisplay (density); }
+void viewptBTask (int, void *) { viewptbdual.createB (0,viewpt);  viewptbdual.prepareDisplay (density); }
+void viewptCTask (int, void *) { viewptcdual.createC (0,viewpt);  viewptcdual.prepareDisplay (density); }
+
+static WorkStealTask createTask[3]   = {createATask,  createBTask,  createCTask};
+static WorkStealTask displayTask[3]  = {displayATask, displayBTask, displayCTask};
+static WorkStealTask viewptTask[3]   = {viewptATask,  viewptBTask,  viewptCTask};
+static const char   *createStage[3]  = {"createA",  "createB",  "createC"};
+static const char   *displayStage[3] = {"displayA", "displayB", "displayC"};
+static const char   *viewptStage[3]  = {"viewpointA", "viewpointB", "viewpointC"};
+
 /******************************************************************************
 ******************************************************************************/
 
 void readInput(char *file)
 {
-  int i,nOb;
+  int i,s,nOb;
+  TangSurfComponents *comp=NULL;
   if (STORED)		// read in tangential surface system from file storage
    {
    		cout << "Using stored tangential surface system" << endl;
@@ -996,33 +1666,46 @@ void readInput(char *file)
       getRightBrace (infile);
      }
     infile.close();
-		cout << "Preparing display of obstacle" << endl;
-    for (i=0; i<nOb; i++) obstacle[i].prepareDisplay (density);
    }
   else			// compute tangential surface system from scratch
    {
     inputSurfaces (file, obstacle);
     nOb = obstacle.getn();
     obdualA.allocate(nOb); obdualB.allocate(nOb); obdualC.allocate(nOb);
-    for (i=0; i<nOb; i++)	// build tangential surfaces in 3 dual spaces
-     {
-      BezierSurf1f a,b,c,d;
-      obdualA[i].tangSurfComponents (obstacle[i], a, b, c, d);
-      obdualA[i].createA (i,a,b,c,d,eps);
-      obdualB[i].createB (i,a,b,c,d,eps);
-      obdualC[i].createC (i,a,b,c,d,eps);
-     }
+    comp = new TangSurfComponents[nOb];
    }
-  if (!NOTANGDISPLAY)
-    for (i=0; i<nOb; i++)
+  // one task per obstacle and dual space, and per display,
+  // each waiting only for what it uses
+  TaskGraph G;
+  initTaskGraph (G, 8*nOb + 3);
+  for (s=0; s<3; s++) addTask (G, viewptStage[s], 0, viewptTask[s], NULL);
+  for (i=0; i<nOb; i++)
+   {
+    int built[3] = {-1,-1,-1};		// tasks building a-, b- and c-surface
+    int d = addTask (G, "displayObstacle", i, displayObstacleTask, NULL);
+    if (!STORED)
      {
-		cout << "Preparing display of tangential a-surface for obstacle " << i << "..." << endl; 
-      obdualA[i].prepareDisplay (density);
-		cout << "Preparing display of tangential b-surface for obstacle " << i << "..." << endl; 
-      obdualB[i].prepareDisplay (density);
-		cout << "Preparing display of tangential c-surface for obstacle " << i << "..." << endl; 
-      obdualC[i].prepareDisplay (density);
+      int c = addTask (G, "components", i, componentsTask, comp);
+      addDependency (G, c, d);		// display data of the obstacle is written
+      for (s=0; s<3; s++)		// only after its components are read
+       {
+        built[s] = addTask (G, createStage[s], i, createTask[s], comp);
+	addDependency (G, c, built[s]);
+       }
      }
+    if (!NOTANGDISPLAY)
+      for (s=0; s<3; s++)
+       {
+        int d = addTask (G, displayStage[s], i, displayTask[s], NULL);
+	if (built[s] != -1) addDependency (G, built[s], d);
+       }
+   }
+  if (nThread == -1) nThread = nProcessor();	// not set by 't' parameter
+  cout << "Building tangential surfaces (" << G.n << " tasks on " << nThread << " threads)..." << endl;
+  runTaskGraph (G, nThread);
+  reportTaskGraph (G);
+  freeTaskGraph (G);
+  delete [] comp;
 }
 
 /******************************************************************************
@@ -1049,43 +1732,18 @@ int main (int argc, char **argv)
       		viewpt[1] = atof(argv[ArgsParsed++]);
 		viewpt[2] = atof(argv[ArgsParsed++]);	break;
       case 'D': NOTANGDISPLAY = 1;			break;
+      case 't': nThread = atoi(argv[ArgsParsed++]);	break;
+      case 'c': CULL = 0;				break;
       case 'h': 
       default:	usage(); exit(-1);			break;
       }
    else ArgsParsed++;
   }
   
-  readInput(argv[argc-1]);
-  viewptadual.createA (0,viewpt);
-  viewptbdual.createB (0,viewpt);
-  viewptcdual.createC (0,viewpt);
-  viewptadual.prepareDisplay (density);
-  viewptbdual.prepareDisplay (density);
-  viewptcdual.prepareDisplay (density);
-  PatchIntArrArrArr fooTrace;
-  cout << "Intersection in a-space" << endl;
-  viewptadual.intersect (obdualA[0], iCurveadual, fooTrace, epsInt);
-  cout << "Intersection in b-space" << endl;
-  viewptbdual.intersect (obdualB[0], iCurvebdual, fooTrace, epsInt);
-  cout << "Intersection in c-space" << endl;
-  viewptcdual.intersect (obdualC[0], iCurvecdual, fooTrace, epsInt);
-  // cout << "Dual of a-silhouette: " << endl;  iCurveadual.print();
-  // cout << "Dual of b-silhouette: " << endl;  iCurvebdual.print();
-  // cout << "Dual of c-silhouette: " << endl;  iCurvecdual.print();
-  cout << "Computing silhouette from intersection curve" << endl;
-  obstacle[0].bMap (iCurveadual, iCurveaprimal);
-  obstacle[0].bMap (iCurvebdual, iCurvebprimal);
-  obstacle[0].bMap (iCurvecdual, iCurvecprimal);
-  // cout << "a-silhouette: " << endl;  iCurveaprimal.print();
-  // cout << "b-silhouette: " << endl;  iCurvebprimal.print();
-  // cout << "c-silhouette: " << endl;  iCurvecprimal.print();
-  // stitch together the silhouette curves from the three dual spaces
-  silhouette =  iCurveaprimal;
-  silhouette += iCurvebprimal;
-  silhouette += iCurvecprimal;
-  while (silhouette.spliceClosest (10*epsInt,0,1))	// commented out until recently
-    ; 
-  // cout << "Full silhouette: " << endl; silhouette.print();
+  readInput(argv[argc-1]);		// and viewpoint duals
+  if (readSilhSurf (obstacle[0], silhSurf))
+    cout << "Control net of obstacle not understood: no tracking" << endl;
+  computeSilhouette (0);
 
   uFirstKnot = obstacle[0].getKnotu(0);	
   vFirstKnot = obstacle[0].getKnotv(0);
@@ -1143,6 +1801,7 @@ int main (int argc, char **argv)
   glutAddMenuEntry ("Silhouette [s]",			     12);
   glutAddMenuEntry ("Flip normals [f]",			     10);
   glutAddMenuEntry ("Orthographic projection [o]",	     13);
+  glutAddMenuEntry ("Orbit viewpoint [O]",		     14);
   glutAttachMenu (GLUT_RIGHT_BUTTON);
 							// a-dual window
   glutInitWindowPosition (xleft+xsize+2*barmargin-1, titleht+10);  